@@ -1,6 +1,10 @@
 #ifndef FLATNORMALTHRESHPOINTCOMPATIBILITYFUNC_HEADER
 #define FLATNORMALTHRESHPOINTCOMPATIBILITYFUNC_HEADER
 #include <GfxTL/MathHelper.h>
+#include "SoAPointBlock.h"
+#include "Plane.h"
+#include "Sphere.h"
+#include "Cylinder.h"
 
 class FlatNormalThreshPointCompatibilityFunc
 {
@@ -26,6 +30,87 @@ public:
 		return distance < m_distThresh
 			&& fabs(normalDeviation) >= m_normalThresh;
 	}
+	// The compatibility of all points of a block with a shape. Planes, spheres, and cylinders are
+	// evaluated by vectorized kernels, the other shapes point by point. All give the same result as above.
+	template< class ShapeT >
+	void operator()(const ShapeT &shape, SoAPointBlock *block) const
+	{
+		for(size_t j = 0; j < block->size; ++j)
+		{
+			Vec3f n;
+			float distance = shape.DistanceAndNormal(
+				Vec3f(block->x[j], block->y[j], block->z[j]), &n);
+			block->compatible[j] = distance < m_distThresh
+				&& fabs(n.dot(Vec3f(block->nx[j], block->ny[j], block->nz[j]))) >= m_normalThresh;
+		}
+	}
+	void operator()(const Plane &plane, SoAPointBlock *block) const
+	{
+		const float a = plane.getNormal()[0], b = plane.getNormal()[1],
+			c = plane.getNormal()[2], d = plane.SignedDistToOrigin();
+		const float distThresh = m_distThresh, normalThresh = m_normalThresh;
+		const float *x = block->x, *y = block->y, *z = block->z,
+			*nx = block->nx, *ny = block->ny, *nz = block->nz;
+		unsigned char *compatible = block->compatible;
+		const int size = static_cast< int >(block->size);
+#ifdef DOPARALLEL
+		#pragma omp simd
+#endif
+		for(int j = 0; j < size; ++j)
+		{
+			const float distance = fabs(d - (a * x[j] + b * y[j] + c * z[j]));
+			const float deviation = fabs(a * nx[j] + b * ny[j] + c * nz[j]);
+			compatible[j] = (distance < distThresh) & (deviation >= normalThresh);
+		}
+	}
+	void operator()(const Sphere &sphere, SoAPointBlock *block) const
+	{
+		const float cx = sphere.Center()[0], cy = sphere.Center()[1],
+			cz = sphere.Center()[2], r = sphere.Radius();
+		const float distThresh = m_distThresh, normalThresh = m_normalThresh;
+		const float *x = block->x, *y = block->y, *z = block->z,
+			*nx = block->nx, *ny = block->ny, *nz = block->nz;
+		unsigned char *compatible = block->compatible;
+		const int size = static_cast< int >(block->size);
+#ifdef DOPARALLEL
+		#pragma omp simd
+#endif
+		for(int j = 0; j < size; ++j)
+		{
+			const float dx = x[j] - cx, dy = y[j] - cy, dz = z[j] - cz;
+			const float l = std::sqrt(dx * dx + dy * dy + dz * dz);
+			// divides (instead of multiplying by the inverse) like DistanceAndNormal(). If l == 0, the
+			// differences are 0 and so is the deviation.
+			const float s = l > 0 ? l : 1.f;
+			const float deviation = fabs((dx / s) * nx[j] + (dy / s) * ny[j] + (dz / s) * nz[j]);
+			compatible[j] = (fabs(l - r) < distThresh) & (deviation >= normalThresh);
+		}
+	}
+	void operator()(const Cylinder &cylinder, SoAPointBlock *block) const
+	{
+		const float px = cylinder.AxisPosition()[0], py = cylinder.AxisPosition()[1],
+			pz = cylinder.AxisPosition()[2];
+		const float ax = cylinder.AxisDirection()[0], ay = cylinder.AxisDirection()[1],
+			az = cylinder.AxisDirection()[2], r = cylinder.Radius();
+		const float distThresh = m_distThresh, normalThresh = m_normalThresh;
+		const float *x = block->x, *y = block->y, *z = block->z,
+			*nx = block->nx, *ny = block->ny, *nz = block->nz;
+		unsigned char *compatible = block->compatible;
+		const int size = static_cast< int >(block->size);
+#ifdef DOPARALLEL
+		#pragma omp simd
+#endif
+		for(int j = 0; j < size; ++j)
+		{
+			const float dx = x[j] - px, dy = y[j] - py, dz = z[j] - pz;
+			const float lambda = ax * dx + ay * dy + az * dz;
+			const float ox = dx - lambda * ax, oy = dy - lambda * ay, oz = dz - lambda * az;
+			const float axisDist = std::sqrt(ox * ox + oy * oy + oz * oz);
+			const float s = axisDist > 0 ? axisDist : 1.f;
+			const float deviation = fabs((ox / s) * nx[j] + (oy / s) * ny[j] + (oz / s) * nz[j]);
+			compatible[j] = (fabs(axisDist - r) < distThresh) & (deviation >= normalThresh);
+		}
+	}
 	float DistanceThresh() const { return m_distThresh; }
 	float NormalThresh() const { return m_normalThresh; }
 
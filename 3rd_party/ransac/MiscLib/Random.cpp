@@ -52,6 +52,8 @@ void MiscLib::rn_setseed(size_t seed)
   }
   for (j=0;j<LL;j++) rn_buf[j+KK-LL]=x[j];
   for (;j<KK;j++) rn_buf[j-LL]=x[j];  
+  // discard what is left of the previous sequence, so the same seed always gives the same sequence
+  rn_point = MiscLib_RN_BUFSIZE;
 }
 
 size_t MiscLib::rn_refresh()
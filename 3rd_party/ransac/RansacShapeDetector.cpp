@@ -6,6 +6,7 @@
 #include <functional>
 #include <ctime>
 #include <deque>
+#include <utility>
 #include <iostream>
 #include <MiscLib/Random.h>
 #include "Candidate.h"
@@ -98,17 +99,15 @@ void RansacShapeDetector::GenerateCandidates(
 	float *bestExpectedValue,
 	CandidatesType *candidates) const
 {
+	// The samples are drawn serially, because rand() and MiscLib::rn_rand() work on a global state
+	// that must not be shared between threads. Only the construction and the scoring of the candidates run in
+	// parallel, and their results are merged in the order of the samples, so the candidates do not depend on
+	// the number of threads.
+	const int numDraws = 200;
+	MiscLib::Vector< MiscLib::Vector< size_t > > drawnSamples(numDraws);
+	MiscLib::Vector< const IndexedOctreeType::CellType * > drawnNodes(numDraws, NULL);
 	size_t genCands = 0;
-
-#ifdef DOPARALLEL
-	#pragma omp parallel
-#endif
-	{
-	ScoreVisitorT scoreVisitorCopy(scoreVisitor);
-#ifdef DOPARALLEL
-	#pragma omp for schedule(dynamic, 10) reduction(+:genCands)
-#endif
-	for(int candIter = 0; candIter < 200; ++candIter)
+	for(int candIter = 0; candIter < numDraws; ++candIter)
 	{
 		// pick a sample level
 		double s = ((double)rand()) / (double)RAND_MAX;
@@ -117,12 +116,30 @@ void RansacShapeDetector::GenerateCandidates(
 			if(sampleLevelProbSum[sampleLevel] >= s)
 				break;
 		// draw samples on current sample level in octree
-		MiscLib::Vector< size_t > samples;
 		const IndexedOctreeType::CellType *node;
 		if(!DrawSamplesStratified(globalOctree, m_reqSamples, sampleLevel,
-			scoreVisitorCopy.GetShapeIndex(), &samples, &node))
+			scoreVisitor.GetShapeIndex(), &drawnSamples[candIter], &node))
 			continue;
+		drawnNodes[candIter] = node;
 		++genCands;
+	}
+
+	// the candidates constructed from each set of samples (the flag tells if a candidate is kept)
+	MiscLib::Vector< MiscLib::Vector< std::pair< Candidate, bool > > > constructed(numDraws);
+#ifdef DOPARALLEL
+	#pragma omp parallel
+#endif
+	{
+	ScoreVisitorT scoreVisitorCopy(scoreVisitor);
+#ifdef DOPARALLEL
+	#pragma omp for schedule(dynamic, 10)
+#endif
+	for(int candIter = 0; candIter < numDraws; ++candIter)
+	{
+		const IndexedOctreeType::CellType *node = drawnNodes[candIter];
+		if(!node)
+			continue;
+		const MiscLib::Vector< size_t > &samples = drawnSamples[candIter];
 		// construct the candidates
 		size_t c = samples.size();
 		MiscLib::Vector< Vec3f > samplePoints(samples.size() << 1);
@@ -162,31 +179,26 @@ void RansacShapeDetector::GenerateCandidates(
 			shape->Release();
 			cand.ImproveBounds(octrees, pc, scoreVisitorCopy,
 				currentSize, m_options.m_bitmapEpsilon, 1);
-			if(cand.UpperBound() < m_options.m_minSupport)
-			{
-#ifdef DOPARALLEL
-				#pragma omp critical
-#endif
-				{
-				(*sampleLevelScores)[node->Level()].first += cand.ExpectedValue();
-				++(*sampleLevelScores)[node->Level()].second;
-				}
-				continue;
-			}
-
-#ifdef DOPARALLEL
-			#pragma omp critical
-#endif
-			{
-				(*sampleLevelScores)[node->Level()].first += cand.ExpectedValue();
-				++(*sampleLevelScores)[node->Level()].second;
-				candidates->push_back(cand);
-				if(cand.ExpectedValue() > *bestExpectedValue)
-					*bestExpectedValue = cand.ExpectedValue();
-			}
+			constructed[candIter].push_back(std::make_pair(cand,
+				cand.UpperBound() >= m_options.m_minSupport));
 		}
 	}
 	}
+
+	for(int candIter = 0; candIter < numDraws; ++candIter)
+	{
+		for(size_t i = 0; i < constructed[candIter].size(); ++i)
+		{
+			const Candidate &cand = constructed[candIter][i].first;
+			(*sampleLevelScores)[cand.Level()].first += cand.ExpectedValue();
+			++(*sampleLevelScores)[cand.Level()].second;
+			if(!constructed[candIter][i].second)
+				continue;
+			candidates->push_back(cand);
+			if(cand.ExpectedValue() > *bestExpectedValue)
+				*bestExpectedValue = cand.ExpectedValue();
+		}
+	}
 	*drawnCandidates += genCands;
 }
 
@@ -460,8 +472,9 @@ RansacShapeDetector::Detect(PointCloud &pc, size_t beginIdx, size_t endIdx,
 	/*
 	 * Initialization part
 	 */
-	srand((unsigned int)time(NULL));
-	rn_setseed((size_t)time(NULL));
+	const size_t seed = m_options.m_seed ? m_options.m_seed : (size_t)time(NULL);
+	srand((unsigned int)seed);
+	rn_setseed(seed);
 
 	CandidatesType candidates;
 
@@ -719,9 +732,8 @@ RansacShapeDetector::Detect(PointCloud &pc, size_t beginIdx, size_t endIdx,
 				// reindex global octree
 				size_t minInvalidIndex = currentSize - numInvalid + beginIdx;
 				int j = 0;
-#ifdef DOPARALLEL
-				#pragma omp parallel for schedule(static)
-#endif
+				// This loop compacts the indices in place (via the shared counter j), so it must
+				// not be parallelized.
 				for(int i = 0; i < static_cast<int>(globalOctreeIndices.size()); ++i)
 					if(shapeIndex[globalOctreeIndices[i]] < minInvalidIndex)
 						globalOctreeIndices[j++] = shapeIndex[globalOctreeIndices[i]];
@@ -814,13 +826,22 @@ RansacShapeDetector::Detect(PointCloud &pc, size_t beginIdx, size_t endIdx,
 			{
 				// the bounds of the candidates have become invalid and have to be
 				// recomputed
+				// The visitor stores the indices and the octree it is working on, so each thread
+				// needs its own copy (as in GenerateCandidates()).
 #ifdef DOPARALLEL
-				#pragma omp parallel for schedule(static, 100)
+				#pragma omp parallel
+#endif
+				{
+				ScorePrimitiveShapeVisitor< FlatNormalThreshPointCompatibilityFunc,
+					ImmediateOctreeType > scoreVisitorCopy(subsetScoreVisitor);
+#ifdef DOPARALLEL
+				#pragma omp for schedule(static, 100)
 #endif
 				for(int i = 0; i < static_cast<int>(candidates.size()); ++i)
-					candidates[i].RecomputeBounds(octrees, pc, subsetScoreVisitor,
+					candidates[i].RecomputeBounds(octrees, pc, scoreVisitorCopy,
 						currentSize - numInvalid, m_options.m_epsilon,
 						m_options.m_normalThresh, m_options.m_bitmapEpsilon);
+				}
 			}
 			// remove all candidates that have become obsolete
 			std::sort(candidates.begin(), candidates.end(), std::greater< Candidate >());
@@ -85,9 +85,7 @@ struct ScoreAACubeTreeStrategy
 				//}
 				//else
 				//{
-					for(typename BaseType::HandleType h = cell.Range().first;
-						h != cell.Range().second; ++h)
-						(*score)(shape, *this, this->Dereference(h));
+					(*score)(shape, *this, cell.Range().first, cell.Range().second);
 				//}
 				return;
 			}
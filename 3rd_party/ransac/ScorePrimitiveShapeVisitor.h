@@ -1,6 +1,7 @@
 #ifndef SCOREPRIMITIVESHAPEVISITOR_HEADER
 #define SCOREPRIMITIVESHAPEVISITOR_HEADER
 #include "PrimitiveShapeVisitor.h"
+#include "SoAPointBlock.h"
 #include <MiscLib/RefCounted.h>
 #include <MiscLib/RefCountPtr.h>
 #include <MiscLib/NoShrinkVector.h>
@@ -44,6 +45,27 @@ public:
 		if(m_pointComp(shape, oct, i))
 			m_indices->push_back(i);
 	}
+	// Scores all points of an octree cell. The points are gathered into blocks in a
+	// structure-of-arrays layout and each block is scored at once (see SoAPointBlock).
+	template< class ShapeT, class OctT, class HandleT >
+	void operator()(const ShapeT &shape, const OctT &oct, HandleT begin, HandleT end)
+	{
+		SoAPointBlock block;
+		for(HandleT h = begin; h != end;)
+		{
+			block.Clear();
+			for(; h != end && !block.Full(); ++h)
+			{
+				size_t i = oct.Dereference(h);
+				if((*m_shapeIndex)[i] == -1)
+					block.Add(oct.at(i), i);
+			}
+			m_pointComp(shape, &block);
+			for(size_t j = 0; j < block.size; ++j)
+				if(block.compatible[j])
+					m_indices->push_back(block.index[j]);
+		}
+	}
 	float Epsilon() const { return m_pointComp.DistanceThresh(); }
 	//size_t &UpperBound() { return m_upperBound; }
 	//size_t &SampledPoints() { return m_sampled; }
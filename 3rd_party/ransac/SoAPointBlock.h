@@ -0,0 +1,35 @@
+#ifndef SOAPOINTBLOCK_HEADER
+#define SOAPOINTBLOCK_HEADER
+#include "PointCloud.h"
+
+// A block of points of an octree cell in a structure-of-arrays layout. Scoring a shape against a
+// block (see FlatNormalThreshPointCompatibilityFunc) runs a single loop over contiguous arrays, which the
+// compiler can vectorize, instead of calling the distance function of the shape for every point.
+struct SoAPointBlock
+{
+	enum { Capacity = 64 };
+
+	SoAPointBlock() : size(0) {}
+	void Clear() { size = 0; }
+	bool Full() const { return size == Capacity; }
+	void Add(const Point &p, size_t i)
+	{
+		x[size] = p.pos[0];
+		y[size] = p.pos[1];
+		z[size] = p.pos[2];
+		nx[size] = p.normal[0];
+		ny[size] = p.normal[1];
+		nz[size] = p.normal[2];
+		index[size] = i;
+		++size;
+	}
+
+	float x[Capacity], y[Capacity], z[Capacity];
+	float nx[Capacity], ny[Capacity], nz[Capacity];
+	size_t index[Capacity];
+	// the result of the scoring: nonzero if the point is compatible with the shape
+	unsigned char compatible[Capacity];
+	size_t size;
+};
+
+#endif
@@ -2100,6 +2100,15 @@ void MainWindow::applyManipulatedTransformation() {
         auto &points = model->points();
         for (auto &p: points)
             p = manip * p;
+        // the points were modified in place, which must be announced (e.g., the point picker caches a spatial index)
+        if (dynamic_cast<SurfaceMesh *>(model))
+            dynamic_cast<SurfaceMesh *>(model)->get_vertex_property<vec3>("v:point").notify_modified();
+        else if (dynamic_cast<PointCloud *>(model))
+            dynamic_cast<PointCloud *>(model)->get_vertex_property<vec3>("v:point").notify_modified();
+        else if (dynamic_cast<Graph *>(model))
+            dynamic_cast<Graph *>(model)->get_vertex_property<vec3>("v:point").notify_modified();
+        else if (dynamic_cast<PolyMesh *>(model))
+            dynamic_cast<PolyMesh *>(model)->get_vertex_property<vec3>("v:point").notify_modified();
 
         if (dynamic_cast<SurfaceMesh *>(model)) {
             dynamic_cast<SurfaceMesh *>(model)->update_vertex_normals();
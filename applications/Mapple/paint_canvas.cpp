@@ -1134,6 +1134,12 @@ void PaintCanvas::paintGL() {
     }
 #endif
 
+    // pick up the latest snapshots published by other threads
+    for (auto m : models_) {
+        if (m->renderer())
+            m->renderer()->apply_published();
+    }
+
     preDraw();
 
     draw();
@@ -243,7 +243,8 @@ bool PaintCanvas::saveSnapshot(int w, int h, int samples, const QString &file_na
 
 #ifdef HAS_FFMPEG
 
-#include <easy3d/video/video_encoder.h>
+#include <easy3d/video/video_recorder.h>
+#include <easy3d/renderer/frame_capture.h>
 
 void PaintCanvas::recordAnimation(const QString &file_name, int fps, int bit_rate, bool bk_white) {
     auto kfi = walkThrough()->interpolator();
@@ -275,10 +276,10 @@ void PaintCanvas::recordAnimation(const QString &file_name, int fps, int bit_rat
 
     const int fw = static_cast<int>(static_cast<float>(w) * dpi_scaling());
     const int fh = static_cast<int>(static_cast<float>(h) * dpi_scaling());
-    VideoEncoder encoder;
-    if (!encoder.start(file_name.toStdString(), fps, bitrate)) {
+    // conversion and encoding run on worker threads, so rendering is not blocked by the encoder
+    VideoRecorder recorder;
+    if (!recorder.start(file_name.toStdString(), fps, bitrate)) {
         // clean up and restore the settings before exit
-        encoder.end();
         setEnabled(true);
         easy3d::connect(&camera_->frame_modified, this, static_cast<void (PaintCanvas::*)(void)>(&PaintCanvas::update));
         return;
@@ -297,6 +298,9 @@ void PaintCanvas::recordAnimation(const QString &file_name, int fps, int bit_rat
     auto fbo = new FramebufferObject(fw, fh, samples());
     fbo->add_color_buffer();
     fbo->add_depth_buffer();
+    // the frames are read back asynchronously and retrieved a few frames later
+    auto capture = new FrameCapture(fw, fh);
+    std::vector<unsigned char> data;
 #endif
 
 #ifdef SHOW_PROGRESS
@@ -341,14 +345,13 @@ void PaintCanvas::recordAnimation(const QString &file_name, int fps, int bit_rat
         }
         if (image.format() != QImage::Format_RGBA8888)
             image = image.convertToFormat(QImage::Format_RGBA8888);
-        if (!encoder.encode(image.constBits(), image.width(), image.height(), VideoEncoder::PIX_FMT_RGBA_8888)) {
+        std::vector<unsigned char> data(image.constBits(), image.constBits() + image.width() * image.height() * 4);
+        if (!recorder.add_frame(std::move(data), image.width(), image.height())) {
             success = false;
             break;
         }
 #else
-        std::vector<unsigned char> data;
-        fbo->read_color(0, data, GL_RGBA);
-        if (!encoder.encode(data.data(), fw, fh, VideoEncoder::PIX_FMT_RGBA_8888)) {
+        if (capture->capture(fbo, data) && !recorder.add_frame(std::move(data), fw, fh, true)) {
             success = false;
             break;
         }
@@ -361,13 +364,22 @@ void PaintCanvas::recordAnimation(const QString &file_name, int fps, int bit_rat
 
     // this very important (the progress bar may interfere the framebuffer)
     makeCurrent();
+#ifndef USE_QT_FBO
+    // the last frames are still in the pixel buffers
+    while (success && capture->retrieve(data)) {
+        if (!recorder.add_frame(std::move(data), fw, fh, true))
+            success = false;
+    }
+    delete capture;
+#endif
     // clean
     delete fbo;
     // restore the clear color
     func_->glClearColor(background_color_[0], background_color_[1], background_color_[2], background_color_[3]);
     doneCurrent();
 
-    encoder.end();
+    if (!recorder.end())
+        success = false;
 
     // enable updating the rendering
     easy3d::connect(&camera_->frame_modified, this, static_cast<void (PaintCanvas::*)(void)>(&PaintCanvas::update));  // this works
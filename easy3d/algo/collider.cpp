@@ -25,21 +25,429 @@
  ********************************************************************/
 
 #include <easy3d/algo/collider.h>
+#include <easy3d/core/box.h>
+#include <easy3d/core/quat.h>
 #include <easy3d/util/stop_watch.h>
 
+#include <unordered_map>
+#include <algorithm>
+
 #include <3rd_party/opcode/Opcode.h>
 
+// Opcode redefines 'for' for the scoping rule of ancient compilers, which breaks the OpenMP pragmas
+#ifdef for
+#undef for
+#endif
+
 using namespace Opcode;
 using namespace IceMaths;
 
 
 namespace internal {
 
+    // builds the AABB tree of a triangle mesh. Returns nullptr on failure.
+    Opcode::Model* build_model(const easy3d::SurfaceMesh* mesh) {
+        if (!mesh->is_triangle_mesh()) {
+            LOG(WARNING) << "the mesh (" << mesh->name() << ") is not a triangle mesh";
+            return nullptr;
+        }
+
+        if (mesh->n_vertices() <= 0 || mesh->n_faces() <= 0) {
+            LOG(WARNING) << "invalid geometry";
+            return nullptr;
+        }
+
+        const auto& pts = mesh->points();
+        auto vertices = new Point[pts.size()];
+        for (std::size_t i=0; i<pts.size(); ++i)
+                vertices[i].Set(pts[i]);
+
+        auto indices = new IndexedTriangle[mesh->n_faces()];
+        for (const auto& f : mesh->faces()) {
+                std::vector<int> ids;
+                for (const auto& v : mesh->vertices(f))
+                        ids.push_back(v.idx());
+                indices[f.idx()] = IndexedTriangle(ids[0], ids[1], ids[2]);
+            }
+
+        auto mesh_interface = new MeshInterface();
+        mesh_interface->SetNbTriangles(mesh->n_faces());
+        mesh_interface->SetNbVertices(mesh->n_vertices());
+        mesh_interface->SetPointers(indices, vertices);
+
+        auto release_mesh_interface = [&]() -> Opcode::Model* {
+            delete [] indices;
+            delete [] vertices;
+            delete mesh_interface;
+            return nullptr;
+        };
+
+        udword degenerated_faces = mesh_interface->CheckTopology();
+        if (degenerated_faces != 0) {
+            LOG(WARNING) << "model has " << degenerated_faces << " degenerated faces and cannot be processed";
+            return release_mesh_interface();
+        }
+        if (!mesh_interface->IsValid()) {
+            LOG(WARNING) << "the mesh if not valid and cannot be processed";
+            return release_mesh_interface();
+        }
+
+        BuildSettings settings;
+        settings.mLimit = 1;
+        settings.mRules = SPLIT_SPLATTER_POINTS | SPLIT_GEOM_CENTER;
+
+        OPCODECREATE data;
+        data.mIMesh = mesh_interface;
+        data.mCanRemap = false;
+        data.mKeepOriginal = false;
+        data.mNoLeaf = true;
+        data.mQuantized = true;
+        data.mSettings = settings;
+
+        auto model = new Opcode::Model();
+        if (!model->Build(data)) {
+            LOG(WARNING) << "failed building AABB tree for the mesh";
+            delete model;
+            return release_mesh_interface();
+        }
+        return model;
+    }
+
+
+    // releases the AABB tree and the mesh interface of a model
+    void destroy_model(Opcode::Model* model) {
+        if (!model)
+            return;
+        auto mesh_interface = model->GetMeshInterface();
+        delete [] mesh_interface->GetTris();
+        delete [] mesh_interface->GetVerts();
+        delete mesh_interface;
+        delete model;
+    }
+
+
+    AABBTreeCollider* create_collider(bool first_contact = false) {
+        auto collider = new AABBTreeCollider;
+        collider->SetFirstContact(first_contact);
+        collider->SetTemporalCoherence(false);
+        collider->SetPrimitiveTests(true);
+        const char* msg = collider->ValidateSettings();
+        if (msg) {
+            LOG(WARNING) << "failed setting AABB tree collider: " << msg;
+            delete collider;
+            return nullptr;
+        }
+        return collider;
+    }
+
+
+    void to_opcode_matrix(const easy3d::mat4 &m, Matrix4x4& trans) {
+        for (auto i = 0; i < 4; ++i) {
+            for (auto j = 0; j < 4; ++j) {
+                // ToDo: Why transpose? (opcode requires 'world' matrix)
+                trans[i][j] = m(j, i);
+            }
+        }
+    }
+
+
+    // the narrow phase: collects the intersecting face pairs of the two models in the cache
+    bool collide(AABBTreeCollider* collider, BVTCache& cache, const Matrix4x4& trans0, const Matrix4x4& trans1,
+                 std::vector<std::pair<easy3d::SurfaceMesh::Face, easy3d::SurfaceMesh::Face> >& result)
+    {
+        if (!collider->Collide(cache, &trans0, &trans1)) {
+            LOG(WARNING) << "failed detecting collision";
+            return false;
+        }
+
+        if (collider->GetContactStatus()) {
+            const udword num = collider->GetNbPairs();
+            result.resize(num);
+            const Pair* pairs = collider->GetPairs();
+            for (udword i = 0; i < num; ++i) {
+                const Pair& pair = pairs[i];
+                result[i] = { easy3d::SurfaceMesh::Face(static_cast<int>(pair.id0)), easy3d::SurfaceMesh::Face(static_cast<int>(pair.id1)) };
+            }
+        }
+        return true;
+    }
+
+
+    // the squared distance between two line segments (see "Real-Time Collision Detection", Section 5.1.9)
+    float segment_segment_sqr_distance(const easy3d::vec3& p0, const easy3d::vec3& p1,
+                                       const easy3d::vec3& q0, const easy3d::vec3& q1)
+    {
+        const float eps = 1e-12f;
+        const easy3d::vec3 d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+        const float a = easy3d::dot(d1, d1), e = easy3d::dot(d2, d2), f = easy3d::dot(d2, r);
+        float s = 0.0f, t = 0.0f;
+        if (a <= eps && e <= eps)
+            return easy3d::length2(r);
+        if (a <= eps)
+            t = easy3d::clamp(f / e, 0.0f, 1.0f);
+        else {
+            const float c = easy3d::dot(d1, r);
+            if (e <= eps)
+                s = easy3d::clamp(-c / a, 0.0f, 1.0f);
+            else {
+                const float b = easy3d::dot(d1, d2);
+                const float denom = a * e - b * b;
+                s = (denom != 0.0f) ? easy3d::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                t = (b * s + f) / e;
+                if (t < 0.0f) {
+                    t = 0.0f;
+                    s = easy3d::clamp(-c / a, 0.0f, 1.0f);
+                } else if (t > 1.0f) {
+                    t = 1.0f;
+                    s = easy3d::clamp((b - c) / a, 0.0f, 1.0f);
+                }
+            }
+        }
+        return easy3d::length2((p0 + d1 * s) - (q0 + d2 * t));
+    }
+
+
+    // tests if a line segment crosses a triangle (Moller-Trumbore). Coplanar configurations are not reported (they
+    // are handled by the edge-edge distances).
+    bool segment_crosses_triangle(const easy3d::vec3& p0, const easy3d::vec3& p1, const easy3d::vec3* tri) {
+        const easy3d::vec3 dir = p1 - p0;
+        const easy3d::vec3 e1 = tri[1] - tri[0], e2 = tri[2] - tri[0];
+        const easy3d::vec3 h = easy3d::cross(dir, e2);
+        const float a = easy3d::dot(e1, h);
+        if (std::abs(a) < 1e-12f)
+            return false;
+        const float f = 1.0f / a;
+        const easy3d::vec3 s = p0 - tri[0];
+        const float u = f * easy3d::dot(s, h);
+        if (u < 0.0f || u > 1.0f)
+            return false;
+        const easy3d::vec3 q = easy3d::cross(s, e1);
+        const float v = f * easy3d::dot(dir, q);
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+        const float t = f * easy3d::dot(e2, q);
+        return t >= 0.0f && t <= 1.0f;
+    }
+
+
+    // the distance between two triangles: either they intersect (then an edge of one crosses the other), or the
+    // closest points are realized by a vertex-triangle or an edge-edge pair.
+    float triangle_triangle_distance(const easy3d::vec3* a, const easy3d::vec3* b) {
+        for (int i = 0; i < 3; ++i) {
+            if (segment_crosses_triangle(a[i], a[(i + 1) % 3], b) || segment_crosses_triangle(b[i], b[(i + 1) % 3], a))
+                return 0.0f;
+        }
+
+        float sqr_dist = std::numeric_limits<float>::max();
+        easy3d::vec3 nearest;
+        for (int i = 0; i < 3; ++i) {
+            const float da = easy3d::geom::dist_point_triangle(a[i], b[0], b[1], b[2], nearest);
+            const float db = easy3d::geom::dist_point_triangle(b[i], a[0], a[1], a[2], nearest);
+            sqr_dist = std::min(sqr_dist, std::min(da * da, db * db));
+            for (int j = 0; j < 3; ++j)
+                sqr_dist = std::min(sqr_dist, segment_segment_sqr_distance(a[i], a[(i + 1) % 3], b[j], b[(j + 1) % 3]));
+        }
+        return std::sqrt(sqr_dist);
+    }
+
+
+    // Branch-and-bound traversal of the AABB trees of two models for the (thresholded) minimum distance
+    class DistanceQuery {
+    public:
+        // The traversal stops as soon as a face pair with a distance not larger than 'stop_distance' is found, and
+        // it never visits face pairs farther than 'upper_bound'.
+        DistanceQuery(const Opcode::Model *model0, const easy3d::mat4 &t0,
+                      const Opcode::Model *model1, const easy3d::mat4 &t1,
+                      float upper_bound, float stop_distance)
+                : best_(upper_bound), stop_(stop_distance), found_(false), closest_(-1, -1)
+        {
+            init(sides_[0], model0, t0);
+            init(sides_[1], model1, t1);
+        }
+
+        // returns the minimum distance found (or the upper bound if no face pair is within the upper bound)
+        float run() {
+            const Ref r0 = root(sides_[0]);
+            const Ref r1 = root(sides_[1]);
+            visit(r0, box(sides_[0], r0), r1, box(sides_[1], r1));
+            return best_;
+        }
+
+        // has a face pair not farther than the stop distance been found?
+        bool found() const { return found_; }
+        // the face pair realizing the minimum distance (-1 if no face pair is within the upper bound)
+        const std::pair<int, int>& closest() const { return closest_; }
+
+    private:
+        struct Side {
+            const Opcode::Model* model;
+            const AABBQuantizedNoLeafTree* tree;
+            const IndexedTriangle* tris;
+            const Point* verts;
+            easy3d::mat4 trans;
+            easy3d::mat3 abs_rot;   // for transforming the extents of the boxes
+        };
+
+        // a reference to either a node or a triangle of the tree
+        struct Ref {
+            const AABBQuantizedNoLeafNode* node;
+            int prim;
+        };
+
+        static void init(Side& side, const Opcode::Model* model, const easy3d::mat4& t) {
+            side.model = model;
+            side.tree = model->HasSingleNode() ? nullptr : static_cast<const AABBQuantizedNoLeafTree*>(model->GetTree());
+            side.tris = model->GetMeshInterface()->GetTris();
+            side.verts = model->GetMeshInterface()->GetVerts();
+            side.trans = t;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j)
+                    side.abs_rot(i, j) = std::abs(t(i, j));
+            }
+        }
+
+        static Ref root(const Side& side) {
+            if (side.tree)
+                return {side.tree->GetNodes(), -1};
+            return {nullptr, 0};
+        }
+
+        static void triangle(const Side& side, int prim, easy3d::vec3* tri) {
+            const IndexedTriangle& t = side.tris[prim];
+            for (int i = 0; i < 3; ++i) {
+                const Point& p = side.verts[t.mVRef[i]];
+                tri[i] = side.trans * easy3d::vec3(p.x, p.y, p.z);
+            }
+        }
+
+        static easy3d::Box3 box(const Side& side, const Ref& r) {
+            easy3d::Box3 result;
+            if (r.node) {
+                const QuantizedAABB& q = r.node->mAABB;
+                const Point& cc = side.tree->mCenterCoeff;
+                const Point& ec = side.tree->mExtentsCoeff;
+                const easy3d::vec3 center(float(q.mCenter[0]) * cc.x, float(q.mCenter[1]) * cc.y, float(q.mCenter[2]) * cc.z);
+                const easy3d::vec3 extents(float(q.mExtents[0]) * ec.x, float(q.mExtents[1]) * ec.y, float(q.mExtents[2]) * ec.z);
+                const easy3d::vec3 c = side.trans * center;
+                const easy3d::vec3 e = side.abs_rot * extents;
+                result.grow(c - e);
+                result.grow(c + e);
+            } else {
+                easy3d::vec3 tri[3];
+                triangle(side, r.prim, tri);
+                for (const auto& p : tri)
+                    result.grow(p);
+            }
+            return result;
+        }
+
+        static float box_distance(const easy3d::Box3& a, const easy3d::Box3& b) {
+            float sqr_dist = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                const float d = std::max(0.0f, std::max(a.min_point()[i] - b.max_point()[i], b.min_point()[i] - a.max_point()[i]));
+                sqr_dist += d * d;
+            }
+            return std::sqrt(sqr_dist);
+        }
+
+        static void children(const Ref& r, Ref* child) {
+            const AABBQuantizedNoLeafNode* n = r.node;
+            if (n->HasPosLeaf())
+                child[0] = {nullptr, static_cast<int>(n->GetPosPrimitive())};
+            else
+                child[0] = {n->GetPos(), -1};
+            if (n->HasNegLeaf())
+                child[1] = {nullptr, static_cast<int>(n->GetNegPrimitive())};
+            else
+                child[1] = {n->GetNeg(), -1};
+        }
+
+        void visit(const Ref& a, const easy3d::Box3& ba, const Ref& b, const easy3d::Box3& bb) {
+            if (found_)
+                return;
+
+            if (!a.node && !b.node) {
+                easy3d::vec3 ta[3], tb[3];
+                triangle(sides_[0], a.prim, ta);
+                triangle(sides_[1], b.prim, tb);
+                const float d = triangle_triangle_distance(ta, tb);
+                if (d < best_ || (d == best_ && closest_.first == -1)) {
+                    best_ = d;
+                    closest_ = {a.prim, b.prim};
+                }
+                if (d <= stop_)
+                    found_ = true;
+                return;
+            }
+
+            // descend into the larger one (a triangle cannot be split)
+            const bool split_a = a.node && (!b.node || ba.diagonal_length() >= bb.diagonal_length());
+            const int s = split_a ? 0 : 1;
+            Ref child[2];
+            children(split_a ? a : b, child);
+            const easy3d::Box3& other = split_a ? bb : ba;
+            const easy3d::Box3 box0 = box(sides_[s], child[0]);
+            const easy3d::Box3 box1 = box(sides_[s], child[1]);
+            const float d0 = box_distance(box0, other);
+            const float d1 = box_distance(box1, other);
+
+            // visit the closer child first, which tightens the bound for the farther one
+            const int first = (d0 <= d1) ? 0 : 1;
+            const float dist[2] = {d0, d1};
+            const easy3d::Box3* boxes[2] = {&box0, &box1};
+            for (int k = 0; k < 2; ++k) {
+                const int c = (k == 0) ? first : 1 - first;
+                if (dist[c] > best_)
+                    continue;
+                if (split_a)
+                    visit(child[c], *boxes[c], b, bb);
+                else
+                    visit(a, ba, child[c], *boxes[c]);
+            }
+        }
+
+    private:
+        Side sides_[2];
+        float best_;
+        float stop_;
+        bool found_;
+        std::pair<int, int> closest_;
+    };
+
+
+    // A rigid motion interpolating two poses: the rotations spherically and the translations linearly
+    class RigidMotion {
+    public:
+        RigidMotion(const easy3d::mat4& begin, const easy3d::mat4& end)
+                : q0_(easy3d::mat3(begin)), q1_(easy3d::mat3(end))
+                , c0_(begin.col(3).xyz()), c1_(end.col(3).xyz()) {}
+
+        easy3d::mat4 at(float t) const {
+            easy3d::mat4 m = easy3d::quat::slerp(q0_, q1_, t).matrix();
+            m.set_col(3, easy3d::vec4(c0_ + (c1_ - c0_) * t, 1.0f));
+            return m;
+        }
+
+        // the upper bound of the displacement of any point within distance 'radius' from the origin of the local
+        // coordinate system, over the entire motion.
+        float bound(float radius) const {
+            return easy3d::distance(c0_, c1_) + (q0_.inverse() * q1_).angle() * radius;
+        }
+
+    private:
+        easy3d::quat q0_, q1_;
+        easy3d::vec3 c0_, c1_;
+    };
+
+
     class ColliderImpl {
     public:
-        ColliderImpl(easy3d::SurfaceMesh *mesh0, easy3d::SurfaceMesh *mesh1) {
-            model0_ = build(mesh0);
-            model1_ = build(mesh1);
+        ColliderImpl(easy3d::SurfaceMesh *mesh0, easy3d::SurfaceMesh *mesh1)
+                : model0_(nullptr), model1_(nullptr), cache_(nullptr), collider_(nullptr)
+                , first_contact_collider_(nullptr), radius0_(0.0f), radius1_(0.0f)
+        {
+            model0_ = build_model(mesh0);
+            model1_ = build_model(mesh1);
             if (!model0_ || !model1_)
                 return;
 
@@ -47,33 +455,19 @@ namespace internal {
             cache_->Model0 = model0_;
             cache_->Model1 = model1_;
 
-            collider_ = new AABBTreeCollider;
-            collider_->SetFirstContact(false);
-            collider_->SetTemporalCoherence(false);
-            collider_->SetPrimitiveTests(true);
-            const char* msg = collider_->ValidateSettings();
-            if (msg) {
-                LOG(WARNING) << "failed setting AABB tree collider: " << msg;
-                delete collider_;
-                collider_ = nullptr;
-            }
+            collider_ = create_collider();
+            first_contact_collider_ = create_collider(true);
+
+            radius0_ = radius(mesh0);
+            radius1_ = radius(mesh1);
         }
 
         ~ColliderImpl() {
-            auto mesh0_interface = model0_->GetMeshInterface();
-            delete [] mesh0_interface->GetTris();
-            delete [] mesh0_interface->GetVerts();
-            delete mesh0_interface;
-            delete model0_;
-
-            auto mesh1_interface = model1_->GetMeshInterface();
-            delete [] mesh1_interface->GetTris();
-            delete [] mesh1_interface->GetVerts();
-            delete mesh1_interface;
-            delete model1_;
-
+            destroy_model(model0_);
+            destroy_model(model1_);
             delete cache_;
             delete collider_;
+            delete first_contact_collider_;
         }
 
     public:
@@ -85,96 +479,295 @@ namespace internal {
             }
 
             Matrix4x4 trans0, trans1;
-            for (auto i = 0; i < 4; ++i) {
-                for (auto j = 0; j < 4; ++j) {
-                    // ToDo: Why transpose? (opcode requires 'world' matrix)
-                    trans0[i][j] = t0(j, i);
-                    trans1[i][j] = t1(j, i);
-                }
+            to_opcode_matrix(t0, trans0);
+            to_opcode_matrix(t1, trans1);
+            collide(collider_, *cache_, trans0, trans1, result);
+            return result;
+        }
+
+        bool intersects(const easy3d::mat4 &t0, const easy3d::mat4 &t1) const {
+            if (!first_contact_collider_) {
+                LOG_EVERY_N(10, WARNING) << "the AABB tree collider was not built";
+                return false;
             }
 
-            if (!collider_->Collide(*cache_, &trans0, &trans1)) {
+            Matrix4x4 trans0, trans1;
+            to_opcode_matrix(t0, trans0);
+            to_opcode_matrix(t1, trans1);
+            if (!first_contact_collider_->Collide(*cache_, &trans0, &trans1)) {
                 LOG(WARNING) << "failed detecting collision";
-                return result;
+                return false;
             }
+            return first_contact_collider_->GetContactStatus() != 0;
+        }
 
-            if (collider_->GetContactStatus()) {
-                const udword num = collider_->GetNbPairs();
-                result.resize(num);
-                const Pair* pairs = collider_->GetPairs();
-                for (udword i = 0; i < num; ++i) {
-                    const Pair& pair = pairs[i];
-                    result[i] = { easy3d::SurfaceMesh::Face(static_cast<int>(pair.id0)), easy3d::SurfaceMesh::Face(static_cast<int>(pair.id1)) };
-                }
+        float distance(const easy3d::mat4 &t0, const easy3d::mat4 &t1, std::pair<int, int>* closest) const {
+            if (!model0_ || !model1_) {
+                LOG_EVERY_N(10, WARNING) << "the AABB trees were not built";
+                return std::numeric_limits<float>::max();
             }
-            return result;
+            DistanceQuery query(model0_, t0, model1_, t1, std::numeric_limits<float>::max(), 0.0f);
+            const float d = query.run();
+            if (closest)
+                *closest = query.closest();
+            return d;
         }
 
-    private:
-        Opcode::Model* build(const easy3d::SurfaceMesh* mesh) {
-            if (!mesh->is_triangle_mesh()) {
-                LOG(WARNING) << "the first mesh (" << mesh->name() << ") is not a triangle mesh";
-                return nullptr;
+        bool within_distance(const easy3d::mat4 &t0, const easy3d::mat4 &t1, float tolerance) const {
+            if (!model0_ || !model1_) {
+                LOG_EVERY_N(10, WARNING) << "the AABB trees were not built";
+                return false;
             }
+            DistanceQuery query(model0_, t0, model1_, t1, tolerance, tolerance);
+            query.run();
+            return query.found();
+        }
 
-            if (mesh->n_vertices() <= 0 || mesh->n_faces() <= 0) {
-                LOG(WARNING) << "invalid geometry";
-                return nullptr;
+        float time_of_impact(const easy3d::mat4 &t0_begin, const easy3d::mat4 &t1_begin,
+                             const easy3d::mat4 &t0_end, const easy3d::mat4 &t1_end, float tolerance,
+                             bool *converged) const
+        {
+            if (converged)
+                *converged = true;
+            if (!model0_ || !model1_) {
+                LOG_EVERY_N(10, WARNING) << "the AABB trees were not built";
+                return -1.0f;
+            }
+            if (tolerance <= 0.0f) {
+                LOG(WARNING) << "tolerance must be positive (" << tolerance << " provided)";
+                return -1.0f;
             }
 
-            const auto& pts = mesh->points();
-            auto vertices = new Point[pts.size()];
-            for (std::size_t i=0; i<pts.size(); ++i)
-                    vertices[i].Set(pts[i]);
+            // conservative advancement: the distance d can not be closed within the time d / max_speed
+            const RigidMotion motion0(t0_begin, t0_end);
+            const RigidMotion motion1(t1_begin, t1_end);
+            const float max_speed = motion0.bound(radius0_) + motion1.bound(radius1_);
+            const int max_iterations = 1000;
+            float t = 0.0f;
+            for (int i = 0; i < max_iterations; ++i) {
+                const float d = distance(motion0.at(t), motion1.at(t), nullptr);
+                if (d <= tolerance)
+                    return t;
+                if (max_speed <= 0.0f)
+                    return -1.0f;
+                t += d / max_speed;
+                if (t > 1.0f)
+                    return -1.0f;
+            }
+            LOG(WARNING) << "time of impact did not converge in " << max_iterations << " iterations";
+            if (converged)
+                *converged = false;
+            return -1.0f;
+        }
 
-            auto indices = new IndexedTriangle[mesh->n_faces()];
-            for (const auto& f : mesh->faces()) {
-                    std::vector<int> ids;
-                    for (const auto& v : mesh->vertices(f))
-                            ids.push_back(v.idx());
-                    indices[f.idx()] = IndexedTriangle(ids[0], ids[1], ids[2]);
+    private:
+        // the max distance of the vertices to the origin of the local coordinate system
+        static float radius(const easy3d::SurfaceMesh* mesh) {
+            float r = 0.0f;
+            for (auto v : mesh->vertices())
+                r = std::max(r, easy3d::length(mesh->position(v)));
+            return r;
+        }
+
+    private:
+        Opcode::Model* model0_;
+        Opcode::Model* model1_;
+        BVTCache* cache_;
+        AABBTreeCollider* collider_;
+        AABBTreeCollider* first_contact_collider_;
+        float radius0_;
+        float radius1_;
+    };
+
+
+    class MultiBodyColliderImpl {
+    public:
+        MultiBodyColliderImpl() : axis_(0), resort_(true) {}
+
+        ~MultiBodyColliderImpl() {
+            for (auto model : models_)
+                destroy_model(model);
+        }
+
+        int add(easy3d::SurfaceMesh* mesh) {
+            int model = -1;
+            auto pos = model_index_.find(mesh);
+            if (pos != model_index_.end())
+                model = pos->second;
+            else {
+                auto m = build_model(mesh);
+                if (!m)
+                    return -1;
+                model = static_cast<int>(models_.size());
+                models_.push_back(m);
+                model_index_[mesh] = model;
+            }
+
+            easy3d::Box3 box;
+            for (auto v : mesh->vertices())
+                box.grow(mesh->position(v));
+
+            bodies_.push_back({model, box});
+            order_.push_back(static_cast<int>(bodies_.size()) - 1);
+            resort_ = true;
+            return static_cast<int>(bodies_.size()) - 1;
+        }
+
+        std::size_t num_bodies() const { return bodies_.size(); }
+
+        std::vector<std::pair<int, int> > overlapping_pairs(const std::vector<easy3d::mat4> &transforms) {
+            std::vector<std::pair<int, int> > pairs;
+            const int num = static_cast<int>(bodies_.size());
+            if (transforms.size() != bodies_.size()) {
+                LOG(WARNING) << "the number of transformations (" << transforms.size()
+                             << ") does not match the number of bodies (" << num << ")";
+                return pairs;
+            }
+
+            // the world-space bounding boxes
+            world_boxes_.resize(num);
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const easy3d::Box3& box = bodies_[i].box;
+                const easy3d::mat4& m = transforms[i];
+                easy3d::Box3 result;
+                for (int c = 0; c < 8; ++c) {
+                    const easy3d::vec3 corner(
+                            (c & 1) ? box.max_coord(0) : box.min_coord(0),
+                            (c & 2) ? box.max_coord(1) : box.min_coord(1),
+                            (c & 4) ? box.max_coord(2) : box.min_coord(2)
+                    );
+                    result.grow(m * corner);
                 }
+                world_boxes_[i] = result;
+            }
 
-            auto mesh_interface = new MeshInterface();
-            mesh_interface->SetNbTriangles(mesh->n_faces());
-            mesh_interface->SetNbVertices(mesh->n_vertices());
-            mesh_interface->SetPointers(indices, vertices);
+            if (resort_) {
+                // sweep along the axis with the largest spread of the bodies
+                easy3d::Box3 centers;
+                for (const auto& b : world_boxes_)
+                    centers.grow(b.center());
+                axis_ = static_cast<int>(centers.max_range_axis());
+                std::sort(order_.begin(), order_.end(), [this](int a, int b) -> bool {
+                    return world_boxes_[a].min_point()[axis_] < world_boxes_[b].min_point()[axis_];
+                });
+                resort_ = false;
+            }
+            else {
+                // the order from the previous call is almost sorted if the bodies move coherently, so insertion
+                // sort is nearly linear.
+                for (int i = 1; i < num; ++i) {
+                    const int body = order_[i];
+                    const float key = world_boxes_[body].min_point()[axis_];
+                    int j = i - 1;
+                    while (j >= 0 && world_boxes_[order_[j]].min_point()[axis_] > key) {
+                        order_[j + 1] = order_[j];
+                        --j;
+                    }
+                    order_[j + 1] = body;
+                }
+            }
 
-            udword degenerated_faces = mesh_interface->CheckTopology();
-            if (degenerated_faces != 0) {
-                LOG(WARNING) << "model has " << degenerated_faces << " degenerated faces and cannot be processed";
-                return nullptr;
+            // the boxes in the sorted order, with the sweep axis first
+            const int axis1 = (axis_ + 1) % 3;
+            const int axis2 = (axis_ + 2) % 3;
+            sorted_.resize(num);
+            for (int i = 0; i < num; ++i) {
+                const easy3d::Box3& b = world_boxes_[order_[i]];
+                sorted_[i] = {
+                        {b.min_point()[axis_], b.min_point()[axis1], b.min_point()[axis2]},
+                        {b.max_point()[axis_], b.max_point()[axis1], b.max_point()[axis2]},
+                        order_[i]
+                };
             }
-            if (!mesh_interface->IsValid()) {
-                LOG(WARNING) << "the mesh if not valid and cannot be processed";
-                return nullptr;
+
+            // sweep and prune (in parallel with OpenMP if supported)
+#pragma omp parallel
+            {
+                std::vector<std::pair<int, int> > local_pairs;
+#pragma omp for schedule(dynamic, 256) nowait
+                for (int a = 0; a < num; ++a) {
+                    const SweepBox& bi = sorted_[a];
+                    for (int b = a + 1; b < num; ++b) {
+                        const SweepBox& bj = sorted_[b];
+                        if (bj.min[0] > bi.max[0])
+                            break;
+                        if (bj.min[1] > bi.max[1] || bj.max[1] < bi.min[1] ||
+                            bj.min[2] > bi.max[2] || bj.max[2] < bi.min[2])
+                            continue;
+                        local_pairs.emplace_back(std::min(bi.id, bj.id), std::max(bi.id, bj.id));
+                    }
+                }
+#pragma omp critical
+                pairs.insert(pairs.end(), local_pairs.begin(), local_pairs.end());
             }
 
-            BuildSettings settings;
-            settings.mLimit = 1;
-            settings.mRules = SPLIT_SPLATTER_POINTS | SPLIT_GEOM_CENTER;
+            // make the result independent of the scheduling of the threads
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        }
 
-            OPCODECREATE data;
-            data.mIMesh = mesh_interface;
-            data.mCanRemap = false;
-            data.mKeepOriginal = false;
-            data.mNoLeaf = true;
-            data.mQuantized = true;
-            data.mSettings = settings;
+        std::vector<easy3d::MultiBodyCollider::Contact> detect(const std::vector<easy3d::mat4> &transforms) {
+            std::vector<easy3d::MultiBodyCollider::Contact> contacts;
+            const auto pairs = overlapping_pairs(transforms);
+            if (pairs.empty())
+                return contacts;
+
+            const int num_bodies = static_cast<int>(bodies_.size());
+            std::vector<Matrix4x4> trans(num_bodies);
+            for (int i = 0; i < num_bodies; ++i)
+                to_opcode_matrix(transforms[i], trans[i]);
+
+            // the narrow phase on the overlapping pairs (in parallel with OpenMP if supported)
+            const int num_pairs = static_cast<int>(pairs.size());
+            std::vector<easy3d::MultiBodyCollider::Contact> results(num_pairs);
+#pragma omp parallel
+            {
+                // a collider holds the state of a query, so each thread has its own one
+                AABBTreeCollider* collider = create_collider();
+                BVTCache cache;
+#pragma omp for schedule(dynamic, 16)
+                for (int i = 0; i < num_pairs; ++i) {
+                    if (!collider)
+                        continue;
+                    const int b0 = pairs[i].first;
+                    const int b1 = pairs[i].second;
+                    cache.Model0 = models_[bodies_[b0].model];
+                    cache.Model1 = models_[bodies_[b1].model];
+                    results[i].body0 = b0;
+                    results[i].body1 = b1;
+                    collide(collider, cache, trans[b0], trans[b1], results[i].faces);
+                }
+                delete collider;
+            }
 
-            auto model = new Opcode::Model();
-            if (!model->Build(data)) {
-                LOG(WARNING) << "failed building AABB tree for the mesh";
-                return nullptr;
+            for (auto& c : results) {
+                if (!c.faces.empty())
+                    contacts.push_back(std::move(c));
             }
-            return model;
+            return contacts;
         }
 
     private:
-        Opcode::Model* model0_;
-        Opcode::Model* model1_;
-        BVTCache* cache_;
-        AABBTreeCollider* collider_;
+        struct Body {
+            int model;          // index into models_
+            easy3d::Box3 box;   // bounding box in the local coordinate system
+        };
+        std::vector<Opcode::Model*> models_;
+        std::unordered_map<const easy3d::SurfaceMesh*, int> model_index_;
+        std::vector<Body> bodies_;
+
+        // the sweep-and-prune state kept between subsequent queries
+        struct SweepBox {
+            float min[3];   // the coordinates are ordered such that the sweep axis comes first
+            float max[3];
+            int id;
+        };
+        std::vector<easy3d::Box3> world_boxes_;
+        std::vector<SweepBox> sorted_;
+        std::vector<int> order_;
+        int axis_;
+        bool resort_;
     };
 }
 
@@ -197,4 +790,59 @@ namespace easy3d {
     std::vector<std::pair<SurfaceMesh::Face, SurfaceMesh::Face> > Collider::detect(const mat4 &t0, const mat4 &t1) const {
         return collider_->detect(t0, t1);
     }
+
+
+    bool Collider::intersects(const mat4 &t0, const mat4 &t1) const {
+        return collider_->intersects(t0, t1);
+    }
+
+
+    float Collider::distance(const mat4 &t0, const mat4 &t1, std::pair<SurfaceMesh::Face, SurfaceMesh::Face> *closest_faces) const {
+        std::pair<int, int> closest;
+        const float d = collider_->distance(t0, t1, &closest);
+        if (closest_faces)
+            *closest_faces = {SurfaceMesh::Face(closest.first), SurfaceMesh::Face(closest.second)};
+        return d;
+    }
+
+
+    bool Collider::within_distance(const mat4 &t0, const mat4 &t1, float tolerance) const {
+        return collider_->within_distance(t0, t1, tolerance);
+    }
+
+
+    float Collider::time_of_impact(const mat4 &t0_begin, const mat4 &t1_begin, const mat4 &t0_end, const mat4 &t1_end,
+                                   float tolerance, bool *converged) const {
+        return collider_->time_of_impact(t0_begin, t1_begin, t0_end, t1_end, tolerance, converged);
+    }
+
+
+    MultiBodyCollider::MultiBodyCollider() {
+        impl_ = new internal::MultiBodyColliderImpl;
+    }
+
+
+    MultiBodyCollider::~MultiBodyCollider() {
+        delete impl_;
+    }
+
+
+    int MultiBodyCollider::add(SurfaceMesh *mesh) {
+        return impl_->add(mesh);
+    }
+
+
+    std::size_t MultiBodyCollider::num_bodies() const {
+        return impl_->num_bodies();
+    }
+
+
+    std::vector<std::pair<int, int> > MultiBodyCollider::overlapping_pairs(const std::vector<mat4> &transforms) {
+        return impl_->overlapping_pairs(transforms);
+    }
+
+
+    std::vector<MultiBodyCollider::Contact> MultiBodyCollider::detect(const std::vector<mat4> &transforms) {
+        return impl_->detect(transforms);
+    }
 }
@@ -33,6 +33,7 @@
 
 namespace internal {
     class ColliderImpl;
+    class MultiBodyColliderImpl;
 }
 
 
@@ -44,7 +45,7 @@ namespace easy3d {
      * \brief Efficient collision detection.
      * \details This class takes two triangle meshes and their transformation matrices as input and outputs the
      *      intersecting face pairs. This implementation is a wrapper of Opcode. It can achieve real-time performance
-     *      for large meshes.
+     *      for large meshes. The AABB trees also accelerate the boolean, distance, and time of impact queries.
      * \class Collider easy3d/algo/collider.h
      * \todo Extension to general polygonal meshes (by internally triangulate the input).
      */
@@ -67,10 +68,113 @@ namespace easy3d {
          */
         std::vector< std::pair<SurfaceMesh::Face, SurfaceMesh::Face> > detect(const mat4& t0, const mat4& t1) const;
 
+        /**
+         * Tests if the two meshes intersect. This is faster than detect() because it stops at the first
+         * intersecting face pair.
+         * @param t0 The transformation of the first mesh.
+         * @param t1 The transformation of the second mesh.
+         * @return \c true if the two meshes intersect.
+         */
+        bool intersects(const mat4& t0, const mat4& t1) const;
+
+        /**
+         * Computes the minimum distance between the two meshes.
+         * @param t0 The transformation of the first mesh.
+         * @param t1 The transformation of the second mesh.
+         * @param closest_faces If not null, returns the face pair realizing the minimum distance.
+         * @return The minimum distance (0 if the two meshes intersect).
+         */
+        float distance(const mat4& t0, const mat4& t1,
+                       std::pair<SurfaceMesh::Face, SurfaceMesh::Face>* closest_faces = nullptr) const;
+
+        /**
+         * Tests if the two meshes are within a distance. This is faster than distance() because it stops at the
+         * first face pair within the distance.
+         * @param t0 The transformation of the first mesh.
+         * @param t1 The transformation of the second mesh.
+         * @param tolerance The distance.
+         * @return \c true if the minimum distance between the two meshes is not larger than \p tolerance.
+         */
+        bool within_distance(const mat4& t0, const mat4& t1, float tolerance) const;
+
+        /**
+         * Computes the time of impact (TOI) of the two meshes moving from their begin poses to their end poses. In
+         * between, the rotations are interpolated spherically and the translations are interpolated linearly. The
+         * computation uses conservative advancement, i.e., it never misses a contact due to tunneling.
+         * @param t0_begin The transformation of the first mesh at the begin of the motion (must be rigid).
+         * @param t1_begin The transformation of the second mesh at the begin of the motion (must be rigid).
+         * @param t0_end The transformation of the first mesh at the end of the motion (must be rigid).
+         * @param t1_end The transformation of the second mesh at the end of the motion (must be rigid).
+         * @param tolerance The two meshes are in contact if their distance is not larger than this value (must be
+         *      positive).
+         * @param converged Optionally returns whether the computation converged. Conservative advancement may need
+         *      many tiny steps if the meshes move along each other within a distance slightly above \p tolerance. It
+         *      gives up after a fixed number of iterations, in which case -1 is returned and \p converged is false.
+         * @return The time in [0, 1] of the first contact, or -1 if the two meshes never get in contact (or if the
+         *      computation did not converge).
+         */
+        float time_of_impact(const mat4& t0_begin, const mat4& t1_begin, const mat4& t0_end, const mat4& t1_end,
+                             float tolerance, bool* converged = nullptr) const;
+
     private:
         internal::ColliderImpl* collider_;
     };
 
+
+    /**
+     * \brief Efficient collision detection for many bodies.
+     * \details This class detects the intersecting face pairs among a large number of triangle meshes (i.e., bodies),
+     *      each with its own transformation. A broad phase (sweep-and-prune over the transformed bounding boxes of
+     *      the bodies) determines the pairs of bodies that potentially collide, and only these pairs are passed to
+     *      the narrow phase (i.e., Opcode), which is performed in parallel. The sorted order of the sweep-and-prune is
+     *      kept between subsequent calls to detect(), so the broad phase runs in nearly linear time when the bodies
+     *      move coherently (e.g., interactively manipulated by the user or animated).
+     *      A mesh added multiple times shares its AABB tree, so many instances of the same model are cheap.
+     * \class MultiBodyCollider easy3d/algo/collider.h
+     */
+    class MultiBodyCollider {
+    public:
+        /// The intersecting face pairs of two bodies.
+        struct Contact {
+            int body0;  ///< The index of the first body.
+            int body1;  ///< The index of the second body (always larger than \c body0).
+            std::vector<std::pair<SurfaceMesh::Face, SurfaceMesh::Face> > faces; ///< The intersecting face pairs.
+        };
+
+    public:
+        MultiBodyCollider();
+        ~MultiBodyCollider();
+
+        /**
+         * Adds a body. The AABB tree of the mesh is built when the mesh is added the first time.
+         * @param mesh The mesh of the body (must be triangle mesh). It must stay alive and unchanged as long as
+         *      the collider is in use.
+         * @return The index of the body, or -1 on failure.
+         */
+        int add(SurfaceMesh* mesh);
+
+        /// Returns the number of bodies.
+        std::size_t num_bodies() const;
+
+        /**
+         * Performs the broad phase only.
+         * @param transforms The transformations of all the bodies (e.g., the matrices of their manipulators).
+         * @return The pairs of bodies (with the first index smaller than the second) whose transformed bounding
+         *      boxes overlap.
+         */
+        std::vector< std::pair<int, int> > overlapping_pairs(const std::vector<mat4>& transforms);
+
+        /**
+         * Performs collision detection, i.e., the broad phase followed by the narrow phase on the overlapping pairs.
+         * @param transforms The transformations of all the bodies (e.g., the matrices of their manipulators).
+         * @return The contacts of the colliding bodies.
+         */
+        std::vector<Contact> detect(const std::vector<mat4>& transforms);
+
+    private:
+        internal::MultiBodyColliderImpl* impl_;
+    };
+
 }
 
 #endif  // EASY3D_ALGO_COLLIDER_H
\ No newline at end of file
@@ -0,0 +1,55 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_GRAPH_ENUMERATOR_H
+#define EASY3D_ALGO_GRAPH_ENUMERATOR_H
+
+
+#include <easy3d/core/graph.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Enumerates connected components for a graph.
+     * \class GraphEnumerator easy3d/algo/graph_enumerator.h
+     */
+    class GraphEnumerator {
+    public:
+        /**
+         * \brief Enumerates the connected components of a graph.
+         * @param graph The input graph.
+         * @param id The vertex property storing the result. The components are numbered in the order of their
+         *      vertices with the smallest index.
+         * @return The number of connected components.
+         */
+        static int enumerate_connected_components(Graph *graph, Graph::VertexProperty<int> id);
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_GRAPH_ENUMERATOR_H
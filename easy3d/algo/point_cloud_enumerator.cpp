@@ -0,0 +1,71 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/point_cloud_enumerator.h>
+#include <easy3d/core/union_find.h>
+#include <easy3d/kdtree/kdtree_search_nanoflann.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+
+    int PointCloudEnumerator::enumerate_euclidean_clusters(PointCloud *cloud, PointCloud::VertexProperty<int> id, float radius) {
+        if (!cloud || cloud->n_vertices() == 0) {
+            LOG(WARNING) << "empty point cloud";
+            return 0;
+        }
+
+        const KdTreeSearch_NanoFLANN kdtree(cloud);
+        const auto& points = cloud->points();
+        const float squared_radius = radius * radius;
+
+        // union-find driven by radius queries (in parallel with OpenMP if supported)
+        UnionFind uf(cloud->vertices_size());
+        const int num = static_cast<int>(cloud->vertices_size());
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num; ++i) {
+            if (cloud->is_deleted(PointCloud::Vertex(i)))
+                continue;
+            std::vector<int> neighbors;
+            kdtree.find_points_in_range(points[i], squared_radius, neighbors);
+            for (auto j : neighbors) {
+                // each pair is reported twice, only the one from the larger index is needed
+                if (j < i && !cloud->is_deleted(PointCloud::Vertex(j)))
+                    uf.unite(i, j);
+            }
+        }
+
+        std::vector<bool> valid;
+        if (cloud->has_garbage()) {
+            valid.resize(cloud->vertices_size());
+            for (auto v : cloud->vertices())
+                valid[v.idx()] = true;
+        }
+        return uf.labels(id.vector(), valid);
+    }
+
+}
@@ -0,0 +1,59 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
+#define EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
+
+
+#include <easy3d/core/point_cloud.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Enumerates Euclidean clusters of a point cloud.
+     * \class PointCloudEnumerator easy3d/algo/point_cloud_enumerator.h
+     * \details Two points belong to the same cluster if they are connected by a chain of points in which every two
+     *      consecutive points are closer than a given distance. The clusters are computed by a parallel union-find
+     *      driven by radius queries.
+     */
+    class PointCloudEnumerator {
+    public:
+        /**
+         * \brief Enumerates the Euclidean clusters of a point cloud.
+         * @param cloud The input point cloud.
+         * @param id The vertex property storing the result. The clusters are numbered in the order of their points
+         *      with the smallest index.
+         * @param radius The max distance between two neighboring points of the same cluster.
+         * @return The number of clusters.
+         */
+        static int enumerate_euclidean_clusters(PointCloud *cloud, PointCloud::VertexProperty<int> id, float radius);
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_POINT_CLOUD_ENUMERATOR_H
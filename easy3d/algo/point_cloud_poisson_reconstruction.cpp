@@ -27,12 +27,20 @@
 #include <easy3d/algo/point_cloud_poisson_reconstruction.h>
 
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/point_cloud.h>
+#include <easy3d/core/surface_mesh_builder.h>
+#include <easy3d/algo/surface_mesh_hole_filling.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/stop_watch.h>
 
+#if !defined( _WIN32 ) && !defined( _WIN64 )
+#include <sys/resource.h>
+#endif
+
 #include <3rd_party/poisson/MyTime.h>
 #include <3rd_party/poisson/MemoryUsage.h>
 #include <3rd_party/poisson/MarchingCubes.h>
@@ -51,6 +59,18 @@ namespace easy3d {
         PROCESS_MEMORY_COUNTERS pmc;
         return GetProcessMemoryInfo(h, &pmc, sizeof(pmc)) ? ((double)pmc.PeakWorkingSetSize) / (1 << 20) : 0;
     }
+#else // !_WIN32 && !_WIN64
+    double PeakMemoryUsageMB(void)
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return ((double)usage.ru_maxrss) / (1 << 20);  // in bytes on macOS
+#else
+        return ((double)usage.ru_maxrss) / (1 << 10);  // in kilobytes on Linux
+#endif
+    }
 #endif // _WIN32 || _WIN64
 
 #define REAL    float
@@ -74,25 +94,16 @@ namespace easy3d {
 
         void print(const char *header) const {
             tree.memoryUsage();
-#if defined( _WIN32 ) || defined( _WIN64 )
             if (header)
                 printf("%s %9.1f (s), %9.1f (MB) / %9.1f (MB) / %9.1f (MB)\n", header, Time() - t, tree.localMemoryUsage(), tree.maxMemoryUsage(), PeakMemoryUsageMB());
             else
                 printf("%9.1f (s), %9.1f (MB) / %9.1f (MB) / %9.1f (MB)\n", Time() - t, tree.localMemoryUsage(), tree.maxMemoryUsage(), PeakMemoryUsageMB());
-#else // !_WIN32 && !_WIN64
-            if (header)
-                printf("%s %9.1f (s), %9.1f (MB) / %9.1f (MB)\n", header, Time() - t, tree.localMemoryUsage(),
-                       tree.maxMemoryUsage());
-            else
-                printf("%9.1f (s), %9.1f (MB) / %9.1f (MB)\n", Time() - t, tree.localMemoryUsage(),
-                       tree.maxMemoryUsage());
-#endif // _WIN32 || _WIN64
         }
     };
 
 
     PoissonReconstruction::PoissonReconstruction()
-            : depth_(8), samples_per_node_(1.0f), triangulate_mesh_(true) {
+            : depth_(8), samples_per_node_(1.0f), triangulate_mesh_(true), blocks_(1), block_overlap_(0.25f) {
         // other default parameters
         full_depth_ = 5;
         cgDepth_ = 0;
@@ -202,6 +213,40 @@ namespace easy3d {
             return nullptr;
         }
 
+        if (blocks_ > 1)
+            return apply_blocked(cloud, density_attr_name);
+
+        LOG(INFO) << "Screened Poisson Reconstruction (V9.0.1)";
+        StopWatch w;
+
+        const float *pts = cloud->points()[0];
+        const float *nms = normals.vector()[0];
+        const float *cls = nullptr;
+        PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
+        if (colors)
+            cls = colors.vector()[0];
+
+        // the cube (slightly enlarged by scale_) containing the point cloud
+        const Box3 &box = cloud->bounding_box();
+        const float size = box.max_range() * scale_;
+        const vec3 origin = box.center() - vec3(size * 0.5f);
+
+        SurfaceMesh *result = reconstruct(cloud->n_vertices(), pts, nms, cls, origin, size, depth_, density_attr_name);
+        if (!result)
+            return nullptr;
+
+        const std::string &file_name = file_system::name_less_extension(cloud->name()) + "_Poisson.ply";
+        result->set_name(file_name);
+        LOG(INFO) << "total reconstruction time: " << w.time_string() << ". peak memory usage: "
+                  << PeakMemoryUsageMB() << " MB";
+
+        return result;
+    }
+
+
+    SurfaceMesh *PoissonReconstruction::reconstruct(std::size_t num, const float *pts, const float *nms, const float *cls,
+                                                    const vec3 &origin, float size, int depth,
+                                                    const std::string &density_attr_name) const {
         typedef typename Octree<REAL>::template DensityEstimator<WEIGHT_DEGREE> DensityEstimator;
         typedef typename Octree<REAL>::template InterpolationInfo<false> InterpolationInfo;
 
@@ -215,17 +260,16 @@ namespace easy3d {
         OctreeProfiler<REAL> profiler(tree);
         tree.threads = threads_;
 
-        int maxSolveDepth = depth_;
-        int kernelDepth = depth_ - 2;
-        if (kernelDepth > depth_) {
-            LOG(ERROR) << "kernelDepth (" << kernelDepth << ") cannot be greater than tree depth (" << depth_ << ")";
-            kernelDepth = depth_;
+        int maxSolveDepth = depth;
+        int kernelDepth = depth - 2;
+        if (kernelDepth > depth) {
+            LOG(ERROR) << "kernelDepth (" << kernelDepth << ") cannot be greater than tree depth (" << depth << ")";
+            kernelDepth = depth;
         }
 
         //////////////////////////////////////////////////////////////////////////
 
-        LOG(INFO) << "Screened Poisson Reconstruction (V9.0.1)";
-        StopWatch t, w;
+        StopWatch t;
 
         //////////////////////////////////////////////////////////////////////////
 
@@ -243,33 +287,19 @@ namespace easy3d {
             LOG(INFO) << "loading data into tree... ";
             t.restart();
             profiler.start();
-            const float *pts = cloud->points()[0];
-            const float *nms = normals.vector()[0];
-            const float *cls = nullptr;
-            PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-            if (colors) {
-                cls = colors.vector()[0];
+            if (cls)
                 sampleData = new std::vector<ProjectiveData<Point3D<REAL>, REAL> >();
-            }
 
+            // maps the cube to the unit cube
             xForm = XForm4x4<REAL>::Identity();
             {
-                const Box3 &box = cloud->bounding_box();
-
-                Point3D<REAL> min_p(box.min_coord(0), box.min_coord(1), box.min_coord(2)), max_p(box.max_coord(0), box.max_coord(1), box.max_coord(2));
-                Point3D<REAL> center = (max_p + min_p) / 2;
-                REAL scale = std::max<REAL>(max_p[0] - min_p[0],
-                                            std::max<REAL>(max_p[1] - min_p[1], max_p[2] - min_p[2]));
-                scale *= scale_;
-                for (int i = 0; i < 3; i++)
-                    center[i] -= scale / 2;
                 XForm4x4<REAL> tXForm = XForm4x4<REAL>::Identity(), sXForm = XForm4x4<REAL>::Identity();
                 for (int i = 0; i < 3; i++)
-                    sXForm(i, i) = (REAL) (1. / scale), tXForm(3, i) = -center[i];
+                    sXForm(i, i) = (REAL) (1. / size), tXForm(3, i) = -origin[i];
                 xForm = (sXForm * tXForm) * xForm;
             }
 
-            pointCount = tree.init<Point3D<REAL> >(cloud->n_vertices(), pts, nms, cls, xForm, maxSolveDepth, false,
+            pointCount = tree.init<Point3D<REAL> >(num, pts, nms, cls, xForm, maxSolveDepth, false,
                                                    *samples, sampleData);
             iXForm = xForm.inverse();
 
@@ -281,7 +311,7 @@ namespace easy3d {
                 profiler.print(" - Load input into tree: ");
 
             LOG(INFO) << "input points/samples: " << pointCount << "/" << samples->size() <<
-                      ". memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB. " << t.time_string();
+                      ". memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB (peak: " << PeakMemoryUsageMB() << " MB). " << t.time_string();
         }
 
         //////////////////////////////////////////////////////////////////////////
@@ -313,7 +343,7 @@ namespace easy3d {
                 if (verbose_)
                     profiler.print(" - Got normal field:     ");
 
-                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB. "
+                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB (peak: " << PeakMemoryUsageMB() << " MB). "
                           << t.time_string();
             }
 
@@ -335,7 +365,7 @@ namespace easy3d {
                 if (verbose_)
                     profiler.print(" - Finalized tree:       ");
 
-                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB. "
+                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB (peak: " << PeakMemoryUsageMB() << " MB). "
                           << t.time_string();
             }
 
@@ -392,7 +422,7 @@ namespace easy3d {
                 if (iInfo)
                     delete iInfo, iInfo = nullptr;
 
-                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB. "
+                LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB (peak: " << PeakMemoryUsageMB() << " MB). "
                           << t.time_string();
             }
         }
@@ -414,8 +444,7 @@ namespace easy3d {
             }
             isoValue = (REAL) (valueSum / weightSum);
 
-            PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-            if (!colors && samples)
+            if (!cls && samples)
                 delete samples, samples = nullptr;
             if (verbose_) {
                 profiler.print(" - Got average:          ");
@@ -470,17 +499,348 @@ namespace easy3d {
                 samples = nullptr;
             }
 
-            LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB. " << t.time_string();
+            LOG(INFO) << "memory usage: " << float(MemoryInfo::Usage()) / (1 << 20) << " MB (peak: " << PeakMemoryUsageMB() << " MB). " << t.time_string();
         }
 
         //////////////////////////////////////////////////////////////////////////
 
-        PointCloud::VertexProperty<vec3> colors = cloud->get_vertex_property<vec3>("v:color");
-        SurfaceMesh *result = internal::convert_to_mesh(mesh, iXForm, density_attr_name, colors);
+        return internal::convert_to_mesh(mesh, iXForm, density_attr_name, cls != nullptr);
+    }
+
+
+    SurfaceMesh *PoissonReconstruction::apply_blocked(const PointCloud *cloud, const std::string &density_attr_name) const {
+        // The number of blocks along each axis is a power of two, so the block boundaries are aligned with the octree
+        // cells of the whole reconstruction. Each block is reconstructed in a cube twice its size (centered at the
+        // block) at a depth giving the same voxel size as reconstructing the whole point cloud at depth_. Thus all
+        // blocks share the same voxel grid and the iso-surfaces of adjacent blocks cross their common boundary at
+        // (almost) the same points, which are then welded.
+        int level = 0;
+        while ((1 << level) < blocks_ && level < depth_ - 2)
+            ++level;
+        const int num = 1 << level;
+        const int block_depth = depth_ - level + 1;
+
+        const Box3 &box = cloud->bounding_box();
+        const float size = box.max_range() * scale_;
+        const vec3 origin = box.center() - vec3(size * 0.5f);
+        const float block_size = size / static_cast<float>(num);
+        const float cell = size / static_cast<float>(1 << depth_);  // the voxel size
+        const float overlap = std::min(std::max(block_overlap_, 0.05f), 0.5f);
+        const float margin = std::min(std::max(overlap * block_size, 2.0f * cell), 0.5f * block_size);
+
+        LOG(INFO) << "Screened Poisson Reconstruction (V9.0.1) in " << num << "x" << num << "x" << num
+                  << " blocks (depth " << block_depth << " per block)";
+        StopWatch w, t;
+
+        // distribute the points into the blocks. A point in an overlapping margin goes into all blocks sharing it.
+        auto block_index = [num](int i, int j, int k) -> int { return (k * num + j) * num + i; };
+        std::vector<std::vector<int> > block_points(num * num * num);
+        std::vector<int> block_core_size(num * num * num, 0);
+        const auto &points = cloud->points();
+        for (int v = 0; v < static_cast<int>(points.size()); ++v) {
+            const vec3 p = points[v] - origin;
+            int lo[3], hi[3], core[3];
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::max(0, static_cast<int>(std::floor((p[a] - margin) / block_size)));
+                hi[a] = std::min(num - 1, static_cast<int>(std::floor((p[a] + margin) / block_size)));
+                core[a] = std::min(num - 1, std::max(0, static_cast<int>(std::floor(p[a] / block_size))));
+            }
+            for (int k = lo[2]; k <= hi[2]; ++k) {
+                for (int j = lo[1]; j <= hi[1]; ++j) {
+                    for (int i = lo[0]; i <= hi[0]; ++i)
+                        block_points[block_index(i, j, k)].push_back(v);
+                }
+            }
+            ++block_core_size[block_index(core[0], core[1], core[2])];
+        }
+        LOG(INFO) << "points distributed into blocks. " << t.time_string();
+
+        auto normals = cloud->get_vertex_property<vec3>("v:normal");
+        auto colors = cloud->get_vertex_property<vec3>("v:color");
+
+        // the vertices and faces kept from all blocks
+        std::vector<vec3> vertex_points, vertex_colors;
+        std::vector<float> vertex_density;
+        std::vector<int> vertex_block;          // the block each vertex comes from
+        std::vector<bool> vertex_welded;        // is a seam vertex welded to its counterpart in an adjacent block?
+        std::vector<int> vertex_welds;          // the number of crossings averaged into a seam vertex
+        std::vector<int> unwelded;              // the seam vertices that are not welded (filled after all blocks)
+        std::vector<int> face_vertices, face_begin(1, 0);
+
+        // The vertices on the (internal) boundaries of the blocks. As all blocks share the same voxel grid, such a
+        // vertex lies on a voxel edge in the boundary plane, and the iso-surfaces of the adjacent blocks cross that
+        // edge at (almost) the same point. So the vertices are keyed on the voxel edges and welded.
+        auto seam_edge = [&](const vec3 &p) -> long long {
+            for (int a = 0; a < 3; ++a) {
+                const float x = (p[a] - origin[a]) / block_size;
+                const float plane = std::round(x);
+                if (plane <= 0 || plane >= num || std::abs(x - plane) * block_size >= 0.01f * cell)
+                    continue;
+                // the edge is along one of the other two axes and at integer coordinates along the third one
+                const vec3 q = (p - origin) / cell;
+                const int b = (a + 1) % 3, c = (a + 2) % 3;
+                const int fixed = std::abs(q[b] - std::round(q[b])) < std::abs(q[c] - std::round(q[c])) ? b : c;
+                const int along = (fixed == b) ? c : b;
+                int coords[3];
+                coords[a] = static_cast<int>(std::round(q[a]));
+                coords[fixed] = static_cast<int>(std::round(q[fixed]));
+                coords[along] = static_cast<int>(std::floor(q[along]));
+                return (static_cast<long long>(along) << 60) | (static_cast<long long>(coords[0]) << 40) |
+                       (static_cast<long long>(coords[1]) << 20) | static_cast<long long>(coords[2]);
+            }
+            return -1;
+        };
+        std::unordered_map<long long, std::vector<int> > seam;
+
+        std::size_t num_blocks = 0;
+        for (int k = 0; k < num; ++k) {
+            for (int j = 0; j < num; ++j) {
+                for (int i = 0; i < num; ++i) {
+                    const int id = block_index(i, j, k);
+                    if (block_core_size[id] == 0)
+                        continue;
+                    ++num_blocks;
+                    t.restart();
+
+                    // gather the points of this block
+                    const auto &indices = block_points[id];
+                    const std::size_t num_points = indices.size();
+                    std::vector<vec3> pts(indices.size()), nms(indices.size()), cls(colors ? indices.size() : 0);
+#pragma omp parallel for num_threads(threads_)
+                    for (int idx = 0; idx < static_cast<int>(indices.size()); ++idx) {
+                        pts[idx] = points[indices[idx]];
+                        nms[idx] = normals[PointCloud::Vertex(indices[idx])];
+                        if (colors)
+                            cls[idx] = colors[PointCloud::Vertex(indices[idx])];
+                    }
+                    std::vector<int>().swap(block_points[id]);
+
+                    const vec3 block_origin = origin + vec3(i - 0.5f, j - 0.5f, k - 0.5f) * block_size;
+                    SurfaceMesh *part = reconstruct(pts.size(), pts[0].data(), nms[0].data(), colors ? cls[0].data() : nullptr,
+                                                    block_origin, 2.0f * block_size, block_depth, density_attr_name);
+                    if (!part)
+                        continue;
+
+                    // keep the faces whose centers are in this block
+                    auto part_density = part->get_vertex_property<float>(density_attr_name);
+                    auto part_colors = part->get_vertex_property<vec3>("v:color");
+                    std::vector<int> local_to_global(part->n_vertices(), -1);
+                    std::unordered_set<int> welded;   // each vertex is welded at most once per block
+
+                    auto add_vertex = [&](SurfaceMesh::Vertex v) -> int {
+                        const vec3 &p = part->position(v);
+                        const long long key = seam_edge(p);
+                        auto pos = (key >= 0) ? seam.find(key) : seam.end();
+                        if (pos != seam.end()) {
+                            for (int u : pos->second) {
+                                if (vertex_block[u] == id || welded.count(u))
+                                    continue;
+                                // the crossings are on the same voxel edge, and their average is used
+                                welded.insert(u);
+                                vertex_welded[u] = true;
+                                const float w = 1.0f / static_cast<float>(++vertex_welds[u]);
+                                vertex_points[u] = (1.0f - w) * vertex_points[u] + w * p;
+                                return u;
+                            }
+                        }
+
+                        const int u = static_cast<int>(vertex_points.size());
+                        vertex_points.push_back(p);
+                        vertex_density.push_back(part_density[v]);
+                        if (colors)
+                            vertex_colors.push_back(part_colors ? part_colors[v] : vec3(0, 0, 0));
+                        vertex_block.push_back(id);
+                        vertex_welded.push_back(false);
+                        vertex_welds.push_back(1);
+                        if (key >= 0)
+                            seam[key].push_back(u);
+                        return u;
+                    };
+
+                    std::size_t num_faces = 0;
+                    for (auto f : part->faces()) {
+                        vec3 center(0, 0, 0);
+                        int n = 0;
+                        for (auto v : part->vertices(f)) {
+                            center += part->position(v);
+                            ++n;
+                        }
+                        center = (center / static_cast<float>(n) - origin) / block_size;
+                        const int ci = std::min(num - 1, std::max(0, static_cast<int>(std::floor(center.x))));
+                        const int cj = std::min(num - 1, std::max(0, static_cast<int>(std::floor(center.y))));
+                        const int ck = std::min(num - 1, std::max(0, static_cast<int>(std::floor(center.z))));
+                        if (ci != i || cj != j || ck != k)
+                            continue;
+
+                        for (auto v : part->vertices(f)) {
+                            if (local_to_global[v.idx()] < 0)
+                                local_to_global[v.idx()] = add_vertex(v);
+                            face_vertices.push_back(local_to_global[v.idx()]);
+                        }
+                        face_begin.push_back(static_cast<int>(face_vertices.size()));
+                        ++num_faces;
+                    }
+                    delete part;
+
+                    LOG(INFO) << "block (" << i << ", " << j << ", " << k << "): " << num_points << " points, "
+                              << num_faces << " faces. peak memory usage: " << PeakMemoryUsageMB() << " MB. "
+                              << t.time_string();
+                }
+            }
+        }
+        for (const auto &entry : seam) {
+            for (int v : entry.second) {
+                if (!vertex_welded[v])
+                    unwelded.push_back(v);
+            }
+        }
+        std::unordered_map<long long, std::vector<int> >().swap(seam);
+
+        // the vertices merged near voxel corners (see below) are tracked using union-find
+        std::vector<int> parent(vertex_points.size());
+        for (std::size_t v = 0; v < parent.size(); ++v)
+            parent[v] = static_cast<int>(v);
+        auto find = [&parent](int v) -> int {
+            while (parent[v] != v)
+                v = parent[v] = parent[parent[v]];
+            return v;
+        };
+
+        // Where the implicit function is almost zero at a voxel corner on a boundary, the adjacent blocks may disagree
+        // on its sign. Their iso-surfaces then cross different voxel edges there, all very close to that corner, and
+        // leave a small hole in the boundary plane. Capping such a hole would fold the surface, so the seam vertices
+        // of different blocks around the corner are merged instead.
+        {
+            const float tolerance = 0.1f * cell;
+            auto grid_key = [](int x, int y, int z) -> long long {
+                return (static_cast<long long>(x + 1) << 42) | (static_cast<long long>(y + 1) << 21) | static_cast<long long>(z + 1);
+            };
+            auto grid_cell = [&](int v, int *x, int *y, int *z) {
+                const vec3 q = (vertex_points[v] - origin) / tolerance;
+                *x = static_cast<int>(std::floor(q.x));
+                *y = static_cast<int>(std::floor(q.y));
+                *z = static_cast<int>(std::floor(q.z));
+            };
+            std::unordered_map<long long, std::vector<int> > grid;
+            for (int v : unwelded) {
+                int x, y, z;
+                grid_cell(v, &x, &y, &z);
+                grid[grid_key(x, y, z)].push_back(v);
+            }
+            std::vector<vec3> sum(vertex_points.size(), vec3(0, 0, 0));
+            std::vector<int> count(vertex_points.size(), 0);
+            for (int v : unwelded) {
+                int x, y, z;
+                grid_cell(v, &x, &y, &z);
+                for (int dz = -1; dz <= 1; ++dz) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            auto pos = grid.find(grid_key(x + dx, y + dy, z + dz));
+                            if (pos == grid.end())
+                                continue;
+                            for (int u : pos->second) {
+                                if (vertex_block[u] != vertex_block[v] &&
+                                    distance2(vertex_points[u], vertex_points[v]) < tolerance * tolerance) {
+                                    const int ru = find(u), rv = find(v);
+                                    if (ru != rv)
+                                        parent[std::max(ru, rv)] = std::min(ru, rv);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            // the merged vertices are placed at their average
+            for (int v : unwelded) {
+                const int r = find(v);
+                sum[r] += vertex_points[v];
+                ++count[r];
+            }
+            std::size_t num_merged = 0;
+            for (int v : unwelded) {
+                if (count[v] > 1) {
+                    vertex_points[v] = sum[v] / static_cast<float>(count[v]);
+                    num_merged += count[v];
+                }
+            }
+            if (num_merged > 0)
+                LOG(INFO) << num_merged << " seam vertices merged near voxel corners";
+        }
+
+        auto result = new SurfaceMesh;
+        auto density = result->add_vertex_property<float>(density_attr_name);
+        SurfaceMesh::VertexProperty<vec3> result_colors;
+        if (colors)
+            result_colors = result->add_vertex_property<vec3>("v:color");
+
+        SurfaceMeshBuilder builder(result);
+        builder.begin_surface();
+        std::vector<SurfaceMesh::Vertex> vertices(vertex_points.size());
+        for (std::size_t v = 0; v < vertex_points.size(); ++v) {
+            if (parent[v] != static_cast<int>(v))
+                continue;
+            vertices[v] = builder.add_vertex(vertex_points[v]);
+            density[vertices[v]] = vertex_density[v];
+            if (colors)
+                result_colors[vertices[v]] = vertex_colors[v];
+        }
+        std::vector<SurfaceMesh::Vertex> polygon;
+        for (std::size_t f = 0; f + 1 < face_begin.size(); ++f) {
+            polygon.clear();
+            for (int idx = face_begin[f]; idx < face_begin[f + 1]; ++idx) {
+                const auto v = vertices[find(face_vertices[idx])];
+                if (std::find(polygon.begin(), polygon.end(), v) == polygon.end())
+                    polygon.push_back(v);
+            }
+            if (polygon.size() >= 3)    // a face collapsed by the merging is dropped
+                builder.add_face(polygon);
+        }
+        builder.end_surface();
+
+        // Fill the holes that are still left (if any) when they are small. A long border loop means a seam could not
+        // be welded, and capping it would fold the surface over itself, so it is left open and reported.
+        const std::size_t max_hole_size = 32;
+        std::vector<std::pair<SurfaceMesh::Halfedge, std::size_t> > holes;
+        auto visited = result->add_halfedge_property<bool>("h:visited", false);
+        for (auto h : result->halfedges()) {
+            if (!result->is_border(h) || visited[h])
+                continue;
+            std::size_t length = 0;
+            auto cur = h;
+            do {
+                visited[cur] = true;
+                ++length;
+                cur = result->next(cur);
+            } while (cur != h);
+            holes.emplace_back(h, length);
+        }
+        result->remove_halfedge_property(visited);
+
+        std::size_t num_filled = 0, num_open = 0, max_open = 0;
+        for (const auto &hole : holes) {
+            if (hole.second <= max_hole_size && SurfaceMeshHoleFilling(result).fill_hole(hole.first))
+                ++num_filled;
+            else {
+                ++num_open;
+                max_open = std::max(max_open, hole.second);
+            }
+        }
+        if (num_filled > 0)
+            LOG(INFO) << num_filled << " small holes between blocks filled";
+        if (num_open > 0)
+            LOG(WARNING) << num_open << " holes between blocks left open (the longest has " << max_open
+                         << " edges). Increasing the overlap of the blocks may help";
+
+        if (result->n_faces() == 0) {
+            LOG(ERROR) << "reconstructed mesh has 0 facet";
+            delete result;
+            return nullptr;
+        }
+
         const std::string &file_name = file_system::name_less_extension(cloud->name()) + "_Poisson.ply";
         result->set_name(file_name);
-        LOG(INFO) << "total reconstruction time: " << w.time_string();
-
+        LOG(INFO) << "reconstructed " << num_blocks << " blocks. total reconstruction time: " << w.time_string()
+                  << ". peak memory usage: " << PeakMemoryUsageMB() << " MB";
         return result;
     }
 
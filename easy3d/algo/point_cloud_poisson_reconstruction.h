@@ -30,6 +30,8 @@
 
 #include <string>
 
+#include <easy3d/core/types.h>
+
 
 namespace easy3d {
 
@@ -61,6 +63,30 @@ namespace easy3d {
          */
         void set_samples_per_node(float s) { samples_per_node_ = s; }
 
+        /**
+         * \brief Set the number of blocks along each axis for the blocked (i.e., out-of-core) reconstruction.
+         * When \p n > 1, the bounding cube of the point cloud is partitioned into n x n x n blocks (n is rounded up
+         * to a power of two). Each block is reconstructed from the points falling into it and into an overlapping
+         * margin around it, at the resolution of the whole reconstruction (i.e., a voxel grid of 2^d x 2^d x 2^d).
+         * The iso-surfaces of the blocks are then clipped against the blocks and stitched into a single mesh, and the
+         * cracks along the seams are closed, so the result is watertight like the one of the whole reconstruction. Only
+         * one block is in memory at a time, so the peak memory is bounded by the densest block instead of the whole
+         * point cloud. The default value is 1 (i.e., the whole point cloud is reconstructed at once).
+         */
+        void set_blocks(int n) { blocks_ = n; }
+
+        /**
+         * \brief Set the overlap between adjacent blocks for the blocked reconstruction.
+         * This floating point value specifies the width of the margin around each block (relative to the block size)
+         * whose points also contribute to the reconstruction of that block. Larger values give smoother transitions
+         * between blocks at the cost of more memory and computation. It is clamped to [0.05, 0.5]. The default value
+         * is 0.25.
+         */
+        void set_block_overlap(float r) { block_overlap_ = r; }
+
+        /// \brief Set the number of threads. The default value is the number of processors.
+        void set_threads(int n) { threads_ = n; }
+
         /// \brief reconstruction
         SurfaceMesh *apply(const PointCloud *cloud, const std::string &density_attr_name = "v:density") const;
 
@@ -81,6 +107,16 @@ namespace easy3d {
         void set_gs_iter(int v) { gsIter_ = v; }
         void set_verbose(bool v) { verbose_ = v; }
 
+    private:
+        // Reconstruct the surface from \p num points in the cube defined by \p origin and \p size. The points must
+        // lie in the cube. \p cls can be nullptr if the points have no colors.
+        SurfaceMesh *reconstruct(std::size_t num, const float *pts, const float *nms, const float *cls,
+                                 const vec3 &origin, float size, int depth,
+                                 const std::string &density_attr_name) const;
+
+        // The blocked (out-of-core) reconstruction
+        SurfaceMesh *apply_blocked(const PointCloud *cloud, const std::string &density_attr_name) const;
+
     private:
         /*
         This integer is the maximum depth of the tree that will be used for surface
@@ -109,6 +145,9 @@ namespace easy3d {
 
         bool triangulate_mesh_;
 
+        int blocks_;            // number of blocks along each axis (for the blocked reconstruction)
+        float block_overlap_;   // overlap between adjacent blocks (relative to the block size)
+
     private:
         // these parameters usually do not need to change
         int cgDepth_;
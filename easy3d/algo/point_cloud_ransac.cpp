@@ -26,6 +26,7 @@
 
 #include <easy3d/algo/point_cloud_ransac.h>
 #include <easy3d/core/point_cloud.h>
+#include <easy3d/util/stop_watch.h>
 
 #include <3rd_party/ransac/RansacShapeDetector.h>
 #include <3rd_party/ransac/PlanePrimitiveShapeConstructor.h>
@@ -58,7 +59,8 @@ namespace easy3d {
                 float dist_thresh,
                 float bitmap_reso,
                 float normal_thresh,
-                float overlook_prob
+                float overlook_prob,
+                unsigned int seed
         ) {
             const Box3 &box = cloud->bounding_box();
             pc.setBBox(
@@ -71,6 +73,7 @@ namespace easy3d {
             //////////////////////////////////////////////////////////////////////////
 
             LOG(INFO) << "detecting primitives...";
+            StopWatch w;
 
             RansacShapeDetector::Options ransacOptions;
             ransacOptions.m_minSupport = min_support;
@@ -78,6 +81,7 @@ namespace easy3d {
             ransacOptions.m_bitmapEpsilon = bitmap_reso * pc.getScale();
             ransacOptions.m_normalThresh = normal_thresh;
             ransacOptions.m_probability = overlook_prob;
+            ransacOptions.m_seed = seed;
 
             RansacShapeDetector detector(ransacOptions); // the detector object
 
@@ -155,8 +159,8 @@ namespace easy3d {
                             const PointCloud::Vertex v(id);
                             primitive_types[v] = PrimitivesRansac::PLANE;
                             primitive_indices[v] = index;
-                            prim.vertices.push_back(id);
                         }
+                        prim.vertices = vts;
                         plane_primitives.push_back(prim);
                         break;
                     }
@@ -173,8 +177,8 @@ namespace easy3d {
                             const PointCloud::Vertex v(id);
                             primitive_types[v] = PrimitivesRansac::CYLINDER;
                             primitive_indices[v] = index;
-                            prim.vertices.push_back(id);
                         }
+                        prim.vertices = vts;
                         cylinder_primitives_.push_back(prim);
                         break;
                     }
@@ -222,7 +226,10 @@ namespace easy3d {
                 ++index;
             }
 
-            LOG(INFO) << index << " primitives extracted. " << remaining << " points remained";
+            const double seconds = w.elapsed_seconds(3);
+            LOG(INFO) << index << " primitives extracted. " << remaining << " points remained. Time: "
+                      << w.time_string() << " (" << (seconds > 0.0 ? index / seconds : 0.0) << " primitives/sec, "
+                      << (seconds > 0.0 ? pc.size() / seconds : 0.0) << " points/sec)";
             return index;
         }
     }
@@ -288,7 +295,7 @@ namespace easy3d {
             pc[i].index = i;
         }
 
-        return internal::do_detect(cloud, pc, types_, plane_primitives_, cylinder_primitives_, min_support, dist_thresh, bitmap_reso, normal_thresh, overlook_prob);
+        return internal::do_detect(cloud, pc, types_, plane_primitives_, cylinder_primitives_, min_support, dist_thresh, bitmap_reso, normal_thresh, overlook_prob, seed_);
     }
 
 
@@ -339,7 +346,7 @@ namespace easy3d {
             pc[index].index = idx;
         }
 
-        return internal::do_detect(cloud, pc, types_, plane_primitives_, cylinder_primitives_, min_support, dist_thresh, bitmap_reso, normal_thresh, overlook_prob);
+        return internal::do_detect(cloud, pc, types_, plane_primitives_, cylinder_primitives_, min_support, dist_thresh, bitmap_reso, normal_thresh, overlook_prob, seed_);
     }
 
 }
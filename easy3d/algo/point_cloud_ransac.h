@@ -57,6 +57,8 @@ namespace easy3d {
         };
 
     public:
+        PrimitivesRansac() : seed_(0) {}
+
         /**
          * \brief Setup the primitive types to be extracted.
          * \details This is done by adding the interested primitive types one by one.
@@ -68,6 +70,13 @@ namespace easy3d {
          */
         void remove_primitive_type(PrimType t);
 
+        /**
+         * \brief Sets the seed of the random number generators.
+         * \details With the same seed (other than 0), the detection gives the same primitives regardless of the
+         *      number of threads. The default value 0 seeds the generators with the current time.
+         */
+        void set_random_seed(unsigned int seed) { seed_ = seed; }
+
         /**
          * \brief Extract primitives from a point cloud.
          * \details The extracted primitives are stored as properties:
@@ -141,6 +150,7 @@ namespace easy3d {
 
     private:
         std::set<PrimType>      types_;
+        unsigned int            seed_;
 
         std::vector<PlanePrim>      plane_primitives_;
         std::vector<CylinderPrim>   cylinder_primitives_;
@@ -124,6 +124,20 @@ namespace easy3d {
             result.emplace_back(SurfaceMeshComponent(mesh));
         }
 
+        // count the elements of each component first to avoid repeated reallocations
+        std::vector<std::size_t> num_vertices(nb_components, 0), num_faces(nb_components, 0);
+        for (auto v : mesh->vertices())
+            ++num_vertices[component_id[v]];
+        for (auto f : mesh->faces())
+            ++num_faces[component_id[mesh->target(mesh->halfedge(f))]];
+        for (int i = 0; i < nb_components; i++) {
+            result[i].vertices_.reserve(num_vertices[i]);
+            result[i].faces_.reserve(num_faces[i]);
+            // for a (closed) triangle mesh: #E ~= 3/2 #F, #H ~= 3 #F
+            result[i].edges_.reserve(num_faces[i] * 3 / 2 + 1);
+            result[i].halfedges_.reserve(num_faces[i] * 3 + 2);
+        }
+
         for (auto v : mesh->vertices()) {
             int idx = component_id[v];
             result[idx].vertices_.push_back(v);
@@ -190,6 +204,7 @@ namespace easy3d {
                 result.halfedges_.push_back(h);
         }
 
+        mesh->remove_vertex_property(component_id);
         return result;
     }
 
@@ -224,6 +239,7 @@ namespace easy3d {
                 result.halfedges_.push_back(h);
         }
 
+        mesh->remove_vertex_property(component_id);
         return result;
     }
 
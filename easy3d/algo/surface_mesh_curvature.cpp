@@ -12,6 +12,7 @@
 #include <easy3d/algo/surface_mesh_curvature.h>
 #include <easy3d/algo/surface_mesh_geometry.h>
 #include <easy3d/core/eigen_solver.h>
+#include <easy3d/core/surface_mesh_adjacency.h>
 
 
 namespace easy3d {
@@ -133,13 +134,10 @@ namespace easy3d {
         double eval1, eval2, eval3, kmin, kmax;
         dvec3 evec1, evec2, evec3;
 
-        std::vector<SurfaceMesh::Vertex> neighborhood;
-        neighborhood.reserve(15);
+        SmallVector<SurfaceMesh::Vertex, 16> neighborhood;
 
         // precompute Voronoi area per vertex
-        for (auto v : mesh_->vertices()) {
-            area[v] = geom::voronoi_area(mesh_, v);
-        }
+        geom::voronoi_areas(mesh_, area.vector());
 
         // precompute face normals
         for (auto f : mesh_->faces()) {
@@ -283,9 +281,12 @@ namespace easy3d {
 
         // cotan weight per edge
         for (auto e : mesh_->edges()) {
-            cotan[e] = geom::cotan_weight(mesh_, e);
+            cotan[e] = std::max(0.0, geom::cotan_weight(mesh_, e));
         }
 
+        // the connectivity does not change during smoothing
+        const SurfaceMeshAdjacency adjacency(mesh_);
+
         for (unsigned int i = 0; i < iterations; ++i) {
             for (auto v : mesh_->vertices()) {
                 // don't smooth feature vertices
@@ -294,14 +295,16 @@ namespace easy3d {
 
                 kmin = kmax = sum_weights = 0.0;
 
-                for (auto vh : mesh_->halfedges(v)) {
-                    auto tv = mesh_->target(vh);
+                const auto ring = adjacency.vertices(v);
+                const auto hedges = adjacency.halfedges(v);
+                for (std::size_t k = 0; k < ring.size(); ++k) {
+                    auto tv = ring[k];
 
                     // don't consider feature vertices (high curvature)
                     if (vfeature && vfeature[tv])
                         continue;
 
-                    weight = std::max(0.0, geom::cotan_weight(mesh_, mesh_->edge(vh)));
+                    weight = cotan[mesh_->edge(hedges[k])];
                     sum_weights += weight;
                     kmin += weight * min_curvature_[tv];
                     kmax += weight * max_curvature_[tv];
@@ -10,6 +10,7 @@
 
 
 #include <easy3d/algo/surface_mesh_enumerator.h>
+#include <easy3d/core/union_find.h>
 
 #include <stack>
 
@@ -37,16 +38,23 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> id) {
-        id.vector().assign(mesh->n_vertices(), -1);
+        // union-find over the edges (in parallel with OpenMP if supported)
+        UnionFind uf(mesh->vertices_size());
+        const int num_edges = static_cast<int>(mesh->edges_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (!mesh->is_deleted(e))
+                uf.unite(mesh->vertex(e, 0).idx(), mesh->vertex(e, 1).idx());
+        }
 
-        int cur_id = 0;
-        for (auto v : mesh->vertices()) {
-            if (id[v] == -1) {
-                propagate_connected_component(mesh, id, v, cur_id);
-                ++cur_id;
-            }
+        std::vector<bool> valid;
+        if (mesh->has_garbage()) {
+            valid.resize(mesh->vertices_size());
+            for (auto v : mesh->vertices())
+                valid[v.idx()] = true;
         }
-        return cur_id;
+        return uf.labels(id.vector(), valid);
     }
 
 
@@ -76,17 +84,27 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::FaceProperty<int> id) {
-        id.vector().assign(mesh->n_faces(), -1);
-
-        int cur_id = 0;
-        for (auto f : mesh->faces()) {
-            if (id[f] == -1) {
-                propagate_connected_component(mesh, id, f, cur_id);
-                ++cur_id;
-            }
+        // union-find over the (non-border) edges (in parallel with OpenMP if supported)
+        UnionFind uf(mesh->faces_size());
+        const int num_edges = static_cast<int>(mesh->edges_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh->is_deleted(e))
+                continue;
+            auto f0 = mesh->face(mesh->halfedge(e, 0));
+            auto f1 = mesh->face(mesh->halfedge(e, 1));
+            if (f0.is_valid() && f1.is_valid())
+                uf.unite(f0.idx(), f1.idx());
         }
 
-        return cur_id;
+        std::vector<bool> valid;
+        if (mesh->has_garbage()) {
+            valid.resize(mesh->faces_size());
+            for (auto f : mesh->faces())
+                valid[f.idx()] = true;
+        }
+        return uf.labels(id.vector(), valid);
     }
 
 
@@ -96,6 +114,7 @@ namespace easy3d {
                                                            float angle_threshold
     ) {
         auto fnormals = mesh->get_face_property<vec3>("f:normal");
+        // may not exist if called outside of enumerate_planar_components()
         auto is_degenerate = mesh->get_face_property<bool>("f:SurfaceMeshEnumerator:is_degenerate");
 
         std::stack<SurfaceMesh::Face> stack;
@@ -109,7 +128,7 @@ namespace easy3d {
                 const vec3 &n_top = fnormals[top];
                 for (auto h : mesh->halfedges(top)) {
                     auto cur = mesh->face(mesh->opposite(h));
-                    if (cur.is_valid() && id[cur] == -1 && !is_degenerate[cur]) {
+                    if (cur.is_valid() && id[cur] == -1 && !(is_degenerate ? is_degenerate[cur] : mesh->is_degenerate(cur))) {
                         const vec3 &n_cur = fnormals[cur];
                         auto angle = geom::angle(n_top, n_cur); // in [-pi, pi]
                         angle = geom::to_degrees(std::abs(angle));
@@ -127,25 +146,43 @@ namespace easy3d {
             float angle_threshold)
     {
         mesh->update_face_normals();
-        auto is_degenerate = mesh->add_face_property<bool>("f:SurfaceMeshEnumerator:is_degenerate", false);
+        auto fnormals = mesh->get_face_property<vec3>("f:normal");
 
+        const int num_faces = static_cast<int>(mesh->faces_size());
+        std::vector<char> is_degenerate(num_faces, 0);
         int num_degenerate = 0;
-        for (auto f : mesh->faces()) {
-            id[f] = -1;
-            if (mesh->is_degenerate(f)) {
-                is_degenerate[f] = true;
+#pragma omp parallel for reduction(+:num_degenerate)
+        for (int i = 0; i < num_faces; ++i) {
+            const SurfaceMesh::Face f(i);
+            if (!mesh->is_deleted(f) && mesh->is_degenerate(f)) {
+                is_degenerate[i] = 1;
                 ++num_degenerate;
             }
         }
 
-        int cur_id = 0;
-        for (auto f : mesh->faces()) {
-            if (!is_degenerate[f] && id[f] == -1) {
-                propagate_planar_component(mesh, id, f, cur_id, angle_threshold);
-                cur_id++;
+        // union-find over the edges whose incident faces are coplanar (in parallel with OpenMP if supported)
+        UnionFind uf(num_faces);
+        const int num_edges = static_cast<int>(mesh->edges_size());
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh->is_deleted(e))
+                continue;
+            auto f0 = mesh->face(mesh->halfedge(e, 0));
+            auto f1 = mesh->face(mesh->halfedge(e, 1));
+            if (f0.is_valid() && f1.is_valid() && !is_degenerate[f0.idx()] && !is_degenerate[f1.idx()]) {
+                auto angle = geom::angle(fnormals[f0], fnormals[f1]); // in [-pi, pi]
+                angle = geom::to_degrees(std::abs(angle));
+                if (angle < angle_threshold)
+                    uf.unite(f0.idx(), f1.idx());
             }
         }
 
+        std::vector<bool> valid(num_faces, false);
+        for (auto f : mesh->faces())
+            valid[f.idx()] = !is_degenerate[f.idx()];
+        const int num = uf.labels(id.vector(), valid);
+
         if (num_degenerate > 0) { // propagate the planar partition to degenerate faces
             LOG(WARNING) << "model has " << num_degenerate << " degenerate faces";
             int num_propagated = 0;
@@ -155,7 +192,7 @@ namespace easy3d {
                     auto f0 = mesh->face(mesh->halfedge(e, 0));
                     auto f1 = mesh->face(mesh->halfedge(e, 1));
                     if (f0.is_valid() && f1.is_valid()) {
-                        if (is_degenerate[f0] && id[f0] == -1 && !is_degenerate[f1]) {
+                        if (is_degenerate[f0.idx()] && id[f0] == -1 && !is_degenerate[f1.idx()]) {
                             id[f0] = id[f1];
                             ++num_propagated;
                         }
@@ -164,8 +201,7 @@ namespace easy3d {
             } while (num_propagated > 0);
         }
 
-        mesh->remove_face_property(is_degenerate);
-        return cur_id;
+        return num;
     }
 
 }
\ No newline at end of file
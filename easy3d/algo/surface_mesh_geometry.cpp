@@ -11,8 +11,10 @@
 
 #include <easy3d/algo/surface_mesh_geometry.h>
 
+#include <vector>
 #include <limits>
 #include <cmath>
+#include <algorithm>
 
 
 namespace easy3d {
@@ -32,34 +34,81 @@ namespace easy3d {
 
         //-----------------------------------------------------------------------------
 
-        float surface_area(const SurfaceMesh *mesh) {
-            float area(0);
-            for (auto f : mesh->faces()) {
-                area += triangle_area(mesh, f);
+        namespace internal {
+
+            // Sums kernel(i) for i in [0, n) in parallel. The indices are split into fixed-size blocks, and the
+            // partial sums are added in block order, so the result does not depend on the number of threads.
+            template<typename Kernel>
+            double blocked_sum(int n, const Kernel &kernel) {
+                const int block_size = 4096;
+                const int num_blocks = (n + block_size - 1) / block_size;
+                std::vector<double> partial_sums(num_blocks, 0.0);
+#pragma omp parallel for
+                for (int b = 0; b < num_blocks; ++b) {
+                    const int end = std::min(n, (b + 1) * block_size);
+                    double sum = 0.0;
+                    for (int i = b * block_size; i < end; ++i)
+                        sum += kernel(i);
+                    partial_sums[b] = sum;
+                }
+
+                double sum = 0.0;
+                for (auto s : partial_sums)
+                    sum += s;
+                return sum;
             }
-            return area;
+
+            // the corners of triangle f (in the same order as the vertex circulator)
+            inline void triangle_points(const SurfaceMesh *mesh, SurfaceMesh::Face f, const vec3 *points,
+                                        vec3 &p0, vec3 &p1, vec3 &p2) {
+                auto h = mesh->halfedge(f);
+                p0 = points[mesh->target(h).idx()];
+                h = mesh->next(h);
+                p1 = points[mesh->target(h).idx()];
+                h = mesh->next(h);
+                p2 = points[mesh->target(h).idx()];
+            }
+
         }
 
         //-----------------------------------------------------------------------------
 
-        float volume(const SurfaceMesh& mesh)
+        float surface_area(const SurfaceMesh *mesh) {
+            const vec3 *points = mesh->get_vertex_property<vec3>("v:point").data();
+            const bool garbage = mesh->has_garbage();
+            const double area = internal::blocked_sum(static_cast<int>(mesh->faces_size()), [&](int i) -> double {
+                const SurfaceMesh::Face f(i);
+                if (garbage && mesh->is_deleted(f))
+                    return 0.0;
+                assert(mesh->valence(f) == 3);
+                vec3 p0, p1, p2;
+                internal::triangle_points(mesh, f, points, p0, p1, p2);
+                return triangle_area(p0, p1, p2);
+            });
+            return static_cast<float>(area);
+        }
+
+        //-----------------------------------------------------------------------------
+
+        float volume(const SurfaceMesh *mesh)
         {
-            if (!mesh.is_triangle_mesh()) {
+            if (!mesh->is_triangle_mesh()) {
                 LOG(ERROR) << "input is not a pure triangle mesh!";
                 return 0;
             }
 
-            float volume(0);
-            for (const auto f : mesh.faces()) {
-                auto fv = mesh.vertices(f);
-                const auto& p0 = mesh.position(*fv);
-                const auto& p1 = mesh.position(*(++fv));
-                const auto& p2 = mesh.position(*(++fv));
-
-                volume += float(1.0) / float(6.0) * dot(cross(p0, p1), p2);
-            }
-
-            return std::abs(volume);
+            const vec3 *points = mesh->get_vertex_property<vec3>("v:point").data();
+            const bool garbage = mesh->has_garbage();
+            const double volume = internal::blocked_sum(static_cast<int>(mesh->faces_size()), [&](int i) -> double {
+                const SurfaceMesh::Face f(i);
+                if (garbage && mesh->is_deleted(f))
+                    return 0.0;
+                vec3 p0, p1, p2;
+                internal::triangle_points(mesh, f, points, p0, p1, p2);
+                return float(1.0) / float(6.0) * dot(cross(p0, p1), p2);
+            });
+
+            return static_cast<float>(std::abs(volume));
         }
 
         //-----------------------------------------------------------------------------
@@ -229,6 +278,20 @@ namespace easy3d {
 
         //-----------------------------------------------------------------------------
 
+        void voronoi_areas(const SurfaceMesh *mesh, std::vector<double> &areas) {
+            const int num = static_cast<int>(mesh->vertices_size());
+            areas.assign(num, 0.0);
+            const bool garbage = mesh->has_garbage();
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                if (!garbage || !mesh->is_deleted(v))
+                    areas[i] = voronoi_area(mesh, v);
+            }
+        }
+
+        //-----------------------------------------------------------------------------
+
         double voronoi_area_barycentric(const SurfaceMesh *mesh, SurfaceMesh::Vertex v) {
             double area(0.0);
 
@@ -13,6 +13,8 @@
 #define EASY3D_ALGO_SURFACE_MESH_GEOMETRY_H
 
 
+#include <vector>
+
 #include <easy3d/core/types.h>
 #include <easy3d/core//surface_mesh.h>
 
@@ -25,10 +27,12 @@ namespace easy3d {
         float triangle_area(const SurfaceMesh *mesh, SurfaceMesh::Face f);
 
         /** \brief surface area of the mesh (assumes triangular faces)    */
+        /** \note the faces are processed in parallel, and the result does not depend on the number of threads.   */
         float surface_area(const SurfaceMesh *mesh);
 
         //! \brief Compute the volume of a mesh
-        //! \details See \cite zhang_2002_efficient for details.
+        //! \details See \cite zhang_2002_efficient for details. The faces are processed in parallel, and the result
+        //!     does not depend on the number of threads.
         //! \pre Input mesh needs to be a pure triangle mesh.
         float volume(const SurfaceMesh *mesh);
 
@@ -49,6 +53,10 @@ namespace easy3d {
         /** \brief compute (mixed) Voronoi area of vertex v    */
         double voronoi_area(const SurfaceMesh *mesh, SurfaceMesh::Vertex v);
 
+        /** \brief compute (mixed) Voronoi areas of all vertices (in parallel). \p areas is indexed by the vertex
+         *      indices, and the deleted vertices have a zero area. */
+        void voronoi_areas(const SurfaceMesh *mesh, std::vector<double> &areas);
+
         /** \brief compute barycentric Voronoi area of vertex v    */
         double voronoi_area_barycentric(const SurfaceMesh *mesh, SurfaceMesh::Vertex v);
 
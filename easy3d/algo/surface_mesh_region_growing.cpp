@@ -0,0 +1,195 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/surface_mesh_region_growing.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+
+namespace easy3d {
+
+
+    SurfaceMeshRegionGrowing::SurfaceMeshRegionGrowing(SurfaceMesh *mesh)
+            : mesh_(mesh), num_regions_(0), threshold_(0.0f), num_updated_(0) {
+    }
+
+
+    void SurfaceMeshRegionGrowing::initialize() {
+        candidates_.clear();
+        history_.clear();
+        num_regions_ = 0;
+        threshold_ = 0.0f;
+        num_updated_ = 0;
+
+        mesh_->update_face_normals();
+        auto fnormals = mesh_->get_face_property<vec3>("f:normal");
+
+        const int num_faces = static_cast<int>(mesh_->faces_size());
+        std::vector<char> is_degenerate(num_faces, 0);
+        host_.assign(num_faces, -1);
+#pragma omp parallel for
+        for (int i = 0; i < num_faces; ++i) {
+            const SurfaceMesh::Face f(i);
+            if (mesh_->is_deleted(f))
+                continue;
+            if (mesh_->is_degenerate(f))
+                is_degenerate[i] = 1;
+            else
+                host_[i] = i;
+        }
+
+        // degenerate faces take the region of a non-degenerate neighbor
+        int num_degenerate = 0;
+        for (int i = 0; i < num_faces; ++i) {
+            if (!is_degenerate[i])
+                continue;
+            ++num_degenerate;
+            for (auto h : mesh_->halfedges(SurfaceMesh::Face(i))) {
+                const auto g = mesh_->face(mesh_->opposite(h));
+                if (g.is_valid() && !is_degenerate[g.idx()]) {
+                    host_[i] = g.idx();
+                    break;
+                }
+            }
+        }
+        if (num_degenerate > 0)
+            LOG(WARNING) << "model has " << num_degenerate << " degenerate faces";
+
+        parent_.resize(num_faces);
+        size_.assign(num_faces, 1);
+        for (int i = 0; i < num_faces; ++i) {
+            parent_[i] = i;
+            if (host_[i] == i)
+                ++num_regions_;
+        }
+
+        // the merge candidates: all the edges between two non-degenerate faces
+        const int num_edges = static_cast<int>(mesh_->edges_size());
+        std::vector<Candidate> candidates(num_edges, {std::numeric_limits<float>::max(), -1, -1});
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh_->is_deleted(e))
+                continue;
+            const auto f0 = mesh_->face(mesh_->halfedge(e, 0));
+            const auto f1 = mesh_->face(mesh_->halfedge(e, 1));
+            if (f0.is_valid() && f1.is_valid() && host_[f0.idx()] == f0.idx() && host_[f1.idx()] == f1.idx()) {
+                auto angle = geom::angle(fnormals[f0], fnormals[f1]); // in [-pi, pi]
+                angle = geom::to_degrees(std::abs(angle));
+                candidates[i] = {static_cast<float>(angle), f0.idx(), f1.idx()};
+            }
+        }
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [](const Candidate &c) { return c.f0 < 0; }), candidates.end());
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate &a, const Candidate &b) { return a.angle < b.angle; });
+        candidates_.swap(candidates);
+        history_.reserve(candidates_.size());
+    }
+
+
+    int SurfaceMeshRegionGrowing::find(int x) const {
+        while (parent_[x] != x)
+            x = parent_[x];
+        return x;
+    }
+
+
+    int SurfaceMeshRegionGrowing::set_angle_threshold(float threshold) {
+        // the candidates with angles smaller than the threshold are merged
+        const auto pos = std::lower_bound(candidates_.begin(), candidates_.end(), threshold,
+                                          [](const Candidate &c, float t) { return c.angle < t; });
+        const std::size_t target = static_cast<std::size_t>(pos - candidates_.begin());
+
+        num_updated_ = 0;
+        // larger threshold: merge the next candidates (union by size keeps the trees shallow)
+        while (history_.size() < target) {
+            const Candidate &c = candidates_[history_.size()];
+            int a = find(c.f0);
+            int b = find(c.f1);
+            if (a == b)
+                history_.push_back({-1, -1});
+            else {
+                if (size_[a] > size_[b])
+                    std::swap(a, b);
+                parent_[a] = b;
+                size_[b] += size_[a];
+                history_.push_back({a, b});
+                --num_regions_;
+            }
+            ++num_updated_;
+        }
+        // smaller threshold: undo the merges in reverse order
+        while (history_.size() > target) {
+            const Merge &m = history_.back();
+            if (m.child >= 0) {
+                parent_[m.child] = m.child;
+                size_[m.parent] -= size_[m.child];
+                ++num_regions_;
+            }
+            history_.pop_back();
+            ++num_updated_;
+        }
+
+        threshold_ = threshold;
+        return num_regions_;
+    }
+
+
+    SurfaceMesh::Face SurfaceMeshRegionGrowing::region(SurfaceMesh::Face f) const {
+        const int host = host_[f.idx()];
+        return SurfaceMesh::Face(host < 0 ? -1 : find(host));
+    }
+
+
+    int SurfaceMeshRegionGrowing::labels(SurfaceMesh::FaceProperty<int> id) const {
+        const int num_faces = static_cast<int>(host_.size());
+        std::vector<int> roots(num_faces, -1);
+#pragma omp parallel for
+        for (int i = 0; i < num_faces; ++i) {
+            if (host_[i] >= 0)
+                roots[i] = find(host_[i]);
+        }
+
+        // number the regions in the order of their first faces
+        std::vector<int> region_label(num_faces, -1);
+        int num = 0;
+        for (int i = 0; i < num_faces; ++i) {
+            const int r = roots[i];
+            if (r < 0)
+                id[SurfaceMesh::Face(i)] = -1;
+            else {
+                if (region_label[r] < 0)
+                    region_label[r] = num++;
+                id[SurfaceMesh::Face(i)] = region_label[r];
+            }
+        }
+        return num;
+    }
+
+}
@@ -0,0 +1,137 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_REGION_GROWING_H
+#define EASY3D_ALGO_SURFACE_MESH_REGION_GROWING_H
+
+#include <vector>
+
+#include <easy3d/core/surface_mesh.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Incremental region growing of planar regions on a surface mesh, for interactive segmentation.
+     * \class SurfaceMeshRegionGrowing easy3d/algo/surface_mesh_region_growing.h
+     * \details Two faces sharing an edge belong to the same region if the dihedral angle between them is smaller
+     *      than an angle threshold, so the regions are the same as those computed by
+     *      SurfaceMeshEnumerator::enumerate_planar_components(). The difference is that the segmentation can be
+     *      updated quickly when the threshold changes: the edges (i.e., the merge candidates) are sorted by their
+     *      dihedral angles once, and the regions are maintained in a union-find structure whose merges can be
+     *      undone. Changing the threshold only processes the candidates whose angles lie between the old and the new
+     *      thresholds, i.e., the edges on the boundaries of the regions that are merged or split.
+     *
+     *      Example usage (e.g., when the user drags a slider):
+     *      \code
+     *          SurfaceMeshRegionGrowing segmentation(mesh);
+     *          segmentation.initialize();                  // once (or after the mesh has changed)
+     *          ...
+     *          segmentation.set_angle_threshold(angle);    // each time the threshold changes
+     *          auto id = mesh->face_property<int>("f:planar_partition", -1);
+     *          segmentation.labels(id);
+     *      \endcode
+     *
+     * \see SurfaceMeshEnumerator
+     */
+    class SurfaceMeshRegionGrowing {
+    public:
+        /// Creates the region growing engine for \p mesh.
+        explicit SurfaceMeshRegionGrowing(SurfaceMesh *mesh);
+
+        /**
+         * \brief Computes the dihedral angles of all the edges and sorts the merge candidates.
+         * \details This resets the threshold to 0 (i.e., each face is a region). It must be called before any other
+         *      operation and each time the mesh has changed.
+         */
+        void initialize();
+
+        /**
+         * \brief Updates the regions for a new angle threshold.
+         * \param threshold Two faces sharing a common edge are in the same region if the dihedral angle is smaller
+         *      than \p threshold (in degrees).
+         * \return The number of regions.
+         */
+        int set_angle_threshold(float threshold);
+
+        /// Returns the current angle threshold (in degrees).
+        float angle_threshold() const { return threshold_; }
+
+        /// Returns the number of regions (degenerate faces are not counted).
+        int num_regions() const { return num_regions_; }
+
+        /// Returns the number of merge candidates processed by the last call of set_angle_threshold().
+        std::size_t num_updated_candidates() const { return num_updated_; }
+
+        /**
+         * \brief Returns the representative face of the region containing face \p f.
+         * \details Two faces are in the same region if they have the same representative. A degenerate face takes
+         *      the region of one of its non-degenerate neighbors. An invalid face is returned if a degenerate face
+         *      has no non-degenerate neighbor.
+         */
+        SurfaceMesh::Face region(SurfaceMesh::Face f) const;
+
+        /**
+         * \brief Labels the faces with their region indices, i.e., 0, 1, ..., num_regions() - 1.
+         * \details Degenerate faces get the label of one of their non-degenerate neighbors (-1 if there is none).
+         * \return The number of regions.
+         */
+        int labels(SurfaceMesh::FaceProperty<int> id) const;
+
+    private:
+        // the root of the tree containing x (no path compression, so merges can be undone)
+        int find(int x) const;
+
+        // a pair of adjacent faces that will be in the same region if their dihedral angle is below the threshold
+        struct Candidate {
+            float angle;
+            int f0, f1;
+        };
+
+        // a merge done for a candidate. 'child' is -1 if the faces were already in the same region.
+        struct Merge {
+            int child;
+            int parent;
+        };
+
+    private:
+        SurfaceMesh *mesh_;
+
+        std::vector<Candidate> candidates_; // sorted by increasing angle
+        std::vector<Merge> history_;        // one merge for each applied candidate (a prefix of 'candidates_')
+
+        std::vector<int> parent_;
+        std::vector<int> size_;
+        std::vector<int> host_;   // the face whose region a face belongs to (a neighbor for degenerate faces)
+
+        int num_regions_;
+        float threshold_;
+        std::size_t num_updated_;
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_REGION_GROWING_H
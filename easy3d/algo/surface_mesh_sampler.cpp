@@ -25,6 +25,12 @@
  ********************************************************************/
 
 #include <easy3d/algo/surface_mesh_sampler.h>
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/util/file_system.h>
@@ -35,123 +41,278 @@
 namespace easy3d {
 
 
-    PointCloud *SurfaceMeshSampler::apply(const SurfaceMesh *input_mesh, int expected_num /* = 1000000 */) {
-        auto func = [](const SurfaceMesh *mesh, int num) -> PointCloud * {
-            auto cloud = new PointCloud;
-            const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
-            cloud->set_name(name);
+    namespace internal {
 
-            auto normals = cloud->add_vertex_property<vec3>("v:normal");
+        // A counter-based random number generator (SplitMix64). A sample derives its random numbers from its own
+        // index, thus the results do not depend on how the samples are distributed among the threads.
+        inline uint64_t split_mix(uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
 
-            LOG(INFO) << "sampling surface...";
+        // returns a random number in [0, 1) and advances the state
+        inline float next_float(uint64_t &state) {
+            state = split_mix(state);
+            return static_cast<float>(state >> 40) * (1.0f / 16777216.0f);
+        }
 
-            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+        // returns a random number in [0, 1) with 53 random bits and advances the state. Used for looking up the
+        // cumulative areas, which a float (24 bits) cannot resolve for meshes with millions of triangles.
+        inline double next_double(uint64_t &state) {
+            state = split_mix(state);
+            return static_cast<double>(state >> 11) * (1.0 / 9007199254740992.0);
+        }
 
-            // we need the vertex normals and face normals.
-            const_cast<SurfaceMesh *>(mesh)->update_vertex_normals();
-            const_cast<SurfaceMesh *>(mesh)->update_face_normals();
+        // the halfedge pointing to v in a non-border face, used to look up per-corner attributes of v.
+        inline SurfaceMesh::Halfedge incoming_halfedge(const SurfaceMesh *mesh, SurfaceMesh::Vertex v) {
+            SurfaceMesh::Halfedge h = mesh->out_halfedge(v);
+            if (!h.is_valid())
+                return h;
+            return mesh->is_border(h) ? mesh->opposite(h) : mesh->prev(h);
+        }
 
-            // add all mesh vertices (even the requested number is smaller than the
-            // number of vertices in the mesh).
-            auto mesh_vertex_normals = mesh->get_vertex_property<vec3>("v:normal");
-            for (auto p : mesh->vertices()) {
-                PointCloud::Vertex v = cloud->add_vertex(mesh_points[p]);
-                if (mesh_vertex_normals)
-                    normals[v] = mesh_vertex_normals[p];
-                else
-                    normals[v] = mesh->compute_vertex_normal(p);
+        // the angle-weighted normal of a vertex of a triangle mesh (computed without requiring the face normals)
+        inline vec3 vertex_normal(const SurfaceMesh *mesh, const SurfaceMesh::VertexProperty<vec3> &points,
+                                  SurfaceMesh::Vertex v) {
+            vec3 nn(0, 0, 0);
+            const vec3 &p0 = points[v];
+            for (auto h : mesh->halfedges(v)) {
+                if (mesh->is_border(h))
+                    continue;
+                const vec3 p1 = points[mesh->target(h)] - p0;
+                const vec3 p2 = points[mesh->source(mesh->prev(h))] - p0;
+                const float denom = std::sqrt(dot(p1, p1) * dot(p2, p2));
+                const vec3 n = cross(p1, p2);
+                const float len = length(n);
+                if (denom > std::numeric_limits<float>::min() && len > std::numeric_limits<float>::min()) {
+                    const float cosine = std::min(1.0f, std::max(-1.0f, dot(p1, p2) / denom));
+                    nn += n * (std::acos(cosine) / len);
+                }
             }
+            return normalize(nn);
+        }
+
+        // finds a multiplier coprime with n to permute the strata of a Latin hypercube.
+        inline int coprime_multiplier(int n) {
+            auto gcd = [](int a, int b) -> int {
+                while (b != 0) {
+                    const int r = a % b;
+                    a = b;
+                    b = r;
+                }
+                return a;
+            };
+            int a = std::max(1, static_cast<int>(n * 0.618034f));
+            while (gcd(a, n) != 1)
+                ++a;
+            return a;
+        }
+
+    }
 
-            // now we may still need some points
-            int num_needed = num - static_cast<int>(cloud->n_vertices());
-            if (num_needed <= 0)
-                return cloud;   // we got enough points already
 
-            // collect triangles and compute their areas
-            struct Triangle : std::vector<SurfaceMesh::Vertex> {};
+    PointCloud *SurfaceMeshSampler::apply(const SurfaceMesh *input_mesh, int expected_num /* = 1000000 */,
+                                          Method method /* = STRATIFIED */, unsigned int seed /* = 0 */,
+                                          bool keep_vertices /* = true */) {
+        auto func = [&](const SurfaceMesh *mesh, int num) -> PointCloud * {
+            LOG(INFO) << "sampling surface...";
 
-            std::vector<Triangle> triangles;
-            std::vector<float> triangle_areas;
-            std::vector<vec3> triangle_normals;
+            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+            auto mesh_vertex_normals = mesh->get_vertex_property<vec3>("v:normal");
+            auto mesh_vertex_colors = mesh->get_vertex_property<vec3>("v:color");
+            auto mesh_face_colors = mesh->get_face_property<vec3>("f:color");
+            auto mesh_vertex_texcoords = mesh->get_vertex_property<vec2>("v:texcoord");
+            auto mesh_halfedge_texcoords = mesh->get_halfedge_property<vec2>("h:texcoord");
 
-            auto mesh_face_normals = mesh->get_face_property<vec3>("f:normal");
-            float surface_area = 0.0f;
+            // collect the triangles (as their three corners). A triangle is represented by the three halfedges,
+            // each pointing to one of its vertices.
+            std::vector<SurfaceMesh::Halfedge> corners;
+            corners.reserve(mesh->n_faces() * 3);
             for (auto f : mesh->faces()) {
-                const vec3 &n = mesh_face_normals[f];
-                SurfaceMesh::Halfedge start = mesh->halfedge(f);
-                SurfaceMesh::Halfedge cur = mesh->next(mesh->next(start));
-                SurfaceMesh::Vertex va = mesh->target(start);
-                while (cur != start) {
-                    SurfaceMesh::Vertex vb = mesh->source(cur);
-                    SurfaceMesh::Vertex vc = mesh->target(cur);
-
-                    Triangle tri;
-                    tri.push_back(va);
-                    tri.push_back(vb);
-                    tri.push_back(vc);
-                    triangles.push_back(tri);
-                    float area = geom::triangle_area(mesh_points[va], mesh_points[vb], mesh_points[vc]);
-                    triangle_areas.push_back(area);
-                    triangle_normals.push_back(n);
-                    surface_area += area;
-
-                    cur = mesh->next(cur);
-                }
+                const SurfaceMesh::Halfedge h0 = mesh->halfedge(f);
+                const SurfaceMesh::Halfedge h1 = mesh->next(h0);
+                corners.push_back(h0);
+                corners.push_back(h1);
+                corners.push_back(mesh->next(h1));
             }
+            const int num_triangles = static_cast<int>(corners.size() / 3);
 
-            float density = static_cast<float>(num_needed) / surface_area;
-            float samples_error = 0.0f;
-            std::size_t triangle_num = triangles.size();
-            std::size_t num_generated = 0;
-            std::size_t triangles_done = 0;
-            ProgressLogger progress(triangle_num, false, false);
-            for (std::size_t idx = 0; idx < triangle_num; ++idx) {
-                if (progress.is_canceled()) {
-                    LOG(WARNING) << "sampling surface mesh cancelled";
-                    delete cloud;
-                    return nullptr;
-                }
+            // compute the areas and normals of the triangles
+            std::vector<double> triangle_areas(num_triangles);
+            std::vector<vec3> triangle_normals(num_triangles);
+#pragma omp parallel for
+            for (int i = 0; i < num_triangles; ++i) {
+                const vec3 &a = mesh_points[mesh->target(corners[i * 3])];
+                const vec3 &b = mesh_points[mesh->target(corners[i * 3 + 1])];
+                const vec3 &c = mesh_points[mesh->target(corners[i * 3 + 2])];
+                const vec3 n = cross(b - a, c - a);
+                const float len = length(n);
+                triangle_areas[i] = 0.5 * len;
+                triangle_normals[i] = len > epsilon<float>() ? n / len : n;
+            }
 
-                const Triangle &tri = triangles[idx];
-                const vec3 &n = triangle_normals[idx];
+            // the cumulative area table: cdf[i] is the total area of the triangles before triangle i
+            std::vector<double> cdf(num_triangles + 1, 0.0);
+            std::partial_sum(triangle_areas.begin(), triangle_areas.end(), cdf.begin() + 1);
+            const double surface_area = cdf.back();
 
-                // samples number considering the facet size (i.e., area)
-                float samples_num = triangle_areas[idx] * density;
-                int quant_samples_num = static_cast<int>(samples_num);
+            std::vector<SurfaceMesh::Vertex> vertices;
+            if (keep_vertices) {
+                vertices.reserve(mesh->n_vertices());
+                for (auto v : mesh->vertices())
+                    vertices.push_back(v);
+            }
+            const int num_vertices = static_cast<int>(vertices.size());
+            const int num_needed = (surface_area > 0.0) ? std::max(0, num - num_vertices) : 0;
 
-                // adjust w.r.t. accumulated error
-                samples_error += samples_num - static_cast<float>(quant_samples_num);
-                if (samples_error > 1.0) {
-                    samples_error -= 1.0;
-                    quant_samples_num++;
-                }
+            // now allocate all the points and their properties at once
+            auto cloud = new PointCloud;
+            const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
+            cloud->set_name(name);
+            cloud->resize(num_vertices + num_needed);
+            vec3 *points = cloud->points().data();
+            vec3 *normals = cloud->add_vertex_property<vec3>("v:normal").vector().data();
+            vec3 *colors = nullptr;
+            if (mesh_vertex_colors || mesh_face_colors)
+                colors = cloud->add_vertex_property<vec3>("v:color").vector().data();
+            vec2 *texcoords = nullptr;
+            if (mesh_vertex_texcoords || mesh_halfedge_texcoords)
+                texcoords = cloud->add_vertex_property<vec2>("v:texcoord").vector().data();
 
-                if (triangles_done ==
-                    triangle_num - 1)        // override number to gather all remaining points if last facet
-                    quant_samples_num = num_needed - static_cast<int>(num_generated);
+            // add all mesh vertices (even the requested number is smaller than the number of vertices in the mesh).
+#pragma omp parallel for
+            for (int i = 0; i < num_vertices; ++i) {
+                const SurfaceMesh::Vertex v = vertices[i];
+                points[i] = mesh_points[v];
+                normals[i] = mesh_vertex_normals ? mesh_vertex_normals[v] : internal::vertex_normal(mesh, mesh_points, v);
+                const SurfaceMesh::Halfedge h = internal::incoming_halfedge(mesh, v);
+                if (colors) {
+                    if (mesh_vertex_colors)
+                        colors[i] = mesh_vertex_colors[v];
+                    else if (h.is_valid())
+                        colors[i] = mesh_face_colors[mesh->face(h)];
+                }
+                if (texcoords) {
+                    if (mesh_halfedge_texcoords) {
+                        if (h.is_valid())
+                            texcoords[i] = mesh_halfedge_texcoords[h];
+                    } else
+                        texcoords[i] = mesh_vertex_texcoords[v];
+                }
+            }
 
-                // generate points
-                for (int j = 0; j < quant_samples_num; j++) {
-                    // compute barycentric coords
-                    double s = std::sqrt(static_cast<double>(rand()) / static_cast<double>(RAND_MAX));
-                    double t = static_cast<double>(rand()) / static_cast<double>(RAND_MAX);
-                    double c[3];
+            if (num_needed == 0) {
+                LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points";
+                return cloud;   // we got enough points already
+            }
 
-                    c[0] = 1.0 - s;
-                    c[1] = s * (1.0 - t);
-                    c[2] = s * t;
+            // writes the sample at the given barycentric coordinates of a triangle into slot idx of the point cloud.
+            auto write_sample = [&](int idx, int tri, float s, float t) {
+                const float c[3] = {1.0f - s, s * (1.0f - t), s * t};
+                const SurfaceMesh::Halfedge *h = &corners[tri * 3];
+                vec3 p(0, 0, 0);
+                for (int k = 0; k < 3; ++k)
+                    p += c[k] * mesh_points[mesh->target(h[k])];
+                points[idx] = p;
+                normals[idx] = triangle_normals[tri];
+                if (colors) {
+                    if (mesh_vertex_colors) {
+                        vec3 color(0, 0, 0);
+                        for (int k = 0; k < 3; ++k)
+                            color += c[k] * mesh_vertex_colors[mesh->target(h[k])];
+                        colors[idx] = color;
+                    } else
+                        colors[idx] = mesh_face_colors[mesh->face(h[0])];
+                }
+                if (texcoords) {
+                    vec2 tc(0, 0);
+                    for (int k = 0; k < 3; ++k)
+                        tc += c[k] * (mesh_halfedge_texcoords ? mesh_halfedge_texcoords[h[k]]
+                                                              : mesh_vertex_texcoords[mesh->target(h[k])]);
+                    texcoords[idx] = tc;
+                }
+            };
 
-                    vec3 p;
-                    for (std::size_t i = 0; i < 3; i++)
-                        p = p + c[i] * mesh_points[tri[i]];
+            // The work is split into chunks that are processed in parallel, which allows to report the progress and
+            // to cancel the sampling in between.
+            const uint64_t key = internal::split_mix(seed);
+            const int num_chunks = std::min(100, method == RANDOM ? num_needed : num_triangles);
+            ProgressLogger progress(num_chunks, false, false);
 
-                    PointCloud::Vertex v = cloud->add_vertex(p);
-                    normals[v] = n;
+            if (method == RANDOM) {
+                for (int chunk = 0; chunk < num_chunks; ++chunk) {
+                    if (progress.is_canceled()) {
+                        LOG(WARNING) << "sampling surface mesh cancelled";
+                        delete cloud;
+                        return nullptr;
+                    }
+                    const int begin = static_cast<int>(static_cast<int64_t>(num_needed) * chunk / num_chunks);
+                    const int end = static_cast<int>(static_cast<int64_t>(num_needed) * (chunk + 1) / num_chunks);
+#pragma omp parallel for
+                    for (int j = begin; j < end; ++j) {
+                        uint64_t state = key ^ internal::split_mix(j);
+                        // pick a triangle with a probability proportional to its area
+                        const double target = internal::next_double(state) * surface_area;
+                        int tri = static_cast<int>(std::upper_bound(cdf.begin(), cdf.end(), target) - cdf.begin()) - 1;
+                        tri = std::min(std::max(tri, 0), num_triangles - 1);
+                        const float s = std::sqrt(internal::next_float(state));
+                        const float t = internal::next_float(state);
+                        write_sample(num_vertices + j, tri, s, t);
+                    }
+                    progress.next();
                 }
+            }
+            else {
+                // The number of samples of each triangle is proportional to its area. Rounding the cumulative area
+                // (instead of the area of each triangle) distributes the quantization error and makes sure exactly
+                // the requested number of samples is generated.
+                const double density = num_needed / surface_area;
+                std::vector<int> first(num_triangles + 1);
+#pragma omp parallel for
+                for (int i = 0; i <= num_triangles; ++i)
+                    first[i] = std::min(num_needed, static_cast<int>(std::llround(cdf[i] * density)));
+                first[num_triangles] = num_needed;
 
-                num_generated += quant_samples_num;
-                triangles_done++;
-                progress.next();
+                // the R2 sequence (the generalized golden ratio in 2D)
+                const float r2_a1 = 0.7548776662f;
+                const float r2_a2 = 0.5698402910f;
+                for (int chunk = 0; chunk < num_chunks; ++chunk) {
+                    if (progress.is_canceled()) {
+                        LOG(WARNING) << "sampling surface mesh cancelled";
+                        delete cloud;
+                        return nullptr;
+                    }
+                    const int begin = static_cast<int>(static_cast<int64_t>(num_triangles) * chunk / num_chunks);
+                    const int end = static_cast<int>(static_cast<int64_t>(num_triangles) * (chunk + 1) / num_chunks);
+#pragma omp parallel for
+                    for (int tri = begin; tri < end; ++tri) {
+                        const int n = first[tri + 1] - first[tri];
+                        if (n <= 0)
+                            continue;
+                        uint64_t state = key ^ internal::split_mix(tri);
+                        if (method == STRATIFIED) {
+                            const int a = internal::coprime_multiplier(n);
+                            const int b = static_cast<int>(internal::next_float(state) * n);
+                            for (int j = 0; j < n; ++j) {
+                                const float u = (j + internal::next_float(state)) / n;
+                                const float v = ((j * a + b) % n + internal::next_float(state)) / n;
+                                write_sample(num_vertices + first[tri] + j, tri, std::sqrt(u), v);
+                            }
+                        } else { // LOW_DISCREPANCY
+                            const float u0 = internal::next_float(state);
+                            const float v0 = internal::next_float(state);
+                            for (int j = 0; j < n; ++j) {
+                                const float u = u0 + r2_a1 * j;
+                                const float v = v0 + r2_a2 * j;
+                                write_sample(num_vertices + first[tri] + j, tri, std::sqrt(u - std::floor(u)),
+                                             v - std::floor(v));
+                            }
+                        }
+                    }
+                    progress.next();
+                }
             }
 
             LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points";
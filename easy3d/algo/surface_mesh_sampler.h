@@ -35,10 +35,34 @@ namespace easy3d {
 
     /// \brief Sample a surface mesh (near uniformly) into a point cloud.
     /// \class SurfaceMeshSampler easy3d/algo/surface_mesh_sampler.h
+    /// \details The samples are distributed according to the areas of the faces (a cumulative area table is used for
+    ///     the lookup) and are generated in parallel. Each sample draws its random numbers from its own counter-based
+    ///     stream derived from \p seed, so the result is deterministic and independent of the number of threads.
+    ///     Besides the positions and normals, per-vertex colors ("v:color"), per-face colors ("f:color"), and
+    ///     texture coordinates ("v:texcoord" or "h:texcoord") of the mesh are interpolated and transferred to the
+    ///     point cloud ("v:color" and "v:texcoord").
     class SurfaceMeshSampler {
     public:
-        /// @param num The expected point number, must be greater than the number of vertices of the surface mesh.
-        static PointCloud *apply(const SurfaceMesh *mesh, int num = 1000000);
+        /// \brief The strategy for distributing the samples over the surface.
+        enum Method {
+            /// Independent samples: a face is chosen with a probability proportional to its area.
+            RANDOM,
+            /// The number of samples of each face is proportional to its area, and the samples within a face are
+            /// jittered in a Latin-hypercube pattern.
+            STRATIFIED,
+            /// Similar to STRATIFIED, but the samples within a face follow a randomly shifted R2 low-discrepancy
+            /// sequence (i.e., fewer clumps and holes within each face). Note that no minimum distance is enforced
+            /// between the samples of different faces, so this is not a blue-noise distribution.
+            LOW_DISCREPANCY
+        };
+
+        /// @param num The expected point number, must be greater than the number of vertices of the surface mesh if
+        ///     \p keep_vertices is \c true.
+        /// @param method The strategy for distributing the samples.
+        /// @param seed The seed of the random number generator. The same seed produces the same point cloud.
+        /// @param keep_vertices \c true to also add all the mesh vertices to the point cloud.
+        static PointCloud *apply(const SurfaceMesh *mesh, int num = 1000000, Method method = STRATIFIED,
+                                 unsigned int seed = 0, bool keep_vertices = true);
     };
 
 } // namespace easy3d
@@ -10,6 +10,7 @@
  ********************************************************************/
 
 #include <easy3d/algo/surface_mesh_simplification.h>
+#include <easy3d/core/surface_mesh_adjacency.h>
 
 #include <cfloat>
 #include <iterator> // for back_inserter on Windows
@@ -146,8 +147,7 @@ namespace easy3d {
         }
 
         unsigned int nv(mesh_->n_vertices());
-        std::vector<SurfaceMesh::Vertex> one_ring;
-        std::vector<SurfaceMesh::Vertex>::iterator or_it, or_end;
+        SmallVector<SurfaceMesh::Vertex, 16> one_ring;
         SurfaceMesh::Halfedge h;
         SurfaceMesh::Vertex v;
         while (nv > n_vertices && !queue_->empty()) {
@@ -162,10 +162,7 @@ namespace easy3d {
                 continue;
 
             // store one-ring
-            one_ring.clear();
-            for (auto vv : mesh_->vertices(cd.v0)) {
-                one_ring.push_back(vv);
-            }
+            gather_one_ring(mesh_, cd.v0, one_ring);
 
             // perform collapse
             mesh_->collapse(h);
@@ -176,9 +173,8 @@ namespace easy3d {
             postprocess_collapse(cd);
 
             // update queue
-            for (or_it = one_ring.begin(), or_end = one_ring.end(); or_it != or_end;
-                 ++or_it)
-                enqueue_vertex(*or_it);
+            for (auto vv : one_ring)
+                enqueue_vertex(vv);
         }
 
         // clean up
@@ -364,7 +360,9 @@ namespace easy3d {
 
         // check Hausdorff error
         if (std::abs(hausdorff_error_) > std::numeric_limits<float>::min()) {
-            Points points;
+            // the buffer is reused across calls to avoid allocations
+            Points &points = hausdorff_points_;
+            points.clear();
             bool ok = false;
 
             // collect points to be tested
@@ -376,7 +374,7 @@ namespace easy3d {
 
             // test points against all faces
             vpoint_[cd.v0] = p1;
-            for (auto point : points) {
+            for (const auto &point : points) {
                 ok = false;
 
                 for (auto f : mesh_->faces(cd.v0)) {
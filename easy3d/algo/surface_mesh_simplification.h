@@ -264,6 +264,7 @@ namespace easy3d {
         SurfaceMesh::VertexProperty<Quadric> vquadric_;
         SurfaceMesh::FaceProperty<NormalCone> normal_cone_;
         SurfaceMesh::FaceProperty<Points> face_points_;
+        Points hausdorff_points_;  // scratch buffer for testing the Hausdorff error
 
         SurfaceMesh::VertexProperty<vec3> vpoint_;
         SurfaceMesh::FaceProperty<vec3> fnormal_;
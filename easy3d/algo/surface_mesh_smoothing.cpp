@@ -15,6 +15,7 @@
 #include <Eigen/Sparse>
 
 #include <easy3d/algo/surface_mesh_geometry.h>
+#include <easy3d/core/surface_mesh_adjacency.h>
 
 
 namespace easy3d {
@@ -67,8 +68,10 @@ namespace easy3d {
             for (auto v : mesh_->vertices())
                 vweight[v] = static_cast<float>(1.0 / mesh_->valence(v));
         } else {
+            std::vector<double> areas;
+            geom::voronoi_areas(mesh_, areas);
             for (auto v : mesh_->vertices())
-                vweight[v] = static_cast<float>(0.5 / geom::voronoi_area(mesh_, v));
+                vweight[v] = static_cast<float>(0.5 / areas[v.idx()]);
         }
     }
 
@@ -88,6 +91,9 @@ namespace easy3d {
         auto points = mesh_->get_vertex_property<vec3>("v:point");
         auto laplace = mesh_->add_vertex_property<vec3>("v:laplace");
 
+        // the connectivity does not change during smoothing
+        const SurfaceMeshAdjacency adjacency(mesh_);
+
         // smoothing iterations
         SurfaceMesh::Vertex vv;
         SurfaceMesh::Edge e;
@@ -99,9 +105,11 @@ namespace easy3d {
                 if (!mesh_->is_border(v)) {
                     float w(0);
 
-                    for (auto h : mesh_->halfedges(v)) {
-                        vv = mesh_->target(h);
-                        e = mesh_->edge(h);
+                    const auto ring = adjacency.vertices(v);
+                    const auto hedges = adjacency.halfedges(v);
+                    for (std::size_t k = 0; k < ring.size(); ++k) {
+                        vv = ring[k];
+                        e = mesh_->edge(hedges[k]);
                         l += eweight[e] * (points[vv] - points[v]);
                         w += eweight[e];
                     }
@@ -27,181 +27,231 @@
 #include <easy3d/algo/surface_mesh_stitching.h>
 
 #include <algorithm>
-#include <cassert>
+#include <cmath>
+#include <cstdint>
 
 #include <easy3d/core/surface_mesh.h>
-
-#include <3rd_party/kdtree/ANN/ANN.h>
-
-
-using namespace ANN;
-
-#define get_tree(x) (reinterpret_cast<ANNkd_tree*>(x))
+#include <easy3d/util/stop_watch.h>
 
 
 namespace easy3d {
 
-    SurfaceMeshStitching::SurfaceMeshStitching(SurfaceMesh *mesh)
-            : mesh_(mesh), coordinates_(nullptr), tree_(nullptr), k_for_radius_search_(4) {
-        for (auto h : mesh_->halfedges()) {
-            if (mesh_->is_border(h))
-                border_edges_.push_back(h);
-        }
-
-        if (border_edges_.empty())
-            return;
-
-        coordinates_ = annAllocPts(border_edges_.size(), 6);
-        for (std::size_t i = 0; i < border_edges_.size(); ++i)
-            assign_edge_coordinate(coordinates_[i], border_edges_[i]);
-
-        tree_ = new ANNkd_tree(coordinates_, border_edges_.size(), 6);
-    }
-
+    namespace internal {
+
+        struct BorderEdge {
+            int mesh;
+            SurfaceMesh::Halfedge halfedge;
+            vec3 source;
+            vec3 target;
+        };
+
+
+        // A spatial hash of border edges keyed by the grid cell of their source points. Since the cell size is not
+        // smaller than the distance threshold, the sources matching a point are in the 27 cells around it.
+        class BorderEdgeHash {
+        public:
+            BorderEdgeHash(const std::vector<BorderEdge> &edges, float cell_size)
+                    : edges_(edges), cell_size_(cell_size), entries_(edges.size())
+            {
+                const int num = static_cast<int>(edges.size());
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                    entries_[i] = {key(cell(edges[i].source)), i};
+                std::sort(entries_.begin(), entries_.end());
+            }
 
-    SurfaceMeshStitching::~SurfaceMeshStitching() {
-        if (coordinates_)
-            annDeallocPts(coordinates_);
+            // returns the index of the closest edge matching edges_[i], i.e., with the opposite direction and both
+            // pairs of end points within the threshold. Returns -1 if no such edge exists.
+            int best_match(int i, float squared_dist_threshold) const {
+                const BorderEdge &e = edges_[i];
+                const Cell c = cell(e.target);
+                float min_sd = squared_dist_threshold;
+                int best = -1;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dz = -1; dz <= 1; ++dz) {
+                            const std::uint64_t k = key({c.x + dx, c.y + dy, c.z + dz});
+                            auto pos = std::lower_bound(entries_.begin(), entries_.end(), std::make_pair(k, -1));
+                            for (; pos != entries_.end() && pos->first == k; ++pos) {
+                                const int j = pos->second;
+                                if (j == i)
+                                    continue;
+                                const BorderEdge &f = edges_[j];
+                                const float sd = std::max(distance2(e.source, f.target), distance2(e.target, f.source));
+                                if (sd < min_sd) {
+                                    min_sd = sd;
+                                    best = j;
+                                }
+                            }
+                        }
+                    }
+                }
+                return best;
+            }
 
-        delete get_tree(tree_);
-        annClose();
-    }
+        private:
+            struct Cell {
+                std::int64_t x, y, z;
+            };
+
+            Cell cell(const vec3 &p) const {
+                return {
+                        static_cast<std::int64_t>(std::floor(p.x / cell_size_)),
+                        static_cast<std::int64_t>(std::floor(p.y / cell_size_)),
+                        static_cast<std::int64_t>(std::floor(p.z / cell_size_))
+                };
+            }
 
+            // collisions of the keys only result in more candidates (which are checked anyway)
+            static std::uint64_t key(const Cell &c) {
+                return static_cast<std::uint64_t>(c.x) * 73856093ull ^
+                       static_cast<std::uint64_t>(c.y) * 19349663ull ^
+                       static_cast<std::uint64_t>(c.z) * 83492791ull;
+            }
 
-    bool SurfaceMeshStitching::lexicographically_smaller(const vec3 &p0, const vec3 &p1) const {
-        if (p0.x > p1.x)
-            return false;
-        else if (p0.x < p1.x)
-            return true;
-        else {
-            if (p0.y > p1.y)
-                return false;
-            else if (p0.y < p1.y)
-                return true;
-            else {
-                if (p0.z > p1.z)
-                    return false;
-                else if (p0.z < p1.z)
-                    return true;
-                else
-                    return false;
+        private:
+            const std::vector<BorderEdge> &edges_;
+            float cell_size_;
+            std::vector<std::pair<std::uint64_t, int> > entries_;
+        };
+
+
+        // collects the border edges of the meshes
+        std::vector<BorderEdge> collect_border_edges(const std::vector<SurfaceMesh *> &meshes, Box3 &box) {
+            std::vector<BorderEdge> edges;
+            for (std::size_t m = 0; m < meshes.size(); ++m) {
+                const SurfaceMesh *mesh = meshes[m];
+                for (auto h : mesh->halfedges()) {
+                    if (mesh->is_border(h)) {
+                        const vec3 &s = mesh->position(mesh->source(h));
+                        const vec3 &t = mesh->position(mesh->target(h));
+                        edges.push_back({static_cast<int>(m), h, s, t});
+                        box.grow(s);
+                        box.grow(t);
+                    }
+                }
             }
+            return edges;
         }
-        assert(false);
-        return true;
-    }
 
 
-    void SurfaceMeshStitching::assign_edge_coordinate(float *coords, SurfaceMesh::Halfedge h) const {
-        const auto vs = mesh_->source(h);
-        const auto vt = mesh_->target(h);
-        const vec3 &s = mesh_->position(vs);
-        const vec3 &t = mesh_->position(vt);
-        if (lexicographically_smaller(s, t)) {
-            for (std::size_t j = 0; j < 3; ++j) {
-                coords[j] = s[j];
-                coords[j + 3] = t[j];
-            }
-        } else {
-            for (std::size_t j = 0; j < 3; ++j) {
-                coords[j] = t[j];
-                coords[j + 3] = s[j];
+        // matches the border edges (in parallel with OpenMP if supported) and resolves the conflicts greedily in
+        // the order of the edges. Returns the index pairs of the matched edges.
+        std::vector<std::pair<int, int> >
+        match_border_edges(const std::vector<BorderEdge> &edges, const Box3 &box, float dist_threshold) {
+            std::vector<std::pair<int, int> > result;
+            if (edges.size() < 2)
+                return result;
+
+            // avoid overflow of the cell coordinates for tiny (or zero) thresholds
+            const float cell_size = std::max(dist_threshold, box.diagonal_length() * 1e-7f);
+            const BorderEdgeHash hash(edges, cell_size);
+
+            const float squared_dist_threshold = dist_threshold * dist_threshold;
+            const int num = static_cast<int>(edges.size());
+            std::vector<int> matches(num);
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (int i = 0; i < num; ++i)
+                matches[i] = hash.best_match(i, squared_dist_threshold);
+
+            std::vector<bool> scheduled(num, false);
+            for (int i = 0; i < num; ++i) {
+                const int j = matches[i];
+                if (!scheduled[i] && j >= 0 && !scheduled[j]) {
+                    result.emplace_back(i, j);
+                    scheduled[i] = true;
+                    scheduled[j] = true;
+                }
             }
+            return result;
         }
     }
 
 
-    void SurfaceMeshStitching::borders_in_range(
-            SurfaceMesh::Halfedge h, float squared_dist_threshold,
-            std::vector<SurfaceMesh::Halfedge> &neighbors
-    ) const {
-        ANNcoord ann_p[6];
-        assign_edge_coordinate(ann_p, h);
-
-        std::vector<int> pts_indices(k_for_radius_search_);               // neighbor indices
-        std::vector<float> pts_squared_distances(k_for_radius_search_);     // neighbor (squared) distances
-        const int n = get_tree(tree_)->annkFRSearch(ann_p, squared_dist_threshold, k_for_radius_search_,
-                                                    pts_indices.data(), pts_squared_distances.data());
-
-        const int num = std::min(n, k_for_radius_search_);
-        neighbors.reserve(num);
-        for (int i = 0; i < num; ++i) {
-            auto idx = pts_indices[i];
-            if (border_edges_[idx] != h) {  // exclude it self
-                neighbors.push_back(border_edges_[idx]);
-            }
+    SurfaceMeshStitching::SurfaceMeshStitching(SurfaceMesh *mesh)
+            : mesh_(mesh) {
+        for (auto h : mesh_->halfedges()) {
+            if (mesh_->is_border(h))
+                border_edges_.push_back(h);
         }
     }
 
 
-    float SurfaceMeshStitching::squared_distance(SurfaceMesh::Halfedge h1, SurfaceMesh::Halfedge h2) const {
-        auto s1 = mesh_->source(h1);
-        auto t1 = mesh_->target(h1);
-        auto s2 = mesh_->source(h2);
-        auto t2 = mesh_->target(h2);
-        return std::max(
-                distance2(mesh_->position(s1), mesh_->position(t2)),
-                distance2(mesh_->position(s2), mesh_->position(t1)));
+    SurfaceMeshStitching::~SurfaceMeshStitching() {
     }
 
 
-    SurfaceMesh::Halfedge
-    SurfaceMeshStitching::matched_border(SurfaceMesh::Halfedge h, float squared_dist_threshold) const {
-        std::vector<SurfaceMesh::Halfedge> neighbors;
-        borders_in_range(h, squared_dist_threshold, neighbors);
-
-        float min_sd = squared_dist_threshold;
-        SurfaceMesh::Halfedge best_match;
-
-        for (int i = 0; i < neighbors.size(); ++i) {
-            auto h2 = neighbors[i];
-            float sd = squared_distance(h, h2);
-            if (sd < min_sd) {
-                min_sd = sd;
-                best_match = h2;
-            }
+    std::size_t SurfaceMeshStitching::apply(float dist_threshold) {
+        if (border_edges_.empty()) {
+            LOG(WARNING) << "no border edges can be found for stitching";
+            return 0;
         }
 
-        return best_match;
-    }
-
-
-    void SurfaceMeshStitching::apply(float dist_threshold) {
-        auto scheduled = mesh_->add_halfedge_property<bool>("h::scheduled::SurfaceMeshStitching::apply", false);
-        std::vector<std::pair<SurfaceMesh::Halfedge, SurfaceMesh::Halfedge> > to_stitch;
-
-        const float squared_dist_threshold = dist_threshold * dist_threshold;
-        for (auto h : border_edges_) {
-            if (!scheduled[h]) {
-                auto h2 = matched_border(h, squared_dist_threshold);
-                if (h2.is_valid() && !scheduled[h2]) {
-                    to_stitch.emplace_back(std::make_pair(h, h2));
-                    scheduled[h] = true;
-                    scheduled[h2] = true;
-                }
-            }
+        StopWatch w;
+        std::vector<internal::BorderEdge> edges(border_edges_.size());
+        Box3 box;
+        for (std::size_t i = 0; i < border_edges_.size(); ++i) {
+            const auto h = border_edges_[i];
+            edges[i] = {0, h, mesh_->position(mesh_->source(h)), mesh_->position(mesh_->target(h))};
+            box.grow(edges[i].source);
+            box.grow(edges[i].target);
         }
+        const auto to_stitch = internal::match_border_edges(edges, box, dist_threshold);
+        const double match_time = w.elapsed_seconds(3);
 
+        w.restart();
         std::size_t count = 0;
         if (!to_stitch.empty()) {
             for (const auto &ep : to_stitch) {
-                if (mesh_->is_stitch_ok(ep.first, ep.second)) {
-                    mesh_->stitch(ep.first, ep.second);
+                const auto h0 = border_edges_[ep.first];
+                const auto h1 = border_edges_[ep.second];
+                if (mesh_->is_stitch_ok(h0, h1)) {
+                    mesh_->stitch(h0, h1);
                     ++count;
                 }
             }
             mesh_->collect_garbage();
 
             if (count > 0)
-                LOG(INFO) << count << " (out of " << to_stitch.size() << ") pairs of edges stitched";
+                LOG(INFO) << count << " (out of " << to_stitch.size() << " matched, " << border_edges_.size()
+                          << " border edges) pairs of edges stitched. Matching: " << match_time
+                          << " sec, stitching: " << w.time_string();
             else
                 LOG(WARNING) << "none of the " << to_stitch.size() << " edge pairs can be stitched";
         } else {
             LOG(WARNING) << "no coincident edges can be found for stitching";
         }
 
-        mesh_->remove_halfedge_property(scheduled);
+        // the border edges have changed
+        border_edges_.clear();
+        for (auto h : mesh_->halfedges()) {
+            if (mesh_->is_border(h))
+                border_edges_.push_back(h);
+        }
+        return count;
     }
 
 
+    std::vector<SurfaceMeshStitching::BorderMatch>
+    SurfaceMeshStitching::match_borders(const std::vector<SurfaceMesh *> &meshes, float dist_threshold) {
+        StopWatch w;
+        Box3 box;
+        const auto edges = internal::collect_border_edges(meshes, box);
+        const auto matched = internal::match_border_edges(edges, box, dist_threshold);
+
+        std::vector<BorderMatch> result(matched.size());
+        std::size_t num_across = 0;
+        for (std::size_t i = 0; i < matched.size(); ++i) {
+            const auto &e0 = edges[matched[i].first];
+            const auto &e1 = edges[matched[i].second];
+            result[i] = {e0.mesh, e0.halfedge, e1.mesh, e1.halfedge};
+            if (e0.mesh != e1.mesh)
+                ++num_across;
+        }
+
+        LOG(INFO) << result.size() << " pairs of border edges matched (" << num_across << " across meshes) from "
+                  << edges.size() << " border edges of " << meshes.size() << " meshes. Time: " << w.time_string();
+        return result;
+    }
+
 } // namespace easy3d
@@ -39,6 +39,9 @@ namespace easy3d {
      *
      * \class SurfaceMeshStitching easy3d/algo/surface_mesh_stitching.h
      *
+     * The coincident border edges are found using a spatial hash, which scales to millions of border edges, and
+     * match_borders() works across multiple meshes (e.g., tiles) without merging them.
+     *
      * \deprecated This class only performs stitching, without reversing the orientation of components having
      * coincident but incompatible boundary cycles. It dose the same thing as Surfacer::stitch_borders()
      * To stitch incompatible boundaries please use Surfacer::merge_reversible_connected_components().
@@ -50,40 +53,38 @@ namespace easy3d {
 
         virtual ~SurfaceMeshStitching();
 
-        void apply(float dist_threshold = 1e-6);
-
-    private:
-
-        // given a border halfedge h (its face is nullptr), return the matched border halfedge.
-        //  - if multiple edges match, return the closest one;
-        //  - if could not found, return an invalid halfedge.
-        SurfaceMesh::Halfedge matched_border(SurfaceMesh::Halfedge h, float squared_dist_threshold) const;
-
-        // given a border halfedge, return all border halfedges that are within a distance threshold.
-        void borders_in_range(
-                SurfaceMesh::Halfedge h, float squared_dist_threshold,
-                std::vector<SurfaceMesh::Halfedge> &neighbors
-        ) const;
-
-        // the coordinates of a halfedge: represented by its two end points going from the xyz-lexicographically
-        // smaller endpoint toward the xyz-lexicographically larger end point.
-        void assign_edge_coordinate(float* coords, SurfaceMesh::Halfedge) const;
-
-        bool lexicographically_smaller(const vec3 &p0, const vec3 &p1) const;
-
-        float squared_distance(SurfaceMesh::Halfedge h1, SurfaceMesh::Halfedge h2) const;
+        /**
+         * \brief Stitches the coincident border edges.
+         * \details The border edges are matched using a spatial hash of their end points (in parallel with OpenMP
+         *      if supported). Two border edges match if they have opposite directions and both pairs of their
+         *      corresponding end points are closer than \p dist_threshold. If multiple edges match, the closest one
+         *      is taken.
+         * \return The number of stitched edge pairs.
+         */
+        std::size_t apply(float dist_threshold = 1e-6);
+
+        /// \brief A pair of matched border halfedges, possibly from different meshes.
+        struct BorderMatch {
+            int mesh0;                  ///< The index of the mesh of the first halfedge.
+            SurfaceMesh::Halfedge h0;   ///< The first halfedge.
+            int mesh1;                  ///< The index of the mesh of the second halfedge.
+            SurfaceMesh::Halfedge h1;   ///< The second halfedge.
+        };
+
+        /**
+         * \brief Matches the coincident border edges of multiple meshes, without merging them.
+         * \details This is useful for tiled meshes, e.g., to check or to snap the seams between the tiles. The
+         *      matching criterion is the same as for apply(). Each halfedge appears in at most one match.
+         * \param meshes The meshes.
+         * \param dist_threshold The distance threshold.
+         * \return The matched border halfedge pairs (within the same mesh or across different meshes).
+         */
+        static std::vector<BorderMatch> match_borders(const std::vector<SurfaceMesh*>& meshes, float dist_threshold = 1e-6);
 
     protected:
         SurfaceMesh *mesh_;
 
         std::vector<SurfaceMesh::Halfedge> border_edges_;
-
-        // the coordinates of all the border edges. Each halfedge is represented by its two end points going from the
-        // xyz-lexicographically smaller endpoint toward the xyz-lexicographically larger end point.
-        float **coordinates_;
-
-        void *tree_;
-        int k_for_radius_search_;
     };
 
 } // namespace easy3d
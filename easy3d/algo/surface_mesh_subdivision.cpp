@@ -13,62 +13,111 @@
 #include <easy3d/algo/surface_mesh_subdivision.h>
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/algo/surface_mesh_geometry.h>
+#include <easy3d/util/logging.h>
 
+#include <limits>
 
-namespace easy3d {
-
-    bool SurfaceMeshSubdivision::catmull_clark(SurfaceMesh *mesh) {
-        if (!mesh)
-            return false;
 
-        auto points = mesh->vertex_property<vec3>("v:point");
-        auto vfeature = mesh->get_vertex_property<bool>("v:feature");
-        auto efeature = mesh->get_edge_property<bool>("e:feature");
+namespace easy3d {
 
-        // reserve memory
-        std::size_t nv = mesh->n_vertices();
-        std::size_t ne = mesh->n_edges();
-        std::size_t nf = mesh->n_faces();
-        mesh->reserve(nv + ne + nf, 2 * ne + 4 * nf, 4 * nf);
+    namespace internal {
+
+        // A copy of the connectivity of a mesh before it is refined. The refined connectivity is written into the
+        // same mesh (reusing the indices of the old elements), so the old connectivity must be kept aside.
+        struct Topology {
+            explicit Topology(const SurfaceMesh *mesh) {
+                const int nh = static_cast<int>(mesh->halfedges_size());
+                const int nv = static_cast<int>(mesh->vertices_size());
+                const int nf = static_cast<int>(mesh->faces_size());
+                target.resize(nh);
+                next.resize(nh);
+                face.resize(nh);
+                out.resize(nv);
+                face_halfedge.resize(nf);
+#pragma omp parallel for
+                for (int i = 0; i < nh; ++i) {
+                    const SurfaceMesh::Halfedge h(i);
+                    target[i] = mesh->target(h).idx();
+                    next[i] = mesh->next(h).idx();
+                    face[i] = mesh->face(h).idx();
+                }
+#pragma omp parallel for
+                for (int i = 0; i < nv; ++i)
+                    out[i] = mesh->out_halfedge(SurfaceMesh::Vertex(i)).idx();
+#pragma omp parallel for
+                for (int i = 0; i < nf; ++i)
+                    face_halfedge[i] = mesh->halfedge(SurfaceMesh::Face(i)).idx();
+            }
 
-        // get properties
-        auto vpoint = mesh->add_vertex_property<vec3>("catmull:vpoint");
-        auto epoint = mesh->add_edge_property<vec3>("catmull:epoint");
-        auto fpoint = mesh->add_face_property<vec3>("catmull:fpoint");
+            std::vector<int> target, next, face;    // per halfedge
+            std::vector<int> out;                   // per vertex
+            std::vector<int> face_halfedge;         // per face
+        };
+
+        // An edge e is split at its midpoint into edge e and edge ne + e (ne: the number of edges before splitting).
+        // These give the halves of the old halfedge h: the first one starts at the source of h, and the second one
+        // ends at the target of h.
+        inline int first_half(int h, int ne) { return (h & 1) == 0 ? h : 2 * (ne + (h >> 1)) + 1; }
+        inline int second_half(int h, int ne) { return (h & 1) == 0 ? 2 * (ne + (h >> 1)) : h; }
+
+        // Splits all the edges of the mesh, whose elements have already been resized. The midpoint of edge e is
+        // vertex nv + e. Only the halfedges on the boundary are linked, the others are linked when splitting faces.
+        void split_edges(SurfaceMesh *mesh, const Topology &topo, int nv, int ne) {
+#pragma omp parallel for
+            for (int e = 0; e < ne; ++e) {
+                const SurfaceMesh::Vertex mid(nv + e);
+                for (int h = 2 * e; h <= 2 * e + 1; ++h) {
+                    const SurfaceMesh::Halfedge h0(first_half(h, ne));
+                    const SurfaceMesh::Halfedge h1(second_half(h, ne));
+                    mesh->set_target(h0, mid);
+                    mesh->set_target(h1, SurfaceMesh::Vertex(topo.target[h]));
+                    if (topo.face[h] < 0) { // boundary
+                        mesh->set_face(h0, SurfaceMesh::Face());
+                        mesh->set_face(h1, SurfaceMesh::Face());
+                        mesh->set_next(h0, h1);
+                        mesh->set_next(h1, SurfaceMesh::Halfedge(first_half(topo.next[h], ne)));
+                    }
+                }
+                // the outgoing halfedge of a boundary vertex must be a boundary halfedge
+                int out = second_half(2 * e, ne);
+                if (topo.face[2 * e + 1] < 0)
+                    out = second_half(2 * e + 1, ne);
+                mesh->set_out_halfedge(mid, SurfaceMesh::Halfedge(out));
+            }
 
-        // compute face vertices
-        for (auto f : mesh->faces())
-            fpoint[f] = geom::centroid(mesh, f);
-
-        // compute edge vertices
-        for (auto e : mesh->edges()) {
-            // boundary or feature edge?
-            if (mesh->is_border(e) || (efeature && efeature[e])) {
-                epoint[e] = 0.5f * (points[mesh->vertex(e, 0)] +
-                                    points[mesh->vertex(e, 1)]);
+            // the first half of the outgoing halfedge of an old vertex starts from the vertex
+#pragma omp parallel for
+            for (int v = 0; v < nv; ++v) {
+                if (topo.out[v] >= 0)
+                    mesh->set_out_halfedge(SurfaceMesh::Vertex(v), SurfaceMesh::Halfedge(first_half(topo.out[v], ne)));
             }
+        }
 
-                // interior edge
-            else {
-                vec3 p(0, 0, 0);
-                p += points[mesh->vertex(e, 0)];
-                p += points[mesh->vertex(e, 1)];
-                p += fpoint[mesh->face(e, 0)];
-                p += fpoint[mesh->face(e, 1)];
-                p *= 0.25f;
-                epoint[e] = p;
+        // Links the halfedges of a face.
+        inline void make_face(SurfaceMesh *mesh, int f, const int *halfedges, int n) {
+            const SurfaceMesh::Face face(f);
+            for (int i = 0; i < n; ++i) {
+                const SurfaceMesh::Halfedge h(halfedges[i]);
+                mesh->set_next(h, SurfaceMesh::Halfedge(halfedges[(i + 1) % n]));
+                mesh->set_face(h, face);
             }
+            mesh->set_halfedge(face, SurfaceMesh::Halfedge(halfedges[0]));
         }
 
-        // compute new positions for old vertices
-        for (auto v : mesh->vertices()) {
+        // The new position of an old vertex on the boundary or on a feature curve (common to Loop and Catmull-Clark).
+        // Returns false if the vertex is an ordinary interior vertex.
+        bool boundary_or_feature_point(const SurfaceMesh *mesh, SurfaceMesh::Vertex v,
+                                       const SurfaceMesh::VertexProperty<vec3> &points,
+                                       const SurfaceMesh::VertexProperty<bool> &vfeature,
+                                       const SurfaceMesh::EdgeProperty<bool> &efeature, vec3 &result) {
             // isolated vertex?
             if (mesh->is_isolated(v)) {
-                vpoint[v] = points[v];
+                result = points[v];
+                return true;
             }
 
-                // boundary vertex?
-            else if (mesh->is_border(v)) {
+            // boundary vertex?
+            if (mesh->is_border(v)) {
                 auto h1 = mesh->out_halfedge(v);
                 auto h0 = mesh->prev(h1);
 
@@ -77,12 +126,12 @@ namespace easy3d {
                 p += points[mesh->target(h1)];
                 p += points[mesh->source(h0)];
                 p *= 0.125;
-
-                vpoint[v] = p;
+                result = p;
+                return true;
             }
 
-                // interior feature vertex?
-            else if (vfeature && vfeature[v]) {
+            // interior feature vertex?
+            if (vfeature && vfeature[v]) {
                 vec3 p = points[v];
                 p *= 6.0;
                 int count(0);
@@ -97,230 +146,321 @@ namespace easy3d {
                 if (count == 2) // vertex is on feature edge
                 {
                     p *= 0.125;
-                    vpoint[v] = p;
+                    result = p;
                 } else // keep fixed
                 {
-                    vpoint[v] = points[v];
+                    result = points[v];
                 }
+                return true;
             }
 
-                // interior vertex
-            else {
-                // weights from SIGGRAPH paper "Subdivision Surfaces in Character Animation"
-
-                const auto k = static_cast<float>(mesh->valence(v));
-                vec3 p(0, 0, 0);
-
-                for (auto vv : mesh->vertices(v))
-                    p += points[vv];
-
-                for (auto f : mesh->faces(v))
-                    p += fpoint[f];
-
-                p /= (k * k);
-
-                p += ((k - 2.0f) / k) * points[v];
+            return false;
+        }
 
-                vpoint[v] = p;
+        // Both halves of a split feature edge are feature edges, and so is the midpoint.
+        void split_features(SurfaceMesh *mesh, int nv, int ne) {
+            auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+            auto efeature = mesh->get_edge_property<bool>("e:feature");
+            if (!efeature)
+                return;
+            for (int e = 0; e < ne; ++e) {
+                if (efeature[SurfaceMesh::Edge(e)]) {
+                    efeature[SurfaceMesh::Edge(ne + e)] = true;
+                    if (vfeature)
+                        vfeature[SurfaceMesh::Vertex(nv + e)] = true;
+                }
             }
         }
 
-        // assign new positions to old vertices
-        for (auto v : mesh->vertices()) {
-            points[v] = vpoint[v];
-        }
 
-        // split edges
-        for (auto e : mesh->edges()) {
-            // feature edge?
-            if (efeature && efeature[e]) {
-                auto h = mesh->insert_vertex(e, epoint[e]);
-                auto v = mesh->target(h);
-                auto e0 = mesh->edge(h);
-                auto e1 = mesh->edge(mesh->next(h));
-
-                vfeature[v] = true;
-                efeature[e0] = true;
-                efeature[e1] = true;
-            }
+        void catmull_clark(SurfaceMesh *mesh) {
+            auto points = mesh->vertex_property<vec3>("v:point");
+            auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+            auto efeature = mesh->get_edge_property<bool>("e:feature");
 
-                // normal edge
-            else {
-                mesh->insert_vertex(e, epoint[e]);
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            // compute face vertices
+            std::vector<vec3> fpoint(nf);
+            std::vector<int> offset(nf + 1, 0); // the first of the new faces/inner edges of each face
+#pragma omp parallel for
+            for (int i = 0; i < nf; ++i) {
+                const SurfaceMesh::Face f(i);
+                fpoint[i] = geom::centroid(mesh, f);
+                offset[i + 1] = static_cast<int>(mesh->valence(f));
             }
-        }
+            for (int i = 0; i < nf; ++i)
+                offset[i + 1] += offset[i];
+
+            // compute edge vertices
+            std::vector<vec3> epoint(ne);
+#pragma omp parallel for
+            for (int i = 0; i < ne; ++i) {
+                const SurfaceMesh::Edge e(i);
+                // boundary or feature edge?
+                if (mesh->is_border(e) || (efeature && efeature[e])) {
+                    epoint[i] = 0.5f * (points[mesh->vertex(e, 0)] +
+                                        points[mesh->vertex(e, 1)]);
+                }
 
-        // split faces
-        for (auto f : mesh->faces()) {
-            auto h0 = mesh->halfedge(f);
-            mesh->insert_edge(h0, mesh->next(mesh->next(h0)));
-
-            auto h1 = mesh->next(h0);
-            mesh->insert_vertex(mesh->edge(h1), fpoint[f]);
-
-            auto h =
-                    mesh->next(mesh->next(mesh->next(h1)));
-            while (h != h0) {
-                mesh->insert_edge(h1, h);
-                h = mesh->next(
-                        mesh->next(mesh->next(h1)));
+                    // interior edge
+                else {
+                    vec3 p(0, 0, 0);
+                    p += points[mesh->vertex(e, 0)];
+                    p += points[mesh->vertex(e, 1)];
+                    p += fpoint[mesh->face(e, 0).idx()];
+                    p += fpoint[mesh->face(e, 1).idx()];
+                    p *= 0.25f;
+                    epoint[i] = p;
+                }
             }
-        }
 
-        // clean-up properties
-        mesh->remove_vertex_property(vpoint);
-        mesh->remove_edge_property(epoint);
-        mesh->remove_face_property(fpoint);
+            // compute new positions for old vertices
+            std::vector<vec3> vpoint(nv);
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                if (!boundary_or_feature_point(mesh, v, points, vfeature, efeature, vpoint[i])) {
+                    // interior vertex
+                    // weights from SIGGRAPH paper "Subdivision Surfaces in Character Animation"
 
-        return true;
-    }
+                    const auto k = static_cast<float>(mesh->valence(v));
+                    vec3 p(0, 0, 0);
 
+                    for (auto vv : mesh->vertices(v))
+                        p += points[vv];
 
-    bool SurfaceMeshSubdivision::loop(SurfaceMesh *mesh) {
-        if (!mesh)
-            return false;
+                    for (auto f : mesh->faces(v))
+                        p += fpoint[f.idx()];
 
-        if (!mesh->is_triangle_mesh()) {
-            LOG(WARNING) << "the Loop subdivision method works only for triangle meshes";
-            return false;
-        }
-
-        auto points = mesh->vertex_property<vec3>("v:point");
-        auto vfeature = mesh->get_vertex_property<bool>("v:feature");
-        auto efeature = mesh->get_edge_property<bool>("e:feature");
-
-        // reserve memory
-        std::size_t nv = mesh->n_vertices();
-        std::size_t ne = mesh->n_edges();
-        std::size_t nf = mesh->n_faces();
-        mesh->reserve(nv + ne, 2 * ne + 3 * nf, 4 * nf);
+                    p /= (k * k);
 
-        // add properties
-        auto vpoint = mesh->add_vertex_property<vec3>("loop:vpoint");
-        auto epoint = mesh->add_edge_property<vec3>("loop:epoint");
+                    p += ((k - 2.0f) / k) * points[v];
 
-        // compute vertex positions
-        for (auto v : mesh->vertices()) {
-            // isolated vertex?
-            if (mesh->is_isolated(v)) {
-                vpoint[v] = points[v];
+                    vpoint[i] = p;
+                }
             }
 
-                // boundary vertex?
-            else if (mesh->is_border(v)) {
-                auto h1 = mesh->out_halfedge(v);
-                auto h0 = mesh->prev(h1);
-
-                vec3 p = points[v];
-                p *= 6.0;
-                p += points[mesh->target(h1)];
-                p += points[mesh->source(h0)];
-                p *= 0.125;
-                vpoint[v] = p;
+            // build the refined mesh: each face of degree n is split into n quads around the face point
+            const Topology topo(mesh);
+            const int num_corners = offset[nf];
+            mesh->resize(nv + ne + nf, 2 * ne + num_corners, num_corners);
+
+            points = mesh->vertex_property<vec3>("v:point");
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i)
+                points[SurfaceMesh::Vertex(i)] = vpoint[i];
+#pragma omp parallel for
+            for (int i = 0; i < ne; ++i)
+                points[SurfaceMesh::Vertex(nv + i)] = epoint[i];
+#pragma omp parallel for
+            for (int i = 0; i < nf; ++i)
+                points[SurfaceMesh::Vertex(nv + ne + i)] = fpoint[i];
+
+            split_features(mesh, nv, ne);
+            split_edges(mesh, topo, nv, ne);
+
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f) {
+                const SurfaceMesh::Vertex center(nv + ne + f);
+                // the halfedges from the midpoint of the k-th edge to the face point (and the opposite) are
+                // 2 * (base + k) and 2 * (base + k) + 1
+                const int base = 2 * ne + offset[f];
+                const int n = offset[f + 1] - offset[f];
+                int h = topo.face_halfedge[f];
+                for (int k = 0; k < n; ++k) {
+                    const int next = topo.next[h];
+                    const int to_center = 2 * (base + k);
+                    const int next_to_center = 2 * (base + (k + 1) % n);
+                    mesh->set_target(SurfaceMesh::Halfedge(to_center), center);
+                    mesh->set_target(SurfaceMesh::Halfedge(to_center + 1), SurfaceMesh::Vertex(nv + (h >> 1)));
+
+                    // the quad at the target of h (the first one reuses the index of the old face)
+                    const int quad = (k == 0) ? f : nf + offset[f] - f + k - 1;
+                    const int halfedges[4] = {second_half(h, ne), first_half(next, ne), next_to_center, to_center + 1};
+                    make_face(mesh, quad, halfedges, 4);
+                    h = next;
+                }
+                mesh->set_out_halfedge(center, SurfaceMesh::Halfedge(2 * base + 1));
             }
+        }
 
-                // interior feature vertex?
-            else if (vfeature && vfeature[v]) {
-                vec3 p = points[v];
-                p *= 6.0;
-                int count(0);
 
-                for (auto h : mesh->halfedges(v)) {
-                    if (efeature[mesh->edge(h)]) {
-                        p += points[mesh->target(h)];
-                        ++count;
+        void loop(SurfaceMesh *mesh) {
+            auto points = mesh->vertex_property<vec3>("v:point");
+            auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+            auto efeature = mesh->get_edge_property<bool>("e:feature");
+
+            const int nv = static_cast<int>(mesh->vertices_size());
+            const int ne = static_cast<int>(mesh->edges_size());
+            const int nf = static_cast<int>(mesh->faces_size());
+
+            // compute vertex positions
+            std::vector<vec3> vpoint(nv);
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                if (!boundary_or_feature_point(mesh, v, points, vfeature, efeature, vpoint[i])) {
+                    // interior vertex
+                    vec3 p(0, 0, 0);
+                    float k(0);
+
+                    for (auto vv : mesh->vertices(v)) {
+                        p += points[vv];
+                        ++k;
                     }
-                }
+                    p /= k;
 
-                if (count == 2) // vertex is on feature edge
-                {
-                    p *= 0.125;
-                    vpoint[v] = p;
-                } else // keep fixed
-                {
-                    vpoint[v] = points[v];
+                    auto beta = static_cast<float>(0.625 - std::pow(0.375 + 0.25 * std::cos(2.0 * M_PI / k), 2.0));
+
+                    vpoint[i] = points[v] * (float) (1.0 - beta) + beta * p;
                 }
             }
 
-                // interior vertex
-            else {
-                vec3 p(0, 0, 0);
-                float k(0);
-
-                for (auto vv : mesh->vertices(v)) {
-                    p += points[vv];
-                    ++k;
+            // compute edge positions
+            std::vector<vec3> epoint(ne);
+#pragma omp parallel for
+            for (int i = 0; i < ne; ++i) {
+                const SurfaceMesh::Edge e(i);
+                // boundary or feature edge?
+                if (mesh->is_border(e) || (efeature && efeature[e])) {
+                    epoint[i] =
+                            (points[mesh->vertex(e, 0)] + points[mesh->vertex(e, 1)]) *
+                            float(0.5);
                 }
-                p /= k;
 
-                auto beta = static_cast<float>(0.625 - std::pow(0.375 + 0.25 * std::cos(2.0 * M_PI / k), 2.0));
+                    // interior edge
+                else {
+                    auto h0 = mesh->halfedge(e, 0);
+                    auto h1 = mesh->halfedge(e, 1);
+                    vec3 p = points[mesh->target(h0)];
+                    p += points[mesh->target(h1)];
+                    p *= 3.0;
+                    p += points[mesh->target(mesh->next(h0))];
+                    p += points[mesh->target(mesh->next(h1))];
+                    p *= 0.125;
+                    epoint[i] = p;
+                }
+            }
 
-                vpoint[v] = points[v] * (float) (1.0 - beta) + beta * p;
+            // build the refined mesh: each triangle is split into 4 triangles
+            const Topology topo(mesh);
+            mesh->resize(nv + ne, 2 * ne + 3 * nf, 4 * nf);
+
+            points = mesh->vertex_property<vec3>("v:point");
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i)
+                points[SurfaceMesh::Vertex(i)] = vpoint[i];
+#pragma omp parallel for
+            for (int i = 0; i < ne; ++i)
+                points[SurfaceMesh::Vertex(nv + i)] = epoint[i];
+
+            split_features(mesh, nv, ne);
+            split_edges(mesh, topo, nv, ne);
+
+#pragma omp parallel for
+            for (int f = 0; f < nf; ++f) {
+                const int ha = topo.face_halfedge[f];
+                const int hb = topo.next[ha];
+                const int hc = topo.next[hb];
+                const SurfaceMesh::Vertex ma(nv + (ha >> 1));
+                const SurfaceMesh::Vertex mb(nv + (hb >> 1));
+                const SurfaceMesh::Vertex mc(nv + (hc >> 1));
+
+                // the three inner edges connect the midpoints. Their even halfedges form the center triangle.
+                const int ab = 2 * (2 * ne + 3 * f);
+                const int bc = ab + 2;
+                const int ca = ab + 4;
+                mesh->set_target(SurfaceMesh::Halfedge(ab), mb);
+                mesh->set_target(SurfaceMesh::Halfedge(ab + 1), ma);
+                mesh->set_target(SurfaceMesh::Halfedge(bc), mc);
+                mesh->set_target(SurfaceMesh::Halfedge(bc + 1), mb);
+                mesh->set_target(SurfaceMesh::Halfedge(ca), ma);
+                mesh->set_target(SurfaceMesh::Halfedge(ca + 1), mc);
+
+                // the corner triangles (the first one reuses the index of the old face), and the center triangle
+                const int corner_a[3] = {second_half(ha, ne), first_half(hb, ne), ab + 1};
+                const int corner_b[3] = {second_half(hb, ne), first_half(hc, ne), bc + 1};
+                const int corner_c[3] = {second_half(hc, ne), first_half(ha, ne), ca + 1};
+                const int center[3] = {ab, bc, ca};
+                make_face(mesh, f, corner_a, 3);
+                make_face(mesh, nf + 3 * f, corner_b, 3);
+                make_face(mesh, nf + 3 * f + 1, corner_c, 3);
+                make_face(mesh, nf + 3 * f + 2, center, 3);
             }
         }
 
-        // compute edge positions
-        for (auto e : mesh->edges()) {
-            // boundary or feature edge?
-            if (mesh->is_border(e) || (efeature && efeature[e])) {
-                epoint[e] =
-                        (points[mesh->vertex(e, 0)] + points[mesh->vertex(e, 1)]) *
-                        float(0.5);
-            }
+    } // namespace internal
 
-                // interior edge
-            else {
-                auto h0 = mesh->halfedge(e, 0);
-                auto h1 = mesh->halfedge(e, 1);
-                vec3 p = points[mesh->target(h0)];
-                p += points[mesh->target(h1)];
-                p *= 3.0;
-                p += points[mesh->target(mesh->next(h0))];
-                p += points[mesh->target(mesh->next(h1))];
-                p *= 0.125;
-                epoint[e] = p;
-            }
-        }
 
-        // set new vertex positions
-        for (auto v : mesh->vertices()) {
-            points[v] = vpoint[v];
+    bool SurfaceMeshSubdivision::catmull_clark(SurfaceMesh *mesh, unsigned int levels) {
+        if (!mesh)
+            return false;
+
+        // the refinement works on the indices of the elements
+        if (mesh->has_garbage())
+            mesh->collect_garbage();
+
+        // reserve memory for the final mesh. After the first level, all faces are quads.
+        std::size_t nv = mesh->n_vertices();
+        std::size_t ne = mesh->n_edges();
+        std::size_t nf = mesh->n_faces();
+        std::size_t nc = 0; // the number of face corners (i.e., the number of non-boundary halfedges)
+        for (auto f : mesh->faces())
+            nc += mesh->valence(f);
+        for (unsigned int i = 0; i < levels; ++i) {
+            nv += ne + nf;
+            ne = 2 * ne + nc;
+            nf = nc;
+            nc = 4 * nf;
+        }
+        if (nv > static_cast<std::size_t>(std::numeric_limits<int>::max()) ||
+            2 * ne > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            LOG(ERROR) << "the subdivided mesh would be too large (" << nv << " vertices, " << nf << " faces)";
+            return false;
         }
+        mesh->reserve(static_cast<unsigned int>(nv), static_cast<unsigned int>(ne), static_cast<unsigned int>(nf));
 
-        // insert new vertices on edges
-        for (auto e : mesh->edges()) {
-            // feature edge?
-            if (efeature && efeature[e]) {
-                auto h = mesh->insert_vertex(e, epoint[e]);
-                auto v = mesh->target(h);
-                auto e0 = mesh->edge(h);
-                auto e1 = mesh->edge(mesh->next(h));
-
-                vfeature[v] = true;
-                efeature[e0] = true;
-                efeature[e1] = true;
-            }
+        for (unsigned int i = 0; i < levels; ++i)
+            internal::catmull_clark(mesh);
 
-                // normal edge
-            else {
-                mesh->insert_vertex(e, epoint[e]);
-            }
+        return true;
+    }
+
+
+    bool SurfaceMeshSubdivision::loop(SurfaceMesh *mesh, unsigned int levels) {
+        if (!mesh)
+            return false;
+
+        if (!mesh->is_triangle_mesh()) {
+            LOG(WARNING) << "the Loop subdivision method works only for triangle meshes";
+            return false;
         }
 
-        // split faces
-        SurfaceMesh::Halfedge h;
-        for (auto f : mesh->faces()) {
-            h = mesh->halfedge(f);
-            mesh->insert_edge(h, mesh->next(mesh->next(h)));
-            h = mesh->next(h);
-            mesh->insert_edge(h, mesh->next(mesh->next(h)));
-            h = mesh->next(h);
-            mesh->insert_edge(h, mesh->next(mesh->next(h)));
+        // the refinement works on the indices of the elements
+        if (mesh->has_garbage())
+            mesh->collect_garbage();
+
+        // reserve memory for the final mesh
+        std::size_t nv = mesh->n_vertices();
+        std::size_t ne = mesh->n_edges();
+        std::size_t nf = mesh->n_faces();
+        for (unsigned int i = 0; i < levels; ++i) {
+            nv += ne;
+            ne = 2 * ne + 3 * nf;
+            nf = 4 * nf;
+        }
+        if (nv > static_cast<std::size_t>(std::numeric_limits<int>::max()) ||
+            2 * ne > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            LOG(ERROR) << "the subdivided mesh would be too large (" << nv << " vertices, " << nf << " faces)";
+            return false;
         }
+        mesh->reserve(static_cast<unsigned int>(nv), static_cast<unsigned int>(ne), static_cast<unsigned int>(nf));
 
-        // clean-up properties
-        mesh->remove_vertex_property(vpoint);
-        mesh->remove_edge_property(epoint);
+        for (unsigned int i = 0; i < levels; ++i)
+            internal::loop(mesh);
 
         return true;
     }
@@ -21,11 +21,23 @@ namespace easy3d {
     /// \class SurfaceMeshSubdivision easy3d/algo/surface_mesh_subdivision.h
     class SurfaceMeshSubdivision {
     public:
-        /** \brief The Catmull-Clark subdivision. */
-        static bool catmull_clark(SurfaceMesh *mesh);
-
-        /** \brief The Loop subdivision. */
-        static bool loop(SurfaceMesh *mesh);
+        /**
+         * \brief The Catmull-Clark subdivision.
+         * \details The element counts of the refined mesh are known in advance, so the memory is allocated once and
+         *      the refined connectivity is built directly (and in parallel if OpenMP is available).
+         * \param mesh The mesh to be subdivided.
+         * \param levels The number of subdivision steps.
+         */
+        static bool catmull_clark(SurfaceMesh *mesh, unsigned int levels = 1);
+
+        /**
+         * \brief The Loop subdivision.
+         * \details The element counts of the refined mesh are known in advance, so the memory is allocated once and
+         *      the refined connectivity is built directly (and in parallel if OpenMP is available).
+         * \param mesh The mesh to be subdivided. It must be a triangle mesh.
+         * \param levels The number of subdivision steps.
+         */
+        static bool loop(SurfaceMesh *mesh, unsigned int levels = 1);
 
         /** \brief The sqrt3 subdivision. */
         static bool sqrt3(SurfaceMesh *mesh);
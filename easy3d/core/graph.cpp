@@ -76,6 +76,28 @@ namespace easy3d {
     }
 
 
+    void Graph::swap(Graph& other)
+    {
+        if (this == &other)
+            return;
+
+        // the property handles point to the arrays, which move together with the containers
+        vprops_.swap(other.vprops_);
+        eprops_.swap(other.eprops_);
+        mprops_.swap(other.mprops_);
+
+        std::swap(vconn_, other.vconn_);
+        std::swap(econn_, other.econn_);
+        std::swap(vdeleted_, other.vdeleted_);
+        std::swap(edeleted_, other.edeleted_);
+        std::swap(vpoint_, other.vpoint_);
+
+        std::swap(deleted_vertices_, other.deleted_vertices_);
+        std::swap(deleted_edges_, other.deleted_edges_);
+        std::swap(garbage_, other.garbage_);
+    }
+
+
     //-----------------------------------------------------------------------------
 
 
@@ -1131,6 +1131,92 @@ namespace easy3d {
         return tmp;
     }
 
+    namespace internal {
+
+        // Blocking parameters of the matrix-matrix product. A panel of B (gemm_kc rows by gemm_nc columns) is reused
+        // by all rows of A, and it fits in the L2 cache for double.
+        static const int gemm_kc = 128;
+        static const int gemm_nc = 256;
+
+        /**
+         * Inner product of two arrays. Four independent partial sums break the dependency chain of the additions,
+         * so the loop can be pipelined and vectorized.
+         */
+        template<typename FT>
+        inline FT dot(const FT *a, const FT *b, int n) {
+            FT s0(0), s1(0), s2(0), s3(0);
+            int i = 0;
+            for (; i + 4 <= n; i += 4) {
+                s0 += a[i] * b[i];
+                s1 += a[i + 1] * b[i + 1];
+                s2 += a[i + 2] * b[i + 2];
+                s3 += a[i + 3] * b[i + 3];
+            }
+            for (; i < n; ++i)
+                s0 += a[i] * b[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        /**
+         * C += A * B, where A is M by K, B is K by N, and C is M by N. All matrices are row-major and contiguous,
+         * and C must not overlap with A or B.
+         * The product is computed panel by panel of B. Within a panel, four rows of C are updated at a time, so each
+         * row of the panel is loaded once for four rows of A. The innermost loops run over contiguous memory.
+         */
+        template<typename FT>
+        void gemm(const FT *A, const FT *B, FT *C, int M, int N, int K) {
+            for (int jj = 0; jj < N; jj += gemm_nc) {
+                const int nb = std::min(gemm_nc, N - jj);
+                for (int kk = 0; kk < K; kk += gemm_kc) {
+                    const int kb = std::min(gemm_kc, K - kk);
+                    int i = 0;
+                    for (; i + 4 <= M; i += 4) {
+                        FT *c0 = C + i * N + jj;
+                        FT *c1 = c0 + N;
+                        FT *c2 = c1 + N;
+                        FT *c3 = c2 + N;
+                        const FT *a0 = A + i * K + kk;
+                        const FT *a1 = a0 + K;
+                        const FT *a2 = a1 + K;
+                        const FT *a3 = a2 + K;
+                        for (int k = 0; k < kb; ++k) {
+                            const FT *b = B + (kk + k) * N + jj;
+                            const FT v0 = a0[k], v1 = a1[k], v2 = a2[k], v3 = a3[k];
+                            for (int j = 0; j < nb; ++j) {
+                                const FT bj = b[j];
+                                c0[j] += v0 * bj;
+                                c1[j] += v1 * bj;
+                                c2[j] += v2 * bj;
+                                c3[j] += v3 * bj;
+                            }
+                        }
+                    }
+                    for (; i < M; ++i) {
+                        FT *c = C + i * N + jj;
+                        const FT *a = A + i * K + kk;
+                        for (int k = 0; k < kb; ++k) {
+                            const FT *b = B + (kk + k) * N + jj;
+                            const FT v = a[k];
+                            for (int j = 0; j < nb; ++j)
+                                c[j] += v * b[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * c = A * b, where A is M by N (row-major and contiguous).
+         */
+        template<typename FT>
+        inline void gemv(const FT *A, const FT *b, FT *c, int M, int N) {
+            for (int i = 0; i < M; ++i)
+                c[i] = dot(A + i * N, b, N);
+        }
+
+    } // namespace internal
+
+
     /**
      * This is an optimized version of matrix-matrix multiplication,
      * where the destination matrix has already been allocated.
@@ -1143,23 +1229,16 @@ namespace easy3d {
 
         assert(B.rows() == K);
 
+        if (&C == &A || &C == &B) { // the result would overwrite an operand
+            Matrix<FT> tmp(M, N);
+            internal::gemm(A.data(), B.data(), tmp.data(), M, N, K);
+            C = tmp;
+            return;
+        }
+
         C.resize(M, N);
-        FT sum = 0;
-        const FT *pRow, *pCol;
-
-        for (int i = 0; i < M; i++)
-            for (int j = 0; j < N; ++j) {
-                pRow = &A[i][0];
-                pCol = &B[0][j];
-                sum = 0;
-
-                for (int k = 0; k < K; ++k) {
-                    sum += (*pRow) * (*pCol);
-                    pRow++;
-                    pCol += N;
-                }
-                C[i][j] = sum;
-            }
+        C.load_zero();
+        internal::gemm(A.data(), B.data(), C.data(), M, N, K);
     }
 
 
@@ -1174,22 +1253,15 @@ namespace easy3d {
 
         assert(b.size() == N);
 
-        c.resize(M);
-        FT sum = 0;
-        const FT *pRow, *pCol;
-
-        for (int i = 0; i < M; i++) {
-            pRow = &A[i][0];
-            pCol = &b[0];
-            sum = 0;
-
-            for (int j = 0; j < N; ++j) {
-                sum += (*pRow) * (*pCol);
-                pRow++;
-                pCol++;
-            }
-            c[i] = sum;
+        if (&b == &c) { // the result would overwrite the operand
+            std::vector<FT> tmp(M);
+            internal::gemv(A.data(), b.data(), tmp.data(), M, N);
+            c.swap(tmp);
+            return;
         }
+
+        c.resize(M);
+        internal::gemv(A.data(), b.data(), c.data(), M, N);
     }
 
 
@@ -1206,22 +1278,7 @@ namespace easy3d {
         assert(B.rows() == K);
 
         Matrix<FT> C(M, N);
-        FT sum = 0;
-        const FT *pRow, *pCol;
-
-        for (int i = 0; i < M; i++)
-            for (int j = 0; j < N; ++j) {
-                pRow = &A[i][0];
-                pCol = &B[0][j];
-                sum = 0;
-
-                for (int k = 0; k < K; ++k) {
-                    sum += (*pRow) * (*pCol);
-                    pRow++;
-                    pCol += N;
-                }
-                C[i][j] = sum;
-            }
+        internal::gemm(A.data(), B.data(), C.data(), M, N, K);
         return C;
     }
 
@@ -1238,21 +1295,7 @@ namespace easy3d {
         assert(b.size() == N);
 
         std::vector<FT> c(M);
-        FT sum = 0;
-        const FT *pRow, *pCol;
-
-        for (int i = 0; i < M; i++) {
-            pRow = &A[i][0];
-            pCol = &b[0];
-            sum = 0;
-
-            for (int j = 0; j < N; ++j) {
-                sum += (*pRow) * (*pCol);
-                pRow++;
-                pCol++;
-            }
-            c[i] = sum;
-        }
+        internal::gemv(A.data(), b.data(), c.data(), M, N);
         return c;
     }
 
@@ -1324,11 +1367,18 @@ namespace easy3d {
         int cols = A2.cols();
         int K = A1.rows();
 
+        // accumulate the outer products of the rows of A1 and A2, so the inner loop runs over contiguous memory
         Matrix<FT> tmp(rows, cols);
-        for (int i = 0; i < rows; ++i)
-            for (int j = 0; j < cols; ++j)
-                for (int k = 0; k < K; ++k)
-                    tmp[i][j] += A1[k][i] * A2[k][j];
+        for (int k = 0; k < K; ++k) {
+            const FT *a = A1[k];
+            const FT *b = A2[k];
+            for (int i = 0; i < rows; ++i) {
+                const FT v = a[i];
+                FT *t = tmp[i];
+                for (int j = 0; j < cols; ++j)
+                    t[j] += v * b[j];
+            }
+        }
 
         return tmp;
     }
@@ -1343,9 +1393,12 @@ namespace easy3d {
         int cols = A.cols();
 
         std::vector<FT> tmp(cols);
-        for (int i = 0; i < cols; ++i)
-            for (int j = 0; j < rows; ++j)
-                tmp[i] += A[j][i] * v[j];
+        for (int j = 0; j < rows; ++j) {
+            const FT *a = A[j];
+            const FT s = v[j];
+            for (int i = 0; i < cols; ++i)
+                tmp[i] += a[i] * s;
+        }
 
         return tmp;
     }
@@ -1360,11 +1413,11 @@ namespace easy3d {
         int cols = A2.rows();
         int K = A1.cols();
 
+        // each element is the inner product of two rows
         Matrix<FT> tmp(rows, cols);
         for (int i = 0; i < rows; ++i)
             for (int j = 0; j < cols; ++j)
-                for (int k = 0; k < K; ++k)
-                    tmp[i][j] += A1[i][k] * A2[j][k];
+                tmp[i][j] = internal::dot(A1[i], A2[j], K);
 
         return tmp;
     }
@@ -1394,6 +1447,7 @@ namespace easy3d {
                 tmp[i][j] = random_float();
             }
         }
+        return tmp;
     }
 
     /** Generate an identity matrix. */
@@ -34,15 +34,24 @@
 namespace easy3d {
 
 
-    double determinant(const MATRIX &A) {
-        const int m = A.rows();
-        const int n = A.cols();
-        Eigen::MatrixXd C(m, n);
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < n; ++j)
-                C(i, j) = A(i, j);
+    namespace internal {
+
+        // MATRIX is row-major and contiguous, so Eigen can work on its data directly (without copying).
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrix;
+
+        inline Eigen::Map<const RowMajorMatrix> map(const MATRIX &A) {
+            return Eigen::Map<const RowMajorMatrix>(A.data(), A.rows(), A.cols());
         }
-        return C.determinant();
+
+        inline Eigen::Map<RowMajorMatrix> map(MATRIX &A) {
+            return Eigen::Map<RowMajorMatrix>(A.data(), A.rows(), A.cols());
+        }
+
+    }
+
+
+    double determinant(const MATRIX &A) {
+        return internal::map(A).determinant();
     }
 
 
@@ -54,18 +63,14 @@ namespace easy3d {
             return false;
         }
 
-        Eigen::MatrixXd C(m, n);
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < n; ++j)
-                C(i, j) = A(i, j);
+        if (&invA == &A) {  // in-place
+            const internal::RowMajorMatrix invC = internal::map(A).inverse();
+            internal::map(invA) = invC;
+            return true;
         }
 
         invA.resize(m, n);
-        const Eigen::MatrixXd invC = C.inverse();
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < n; ++j)
-                invA(i, j) = invC(i, j);
-        }
+        internal::map(invA) = internal::map(A).inverse();
         return true;
     }
 
@@ -85,27 +90,17 @@ namespace easy3d {
     void svd_decompose(const MATRIX &A, MATRIX &U, MATRIX &S, MATRIX &V) {
         const int m = A.rows();
         const int n = A.cols();
-        Eigen::MatrixXd C(m, n);
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < n; ++j)
-                C(i, j) = A(i, j);
-        }
 
-        Eigen::JacobiSVD<Eigen::MatrixXd> svd(C, Eigen::ComputeFullU | Eigen::ComputeFullV);
-        const Eigen::MatrixXd &eU = svd.matrixU();
-        const Eigen::MatrixXd &eV = svd.matrixV();
+        Eigen::JacobiSVD<Eigen::MatrixXd> svd(internal::map(A), Eigen::ComputeFullU | Eigen::ComputeFullV);
         const auto &eS = svd.singularValues();
 
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < m; ++j)
-                U(i, j) = eU(i, j);
-        }
+        U.resize(m, m);
+        internal::map(U) = svd.matrixU();
 
-        for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j)
-                V(i, j) = eV(i, j);
-        }
+        V.resize(n, n);
+        internal::map(V) = svd.matrixV();
 
+        S.resize(m, n);
         S.load_zero();
         for (int i = 0; i < std::min(m, n); ++i)
             S(i, i) = eS(i);
@@ -125,15 +120,8 @@ namespace easy3d {
             return false;
         }
 
-        Eigen::MatrixXd M(m, n);
-        for (int i = 0; i < m; ++i) {
-            for (int j = 0; j < n; ++j)
-                M(i, j) = A(i, j);
-        }
-
-        Eigen::VectorXd C(m);
-        for (int i = 0; i < m; ++i)
-            C(i) = b[i];
+        const auto M = internal::map(A);
+        const Eigen::Map<const Eigen::VectorXd> C(b.data(), m);
 
         // https://eigen.tuxfamily.org/dox/group__LeastSquares.html
 #if 0
@@ -153,9 +141,8 @@ namespace easy3d {
 #endif
 
         x.resize(n);
-        for (int i = 0; i < n; ++i)
-            x[i] = X(i);
+        Eigen::Map<Eigen::VectorXd>(x.data(), n) = X;
 
         return true;
     }
-}
\ No newline at end of file
+}
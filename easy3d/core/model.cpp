@@ -25,6 +25,7 @@
  ********************************************************************/
 
 #include <easy3d/core/model.h>
+#include <easy3d/core/property.h>
 #include <easy3d/util/logging.h>
 
 
@@ -33,6 +34,7 @@ namespace easy3d {
     Model::Model(const std::string& name /* = "unknown" */)
             : name_(name)
             , bbox_known_(false)
+            , bbox_version_(0)
             , renderer_(nullptr)
             , manipulator_(nullptr)
     {
@@ -40,6 +42,11 @@ namespace easy3d {
 
 
     const Box3& Model::bounding_box(bool recompute) const {
+        // the known bounding box is outdated if the points have been modified since then
+        const BasePropertyArray* points_array = vertex_property_array("v:point");
+        if (points_array && points_array->version() != bbox_version_)
+            recompute = true;
+
         if (!bbox_known_ || recompute) {
             Box3& box = const_cast<Model*>(this)->bbox_;
             box.clear();
@@ -50,6 +57,7 @@ namespace easy3d {
                 const_cast<Model*>(this)->bbox_known_ = true;
             else
                 LOG(WARNING) << "model has no valid geometry";
+            const_cast<Model*>(this)->bbox_version_ = points_array ? points_array->version() : 0;
         }
         return bbox_;
     }
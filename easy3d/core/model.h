@@ -38,6 +38,7 @@ namespace easy3d {
 
     class Renderer;
     class Manipulator;
+    class BasePropertyArray;
 
     /**
      * \brief The base class of renderable 3D models.
@@ -63,7 +64,8 @@ namespace easy3d {
          * \brief The bounding box of the model.
          * \param recompute If \c true, or if the bounding box is not known, it computes and returns the bounding
          *      box of the model. Otherwise, it returns the known bounding box.
-         * \note Manipulation transformation is not handled.
+         * \note Manipulation transformation is not handled. The known bounding box is automatically re-computed if
+         *      the "v:point" property has been modified (see BasePropertyArray::version()) since its computation.
          * \see invalidate_bounding_box().
          */
         const Box3& bounding_box(bool recompute = false) const;
@@ -82,6 +84,13 @@ namespace easy3d {
         /** \brief Tests if the model is empty. */
         bool empty() const { return points().empty(); };
 
+        /**
+         * \brief The array of the vertex property named \p name, or \c nullptr if it does not exist.
+         * \details This gives generic access to the modification tracking of the vertex properties (see
+         *      BasePropertyArray::version()), e.g., for updating only the modified rendering buffers.
+         */
+        virtual const BasePropertyArray* vertex_property_array(const std::string& name) const { return nullptr; }
+
         /** \brief Prints the names of all properties to an output stream (e.g., std::cout). */
         virtual void property_stats(std::ostream &output) const {}
 
@@ -111,6 +120,7 @@ namespace easy3d {
 
         Box3		bbox_;
         bool		bbox_known_;
+        std::size_t bbox_version_;   // the version of the points when the bounding box was computed
 
         Renderer* renderer_;         // for rendering
         Manipulator* manipulator_;   // for manipulation
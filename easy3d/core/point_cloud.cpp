@@ -67,6 +67,21 @@ namespace easy3d {
     }
 
 
+    void PointCloud::swap(PointCloud& other)
+    {
+        if (this == &other)
+            return;
+
+        // the property handles point to the arrays, which move together with the containers
+        vprops_.swap(other.vprops_);
+        mprops_.swap(other.mprops_);
+        std::swap(vdeleted_, other.vdeleted_);
+        std::swap(vpoint_, other.vpoint_);
+        std::swap(deleted_vertices_, other.deleted_vertices_);
+        std::swap(garbage_, other.garbage_);
+    }
+
+
 	//-----------------------------------------------------------------------------
 
 
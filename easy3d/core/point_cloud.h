@@ -253,6 +253,14 @@ namespace easy3d {
         /// @brief assign \c rhs to \c *this. does not copy custom properties.
         PointCloud& assign(const PointCloud& rhs);
 
+        /**
+         * @brief Exchanges the content (i.e., all properties) of \c *this and \c other in constant time.
+         * @details Unlike the assignment, no data is copied. This allows a worker thread to prepare a new state of
+         *      the model and hand it over cheaply (see Renderer::publish()). The name, renderer, and manipulator of
+         *      the models are not exchanged.
+         */
+        void swap(PointCloud& other);
+
         //@}
 
 
@@ -399,6 +407,11 @@ namespace easy3d {
         {
             return vprops_.get_type(name);
         }
+        /** @brief get the array of vertex property \p name. returns nullptr if the property does not exist. */
+        const BasePropertyArray* vertex_property_array(const std::string& name) const override
+        {
+            return vprops_.get_array(name);
+        }
         /** @brief get the type_info \c T of model property \p name. returns an typeid(void)
         if the property does not exist or if the type does not match. */
         const std::type_info& get_model_property_type(const std::string& name) const
@@ -0,0 +1,371 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/point_projection.h>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EASY3D_PROJECTION_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define EASY3D_PROJECTION_NEON
+#include <arm_neon.h>
+#endif
+
+
+namespace easy3d {
+
+    namespace point_projection {
+
+        namespace details {
+
+            const int block_size = BlockIndex::block_size;
+
+#if defined(EASY3D_PROJECTION_SSE2) || defined(EASY3D_PROJECTION_NEON)
+#define EASY3D_PROJECTION_SIMD
+            // a minimal portable layer for 4-wide float vectors
+#if defined(EASY3D_PROJECTION_SSE2)
+            typedef __m128 float4;
+            inline float4 set1(float v) { return _mm_set1_ps(v); }
+            inline float4 load(const float *p) { return _mm_load_ps(p); }
+            inline void store(float *p, float4 v) { _mm_store_ps(p, v); }
+            inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+            inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+            inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+            inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+            // bit k is set if lo[k] <= v[k] <= hi[k]
+            inline int inside(float4 v, float4 lo, float4 hi) {
+                return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, lo), _mm_cmple_ps(v, hi)));
+            }
+            // bit k is set if a[k] < b[k]
+            inline int less(float4 a, float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+#else
+            typedef float32x4_t float4;
+            inline float4 set1(float v) { return vdupq_n_f32(v); }
+            inline float4 load(const float *p) { return vld1q_f32(p); }
+            inline void store(float *p, float4 v) { vst1q_f32(p, v); }
+            inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+            inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+            inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+            inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+            inline int movemask(uint32x4_t m) {
+                static const int32_t shifts[4] = {0, 1, 2, 3};
+                return static_cast<int>(vaddvq_u32(vshlq_u32(vshrq_n_u32(m, 31), vld1q_s32(shifts))));
+            }
+            inline int inside(float4 v, float4 lo, float4 hi) {
+                return movemask(vandq_u32(vcgeq_f32(v, lo), vcleq_f32(v, hi)));
+            }
+            inline int less(float4 a, float4 b) { return movemask(vcltq_f32(a, b)); }
+#endif
+#endif
+
+            // the projected coordinates of a block of points
+            struct Block {
+                alignas(16) float x[block_size];
+                alignas(16) float y[block_size];
+            };
+
+            inline void project(const float *m, const vec3 &p, float &x, float &y) {
+                x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+                y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+                const float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+                x /= w;
+                y /= w;
+                x = 0.5f * x + 0.5f;
+                y = 0.5f * y + 0.5f;
+            }
+
+            // projects 'num' points. In the vectorized version, the coordinates are padded to a multiple of 4.
+            void project_block(const float *m, const vec3 *points, int num, Block &block, bool vectorized) {
+#ifdef EASY3D_PROJECTION_SIMD
+                if (vectorized) {
+                    // transpose to a structure of arrays
+                    alignas(16) float px[block_size];
+                    alignas(16) float py[block_size];
+                    alignas(16) float pz[block_size];
+                    for (int i = 0; i < num; ++i) {
+                        px[i] = points[i].x;
+                        py[i] = points[i].y;
+                        pz[i] = points[i].z;
+                    }
+                    const int padded = (num + 3) & ~3;
+                    for (int i = num; i < padded; ++i)
+                        px[i] = py[i] = pz[i] = 0.0f;
+
+                    const float4 m0 = set1(m[0]), m1 = set1(m[1]), m3 = set1(m[3]);
+                    const float4 m4 = set1(m[4]), m5 = set1(m[5]), m7 = set1(m[7]);
+                    const float4 m8 = set1(m[8]), m9 = set1(m[9]), m11 = set1(m[11]);
+                    const float4 m12 = set1(m[12]), m13 = set1(m[13]), m15 = set1(m[15]);
+                    const float4 half = set1(0.5f);
+                    for (int i = 0; i < padded; i += 4) {
+                        const float4 X = load(px + i), Y = load(py + i), Z = load(pz + i);
+                        // same order of operations as the scalar version, so the results are identical
+                        const float4 x = add(add(add(mul(m0, X), mul(m4, Y)), mul(m8, Z)), m12);
+                        const float4 y = add(add(add(mul(m1, X), mul(m5, Y)), mul(m9, Z)), m13);
+                        const float4 w = add(add(add(mul(m3, X), mul(m7, Y)), mul(m11, Z)), m15);
+                        store(block.x + i, add(mul(half, div(x, w)), half));
+                        store(block.y + i, add(mul(half, div(y, w)), half));
+                    }
+                    return;
+                }
+#endif
+                for (int i = 0; i < num; ++i)
+                    project(m, points[i], block.x[i], block.y[i]);
+            }
+
+            enum Coverage { OUTSIDE, INSIDE, PARTIAL };
+
+            // classifies the projection of a box against a rectangle. The projection of the box is bounded by the
+            // projection of its corners only if all the corners are in front of the viewer (w > 0).
+            Coverage classify(const float *m, const Box3 &box, const Box2 &rect) {
+                if (!box.is_valid())
+                    return PARTIAL;
+                const vec3 &a = box.min_point();
+                const vec3 &b = box.max_point();
+                Box2 projected;
+                for (int k = 0; k < 8; ++k) {
+                    const vec3 p((k & 1) ? b.x : a.x, (k & 2) ? b.y : a.y, (k & 4) ? b.z : a.z);
+                    const float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+                    if (!(w > 0.0f))
+                        return PARTIAL;
+                    float x, y;
+                    project(m, p, x, y);
+                    projected.grow(vec2(x, y));
+                }
+
+                // a margin for the rounding errors of the projection
+                const float eps = 1e-5f;
+                const vec2 &pmin = projected.min_point();
+                const vec2 &pmax = projected.max_point();
+                const vec2 &rmin = rect.min_point();
+                const vec2 &rmax = rect.max_point();
+                if (pmax.x < rmin.x - eps || pmin.x > rmax.x + eps || pmax.y < rmin.y - eps || pmin.y > rmax.y + eps)
+                    return OUTSIDE;
+                if (pmin.x > rmin.x + eps && pmax.x < rmax.x - eps && pmin.y > rmin.y + eps && pmax.y < rmax.y - eps)
+                    return INSIDE;
+                return PARTIAL;
+            }
+
+            // calls func(i) for each of the 'num' projected points inside the rectangle
+            template<typename FUNC>
+            void for_each_in_rect(const Block &block, int num, const Box2 &rect, bool vectorized, FUNC func) {
+                const float xmin = rect.min_point().x, ymin = rect.min_point().y;
+                const float xmax = rect.max_point().x, ymax = rect.max_point().y;
+#ifdef EASY3D_PROJECTION_SIMD
+                if (vectorized) {
+                    const float4 lo_x = set1(xmin), lo_y = set1(ymin);
+                    const float4 hi_x = set1(xmax), hi_y = set1(ymax);
+                    for (int i = 0; i < num; i += 4) {
+                        int mask = inside(load(block.x + i), lo_x, hi_x) & inside(load(block.y + i), lo_y, hi_y);
+                        if (num - i < 4)
+                            mask &= (1 << (num - i)) - 1;
+                        for (int k = 0; mask; ++k, mask >>= 1) {
+                            if (mask & 1)
+                                func(i + k);
+                        }
+                    }
+                    return;
+                }
+#endif
+                for (int i = 0; i < num; ++i) {
+                    const float x = block.x[i], y = block.y[i];
+                    if (x >= xmin && x <= xmax && y >= ymin && y <= ymax)
+                        func(i);
+                }
+            }
+
+            std::size_t count_selected(const std::vector<bool> &select, std::size_t begin, std::size_t end) {
+                std::size_t count = 0;
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (select[i])
+                        ++count;
+                }
+                return count;
+            }
+
+        } // namespace details
+
+
+        void BlockIndex::build(const vec3 *points, std::size_t n) {
+            const int num_blocks = static_cast<int>((n + block_size - 1) / block_size);
+            boxes_.assign(num_blocks, Box3());
+#pragma omp parallel for
+            for (int b = 0; b < num_blocks; ++b) {
+                const std::size_t begin = static_cast<std::size_t>(b) * block_size;
+                const std::size_t end = std::min(begin + block_size, n);
+                Box3 box;
+                for (std::size_t i = begin; i < end; ++i)
+                    box.grow(points[i]);
+                boxes_[b] = box;
+            }
+            num_points_ = n;
+        }
+
+
+        void BlockIndex::clear() {
+            boxes_.clear();
+            num_points_ = 0;
+        }
+
+
+        std::size_t select_in_rect(const vec3 *points, std::size_t n, const mat4 &m, const Box2 &rect, bool value,
+                                   std::vector<bool> &select, const BlockIndex *index, bool vectorized) {
+            using namespace details;
+            if (select.size() < n)
+                select.resize(n, false);
+
+            const float *e = m;
+            const bool use_index = index && index->num_points() == n;
+            const int num_blocks = static_cast<int>((n + block_size - 1) / block_size);
+
+            // each block is processed by a single thread. The block size is a multiple of 64, so two threads never
+            // write into the same word of the std::vector<bool>.
+            long long count = 0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:count)
+            for (int b = 0; b < num_blocks; ++b) {
+                const std::size_t begin = static_cast<std::size_t>(b) * block_size;
+                const int num = static_cast<int>(std::min<std::size_t>(block_size, n - begin));
+                const Coverage coverage = use_index ? classify(e, index->boxes()[b], rect) : PARTIAL;
+                if (coverage == INSIDE) {
+                    for (int i = 0; i < num; ++i)
+                        select[begin + i] = value;
+                    count += value ? num : 0;
+                    continue;
+                }
+                if (coverage == PARTIAL) {
+                    Block block;
+                    project_block(e, points + begin, num, block, vectorized);
+                    for_each_in_rect(block, num, rect, vectorized, [&](int i) { select[begin + i] = value; });
+                }
+                count += static_cast<long long>(count_selected(select, begin, begin + num));
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+
+        std::size_t select_in_polygon(const vec3 *points, std::size_t n, const mat4 &m,
+                                      const std::vector<vec2> &polygon, bool value, std::vector<bool> &select,
+                                      const BlockIndex *index, bool vectorized) {
+            using namespace details;
+            if (select.size() < n)
+                select.resize(n, false);
+            if (polygon.size() < 3)
+                return count_selected(select, 0, n);
+
+            Box2 bbox;
+            for (const auto &p : polygon)
+                bbox.grow(p);
+
+            const float *e = m;
+            const bool use_index = index && index->num_points() == n;
+            const int num_blocks = static_cast<int>((n + block_size - 1) / block_size);
+
+            long long count = 0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:count)
+            for (int b = 0; b < num_blocks; ++b) {
+                const std::size_t begin = static_cast<std::size_t>(b) * block_size;
+                const int num = static_cast<int>(std::min<std::size_t>(block_size, n - begin));
+                // a block inside the bounding box of the polygon is not necessarily inside the polygon
+                const Coverage coverage = use_index ? classify(e, index->boxes()[b], bbox) : PARTIAL;
+                if (coverage != OUTSIDE) {
+                    Block block;
+                    project_block(e, points + begin, num, block, vectorized);
+                    for_each_in_rect(block, num, bbox, vectorized, [&](int i) {
+                        if (geom::point_in_polygon(vec2(block.x[i], block.y[i]), polygon))
+                            select[begin + i] = value;
+                    });
+                }
+                count += static_cast<long long>(count_selected(select, begin, begin + num));
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+
+        int pick_nearest(const vec3 *points, std::size_t n, const mat4 &m, const vec2 &center, const vec2 &scale,
+                         float radius, const vec3 &viewer, const BlockIndex *index, bool vectorized) {
+            using namespace details;
+            if (scale.x <= 0.0f || scale.y <= 0.0f)
+                return -1;
+
+            const float *e = m;
+            const bool use_index = index && index->num_points() == n;
+            const int num_blocks = static_cast<int>((n + block_size - 1) / block_size);
+            const float sqr_radius = radius * radius;
+            // the square enclosing the circle, used to reject blocks and as a first test of the points
+            const vec2 extent(radius / scale.x, radius / scale.y);
+            Box2 square;
+            square.grow(center - extent);
+            square.grow(center + extent);
+
+            int best_index = -1;
+            float best_dist = std::numeric_limits<float>::max();
+#pragma omp parallel
+            {
+                // the nearest point found by this thread
+                int local_index = -1;
+                float local_dist = std::numeric_limits<float>::max();
+
+#pragma omp for schedule(dynamic, 16)
+                for (int b = 0; b < num_blocks; ++b) {
+                    const std::size_t begin = static_cast<std::size_t>(b) * block_size;
+                    const int num = static_cast<int>(std::min<std::size_t>(block_size, n - begin));
+                    if (use_index && classify(e, index->boxes()[b], square) == OUTSIDE)
+                        continue;
+
+                    Block block;
+                    project_block(e, points + begin, num, block, vectorized);
+                    for_each_in_rect(block, num, square, vectorized, [&](int i) {
+                        const float dx = (block.x[i] - center.x) * scale.x;
+                        const float dy = (block.y[i] - center.y) * scale.y;
+                        if (dx * dx + dy * dy < sqr_radius) {
+                            const int idx = static_cast<int>(begin) + i;
+                            const float dist = distance2(points[idx], viewer);
+                            // ties are broken by the index, so the result does not depend on the scheduling
+                            if (dist < local_dist || (dist == local_dist && idx < local_index)) {
+                                local_dist = dist;
+                                local_index = idx;
+                            }
+                        }
+                    });
+                }
+
+#pragma omp critical
+                {
+                    if (local_index >= 0 &&
+                        (local_dist < best_dist || (local_dist == best_dist && local_index < best_index) || best_index < 0)) {
+                        best_dist = local_dist;
+                        best_index = local_index;
+                    }
+                }
+            }
+            return best_index;
+        }
+
+    } // namespace point_projection
+
+} // namespace easy3d
@@ -0,0 +1,127 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_POINT_PROJECTION_H
+#define EASY3D_CORE_POINT_PROJECTION_H
+
+#include <cstddef>
+#include <vector>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Kernels projecting large numbers of points onto the screen, e.g., for selecting points using a
+     *      rectangle or a lasso, or for picking the point under the mouse.
+     * \details A point \c p is projected by the combined matrix \c m (e.g., MVP * MANIP) into normalized screen
+     *      coordinates in [0, 1] (y pointing up):
+     *      \code
+     *          x = 0.5 * (m * p).x / (m * p).w + 0.5
+     *          y = 0.5 * (m * p).y / (m * p).w + 0.5
+     *      \endcode
+     *      The points are processed in blocks of BlockIndex::block_size consecutive points, which are distributed
+     *      over the threads (if OpenMP is available). Within a block, the points are transposed into a
+     *      structure-of-arrays and projected four at a time using SSE2 or NEON (if available). A BlockIndex can be
+     *      provided to reject (or accept) whole blocks whose bounding box is projected outside (or inside) the
+     *      region. All kernels have a scalar implementation (\p vectorized = false), which gives the same results
+     *      and serves as the reference.
+     * \namespace easy3d::point_projection
+     */
+    namespace point_projection {
+
+        /**
+         * \brief A coarse spatial index storing the bounding box of each block of consecutive points.
+         * \details The index is effective if consecutive points are spatially coherent, which is the case for most
+         *      scanned data (e.g., points stored in scan order or sorted along a space-filling curve). For randomly
+         *      ordered points, the boxes are large and few blocks can be rejected, but the results are still correct.
+         */
+        class BlockIndex {
+        public:
+            /// The number of points in a block (a multiple of 64, so threads never write to the same word of a
+            /// std::vector<bool>).
+            static const int block_size = 1024;
+
+            /// Builds the index for \p n points.
+            void build(const vec3 *points, std::size_t n);
+            /// Clears the index.
+            void clear();
+            /// Returns the number of points the index was built for.
+            std::size_t num_points() const { return num_points_; }
+            /// Returns the bounding boxes of the blocks.
+            const std::vector<Box3> &boxes() const { return boxes_; }
+
+        private:
+            std::vector<Box3> boxes_;
+            std::size_t num_points_ = 0;
+        };
+
+        /**
+         * \brief Marks the points projected into a rectangle.
+         * \param points The points.
+         * \param n The number of points.
+         * \param m The combined transformation (e.g., MVP * MANIP).
+         * \param rect The rectangle in normalized screen coordinates.
+         * \param value The value assigned to the points inside the rectangle (i.e., \c false for deselection).
+         * \param select The selection status of the points (of size \p n).
+         * \param index An optional spatial index built for the same points.
+         * \param vectorized \c false to use the scalar implementation.
+         * \return The number of selected points (i.e., the number of \c true values in \p select) after the
+         *      operation.
+         */
+        std::size_t select_in_rect(const vec3 *points, std::size_t n, const mat4 &m, const Box2 &rect, bool value,
+                                   std::vector<bool> &select, const BlockIndex *index = nullptr,
+                                   bool vectorized = true);
+
+        /**
+         * \brief Marks the points projected into a polygon (e.g., a lasso).
+         * \param polygon The polygon in normalized screen coordinates. See select_in_rect() for the other parameters.
+         * \return The number of selected points after the operation.
+         */
+        std::size_t select_in_polygon(const vec3 *points, std::size_t n, const mat4 &m,
+                                      const std::vector<vec2> &polygon, bool value, std::vector<bool> &select,
+                                      const BlockIndex *index = nullptr, bool vectorized = true);
+
+        /**
+         * \brief Finds the point that is projected close to a screen location and nearest to the viewer.
+         * \param center The screen location in normalized screen coordinates.
+         * \param scale The size of the screen (in pixels), which converts normalized distances into pixels.
+         * \param radius The maximum distance (in pixels) of the projected point to \p center.
+         * \param viewer The point on the near plane, the distance to which decides the nearest point.
+         * \return The index of the point, or -1 if no point is projected within \p radius. See select_in_rect() for
+         *      the other parameters.
+         */
+        int pick_nearest(const vec3 *points, std::size_t n, const mat4 &m, const vec2 &center, const vec2 &scale,
+                         float radius, const vec3 &viewer, const BlockIndex *index = nullptr,
+                         bool vectorized = true);
+
+    } // namespace point_projection
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_CORE_POINT_PROJECTION_H
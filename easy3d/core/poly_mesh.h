@@ -1039,6 +1039,11 @@ namespace easy3d {
         {
             return vprops_.get_type(name);
         }
+        /** get the array of vertex property \p name. returns nullptr if the property does not exist. */
+        const BasePropertyArray* vertex_property_array(const std::string& name) const override
+        {
+            return vprops_.get_array(name);
+        }
         /** get the type_info \c T of edge property \p name. returns an typeid(void)
          if the property does not exist or if the type does not match. */
         const std::type_info& get_edge_property_type(const std::string& name) const
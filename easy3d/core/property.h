@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <typeinfo>
 #include <cassert>
+#include <atomic>
 
 
 namespace easy3d {
@@ -42,7 +43,9 @@ namespace easy3d {
     public:
 
         /// Default constructor
-        explicit BasePropertyArray(const std::string& name) : name_(name) {}
+        explicit BasePropertyArray(const std::string& name)
+            : name_(name), version_(next_version()), range_version_(version_), range_begin_(0), range_end_(0)
+            , pending_begin_(0), pending_end_(0), modified_(false), reset_range_(false) {}
 
         /// Destructor.
         virtual ~BasePropertyArray() = default;
@@ -95,9 +98,115 @@ namespace easy3d {
             return (name() == other.name() && type() == other.type());
         }
 
+        /// \name Modification tracking
+        /// @{
+
+        /**
+         * \brief The version of the property, which changes whenever the property is modified.
+         * \details Versions are unique across all property arrays, so a consumer (e.g., a drawable) can tell if a
+         *      property has changed by comparing its version with the one it saw last time. Structural changes (e.g.,
+         *      resize(), push_back(), swap()) are tracked automatically. Modifications of the elements through
+         *      operator[] or vector() must be announced by calling notify_modified().
+         * \note A modification only marks the property as modified, and the new version is drawn from the global
+         *      counter at the next query. So a bulk operation (e.g., adding a million vertices) costs a single
+         *      version. Like the elements, the version must not be queried while the property is being modified.
+         *      The modified range (see modified_range()) is kept only for the step from the previous version to the
+         *      new one, so it does not grow with the modifications of subsequent versions.
+         */
+        std::size_t version() const
+        {
+            if (modified_) {
+                const std::size_t previous = version_;
+                version_ = next_version();
+                if (reset_range_) {
+                    range_version_ = version_;
+                    range_begin_ = range_end_ = 0;
+                }
+                else {
+                    range_version_ = previous;
+                    range_begin_ = pending_begin_;
+                    range_end_ = pending_end_;
+                }
+                pending_begin_ = pending_end_ = 0;
+                modified_ = reset_range_ = false;
+            }
+            return version_;
+        }
+
+        /// Announces that (potentially) all elements have been modified.
+        void notify_modified()
+        {
+            modified_ = true;
+            reset_range_ = true;
+            pending_begin_ = pending_end_ = 0;
+        }
+
+        /// Announces that the elements in the range [\p begin, \p end) have been modified.
+        void notify_modified(std::size_t begin, std::size_t end)
+        {
+            if (begin >= end)
+                return;
+            if (reset_range_)
+                return;
+            if (pending_begin_ == pending_end_) {
+                pending_begin_ = begin;
+                pending_end_ = end;
+            }
+            else {
+                pending_begin_ = std::min(pending_begin_, begin);
+                pending_end_ = std::max(pending_end_, end);
+            }
+            modified_ = true;
+        }
+
+        /**
+         * \brief Queries the elements that have been modified since a given version.
+         * \param since The version at which the consumer last saw the property.
+         * \param begin Returns the first modified element.
+         * \param end Returns one past the last modified element (\p begin == \p end if nothing has changed).
+         * \return \c false if the modified elements are not known (e.g., the property has been resized since
+         *      \p since, or \p since is older than the previous version), in which case all elements should be
+         *      considered modified.
+         */
+        bool modified_range(std::size_t since, std::size_t& begin, std::size_t& end) const
+        {
+            if (since == version()) {
+                begin = end = 0;
+                return true;
+            }
+            if (since != range_version_)
+                return false;
+            begin = range_begin_;
+            end = range_end_;
+            return true;
+        }
+
+        /// @}
+
+    protected:
+        static std::size_t next_version()
+        {
+            static std::atomic<std::size_t> counter(0);
+            return ++counter;
+        }
+
     protected:
 
         std::string name_;
+
+        // the versions are assigned lazily (see version()), thus mutable
+        mutable std::size_t version_;
+        // the modifications from range_version_ (the previous version) to version_ lie in [range_begin_, range_end_)
+        mutable std::size_t range_version_;
+        mutable std::size_t range_begin_;
+        mutable std::size_t range_end_;
+        // the modifications since version_ was assigned lie in [pending_begin_, pending_end_)
+        mutable std::size_t pending_begin_;
+        mutable std::size_t pending_end_;
+        // modified since version_ was assigned
+        mutable bool modified_;
+        // all elements have been modified since version_ was assigned, i.e., range_version_ moves to the new version
+        mutable bool reset_range_;
     };
 
 
@@ -129,16 +238,19 @@ namespace easy3d {
         void resize(size_t n) override
         {
             data_.resize(n, value_);
+            notify_modified();
         }
 
         void push_back() override
         {
             data_.push_back(value_);
+            notify_modified();
         }
 
         void reset(size_t idx) override
         {
             data_[idx] = value_;
+            notify_modified(idx, idx + 1);
         }
 
         bool transfer(const BasePropertyArray& other) override
@@ -146,6 +258,7 @@ namespace easy3d {
             const auto pa = dynamic_cast<const PropertyArray*>(&other);
             if(pa != nullptr){
                 std::copy((*pa).data_.begin(), (*pa).data_.end(), data_.end()-(*pa).data_.size());
+                notify_modified();
                 return true;
             }
             return false;
@@ -157,6 +270,7 @@ namespace easy3d {
             if (pa != nullptr)
             {
                 data_[to] = (*pa)[from];
+                notify_modified(to, to + 1);
                 return true;
             }
 
@@ -173,11 +287,13 @@ namespace easy3d {
             T d(data_[i0]);
             data_[i0]=data_[i1];
             data_[i1]=d;
+            notify_modified(std::min(i0, i1), std::max(i0, i1) + 1);
         }
 
         void copy(size_t from, size_t to) override
         {
             data_[to]=data_[from];
+            notify_modified(to, to + 1);
         }
 
         BasePropertyArray* clone() const override
@@ -211,6 +327,12 @@ namespace easy3d {
             return data_;
         }
 
+        /// Get const reference to the underlying vector
+        const std::vector<T>& vector() const
+        {
+            return data_;
+        }
+
 
         /// Access the i'th element. No range check is performed!
         reference operator[](size_t _idx)
@@ -326,6 +448,24 @@ namespace easy3d {
             parray_->set_name(n);
         }
 
+        /// The version of the property. \sa BasePropertyArray::version()
+        std::size_t version() const {
+            assert(parray_ != nullptr);
+            return parray_->version();
+        }
+
+        /// Announces that (potentially) all elements have been modified.
+        void notify_modified() {
+            assert(parray_ != nullptr);
+            parray_->notify_modified();
+        }
+
+        /// Announces that the elements in the range [\p begin, \p end) have been modified.
+        void notify_modified(std::size_t begin, std::size_t end) {
+            assert(parray_ != nullptr);
+            parray_->notify_modified(begin, end);
+        }
+
     private:
         PropertyArray<T>* parray_;
     };
@@ -465,6 +605,16 @@ namespace easy3d {
         }
 
 
+        // get the property array by its name. returns nullptr if it does not exist.
+        const BasePropertyArray* get_array(const std::string& name) const
+        {
+            for(auto pa : parrays_)
+                if (pa->name() == name)
+                    return pa;
+            return nullptr;
+        }
+
+
         // get the type of property by its name. returns typeid(void) if it does not exist.
         const std::type_info& get_type(const std::string& name) const
         {
@@ -0,0 +1,255 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/quantization.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EASY3D_QUANTIZATION_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace easy3d {
+
+    namespace quantization {
+
+        void quantize_positions(const vec3 *points, std::size_t n, const Box3 &box, unsigned short *result) {
+            const vec3 &origin = box.min_point();
+            const vec3 extent = box.max_point() - box.min_point();
+            float inv[3];
+            for (int a = 0; a < 3; ++a)
+                inv[a] = extent[a] > 0.0f ? 65535.0f / extent[a] : 0.0f;
+
+            std::size_t i = 0;
+#ifdef EASY3D_QUANTIZATION_SSE2
+            const __m128 vmin = _mm_setr_ps(origin.x, origin.y, origin.z, 0.0f);
+            const __m128 vinv = _mm_setr_ps(inv[0], inv[1], inv[2], 0.0f);   // the 4th component becomes 0
+            const __m128 vzero = _mm_setzero_ps();
+            const __m128 vmax = _mm_set1_ps(65535.0f);
+            const __m128i bias = _mm_set1_epi32(32768);
+            const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+            // 4 floats are loaded for each point, so the last point is left to the scalar code below
+            for (; i + 1 < n; ++i) {
+                __m128 p = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(points[i].data()), vmin), vinv);
+                p = _mm_min_ps(_mm_max_ps(p, vzero), vmax);
+                // there is no unsigned saturation from 32 to 16 bits in SSE2: shift to the signed range and back
+                const __m128i q = _mm_sub_epi32(_mm_cvtps_epi32(p), bias);
+                const __m128i packed = _mm_xor_si128(_mm_packs_epi32(q, q), sign);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(result + 4 * i), packed);
+            }
+#endif
+            for (; i < n; ++i) {
+                for (int a = 0; a < 3; ++a) {
+                    const float v = std::min(std::max((points[i][a] - origin[a]) * inv[a], 0.0f), 65535.0f);
+                    result[4 * i + a] = static_cast<unsigned short>(std::nearbyint(v));
+                }
+                result[4 * i + 3] = 0;
+            }
+        }
+
+
+        vec3 dequantize_position(const unsigned short *value, const Box3 &box) {
+            const vec3 extent = box.max_point() - box.min_point();
+            return box.min_point() + vec3(value[0] / 65535.0f * extent.x,
+                                          value[1] / 65535.0f * extent.y,
+                                          value[2] / 65535.0f * extent.z);
+        }
+
+
+        void encode_normals(const vec3 *normals, std::size_t n, short *result) {
+            std::size_t i = 0;
+#ifdef EASY3D_QUANTIZATION_SSE2
+            // four normals at a time, with the same operations (thus the same results) as the scalar code below
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 minus_one = _mm_set1_ps(-1.0f);
+            const __m128 scale = _mm_set1_ps(32767.0f);
+            const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            for (; i + 4 <= n; i += 4) {
+                const vec3 *v = normals + i;
+                const __m128 x = _mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x);
+                const __m128 y = _mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y);
+                const __m128 z = _mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z);
+                const __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, abs_mask), _mm_and_ps(y, abs_mask)),
+                                             _mm_and_ps(z, abs_mask));
+                const __m128 valid = _mm_cmpgt_ps(l1, zero);  // false for zero vectors and NaN
+                __m128 u = _mm_and_ps(_mm_div_ps(x, l1), valid);
+                __m128 w = _mm_and_ps(_mm_div_ps(y, l1), valid);
+
+                // fold the lower hemisphere over the diagonals
+                const __m128 su = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(u, zero), one),
+                                            _mm_andnot_ps(_mm_cmpge_ps(u, zero), minus_one));
+                const __m128 sw = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(w, zero), one),
+                                            _mm_andnot_ps(_mm_cmpge_ps(w, zero), minus_one));
+                const __m128 fu = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(w, abs_mask)), su);
+                const __m128 fw = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(u, abs_mask)), sw);
+                const __m128 lower = _mm_and_ps(_mm_cmplt_ps(z, zero), valid);
+                u = _mm_or_ps(_mm_and_ps(lower, fu), _mm_andnot_ps(lower, u));
+                w = _mm_or_ps(_mm_and_ps(lower, fw), _mm_andnot_ps(lower, w));
+
+                // clamp, scale, and round to nearest (even), as std::nearbyint() in the default rounding mode
+                u = _mm_mul_ps(_mm_min_ps(_mm_max_ps(u, minus_one), one), scale);
+                w = _mm_mul_ps(_mm_min_ps(_mm_max_ps(w, minus_one), one), scale);
+                const __m128i qu = _mm_cvtps_epi32(u);
+                const __m128i qw = _mm_cvtps_epi32(w);
+                // interleave to (u0, w0, u1, w1, ...) and pack to 16 bits (the values are in [-32767, 32767])
+                const __m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(qu, qw), _mm_unpackhi_epi32(qu, qw));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(result + 2 * i), packed);
+            }
+#endif
+            for (; i < n; ++i) {
+                const vec3 &v = normals[i];
+                const float l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+                float u = 0.0f, w = 0.0f;
+                if (l1 > 0.0f) {
+                    u = v.x / l1;
+                    w = v.y / l1;
+                    if (v.z < 0.0f) {   // fold the lower hemisphere over the diagonals
+                        const float fu = (1.0f - std::abs(w)) * (u >= 0.0f ? 1.0f : -1.0f);
+                        const float fw = (1.0f - std::abs(u)) * (w >= 0.0f ? 1.0f : -1.0f);
+                        u = fu;
+                        w = fw;
+                    }
+                }
+                result[2 * i] = static_cast<short>(std::nearbyint(std::min(std::max(u, -1.0f), 1.0f) * 32767.0f));
+                result[2 * i + 1] = static_cast<short>(std::nearbyint(std::min(std::max(w, -1.0f), 1.0f) * 32767.0f));
+            }
+        }
+
+
+        vec3 decode_normal(const short *value) {
+            const float u = std::max(value[0] / 32767.0f, -1.0f);
+            const float w = std::max(value[1] / 32767.0f, -1.0f);
+            vec3 v(u, w, 1.0f - std::abs(u) - std::abs(w));
+            if (v.z < 0.0f) {
+                v.x = (1.0f - std::abs(w)) * (u >= 0.0f ? 1.0f : -1.0f);
+                v.y = (1.0f - std::abs(u)) * (w >= 0.0f ? 1.0f : -1.0f);
+            }
+            return normalize(v);
+        }
+
+
+        void pack_colors(const vec3 *colors, std::size_t n, unsigned char *result) {
+            std::size_t i = 0;
+#ifdef EASY3D_QUANTIZATION_SSE2
+            const __m128 v255 = _mm_set1_ps(255.0f);
+            for (; i + 1 < n; ++i) {
+                const __m128i q = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(colors[i].data()), v255));
+                // saturating packs clamp the values to [0, 255]
+                const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(q, q), _mm_setzero_si128());
+                const unsigned int rgb = static_cast<unsigned int>(_mm_cvtsi128_si32(bytes));
+                std::memcpy(result + 4 * i, &rgb, 3);
+                result[4 * i + 3] = 255;
+            }
+#endif
+            for (; i < n; ++i) {
+                for (int a = 0; a < 3; ++a) {
+                    const float v = std::min(std::max(colors[i][a] * 255.0f, 0.0f), 255.0f);
+                    result[4 * i + a] = static_cast<unsigned char>(std::nearbyint(v));
+                }
+                result[4 * i + 3] = 255;
+            }
+        }
+
+
+        void pack_texcoords(const vec2 *texcoords, std::size_t n, unsigned short *result) {
+            for (std::size_t i = 0; i < n; ++i) {
+                result[2 * i] = float_to_half(texcoords[i].x);
+                result[2 * i + 1] = float_to_half(texcoords[i].y);
+            }
+        }
+
+
+        unsigned short float_to_half(float value) {
+            unsigned int f;
+            std::memcpy(&f, &value, sizeof(float));
+            const unsigned int sign = (f >> 16) & 0x8000u;
+            const unsigned int exponent = (f >> 23) & 0xffu;
+            unsigned int mantissa = f & 0x7fffffu;
+
+            if (exponent == 0xff)   // infinity or NaN
+                return static_cast<unsigned short>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+
+            const int e = static_cast<int>(exponent) - 127 + 15;
+            if (e >= 31)            // too large: infinity
+                return static_cast<unsigned short>(sign | 0x7c00u);
+
+            if (e <= 0) {           // subnormal half (or zero)
+                if (e < -10)
+                    return static_cast<unsigned short>(sign);
+                mantissa |= 0x800000u;
+                const unsigned int shift = static_cast<unsigned int>(14 - e);
+                unsigned int half = mantissa >> shift;
+                const unsigned int remainder = mantissa & ((1u << shift) - 1u);
+                const unsigned int halfway = 1u << (shift - 1u);
+                if (remainder > halfway || (remainder == halfway && (half & 1u)))
+                    ++half;
+                return static_cast<unsigned short>(sign | half);
+            }
+
+            unsigned int half = (static_cast<unsigned int>(e) << 10) | (mantissa >> 13);
+            const unsigned int remainder = mantissa & 0x1fffu;
+            if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+                ++half;     // a carry into the exponent is still correct (up to infinity)
+            return static_cast<unsigned short>(sign | half);
+        }
+
+
+        float half_to_float(unsigned short value) {
+            const unsigned int sign = (static_cast<unsigned int>(value) & 0x8000u) << 16;
+            unsigned int exponent = (value >> 10) & 0x1fu;
+            unsigned int mantissa = value & 0x3ffu;
+
+            unsigned int f;
+            if (exponent == 0) {
+                if (mantissa == 0)
+                    f = sign;
+                else {              // subnormal: normalize it
+                    exponent = 127 - 15 + 1;
+                    while (!(mantissa & 0x400u)) {
+                        mantissa <<= 1;
+                        --exponent;
+                    }
+                    f = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+                }
+            }
+            else if (exponent == 31)
+                f = sign | 0x7f800000u | (mantissa << 13);
+            else
+                f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+            float result;
+            std::memcpy(&result, &f, sizeof(float));
+            return result;
+        }
+
+    }
+
+}
@@ -0,0 +1,77 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_QUANTIZATION_H
+#define EASY3D_CORE_QUANTIZATION_H
+
+#include <cstddef>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Compact encodings of vertex attributes for rendering.
+     * \details The encoded values match the formats OpenGL can normalize when fetching vertex attributes:
+     *  - positions: 16-bit unsigned integers relative to a box (GL_UNSIGNED_SHORT, normalized), 4 per point (the
+     *    4th is always 0, for 8-byte alignment). Decoded by \c box.min + value * \c box.extent;
+     *  - normals: octahedral encoding into 2 signed 16-bit integers (GL_SHORT, normalized);
+     *  - colors: 8-bit RGBA (GL_UNSIGNED_BYTE, normalized), alpha being 255;
+     *  - texture coordinates: half-precision floats (GL_HALF_FLOAT).
+     * The encoding functions take arrays. Positions, normals, and colors are encoded using SSE2 where it is
+     * available; texture coordinates are always converted by the scalar float_to_half().
+     * \namespace easy3d::quantization
+     */
+    namespace quantization {
+
+        /// Quantizes \p n points into 16-bit values relative to \p box. \p result must have room for 4 * n values.
+        void quantize_positions(const vec3 *points, std::size_t n, const Box3 &box, unsigned short *result);
+        /// Decodes a point quantized by quantize_positions().
+        vec3 dequantize_position(const unsigned short *value, const Box3 &box);
+
+        /// Encodes \p n unit vectors using the octahedral mapping. \p result must have room for 2 * n values.
+        void encode_normals(const vec3 *normals, std::size_t n, short *result);
+        /// Decodes a normal encoded by encode_normals().
+        vec3 decode_normal(const short *value);
+
+        /// Packs \p n colors (in [0, 1]) into 8-bit RGBA values. \p result must have room for 4 * n values.
+        void pack_colors(const vec3 *colors, std::size_t n, unsigned char *result);
+
+        /// Converts \p n texture coordinates into half-precision floats. \p result must have room for 2 * n values.
+        void pack_texcoords(const vec2 *texcoords, std::size_t n, unsigned short *result);
+
+        /// Converts a float into a half-precision float (rounded to nearest even).
+        unsigned short float_to_half(float value);
+        /// Converts a half-precision float into a float.
+        float half_to_float(unsigned short value);
+
+    }
+
+}
+
+
+#endif  // EASY3D_CORE_QUANTIZATION_H
@@ -29,11 +29,35 @@
 
 
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include <easy3d/util/timer_service.h>
 
 
 namespace easy3d {
 
+    /**
+     * \brief The ways a connected function is invoked when a signal is emitted.
+     * \details
+     *  - \c DIRECT_CONNECTION: the function is called immediately, in the thread emitting the signal.
+     *  - \c QUEUED_CONNECTION: each emission is posted (with a copy of the arguments) to the event loop of the main
+     *      thread, i.e., the thread calling TimerService::process_main_thread_tasks() (e.g., the rendering loop of
+     *      the viewer). The function is called there once per emission, in the order of the emissions.
+     *  - \c COALESCED_CONNECTION: same as \c QUEUED_CONNECTION, but repeated emissions before the event loop gets
+     *      the chance to process them are merged: the function is called only once (per frame), with the arguments
+     *      of the latest emission. This is the preferred way to connect high-frequency signals (e.g., camera
+     *      changes) to functions like update().
+     */
+    enum ConnectionType {
+        DIRECT_CONNECTION,
+        QUEUED_CONNECTION,
+        COALESCED_CONNECTION
+    };
+
+
     /**
      * \brief A light-weight implementation of the simple signal-slot mechanism.
      * \class Signal easy3d/core/signal.h
@@ -47,6 +71,19 @@ namespace easy3d {
      *      viewer's update() function. So in Easy3D, the viewer's update function is connected to the camera's
      *      corresponding signal.
      *
+     *      Functions can be connected with different connection types (see ConnectionType). Queued connections
+     *      deliver the emissions to the event loop of the main thread (see TimerService::process_main_thread_tasks()),
+     *      which allows emitting signals from worker threads and merging the emissions within a frame.
+     *
+     *      Connecting, disconnecting, and emitting are thread-safe. The list of connections is copied on write, so an
+     *      emission does not allocate memory for direct connections and the connected functions can safely connect
+     *      or disconnect (themselves or others) while the signal is being emitted.
+     *
+     * \note Once disconnect() returns, a function connected with a queued connection will not be called anymore
+     *      (if it is being executed on the main thread, disconnect() waits until its execution is finished). A
+     *      function connected with a direct connection may still be running in the threads that are emitting the
+     *      signal.
+     *
      * \see A more powerful implementation [sigslot](https://github.com/palacaze/sigslot) based on C++14.
      *
      * \example Test_Signal  \include{lineno} test_signal.cpp
@@ -63,14 +100,19 @@ namespace easy3d {
         Signal(Signal const & /*unused*/) {}
 
         /// \brief Move constructor.
-        Signal(Signal &&other) noexcept:
-                slots_(std::move(other.slots_)),
-                current_id_(other.current_id_) {
+        Signal(Signal &&other) noexcept {
+            std::lock_guard<std::mutex> lock(other.mutex_);
+            slots_ = std::move(other.slots_);
+            current_id_ = other.current_id_;
         }
 
         /// \brief The assignment operator
         Signal &operator=(Signal &&other) noexcept {
             if (this != &other) {
+                disconnect_all();
+                std::lock(mutex_, other.mutex_);
+                std::lock_guard<std::mutex> lock(mutex_, std::adopt_lock);
+                std::lock_guard<std::mutex> other_lock(other.mutex_, std::adopt_lock);
                 slots_ = std::move(other.slots_);
                 current_id_ = other.current_id_;
             }
@@ -88,15 +130,23 @@ namespace easy3d {
         /**
          * \brief Connects a function to this signal.
          * \details The returned value can be used to disconnect the function from this signal.
+         * \param slot The function to be connected.
+         * \param type The connection type, which determines when and in which thread the function is called.
          * \note When a function has overloads, explicitly cast the function to the right function type, e.g.,
          *      \code
          *          static_cast<void (*)(const std::string&, int)>(&print)
          *      \endcode
          *     Or use the helper function \c overload for a lighter syntax.
          */
-        int connect(std::function<void(Args...)> const &slot) {
-            slots_.insert(std::make_pair(++current_id_, slot));
-            return current_id_;
+        int connect(std::function<void(Args...)> const &slot, ConnectionType type = DIRECT_CONNECTION) {
+            std::shared_ptr<Connection> connection = std::make_shared<Connection>(slot, type);
+            std::lock_guard<std::mutex> lock(mutex_);
+            connection->id = ++current_id_;
+            // copy on write: the emissions in progress keep using the old list
+            std::shared_ptr<SlotList> slots = slots_ ? std::make_shared<SlotList>(*slots_) : std::make_shared<SlotList>();
+            slots->push_back(connection);
+            slots_ = slots;
+            return connection->id;
         }
 
         /**
@@ -112,10 +162,10 @@ namespace easy3d {
          *     Or use the helper function \c overload for a lighter syntax.
          */
         template<typename Class>
-        int connect(Class *inst, void (Class::*func)(Args...)) {
+        int connect(Class *inst, void (Class::*func)(Args...), ConnectionType type = DIRECT_CONNECTION) {
             return connect([=](Args... args) {
                 (inst->*func)(args...);
-            });
+            }, type);
         }
 
         /**
@@ -131,10 +181,10 @@ namespace easy3d {
          *     Or use the helper function \c overload for a lighter syntax.
          */
         template<typename Class>
-        int connect(Class *inst, void (Class::*func)(Args...) const) {
+        int connect(Class *inst, void (Class::*func)(Args...) const, ConnectionType type = DIRECT_CONNECTION) {
             return connect([=](Args... args) {
                 (inst->*func)(args...);
-            });
+            }, type);
         }
 
         /**
@@ -142,46 +192,164 @@ namespace easy3d {
          * \details Upon return, the emission of this signal will trigger \p receiver to emit.
          * The returned value can be used to disconnect the connected signal.
          */
-        int connect(Signal<Args...> *receiver) {
-            return connect(receiver, &Signal<Args...>::send);
+        int connect(Signal<Args...> *receiver, ConnectionType type = DIRECT_CONNECTION) {
+            return connect(receiver, &Signal<Args...>::send, type);
         }
 
         /// \brief Disconnects a previously connected function.
         void disconnect(int id) {
-            slots_.erase(id);
+            std::shared_ptr<Connection> removed;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!slots_)
+                    return;
+                std::shared_ptr<SlotList> slots = std::make_shared<SlotList>();
+                slots->reserve(slots_->size());
+                for (auto const &c : *slots_) {
+                    if (c->id == id)
+                        removed = c;
+                    else
+                        slots->push_back(c);
+                }
+                if (!removed)
+                    return;
+                if (slots->empty())
+                    slots_.reset();
+                else
+                    slots_ = slots;
+            }
+            release(removed);
         }
 
         /// \brief Disconnects all previously connected functions.
         void disconnect_all() {
-            slots_.clear();
+            std::shared_ptr<const SlotList> slots;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slots.swap(slots_);
+            }
+            if (slots) {
+                for (auto const &c : *slots)
+                    release(c);
+            }
+        }
+
+        /// \brief Returns the number of connected functions.
+        std::size_t num_connections() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return slots_ ? slots_->size() : 0;
         }
 
         /// \brief Calls all connected functions.
         void send(Args... p) {
-            for (auto const &it : slots_) {
-                it.second(p...);
-            }
+            const std::shared_ptr<const SlotList> slots = snapshot();
+            if (!slots)
+                return;
+            for (auto const &c : *slots)
+                deliver(c, p...);
         }
 
         /// \brief Calls all connected functions except for one.
         void send_for_all_but_one(int excludedConnectionID, Args... p) {
-            for (auto const &it : slots_) {
-                if (it.first != excludedConnectionID) {
-                    it.second(p...);
-                }
+            const std::shared_ptr<const SlotList> slots = snapshot();
+            if (!slots)
+                return;
+            for (auto const &c : *slots) {
+                if (c->id != excludedConnectionID)
+                    deliver(c, p...);
             }
         }
 
         /// \brief Calls only one connected function.
         void emit_for(int connectionID, Args... p) {
-            auto const &it = slots_.find(connectionID);
-            if (it != slots_.end()) {
-                it->second(p...);
+            const std::shared_ptr<const SlotList> slots = snapshot();
+            if (!slots)
+                return;
+            for (auto const &c : *slots) {
+                if (c->id == connectionID) {
+                    deliver(c, p...);
+                    break;
+                }
+            }
+        }
+
+    private:
+        // a pending emission of a coalesced connection, i.e., a copy of the arguments applied to the slot
+        typedef std::function<void(std::function<void(Args...)> const &)> Call;
+
+        struct Connection {
+            Connection(std::function<void(Args...)> const &s, ConnectionType t)
+                    : id(0), slot(s), type(t), connected(true), posted(false) {}
+            int id;
+            std::function<void(Args...)> slot;
+            ConnectionType type;
+            std::atomic<bool> connected;
+            std::recursive_mutex invoke_mutex;  // serializes queued invocations and disconnection
+            std::mutex pending_mutex;           // guards 'pending' and 'posted' of coalesced connections
+            Call pending;                       // the latest emission that has not been delivered yet
+            bool posted;
+        };
+        typedef std::vector< std::shared_ptr<Connection> > SlotList;
+
+        std::shared_ptr<const SlotList> snapshot() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return slots_;
+        }
+
+        static void deliver(std::shared_ptr<Connection> const &c, Args... p) {
+            if (!c->connected)
+                return;
+
+            switch (c->type) {
+                case DIRECT_CONNECTION:
+                    c->slot(p...);
+                    break;
+                case QUEUED_CONNECTION: {
+                    std::shared_ptr<Connection> conn = c;
+                    TimerService::instance().post([conn, p...]() mutable {
+                        std::lock_guard<std::recursive_mutex> guard(conn->invoke_mutex);
+                        if (conn->connected)
+                            conn->slot(p...);
+                    }, conn.get());
+                    break;
+                }
+                case COALESCED_CONNECTION: {
+                    std::shared_ptr<Connection> conn = c;
+                    Call call = [p...](std::function<void(Args...)> const &slot) mutable { slot(p...); };
+                    {
+                        std::lock_guard<std::mutex> lock(conn->pending_mutex);
+                        conn->pending.swap(call);   // the latest emission wins
+                        if (conn->posted)
+                            return;
+                        conn->posted = true;
+                    }
+                    TimerService::instance().post([conn]() {
+                        Call latest;
+                        {
+                            std::lock_guard<std::mutex> lock(conn->pending_mutex);
+                            latest.swap(conn->pending);
+                            conn->posted = false;
+                        }
+                        std::lock_guard<std::recursive_mutex> guard(conn->invoke_mutex);
+                        if (conn->connected && latest)
+                            latest(conn->slot);
+                    }, conn.get());
+                    break;
+                }
             }
         }
 
+        static void release(std::shared_ptr<Connection> const &c) {
+            // waits for a queued invocation running on another thread (a function may disconnect itself)
+            std::lock_guard<std::recursive_mutex> guard(c->invoke_mutex);
+            c->connected = false;
+            std::lock_guard<std::mutex> lock(c->pending_mutex);
+            c->pending = nullptr;
+        }
+
     private:
-        std::unordered_map<int, std::function<void(Args...)>> slots_;
+        mutable std::mutex mutex_;  // guards 'slots_' and 'current_id_'
+        std::shared_ptr<const SlotList> slots_;
         int current_id_{0};
     };
 
@@ -220,14 +388,27 @@ namespace easy3d {
         return signal->connect(inst, slot);
     }
 
+    /**
+     * \brief Connects a member function of an object to this Signal using the connection \p type.
+     * \details The returned value can be used to disconnect the function from this signal. For example, the viewer
+     *      is repainted at most once per frame no matter how many times the camera is modified within that frame:
+     *    \code
+     *       easy3d::connect(&camera_->frame_modified, viewer, &Viewer::update, COALESCED_CONNECTION);
+     *    \endcode
+     */
+    template<typename SIGNAL, typename CLASS, typename FUNCTION>
+    inline int connect(SIGNAL *signal, CLASS *inst, FUNCTION const &slot, ConnectionType type) {
+        return signal->connect(inst, slot, type);
+    }
+
     /**
      * \brief Connects this signal to \p another signal.
      * \details Upon return, the emission of this signal will trigger \p another to be emitted.
      * The returned value can be used to disconnect the connected signal.
      */
     template<typename... Args>
-    int connect(Signal<Args...> *sender, Signal<Args...> *receiver) {
-        return sender->connect(receiver);
+    int connect(Signal<Args...> *sender, Signal<Args...> *receiver, ConnectionType type = DIRECT_CONNECTION) {
+        return sender->connect(receiver, type);
     }
 
     /// \brief Disconnects a previously connected function.
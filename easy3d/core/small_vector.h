@@ -0,0 +1,146 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_SMALL_VECTOR_H
+#define EASY3D_CORE_SMALL_VECTOR_H
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A vector that stores up to \p N elements inline (i.e., without allocating memory).
+     * \class SmallVector easy3d/core/small_vector.h
+     * \details It is meant for short sequences collected in hot loops, e.g., the one-ring neighbors of a vertex,
+     *      whose size is almost always small but not bounded. Elements beyond the inline capacity go to the heap.
+     *      Once on the heap, the storage stays there until the vector is destroyed, so a reused SmallVector does not
+     *      allocate again. The element type must be default constructible and copyable.
+     * \code
+     *      SmallVector<SurfaceMesh::Vertex, 16> ring;
+     *      for (auto v : mesh->vertices()) {
+     *          ring.clear();
+     *          for (auto vv : mesh->vertices(v))
+     *              ring.push_back(vv);
+     *          ...
+     *      }
+     * \endcode
+     */
+    template<typename T, std::size_t N>
+    class SmallVector {
+        // grow() doubles the capacity, which never grows an empty inline storage
+        static_assert(N > 0, "SmallVector requires an inline capacity of at least one element");
+
+    public:
+        typedef T value_type;
+        typedef T *iterator;
+        typedef const T *const_iterator;
+
+    public:
+        SmallVector() : size_(0) {}
+
+        SmallVector(const SmallVector &other) : size_(0) { *this = other; }
+
+        SmallVector &operator=(const SmallVector &other) {
+            if (this != &other) {
+                clear();
+                for (const auto &x : other)
+                    push_back(x);
+            }
+            return *this;
+        }
+
+        /// Returns the number of elements.
+        std::size_t size() const { return size_; }
+
+        /// Returns true if there is no element.
+        bool empty() const { return size_ == 0; }
+
+        /// Returns the number of elements that can be stored without allocating memory.
+        std::size_t capacity() const { return heap_.empty() ? N : heap_.size(); }
+
+        /// Returns true if the elements are stored inline (i.e., no memory has been allocated).
+        bool is_inline() const { return heap_.empty(); }
+
+        /// Removes all elements (the capacity is kept).
+        void clear() { size_ = 0; }
+
+        /// Appends an element.
+        void push_back(const T &x) {
+            if (size_ == capacity())
+                grow();
+            data()[size_++] = x;
+        }
+
+        /// Removes the last element.
+        void pop_back() {
+            assert(size_ > 0);
+            --size_;
+        }
+
+        T *data() { return heap_.empty() ? inline_ : heap_.data(); }
+        const T *data() const { return heap_.empty() ? inline_ : heap_.data(); }
+
+        T &operator[](std::size_t i) {
+            assert(i < size_);
+            return data()[i];
+        }
+        const T &operator[](std::size_t i) const {
+            assert(i < size_);
+            return data()[i];
+        }
+
+        T &front() { return (*this)[0]; }
+        const T &front() const { return (*this)[0]; }
+        T &back() { return (*this)[size_ - 1]; }
+        const T &back() const { return (*this)[size_ - 1]; }
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + size_; }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + size_; }
+
+    private:
+        // moves the elements to a heap storage with twice the capacity
+        void grow() {
+            std::vector<T> storage(capacity() * 2);
+            for (std::size_t i = 0; i < size_; ++i)
+                storage[i] = data()[i];
+            heap_.swap(storage);
+        }
+
+    private:
+        T inline_[N];
+        std::vector<T> heap_;
+        std::size_t size_;
+    };
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_CORE_SMALL_VECTOR_H
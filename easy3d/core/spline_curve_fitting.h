@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <cassert>
+#include <algorithm>
 
 
 namespace easy3d {
@@ -89,6 +90,14 @@ namespace easy3d {
         ///     distances along the curve, use the parameter generated from get_equally_spaced_parameters().
         Point_t eval_f(FT u) const;
 
+        /// \brief Evaluates positions of the spline at many parameters at once.
+        /// \details This is equivalent to calling eval_f() for each parameter, but the intermediate buffer is shared
+        ///     by all evaluations, and the knot span of each parameter is searched from the span of the previous one
+        ///     (if the parameters are increasing).
+        /// @param u : curve parameters ranging from [0; 1].
+        /// @param points : the evaluated positions, one for each parameter.
+        void eval_f(const std::vector<FT> &u, std::vector<Point_t> &points) const;
+
         /// \brief Evaluates speed of the spline
         Point_t eval_df(FT u) const;
 
@@ -102,6 +111,15 @@ namespace easy3d {
         ///     spaced along the curve.
         std::vector<FT> get_equally_spaced_parameters(std::size_t steps) const;
 
+        /// \brief Computes an arc-length table of the curve.
+        /// \details The curve is evaluated at \p steps equally spaced parameters, and the accumulated length of the
+        ///     resulting polyline is recorded for each parameter. The table can be used to map curve lengths to
+        ///     parameters (and vice versa) without evaluating the curve again.
+        /// @param steps : the number of samples (at least 2).
+        /// @param parameters : the sampled parameters, increasing from 0 to 1.
+        /// @param lengths : the accumulated curve length at each parameter (the last one is the curve length).
+        void get_arc_length_table(std::size_t steps, std::vector<FT> &parameters, std::vector<FT> &lengths) const;
+
     private:
         // -------------------------------------------------------------------------
         /// @name Class tools
@@ -135,10 +153,15 @@ namespace easy3d {
                      const std::vector<FT> &node,
                      int off = 0) const;
 
-        Point_t eval_rec(FT u,
-                         std::vector<Point_t> p_in,
-                         int k,
-                         std::vector<FT> node_in) const;
+        /// Find the knot span of the parameter u, i.e., the first 'dec' such that u <= node[dec + k + off]. The
+        /// search starts from 'hint' if the span is known to be after it (e.g., for increasing parameters).
+        int find_span(FT u, const std::vector<Point_t> &point, int k, const std::vector<FT> &node, int off,
+                      int hint = 0) const;
+
+        /// Evaluate the blossom of the k control points starting from 'dec' in place in 'buffer' (at least k
+        /// points). The result is the same as the recursive definition, without allocating memory.
+        Point_t eval_blossom(FT u, const std::vector<Point_t> &point, int k, const std::vector<FT> &node, int off,
+                             int dec, Point_t *buffer) const;
 
         // -------------------------------------------------------------------------
         /// @name attributes
@@ -212,42 +235,60 @@ namespace easy3d {
 
     // -----------------------------------------------------------------------------
 
+    template<typename Point_t>
+    void SplineCurveFitting<Point_t>::eval_f(const std::vector<FT> &u, std::vector<Point_t> &points) const {
+        assert_splines();
+        points.resize(u.size());
+        std::vector<Point_t> buffer(_k);
+        int dec = 0;
+        for (std::size_t i = 0; i < u.size(); ++i) {
+            const FT t = std::max(std::min(u[i], (FT) 1), (FT) 0); // clamp between [0 1]
+            dec = find_span(t, _point, _k, _node, 0, dec);
+            points[i] = eval_blossom(t, _point, _k, _node, 0, dec, buffer.data());
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template<typename Point_t>
+    void SplineCurveFitting<Point_t>::get_arc_length_table(std::size_t steps, std::vector<FT> &parameters,
+                                                           std::vector<FT> &lengths) const {
+        steps = std::max(steps, std::size_t(2));
+        parameters.resize(steps);
+        for (std::size_t i = 0; i < steps; ++i)
+            parameters[i] = static_cast<FT>(i) / static_cast<FT>(steps - 1);
+
+        std::vector<Point_t> points;
+        eval_f(parameters, points);
+
+        lengths.resize(steps);
+        lengths[0] = 0;
+        for (std::size_t i = 1; i < steps; ++i)
+            lengths[i] = lengths[i - 1] + distance(points[i], points[i - 1]);
+    }
+
+    // -----------------------------------------------------------------------------
+
     template<typename Point_t>
     std::vector<typename Point_t::FT> SplineCurveFitting<Point_t>::get_equally_spaced_parameters(std::size_t steps) const {
         assert_splines();
+        if (steps < 2)
+            return std::vector<FT>(steps, FT(0));
 
-        std::vector<FT> lengths(steps, 0);
-        std::vector<FT> parameters(steps, 0);
-        Point_t prev_point;
-        for (std::size_t i = 0; i < steps; ++i) {
-            const FT u = static_cast<FT>(i) / static_cast<FT>(steps - 1);
-            parameters[i] = u;
-            const Point_t pos = eval_f(u);
-            if (i > 0)
-                lengths[i] = lengths[i - 1] + distance(pos, prev_point);
-            prev_point = pos;
-        }
-        FT total_length = lengths.back();
-
-        // given a \c value and a sorted sequence of values, find the two indices such that
-        // sorted_values[left_index] <= value and sorted_values[right_index] >= value.
-        auto find_closest_less_or_equal = [](const std::vector<FT> &sorted_values, FT value,
-                                             std::size_t start) -> std::size_t {
-            assert(value >= sorted_values.front() && value <= sorted_values.back());
-            std::size_t index = start;
-            while (sorted_values[index] < value)
-                ++index;
-            while (sorted_values[index] > value)
-                --index;
-            return index;
-        };
+        std::vector<FT> parameters, lengths;
+        get_arc_length_table(steps, parameters, lengths);
+        const FT total_length = lengths.back();
 
+        // the lengths are increasing, so the interval containing each (increasing) target length is found by
+        // walking from the previous one.
         std::vector<FT> U(steps);
+        std::size_t left_index = 0;
         for (std::size_t i = 0; i < steps; ++i) {
             FT u = static_cast<FT>(i) / static_cast<FT>(steps - 1);
-            FT length = total_length * u;
-            std::size_t left_index = find_closest_less_or_equal(lengths, length, i);
-            std::size_t right_index = (lengths[left_index] == length) ? left_index : left_index + 1;
+            const FT length = total_length * u;
+            while (left_index + 1 < steps && lengths[left_index + 1] <= length)
+                ++left_index;
+            const std::size_t right_index = (lengths[left_index] == length) ? left_index : std::min(left_index + 1, steps - 1);
             if (lengths[left_index] == lengths[right_index])
                 u = parameters[left_index];
             else { // linear interpolation
@@ -324,50 +365,56 @@ namespace easy3d {
         assert(k > 1);
         assert((int) point.size() >= k);
         assert_splines();
-        int dec = 0;
-        // TODO: better search with dychotomi ?
-        // TODO: check for overflow
-        while (u > node[dec + k + off])
-            dec++;
-
-        // TODO: use buffers in attributes for better performances ?
-        std::vector<Point_t> p_rec(k, Point_t());
-        for (int i = dec, j = 0; i < (dec + k); ++i, ++j)
-            p_rec[j] = point[i];
+        const int dec = find_span(u, point, k, node, off);
+        std::vector<Point_t> buffer(k);
+        return eval_blossom(u, point, k, node, off, dec, buffer.data());
+    }
 
-        std::vector<FT> node_rec(k + k - 2, (FT) 0);
-        for (int i = (dec + 1), j = 0; i < (dec + k + k - 1); ++i, ++j)
-            node_rec[j] = node[i + off];
+    // -----------------------------------------------------------------------------
 
-        return eval_rec(u, p_rec, k, node_rec);
+    template<typename Point_t>
+    int SplineCurveFitting<Point_t>::find_span(FT u,
+                                               const std::vector<Point_t> &point,
+                                               int k,
+                                               const std::vector<FT> &node,
+                                               int off,
+                                               int hint) const {
+        // the nodal vector is non-decreasing, so the span can be found by a binary search. It is after the hint if
+        // the node before the hint is smaller than u.
+        const auto begin = node.begin() + (k + off);
+        const int size = static_cast<int>(node.end() - begin);
+        const int first = (hint > 0 && hint <= size && begin[hint - 1] < u) ? hint : 0;
+        const int dec = static_cast<int>(std::lower_bound(begin + first, node.end(), u) - begin);
+        // the k control points starting from dec must exist
+        return std::max(0, std::min(dec, (int) point.size() - k));
     }
 
     // -----------------------------------------------------------------------------
 
     template<typename Point_t>
-    Point_t SplineCurveFitting<Point_t>::eval_rec(FT u,
-                                      std::vector<Point_t> p_in,
-                                      int k,
-                                      std::vector<FT> node_in) const {
-        if (p_in.size() == 1)
-            return p_in[0];
-
-        // TODO: use buffers in attributes for better performances ?
-        std::vector<Point_t> p_out(k - 1, Point_t());
-        for (int i = 0; i < (k - 1); ++i) {
-            const FT n0 = node_in[i + k - 1];
-            const FT n1 = node_in[i];
-            const FT f0 = (n0 - u) / (n0 - n1);
-            const FT f1 = (u - n1) / (n0 - n1);
-
-            p_out[i] = p_in[i] * f0 + p_in[i + 1] * f1;
+    Point_t SplineCurveFitting<Point_t>::eval_blossom(FT u,
+                                                      const std::vector<Point_t> &point,
+                                                      int k,
+                                                      const std::vector<FT> &node,
+                                                      int off,
+                                                      int dec,
+                                                      Point_t *buffer) const {
+        for (int j = 0; j < k; ++j)
+            buffer[j] = point[dec + j];
+
+        // at each level, the order decreases by one and the nodes window moves one node forward
+        const FT *nodes = node.data() + dec + 1 + off;
+        for (int level = k; level > 1; --level, ++nodes) {
+            for (int i = 0; i < (level - 1); ++i) {
+                const FT n0 = nodes[i + level - 1];
+                const FT n1 = nodes[i];
+                const FT f0 = (n0 - u) / (n0 - n1);
+                const FT f1 = (u - n1) / (n0 - n1);
+
+                buffer[i] = buffer[i] * f0 + buffer[i + 1] * f1;
+            }
         }
-
-        std::vector<FT> node_out(node_in.size() - 2);
-        for (int i = 1, j = 0; i < ((int) node_in.size() - 1); ++i, ++j)
-            node_out[j] = node_in[i];
-
-        return eval_rec(u, p_out, (k - 1), node_out);
+        return buffer[0];
     }
 
 }   // namespace easy3d
@@ -109,6 +109,15 @@ namespace easy3d {
          */
         Point_t eval_f(FT u) const;
 
+        /**
+         * Evaluates the positions of the spline curve at many parameters at once.
+         * \details This is equivalent to calling eval_f() for each parameter, but each coordinate is evaluated for
+         *      all parameters in a row.
+         * \param u Curve parameters in the range [0, 1].
+         * \param points The evaluated positions, one for each parameter.
+         */
+        void eval_f(const std::vector<FT> &u, std::vector<Point_t> &points) const;
+
     private:
         // -------------------------------------------------------------------------
         /// @name Class tools
@@ -218,6 +227,17 @@ namespace easy3d {
     }
 
 
+    template<typename Point_t>
+    void SplineCurveInterpolation<Point_t>::eval_f(const std::vector<FT> &u, std::vector<Point_t> &points) const {
+        points.resize(u.size());
+        for (std::size_t i=0; i<dim_; ++i) {
+            const auto &interpolator = interpolators_[i];
+            for (std::size_t j=0; j<u.size(); ++j)
+                points[j][i] = interpolator(u[j] * largest_t_);
+        }
+    }
+
+
 }   // namespace easy3d
 
 
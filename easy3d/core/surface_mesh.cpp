@@ -87,6 +87,35 @@ namespace easy3d {
     }
 
 
+    void SurfaceMesh::swap(SurfaceMesh& other)
+    {
+        if (this == &other)
+            return;
+
+        // the property handles point to the arrays, which move together with the containers
+        vprops_.swap(other.vprops_);
+        hprops_.swap(other.hprops_);
+        eprops_.swap(other.eprops_);
+        fprops_.swap(other.fprops_);
+        mprops_.swap(other.mprops_);
+
+        std::swap(vconn_, other.vconn_);
+        std::swap(hconn_, other.hconn_);
+        std::swap(fconn_, other.fconn_);
+        std::swap(vdeleted_, other.vdeleted_);
+        std::swap(edeleted_, other.edeleted_);
+        std::swap(fdeleted_, other.fdeleted_);
+        std::swap(vpoint_, other.vpoint_);
+        std::swap(vnormal_, other.vnormal_);
+        std::swap(fnormal_, other.fnormal_);
+
+        std::swap(deleted_vertices_, other.deleted_vertices_);
+        std::swap(deleted_edges_, other.deleted_edges_);
+        std::swap(deleted_faces_, other.deleted_faces_);
+        std::swap(garbage_, other.garbage_);
+    }
+
+
     //-----------------------------------------------------------------------------
 
 
@@ -1013,16 +1042,24 @@ namespace easy3d {
         if (!fnormal_)
             fnormal_ = face_property<vec3>("f:normal");
 
-        FaceIterator fit, fend=faces_end();
+        // the faces are independent, so they are processed in parallel over the raw indices (deleted faces are
+        // skipped only if the mesh has garbage)
+        const int num = static_cast<int>(faces_size());
+        const bool garbage = has_garbage();
 
         int num_degenerate = 0;
-        for (fit=faces_begin(); fit!=fend; ++fit) {
-            if (is_degenerate(*fit)) {
+#pragma omp parallel for reduction(+:num_degenerate)
+        for (int i = 0; i < num; ++i) {
+            const Face f(i);
+            if (garbage && fdeleted_[f])
+                continue;
+            if (is_degenerate(f)) {
                 ++num_degenerate;
-                fnormal_[*fit] = vec3(0, 0, 1);
+                fnormal_[f] = vec3(0, 0, 1);
             } else
-                fnormal_[*fit] = compute_face_normal(*fit);
+                fnormal_[f] = compute_face_normal(f);
         }
+        fnormal_.notify_modified();
 
         if (num_degenerate > 0)
             LOG(WARNING) << "model has " << num_degenerate << " degenerate faces";
@@ -1101,8 +1138,17 @@ namespace easy3d {
         if (!fnormal_)
             update_face_normals();
 
-        for (VertexIterator vit=vertices_begin(), vend = vertices_end(); vit!=vend; ++vit)
-            vnormal_[*vit] = compute_vertex_normal(*vit);
+        // the vertices are independent, so they are processed in parallel (see update_face_normals())
+        const int num = static_cast<int>(vertices_size());
+        const bool garbage = has_garbage();
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const Vertex v(i);
+            if (garbage && vdeleted_[v])
+                continue;
+            vnormal_[v] = compute_vertex_normal(v);
+        }
+        vnormal_.notify_modified();
     }
 
 
@@ -1009,6 +1009,14 @@ namespace easy3d {
 
         /// assign \c rhs to \c *this. does not copy custom properties.
         SurfaceMesh& assign(const SurfaceMesh& rhs);
+
+        /**
+         * @brief Exchanges the content (i.e., all properties) of \c *this and \c other in constant time.
+         * @details Unlike the assignment, no data is copied. This allows a worker thread to prepare a new state of
+         *      the model and hand it over cheaply (see Renderer::publish()). The name, renderer, and manipulator of
+         *      the models are not exchanged.
+         */
+        void swap(SurfaceMesh& other);
         //@}
 
         //! \name File IO
@@ -1552,6 +1560,11 @@ namespace easy3d {
         {
             return vprops_.get_type(name);
         }
+        /** get the array of vertex property \p name. returns nullptr if the property does not exist. */
+        const BasePropertyArray* vertex_property_array(const std::string& name) const override
+        {
+            return vprops_.get_array(name);
+        }
         /** get the type_info \c T of halfedge property \p name. returns an typeid(void)
          if the property does not exist or if the type does not match. */
         const std::type_info& get_halfedge_property_type(const std::string& name) const
@@ -0,0 +1,78 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/surface_mesh_adjacency.h>
+
+
+namespace easy3d {
+
+    void SurfaceMeshAdjacency::build(const SurfaceMesh *mesh) {
+        clear();
+        if (!mesh)
+            return;
+
+        const int num = static_cast<int>(mesh->vertices_size());
+        offsets_.assign(num + 1, 0);
+
+        // count the neighbors
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (!mesh->is_deleted(v))
+                offsets_[i + 1] = mesh->valence(v);
+        }
+
+        // prefix sum
+        for (int i = 0; i < num; ++i)
+            offsets_[i + 1] += offsets_[i];
+
+        vertices_.resize(offsets_[num]);
+        halfedges_.resize(offsets_[num]);
+
+        // fill in the one-rings
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (mesh->is_deleted(v))
+                continue;
+            unsigned int k = offsets_[i];
+            for (auto h : mesh->halfedges(v)) {
+                halfedges_[k] = h;
+                vertices_[k] = mesh->target(h);
+                ++k;
+            }
+        }
+    }
+
+
+    void SurfaceMeshAdjacency::clear() {
+        // swap with empty containers to actually release the memory
+        std::vector<unsigned int>().swap(offsets_);
+        std::vector<Vertex>().swap(vertices_);
+        std::vector<Halfedge>().swap(halfedges_);
+    }
+
+}   // namespace easy3d
@@ -0,0 +1,153 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_SURFACE_MESH_ADJACENCY_H
+#define EASY3D_CORE_SURFACE_MESH_ADJACENCY_H
+
+#include <vector>
+
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/small_vector.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A precomputed vertex-to-one-ring adjacency of a surface mesh.
+     * \class SurfaceMeshAdjacency easy3d/core/surface_mesh_adjacency.h
+     * \details The one-ring of all vertices are stored contiguously in a compressed sparse row (CSR) layout, i.e.,
+     *      an offset array indexed by the vertices and two parallel arrays holding the neighboring vertices and the
+     *      outgoing halfedges, both in the same order as the circulators visit them. Traversing this cache touches
+     *      only sequential memory, which is much cheaper than circulating the halfedge connectivity. It is meant for
+     *      read-only phases (e.g., iterative smoothing) and has to be rebuilt once the connectivity changes.
+     * Example use:
+     * \code
+     *      SurfaceMeshAdjacency adjacency(mesh);
+     *      for (auto v : mesh->vertices()) {
+     *          for (auto vv : adjacency.vertices(v))
+     *              ...
+     *      }
+     * \endcode
+     */
+    class SurfaceMeshAdjacency {
+    public:
+        typedef SurfaceMesh::Vertex     Vertex;
+        typedef SurfaceMesh::Halfedge   Halfedge;
+
+        /// A light-weight range over a contiguous block of the cache, for C++11 range-based for-loops.
+        template<typename T>
+        class Range {
+        public:
+            Range(const T *begin, const T *end) : begin_(begin), end_(end) {}
+            const T *begin() const { return begin_; }
+            const T *end() const { return end_; }
+            std::size_t size() const { return static_cast<std::size_t>(end_ - begin_); }
+            bool empty() const { return begin_ == end_; }
+            const T &operator[](std::size_t i) const { return begin_[i]; }
+        private:
+            const T *begin_;
+            const T *end_;
+        };
+
+    public:
+        /// Constructs an empty cache.
+        SurfaceMeshAdjacency() {}
+
+        /// Constructs the cache for \p mesh.
+        explicit SurfaceMeshAdjacency(const SurfaceMesh *mesh) { build(mesh); }
+
+        /**
+         * \brief (Re)builds the cache for \p mesh.
+         * \details Deleted and isolated vertices get an empty one-ring. The vertices are processed in parallel if
+         *      OpenMP is available.
+         */
+        void build(const SurfaceMesh *mesh);
+
+        /// Releases the memory of the cache.
+        void clear();
+
+        /// Returns true if the cache has not been built.
+        bool empty() const { return offsets_.empty(); }
+
+        /// Returns the number of vertices (including the deleted ones) the cache was built for.
+        std::size_t vertices_size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+        /// Returns the number of neighbors of vertex \p v.
+        unsigned int valence(Vertex v) const {
+            return offsets_[v.idx() + 1] - offsets_[v.idx()];
+        }
+
+        /// Returns the neighboring vertices of vertex \p v.
+        Range<Vertex> vertices(Vertex v) const {
+            return Range<Vertex>(vertices_.data() + offsets_[v.idx()], vertices_.data() + offsets_[v.idx() + 1]);
+        }
+
+        /// Returns the outgoing halfedges of vertex \p v.
+        Range<Halfedge> halfedges(Vertex v) const {
+            return Range<Halfedge>(halfedges_.data() + offsets_[v.idx()], halfedges_.data() + offsets_[v.idx() + 1]);
+        }
+
+    private:
+        std::vector<unsigned int> offsets_;     // vertex v owns the entries [offsets_[v], offsets_[v+1])
+        std::vector<Vertex>       vertices_;
+        std::vector<Halfedge>     halfedges_;
+    };
+
+
+    /**
+     * \brief Collects the one-ring neighbors of vertex \p v into \p ring (in the order of the circulator).
+     * \details The previous content of \p ring is discarded. Reusing \p ring across calls avoids memory allocation.
+     * \return The number of neighbors.
+     */
+    template<std::size_t N>
+    inline std::size_t gather_one_ring(const SurfaceMesh *mesh, SurfaceMesh::Vertex v,
+                                       SmallVector<SurfaceMesh::Vertex, N> &ring) {
+        ring.clear();
+        for (auto vv : mesh->vertices(v))
+            ring.push_back(vv);
+        return ring.size();
+    }
+
+    /**
+     * \brief Collects the positions of the one-ring neighbors of vertex \p v into \p points (in the order of the
+     *      circulator).
+     * \details The previous content of \p points is discarded. Reusing \p points across calls avoids memory
+     *      allocation.
+     * \return The number of neighbors.
+     */
+    template<std::size_t N>
+    inline std::size_t gather_one_ring_positions(const SurfaceMesh *mesh, SurfaceMesh::Vertex v,
+                                                 SmallVector<vec3, N> &points) {
+        points.clear();
+        for (auto vv : mesh->vertices(v))
+            points.push_back(mesh->position(vv));
+        return points.size();
+    }
+
+}   // namespace easy3d
+
+
+#endif  // EASY3D_CORE_SURFACE_MESH_ADJACENCY_H
@@ -0,0 +1,129 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_UNION_FIND_H
+#define EASY3D_CORE_UNION_FIND_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A lock-free union-find (i.e., disjoint-set) data structure.
+     * \class UnionFind easy3d/core/union_find.h
+     * \details Both unite() and find() can be called concurrently from multiple threads (e.g., within an OpenMP
+     *      parallel loop). The root of a set is always its smallest element, which makes the result independent of
+     *      the order of the operations. A typical use is labeling the connected components of a graph:
+     * \code
+     *      UnionFind uf(num_vertices);
+     *      #pragma omp parallel for
+     *      for (int i = 0; i < num_edges; ++i)
+     *          uf.unite(edges[i].first, edges[i].second);
+     *      std::vector<int> labels;
+     *      int num_components = uf.labels(labels);
+     * \endcode
+     */
+    class UnionFind {
+    public:
+        /// Creates \p n singleton sets {0}, {1}, ..., {n-1}.
+        explicit UnionFind(std::size_t n) : parent_(n) {
+            for (std::size_t i = 0; i < n; ++i)
+                parent_[i].store(static_cast<int>(i), std::memory_order_relaxed);
+        }
+
+        /// The number of elements.
+        std::size_t size() const { return parent_.size(); }
+
+        /// Returns the root (i.e., the smallest element) of the set containing \p x.
+        int find(int x) {
+            while (true) {
+                int p = parent_[x].load(std::memory_order_relaxed);
+                if (p == x)
+                    return x;
+                const int gp = parent_[p].load(std::memory_order_relaxed);
+                if (p != gp) // path halving. Failing is harmless: another thread has shortened the path.
+                    parent_[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+                x = gp;
+            }
+        }
+
+        /// Merges the sets containing \p a and \p b.
+        void unite(int a, int b) {
+            while (true) {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                    return;
+                // always link the larger root to the smaller one, which avoids cycles without locking
+                if (a < b)
+                    std::swap(a, b);
+                int expected = a;
+                if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                    return;
+            }
+        }
+
+        /// Tests if \p a and \p b are in the same set.
+        bool same(int a, int b) { return find(a) == find(b); }
+
+        /**
+         * \brief Labels the sets with consecutive indices.
+         * \details The sets are numbered in the order of their smallest elements, i.e., the same as labeling the
+         *      components by propagation from the elements in increasing order.
+         * \param labels Returns the label of each element.
+         * \param valid If not empty, only elements with \c valid[i] == true are labeled (the others get -1).
+         * \return The number of sets.
+         */
+        int labels(std::vector<int> &labels, const std::vector<bool> &valid = std::vector<bool>()) {
+            const int n = static_cast<int>(parent_.size());
+            labels.resize(n);
+#pragma omp parallel for
+            for (int i = 0; i < n; ++i)
+                labels[i] = find(i);
+
+            // the root of a set is its smallest element, thus it is labeled before all others in the set
+            int num = 0;
+            for (int i = 0; i < n; ++i) {
+                if (!valid.empty() && !valid[i])
+                    labels[i] = -1;
+                else if (labels[i] == i)
+                    labels[i] = num++;
+                else
+                    labels[i] = labels[labels[i]];
+            }
+            return num;
+        }
+
+    private:
+        std::vector< std::atomic<int> > parent_;
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_CORE_UNION_FIND_H
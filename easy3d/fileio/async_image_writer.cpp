@@ -0,0 +1,128 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/async_image_writer.h>
+
+#include <memory>
+#include <algorithm>
+
+#include <easy3d/fileio/image_io.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        AsyncImageWriter::AsyncImageWriter(std::size_t queue_capacity, unsigned int num_threads)
+                : tasks_(std::max<std::size_t>(queue_capacity, 1)), num_pending_(0), num_written_(0), num_failed_(0)
+        {
+            for (unsigned int i = 0; i < std::max(num_threads, 1u); ++i) {
+                workers_.emplace_back([this]() {
+                    std::function<bool()> task;
+                    while (tasks_.pop(task)) {
+                        const bool success = task();
+                        task = nullptr; // release the image data before reporting
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (success)
+                            ++num_written_;
+                        else
+                            ++num_failed_;
+                        if (--num_pending_ == 0)
+                            all_done_.notify_all();
+                    }
+                });
+            }
+        }
+
+
+        AsyncImageWriter::~AsyncImageWriter() {
+            tasks_.close();  // the workers finish the queued images and then exit
+            for (auto& worker : workers_)
+                worker.join();
+
+            if (num_failed_ > 0)
+                LOG(WARNING) << num_failed_ << " images could not be written";
+        }
+
+
+        bool AsyncImageWriter::save(const std::string &file_name, std::vector<unsigned char>&& data, int width,
+                                    int height, int channels, bool flip_vertically)
+        {
+            // the data is moved into a shared buffer, since std::function requires copyable callables
+            auto image = std::make_shared< std::vector<unsigned char> >(std::move(data));
+            return enqueue([=]() {
+                return ImageIO::save(file_name, *image, width, height, channels, flip_vertically);
+            });
+        }
+
+
+        bool AsyncImageWriter::save_depth(const std::string &file_name, std::vector<float>&& depths, int width,
+                                          int height, bool flip_vertically)
+        {
+            auto depth_map = std::make_shared< std::vector<float> >(std::move(depths));
+            return enqueue([=]() {
+                return ImageIO::save_depth(file_name, *depth_map, width, height, flip_vertically);
+            });
+        }
+
+
+        void AsyncImageWriter::wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            all_done_.wait(lock, [this]() { return num_pending_ == 0; });
+        }
+
+
+        std::size_t AsyncImageWriter::num_written() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return num_written_;
+        }
+
+
+        std::size_t AsyncImageWriter::num_failed() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return num_failed_;
+        }
+
+
+        bool AsyncImageWriter::enqueue(std::function<bool()>&& task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++num_pending_;
+            }
+            if (tasks_.push(std::move(task)))
+                return true;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--num_pending_ == 0)
+                all_done_.notify_all();
+            LOG(ERROR) << "the image writer has been shut down";
+            return false;
+        }
+
+    }
+
+}
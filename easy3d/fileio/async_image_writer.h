@@ -0,0 +1,114 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_FILEIO_ASYNC_IMAGE_WRITER_H
+#define EASY3D_FILEIO_ASYNC_IMAGE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <easy3d/util/blocking_queue.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        /**
+         * \brief Writes images and depth maps to files on background threads.
+         * \class AsyncImageWriter easy3d/fileio/async_image_writer.h
+         *
+         * \details save() and save_depth() take the data by move and return immediately. The images are then
+         *      written by ImageIO::save() and ImageIO::save_depth() on the worker threads. The queue is bounded,
+         *      so the caller blocks only when the writers fall behind, and the memory use stays bounded when
+         *      exporting thousands of frames. Since PNG files are already compressed in parallel, one worker
+         *      thread is usually enough. Example usage:
+         *      \code
+         *          io::AsyncImageWriter writer;
+         *          for (int i = 0; i < num_frames; ++i) {
+         *              std::vector<float> depths;
+         *              fbo->read_depth(depths);
+         *              writer.save_depth("depth-" + std::to_string(i) + ".pfm", std::move(depths), w, h);
+         *          }
+         *          writer.wait();  // optional: blocks until all the files have been written
+         *      \endcode
+         */
+        class AsyncImageWriter {
+        public:
+            /**
+             * \brief Constructor. It launches the worker threads.
+             * \param queue_capacity The max number of images waiting to be written.
+             * \param num_threads The number of worker threads.
+             */
+            explicit AsyncImageWriter(std::size_t queue_capacity = 4, unsigned int num_threads = 1);
+            /// Destructor. It waits until all the queued images have been written.
+            ~AsyncImageWriter();
+
+            /**
+             * \brief Queues an image for writing. See ImageIO::save() for the parameters.
+             * \return false if the writer has been shut down.
+             */
+            bool save(const std::string& file_name, std::vector<unsigned char>&& data, int width, int height,
+                      int channels, bool flip_vertically = false);
+
+            /**
+             * \brief Queues a depth map for writing. See ImageIO::save_depth() for the parameters.
+             * \return false if the writer has been shut down.
+             */
+            bool save_depth(const std::string& file_name, std::vector<float>&& depths, int width, int height,
+                            bool flip_vertically = false);
+
+            /// Blocks until all the queued images have been written.
+            void wait();
+
+            /// Returns the number of images that have been written successfully.
+            std::size_t num_written() const;
+            /// Returns the number of images that could not be written.
+            std::size_t num_failed() const;
+
+        private:
+            bool enqueue(std::function<bool()>&& task);
+
+        private:
+            BlockingQueue< std::function<bool()> > tasks_;
+            std::vector<std::thread> workers_;
+
+            mutable std::mutex mutex_;
+            std::condition_variable all_done_;
+            std::size_t num_pending_;
+            std::size_t num_written_;
+            std::size_t num_failed_;
+        };
+
+    }
+
+}
+
+#endif  // EASY3D_FILEIO_ASYNC_IMAGE_WRITER_H
@@ -26,6 +26,10 @@
 
 #include <easy3d/fileio/image_io.h>
 
+#include <cstring>
+#include <algorithm>
+
+#include <easy3d/fileio/image_io_png.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/logging.h>
 
@@ -65,6 +69,135 @@ namespace easy3d {
     }
 
 
+    namespace internal {
+
+        // copies the rows of an image in reverse order
+        void flip_rows(const unsigned char* src, unsigned char* dst, std::size_t row_bytes, int height) {
+#pragma omp parallel for
+            for (int r = 0; r < height; ++r)
+                std::memcpy(dst + r * row_bytes, src + (height - 1 - r) * row_bytes, row_bytes);
+        }
+
+
+        bool save_png(const std::string& file_name, const unsigned char* data, int width, int height, int channels,
+                      int bit_depth, bool flip_vertically)
+        {
+            io::StripedPngWriter writer;
+            if (!writer.open(file_name, width, height, channels, bit_depth))
+                return false;
+
+            const std::size_t row_bytes = static_cast<std::size_t>(width) * channels * bit_depth / 8;
+            bool success = true;
+            if (!flip_vertically)
+                success = writer.write_rows(data, height);
+            else {
+                // flip the rows band by band (about 8 MB each) to avoid a copy of the full image
+                const int band_rows = std::max(1, static_cast<int>((8u << 20) / row_bytes));
+                std::vector<unsigned char> band;
+                for (int first = 0; first < height && success; first += band_rows) {
+                    const int num = std::min(band_rows, height - first);
+                    band.resize(num * row_bytes);
+                    flip_rows(data + (height - first - num) * row_bytes, band.data(), row_bytes, num);
+                    success = writer.write_rows(band.data(), num);
+                }
+            }
+            return writer.close() && success;
+        }
+
+
+        inline bool is_little_endian() {
+            const unsigned int value = 1;
+            return *reinterpret_cast<const unsigned char*>(&value) == 1;
+        }
+
+
+        // Portable FloatMap (grey): the rows are stored bottom to top, the sign of the scale gives the byte order
+        bool save_pfm(const std::string& file_name, const std::vector<float>& depths, int width, int height,
+                      bool flip_vertically)
+        {
+            FILE* fptr = fopen(file_name.c_str(), "wb");
+            if (!fptr) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return false;
+            }
+
+            char header[256];
+            sprintf(header, "Pf\n%i %i\n%s\n", width, height, is_little_endian() ? "-1.0" : "1.0");
+            bool success = fwrite(header, strlen(header), 1, fptr) == 1;
+            for (int r = 0; r < height && success; ++r) {
+                const int row = flip_vertically ? r : height - 1 - r;
+                success = fwrite(depths.data() + static_cast<std::size_t>(row) * width, sizeof(float), width, fptr) ==
+                          static_cast<std::size_t>(width);
+            }
+            if (fclose(fptr) != 0)
+                success = false;
+
+            if (!success)
+                LOG(ERROR) << "failed writing file: " << file_name;
+            return success;
+        }
+
+
+        bool load_pfm(const std::string& file_name, std::vector<float>& depths, int& width, int& height,
+                      bool flip_vertically)
+        {
+            FILE* fptr = fopen(file_name.c_str(), "rb");
+            if (!fptr) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return false;
+            }
+
+            char type[3] = {0};
+            int w = 0, h = 0;
+            float scale = 0.0f;
+            if (fscanf(fptr, "%2s %d %d %f", type, &w, &h, &scale) != 4 || w <= 0 || h <= 0 || fgetc(fptr) == EOF) {
+                LOG(ERROR) << "invalid PFM header: " << file_name;
+                fclose(fptr);
+                return false;
+            }
+            int channels = 0;
+            if (strcmp(type, "Pf") == 0) channels = 1;
+            else if (strcmp(type, "PF") == 0) channels = 3;
+            else {
+                LOG(ERROR) << "not a PFM file: " << file_name;
+                fclose(fptr);
+                return false;
+            }
+
+            std::vector<float> values(static_cast<std::size_t>(w) * h * channels);
+            const bool success = fread(values.data(), sizeof(float), values.size(), fptr) == values.size();
+            fclose(fptr);
+            if (!success) {
+                LOG(ERROR) << "unexpected end of file: " << file_name;
+                return false;
+            }
+
+            const bool swap_bytes = (scale < 0.0f) != is_little_endian();
+            depths.resize(static_cast<std::size_t>(w) * h);
+#pragma omp parallel for
+            for (int r = 0; r < h; ++r) {
+                // the rows in the file are from bottom to top
+                const int row = flip_vertically ? r : h - 1 - r;
+                const float* src = values.data() + static_cast<std::size_t>(r) * w * channels;
+                float* dst = depths.data() + static_cast<std::size_t>(row) * w;
+                for (int i = 0; i < w; ++i) {
+                    float v = src[i * channels];
+                    if (swap_bytes) {
+                        unsigned char* bytes = reinterpret_cast<unsigned char*>(&v);
+                        std::swap(bytes[0], bytes[3]);
+                        std::swap(bytes[1], bytes[2]);
+                    }
+                    dst[i] = v;
+                }
+            }
+            width = w;
+            height = h;
+            return true;
+        }
+
+    }
+
+
     bool ImageIO::save(
             const std::string& file_name,
             const std::vector<unsigned char>& data,
@@ -76,9 +209,11 @@ namespace easy3d {
             LOG(ERROR) << "image data is empty";
             return false;
         }
-
-        // flag is non-zero to flip data vertically
-        stbi_flip_vertically_on_write(flip_vertically);
+        if (data.size() < static_cast<std::size_t>(width) * height * channels) {
+            LOG(ERROR) << "image data is smaller than the image size (" << width << " x " << height << " x "
+                       << channels << ")";
+            return false;
+        }
 
         std::string final_name = file_name;
         const std::string &ext = file_system::extension(file_name, true);
@@ -88,18 +223,24 @@ namespace easy3d {
                 LOG(ERROR) << "No extension specified. Default to png";
                 final_name = final_name + ".png";
             }
+            return internal::save_png(final_name, data.data(), width, height, channels, 8, flip_vertically);
+        }
 
-            // PNG allows you to set deflate compression level by setting the global
-            // variable 'stbi_write_png_compression_level' (it defaults to 8).
-            stbi_write_png_compression_level = 8; //
-            return ::stbi_write_png(final_name.c_str(), width, height, channels, data.data(), width * channels);
-        } else if (ext == "jpg") {
+        // The flip flag of stb_image_write is global, so the data is flipped here (to allow concurrent writing).
+        std::vector<unsigned char> flipped;
+        if (flip_vertically) {
+            flipped.resize(static_cast<std::size_t>(width) * height * channels);
+            internal::flip_rows(data.data(), flipped.data(), static_cast<std::size_t>(width) * channels, height);
+        }
+        const unsigned char* pixels = flip_vertically ? flipped.data() : data.data();
+
+        if (ext == "jpg") {
             // quality is between 1 and 100. Higher quality looks better but results in a bigger image.
-            return ::stbi_write_jpg(final_name.c_str(), width, height, channels, data.data(), 100);
+            return ::stbi_write_jpg(final_name.c_str(), width, height, channels, pixels, 100);
         } else if (ext == "bmp")
-            return ::stbi_write_bmp(final_name.c_str(), width, height, channels, data.data());
+            return ::stbi_write_bmp(final_name.c_str(), width, height, channels, pixels);
         else if (ext == "tga")
-            return ::stbi_write_tga(final_name.c_str(), width, height, channels, data.data());
+            return ::stbi_write_tga(final_name.c_str(), width, height, channels, pixels);
         else {
             LOG(ERROR) << "unsupported file format: " << ext;
             return false;
@@ -107,6 +248,85 @@ namespace easy3d {
     }
 
 
+    bool ImageIO::save_depth(
+            const std::string& file_name,
+            const std::vector<float>& depths,
+            int width,
+            int height,
+            bool flip_vertically) {
+        if (depths.empty() || depths.size() < static_cast<std::size_t>(width) * height) {
+            LOG(ERROR) << "depth data is empty or smaller than the image size (" << width << " x " << height << ")";
+            return false;
+        }
+
+        const int num = width * height;
+        const std::string &ext = file_system::extension(file_name, true);
+        if (ext == "pfm")
+            return internal::save_pfm(file_name, depths, width, height, flip_vertically);
+        else if (ext == "png") {
+            // 16-bit grey values in big-endian byte order
+            std::vector<unsigned char> bits(static_cast<std::size_t>(num) * 2);
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const float d = std::min(std::max(depths[i], 0.0f), 1.0f);
+                const unsigned int v = static_cast<unsigned int>(d * 65535.0f + 0.5f);
+                bits[i * 2] = static_cast<unsigned char>(v >> 8);
+                bits[i * 2 + 1] = static_cast<unsigned char>(v & 0xff);
+            }
+            return internal::save_png(file_name, bits.data(), width, height, 1, 16, flip_vertically);
+        }
+        else {
+            std::vector<unsigned char> bits(static_cast<std::size_t>(num) * 3);
+            // convert the depth values to unsigned char RGB values (and flip the rows, since save_ppm() can't)
+#pragma omp parallel for
+            for (int r = 0; r < height; ++r) {
+                const float* src = depths.data() + static_cast<std::size_t>(r) * width;
+                unsigned char* dst = bits.data() + static_cast<std::size_t>(flip_vertically ? height - 1 - r : r) * width * 3;
+                for (int i = 0; i < width; ++i)
+                    dst[i * 3] = dst[i * 3 + 1] = dst[i * 3 + 2] = static_cast<unsigned char>(src[i] * 255);
+            }
+            if (ext == "ppm")
+                return io::save_ppm(file_name, bits, width, height);
+            else
+                return save(file_name, bits, width, height, 3, false);
+        }
+    }
+
+
+    bool ImageIO::load_depth(
+            const std::string& file_name,
+            std::vector<float>& depths,
+            int& width,
+            int& height,
+            bool flip_vertically) {
+        depths.clear();
+
+        const std::string &ext = file_system::extension(file_name, true);
+        if (ext == "pfm")
+            return internal::load_pfm(file_name, depths, width, height, flip_vertically);
+
+        // 16-bit images are kept 16-bit; 8-bit images are scaled to 16-bit.
+        // The rows are flipped here (as in save_depth()), since stbi_set_flip_vertically_on_load() is a global state.
+        int channels = 0;
+        stbi_us* values = stbi_load_16(file_name.c_str(), &width, &height, &channels, 1);
+        if (!values) {
+            LOG(ERROR) << "failed load image file: " << file_name << ". " << stbi_failure_reason();
+            return false;
+        }
+
+        depths.resize(static_cast<std::size_t>(width) * height);
+#pragma omp parallel for
+        for (int r = 0; r < height; ++r) {
+            const stbi_us* src = values + static_cast<std::size_t>(r) * width;
+            float* dst = depths.data() + static_cast<std::size_t>(flip_vertically ? height - 1 - r : r) * width;
+            for (int i = 0; i < width; ++i)
+                dst[i] = static_cast<float>(src[i]) / 65535.0f;
+        }
+        stbi_image_free(values);
+        return true;
+    }
+
+
 
     namespace io {
 
@@ -111,6 +111,9 @@ namespace easy3d {
          * \param flip_vertically Flip the image data vertically before writing.
          *
          * \return Return true on success or false if failed.
+         *
+         * \note PNG files are filtered and compressed in parallel by strips of rows (see io::StripedPngWriter).
+         *      This function can be called from multiple threads (see io::AsyncImageWriter).
          */
         static bool	save(
                 const std::string& file_name,
@@ -121,6 +124,49 @@ namespace easy3d {
                 bool flip_vertically = false
                 );
 
+        /**
+         * \brief Write a depth map into a file without the lossy conversion to 8-bit colors (if the format allows).
+         *        File format is determined by the file extension given in the file name:
+         *          - pfm: 32-bit floating point values (Portable FloatMap), i.e., the exact depth values;
+         *          - png: 16-bit grey values, i.e., depth * 65535;
+         *          - other formats supported by save(): 8-bit grey values stored as RGB, i.e., depth * 255.
+         *
+         * \param file_name The file to which the depth map will be save.
+         * \param depths The depth values (in [0, 1] for the integer formats), 'height' rows of 'width' values.
+         * \param width The width of the depth map, in pixels.
+         * \param height The height of the depth map, in pixels.
+         * \param flip_vertically Flip the depth map vertically before writing.
+         *
+         * \return Return true on success or false if failed.
+         */
+        static bool save_depth(
+                const std::string& file_name,
+                const std::vector<float>& depths,
+                int width,
+                int height,
+                bool flip_vertically = false
+                );
+
+        /**
+         * \brief Load a depth map from a file written by save_depth(). For pfm files, the values are loaded
+         *        exactly. For other formats, the first channel is scaled to [0, 1].
+         *
+         * \param file_name The file to load.
+         * \param depths Outputs the depth values, 'height' rows of 'width' values.
+         * \param width Outputs the width of the depth map in pixels.
+         * \param height Outputs the height of the depth map in pixels.
+         * \param flip_vertically Flip the depth map vertically if it is true, so the first value is the bottom left.
+         *
+         * \return true on success or false if failed.
+         */
+        static bool load_depth(
+                const std::string& file_name,
+                std::vector<float>& depths,
+                int& width,
+                int& height,
+                bool flip_vertically = false
+                );
+
     };
 
 
@@ -0,0 +1,511 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/image_io_png.h>
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace internal {
+
+            // A compressed strip: the complete bytes plus the bits left in the last (incomplete) byte.
+            struct CompressedStrip {
+                std::vector<unsigned char> bytes;
+                unsigned int tail_bits;
+                int tail_count;
+                unsigned int adler;
+                std::size_t raw_size;
+            };
+
+
+            class BitWriter {
+            public:
+                explicit BitWriter(std::vector<unsigned char>& out) : out_(out), buffer_(0), count_(0) {}
+                inline void add(unsigned int value, int num_bits) {
+                    buffer_ |= value << count_;
+                    count_ += num_bits;
+                    while (count_ >= 8) {
+                        out_.push_back(static_cast<unsigned char>(buffer_ & 0xff));
+                        buffer_ >>= 8;
+                        count_ -= 8;
+                    }
+                }
+                unsigned int buffer() const { return buffer_; }
+                int count() const { return count_; }
+            private:
+                std::vector<unsigned char>& out_;
+                unsigned int buffer_;
+                int count_;
+            };
+
+
+            inline unsigned int reverse_bits(unsigned int code, int num_bits) {
+                unsigned int result = 0;
+                for (int i = 0; i < num_bits; ++i) {
+                    result = (result << 1) | (code & 1);
+                    code >>= 1;
+                }
+                return result;
+            }
+
+
+            // writes a literal/length symbol using the fixed Huffman codes of the deflate format (RFC 1951, 3.2.6)
+            inline void add_fixed_symbol(BitWriter& writer, unsigned int symbol) {
+                if (symbol <= 143)
+                    writer.add(reverse_bits(0x30 + symbol, 8), 8);
+                else if (symbol <= 255)
+                    writer.add(reverse_bits(0x190 + symbol - 144, 9), 9);
+                else if (symbol <= 279)
+                    writer.add(reverse_bits(symbol - 256, 7), 7);
+                else
+                    writer.add(reverse_bits(0xc0 + symbol - 280, 8), 8);
+            }
+
+
+            unsigned int adler32(const unsigned char* data, std::size_t size) {
+                const unsigned int base = 65521;
+                unsigned int s1 = 1, s2 = 0;
+                while (size > 0) {
+                    const std::size_t block = std::min<std::size_t>(size, 5552);
+                    for (std::size_t i = 0; i < block; ++i) {
+                        s1 += data[i];
+                        s2 += s1;
+                    }
+                    s1 %= base;
+                    s2 %= base;
+                    data += block;
+                    size -= block;
+                }
+                return (s2 << 16) | s1;
+            }
+
+
+            // the Adler-32 of the concatenation of two byte sequences (the same as adler32_combine() of zlib)
+            unsigned int adler32_combine(unsigned int adler1, unsigned int adler2, std::size_t size2) {
+                const unsigned long long base = 65521;
+                const unsigned long long rem = size2 % base;
+                unsigned long long sum1 = adler1 & 0xffff;
+                unsigned long long sum2 = (rem * sum1) % base;
+                sum1 += (adler2 & 0xffff) + base - 1;
+                sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+                if (sum1 >= base) sum1 -= base;
+                if (sum1 >= base) sum1 -= base;
+                if (sum2 >= (base << 1)) sum2 -= (base << 1);
+                if (sum2 >= base) sum2 -= base;
+                return static_cast<unsigned int>(sum1 | (sum2 << 16));
+            }
+
+
+            unsigned int crc32(unsigned int crc, const unsigned char* data, std::size_t size) {
+                static unsigned int table[256] = {0};
+                static const bool initialized = []() {
+                    for (unsigned int i = 0; i < 256; ++i) {
+                        unsigned int c = i;
+                        for (int k = 0; k < 8; ++k)
+                            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : (c >> 1);
+                        table[i] = c;
+                    }
+                    return true;
+                }();
+                (void) initialized;
+
+                crc = ~crc;
+                for (std::size_t i = 0; i < size; ++i)
+                    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+                return ~crc;
+            }
+
+
+            inline int paeth(int a, int b, int c) {
+                const int p = a + b - c;
+                const int pa = std::abs(p - a);
+                const int pb = std::abs(p - b);
+                const int pc = std::abs(p - c);
+                if (pa <= pb && pa <= pc) return a;
+                if (pb <= pc) return b;
+                return c;
+            }
+
+
+            // Filters a row with each of the five PNG filters and keeps the one with the smallest sum of absolute
+            // (signed) differences. The result (filter type followed by the filtered bytes) is appended to 'out'.
+            void filter_row(const unsigned char* row, const unsigned char* prev, int row_bytes, int bpp,
+                            std::vector<unsigned char>& candidate, std::vector<unsigned char>& out)
+            {
+                std::size_t best_offset = out.size();
+                long best_sum = -1;
+                out.resize(best_offset + row_bytes + 1);
+
+                candidate.resize(row_bytes);
+                for (int type = 0; type < 5; ++type) {
+                    long sum = 0;
+                    for (int i = 0; i < row_bytes; ++i) {
+                        const int a = (i >= bpp) ? row[i - bpp] : 0;
+                        const int b = prev[i];
+                        const int c = (i >= bpp) ? prev[i - bpp] : 0;
+                        int predictor = 0;
+                        switch (type) {
+                            case 0: predictor = 0; break;
+                            case 1: predictor = a; break;
+                            case 2: predictor = b; break;
+                            case 3: predictor = (a + b) >> 1; break;
+                            default: predictor = paeth(a, b, c); break;
+                        }
+                        const unsigned char v = static_cast<unsigned char>(row[i] - predictor);
+                        candidate[i] = v;
+                        sum += std::abs(static_cast<signed char>(v));
+                    }
+                    if (best_sum < 0 || sum < best_sum) {
+                        best_sum = sum;
+                        out[best_offset] = static_cast<unsigned char>(type);
+                        std::memcpy(out.data() + best_offset + 1, candidate.data(), row_bytes);
+                    }
+                }
+            }
+
+
+            // Compresses the data into a single non-final deflate block using the fixed Huffman codes, LZ77 with
+            // hash chains, and lazy matching. Since each block is self-contained, blocks can be concatenated.
+            void compress_block(const unsigned char* data, int size, CompressedStrip& strip) {
+                static const int length_base[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+                                                  51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258, 259};
+                static const int length_extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4,
+                                                   4, 4, 4, 5, 5, 5, 5, 0};
+                static const int dist_base[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+                                                385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+                                                16385, 24577, 32769};
+                static const int dist_extra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9,
+                                                 10, 10, 11, 11, 12, 12, 13, 13};
+
+                const int window_size = 32768;
+                const int window_mask = window_size - 1;
+                const int hash_bits = 15;
+                const int max_chain = 64;
+                const int max_match = 258;
+                const int good_match = 32;   // matches at least this long are taken without lazy evaluation
+
+                strip.bytes.clear();
+                strip.bytes.reserve(size / 2 + 64);
+                BitWriter writer(strip.bytes);
+                writer.add(0, 1);   // BFINAL: not the last block
+                writer.add(1, 2);   // BTYPE: fixed Huffman codes
+
+                std::vector<int> head(1 << hash_bits, -1);
+                std::vector<int> prev(window_size, -1);
+                auto hash = [data](int i) -> unsigned int {
+                    const unsigned int v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+                    return (v * 2654435761u) >> (32 - hash_bits);
+                };
+                auto find_match = [&](int i, unsigned int h, int& best_dist) -> int {
+                    const int limit = std::min(max_match, size - i);
+                    int best_len = 0;
+                    int candidate = head[h];
+                    for (int chain = 0; candidate >= 0 && chain < max_chain; ++chain) {
+                        const int dist = i - candidate;
+                        if (dist > window_size)
+                            break;
+                        if (data[candidate + best_len] == data[i + best_len]) {
+                            int len = 0;
+                            while (len < limit && data[candidate + len] == data[i + len])
+                                ++len;
+                            if (len > best_len) {
+                                best_len = len;
+                                best_dist = dist;
+                                if (len == limit)
+                                    break;
+                            }
+                        }
+                        candidate = prev[candidate & window_mask];
+                    }
+                    return best_len;
+                };
+                auto insert = [&](int i, unsigned int h) {
+                    prev[i & window_mask] = head[h];
+                    head[h] = i;
+                };
+
+                int i = 0;
+                while (i < size) {
+                    int best_len = 0, best_dist = 0;
+                    if (i + 3 <= size) {
+                        const unsigned int h = hash(i);
+                        best_len = find_match(i, h, best_dist);
+                        insert(i, h);
+                        if (best_len >= 3 && best_len < good_match && i + 4 <= size) {
+                            int next_dist = 0;
+                            if (find_match(i + 1, hash(i + 1), next_dist) > best_len)
+                                best_len = 0;   // emit a literal and take the longer match at the next position
+                        }
+                    }
+
+                    if (best_len >= 3) {
+                        int k = 0;
+                        while (length_base[k + 1] <= best_len) ++k;
+                        add_fixed_symbol(writer, 257 + k);
+                        if (length_extra[k])
+                            writer.add(best_len - length_base[k], length_extra[k]);
+
+                        int d = 0;
+                        while (dist_base[d + 1] <= best_dist) ++d;
+                        writer.add(reverse_bits(d, 5), 5);
+                        if (dist_extra[d])
+                            writer.add(best_dist - dist_base[d], dist_extra[d]);
+
+                        for (int j = 1; j < best_len; ++j) {
+                            if (i + j + 3 <= size)
+                                insert(i + j, hash(i + j));
+                        }
+                        i += best_len;
+                    } else {
+                        add_fixed_symbol(writer, data[i]);
+                        ++i;
+                    }
+                }
+                add_fixed_symbol(writer, 256);  // end of block
+
+                strip.tail_bits = writer.buffer();
+                strip.tail_count = writer.count();
+            }
+
+        }
+
+
+        StripedPngWriter::StripedPngWriter()
+                : file_(nullptr), width_(0), height_(0), channels_(0), bytes_per_pixel_(0), rows_written_(0), failed_(false)
+                , bit_buffer_(0), bit_count_(0), adler_(1)
+        {
+        }
+
+
+        StripedPngWriter::~StripedPngWriter() {
+            if (file_)
+                close();
+        }
+
+
+        bool StripedPngWriter::open(const std::string &file_name, int width, int height, int channels, int bit_depth) {
+            if (file_) {
+                LOG(ERROR) << "the writer is still writing to another file: " << file_name_;
+                return false;
+            }
+            if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+                LOG(ERROR) << "invalid image size or number of channels (" << width << " x " << height << " x "
+                           << channels << ")";
+                return false;
+            }
+            if (bit_depth != 8 && bit_depth != 16) {
+                LOG(ERROR) << "unsupported bit depth: " << bit_depth << " (must be 8 or 16)";
+                return false;
+            }
+
+            file_ = fopen(file_name.c_str(), "wb");
+            if (!file_) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return false;
+            }
+
+            file_name_ = file_name;
+            width_ = width;
+            height_ = height;
+            channels_ = channels;
+            bytes_per_pixel_ = channels * bit_depth / 8;
+            rows_written_ = 0;
+            failed_ = false;
+            previous_row_.assign(static_cast<std::size_t>(width) * bytes_per_pixel_, 0);
+            idat_.clear();
+            bit_buffer_ = 0;
+            bit_count_ = 0;
+            adler_ = 1;
+
+            static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+            if (fwrite(signature, 1, 8, file_) != 8)
+                failed_ = true;
+
+            static const unsigned char color_types[5] = {0, 0, 4, 2, 6};
+            unsigned char header[13] = {
+                    static_cast<unsigned char>(width >> 24), static_cast<unsigned char>(width >> 16),
+                    static_cast<unsigned char>(width >> 8), static_cast<unsigned char>(width),
+                    static_cast<unsigned char>(height >> 24), static_cast<unsigned char>(height >> 16),
+                    static_cast<unsigned char>(height >> 8), static_cast<unsigned char>(height),
+                    static_cast<unsigned char>(bit_depth),
+                    color_types[channels],
+                    0, 0, 0 // compression, filter, and interlace methods
+            };
+            write_chunk("IHDR", header, 13);
+
+            // the zlib header: deflate with a 32K window, default compression level
+            idat_.push_back(0x78);
+            idat_.push_back(0x5e);
+            return !failed_;
+        }
+
+
+        bool StripedPngWriter::write_rows(const unsigned char *data, int num_rows) {
+            if (!file_) {
+                LOG(ERROR) << "no file is open for writing";
+                return false;
+            }
+            if (rows_written_ + num_rows > height_) {
+                LOG(ERROR) << "too many rows (" << rows_written_ + num_rows << ") for image height " << height_;
+                failed_ = true;
+                return false;
+            }
+            if (num_rows <= 0)
+                return true;
+
+            const int row_bytes = width_ * bytes_per_pixel_;
+            // strips of roughly 256 KB keep all cores busy while still giving LZ77 enough context
+            const int strip_rows = std::max(1, (256 * 1024) / (row_bytes + 1));
+            const int num_strips = (num_rows + strip_rows - 1) / strip_rows;
+            std::vector<internal::CompressedStrip> strips(num_strips);
+
+#pragma omp parallel for schedule(dynamic)
+            for (int s = 0; s < num_strips; ++s) {
+                const int first = s * strip_rows;
+                const int last = std::min(num_rows, first + strip_rows);
+
+                std::vector<unsigned char> filtered, candidate;
+                filtered.reserve(static_cast<std::size_t>(last - first) * (row_bytes + 1));
+                for (int r = first; r < last; ++r) {
+                    const unsigned char* row = data + static_cast<std::size_t>(r) * row_bytes;
+                    const unsigned char* prev = (r == 0) ? previous_row_.data() : row - row_bytes;
+                    internal::filter_row(row, prev, row_bytes, bytes_per_pixel_, candidate, filtered);
+                }
+
+                internal::CompressedStrip& strip = strips[s];
+                strip.raw_size = filtered.size();
+                strip.adler = internal::adler32(filtered.data(), filtered.size());
+                internal::compress_block(filtered.data(), static_cast<int>(filtered.size()), strip);
+            }
+
+            for (const auto& strip : strips) {
+                write_bits(strip.bytes, strip.tail_bits, strip.tail_count);
+                adler_ = internal::adler32_combine(adler_, strip.adler, strip.raw_size);
+                flush_idat(false);
+            }
+
+            std::memcpy(previous_row_.data(), data + static_cast<std::size_t>(num_rows - 1) * row_bytes, row_bytes);
+            rows_written_ += num_rows;
+            return !failed_;
+        }
+
+
+        bool StripedPngWriter::close() {
+            if (!file_)
+                return false;
+
+            if (rows_written_ != height_) {
+                LOG(ERROR) << "incomplete image: " << rows_written_ << " of " << height_ << " rows written";
+                failed_ = true;
+            }
+
+            // an empty final block (BFINAL = 1, fixed Huffman codes, end-of-block code), then pad to a byte
+            std::vector<unsigned char> final_block;
+            write_bits(final_block, 0x3, 3);
+            write_bits(final_block, 0x0, 7);
+            if (bit_count_ > 0)
+                write_bits(final_block, 0x0, 8 - bit_count_);
+
+            idat_.push_back(static_cast<unsigned char>(adler_ >> 24));
+            idat_.push_back(static_cast<unsigned char>(adler_ >> 16));
+            idat_.push_back(static_cast<unsigned char>(adler_ >> 8));
+            idat_.push_back(static_cast<unsigned char>(adler_));
+            flush_idat(true);
+            write_chunk("IEND", nullptr, 0);
+
+            if (fclose(file_) != 0)
+                failed_ = true;
+            file_ = nullptr;
+
+            if (failed_)
+                LOG(ERROR) << "failed writing image file: " << file_name_;
+            return !failed_;
+        }
+
+
+        void StripedPngWriter::write_bits(const std::vector<unsigned char>& bytes, unsigned int tail_bits, int tail_count) {
+            if (bit_count_ == 0)
+                idat_.insert(idat_.end(), bytes.begin(), bytes.end());
+            else {
+                for (auto b : bytes) {
+                    bit_buffer_ |= static_cast<unsigned int>(b) << bit_count_;
+                    idat_.push_back(static_cast<unsigned char>(bit_buffer_ & 0xff));
+                    bit_buffer_ >>= 8;
+                }
+            }
+
+            bit_buffer_ |= tail_bits << bit_count_;
+            bit_count_ += tail_count;
+            while (bit_count_ >= 8) {
+                idat_.push_back(static_cast<unsigned char>(bit_buffer_ & 0xff));
+                bit_buffer_ >>= 8;
+                bit_count_ -= 8;
+            }
+        }
+
+
+        void StripedPngWriter::write_chunk(const char *type, const unsigned char *data, std::size_t size) {
+            const unsigned char length[4] = {
+                    static_cast<unsigned char>(size >> 24), static_cast<unsigned char>(size >> 16),
+                    static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size)
+            };
+            unsigned int crc = internal::crc32(0, reinterpret_cast<const unsigned char*>(type), 4);
+            if (size > 0)
+                crc = internal::crc32(crc, data, size);
+            const unsigned char checksum[4] = {
+                    static_cast<unsigned char>(crc >> 24), static_cast<unsigned char>(crc >> 16),
+                    static_cast<unsigned char>(crc >> 8), static_cast<unsigned char>(crc)
+            };
+
+            bool ok = fwrite(length, 1, 4, file_) == 4 && fwrite(type, 1, 4, file_) == 4;
+            if (size > 0)
+                ok = ok && fwrite(data, 1, size, file_) == size;
+            ok = ok && fwrite(checksum, 1, 4, file_) == 4;
+            if (!ok)
+                failed_ = true;
+        }
+
+
+        void StripedPngWriter::flush_idat(bool force) {
+            // data is written in chunks of about 1 MB, so memory use does not grow with the image size
+            const std::size_t chunk_size = 1024 * 1024;
+            if (idat_.size() >= chunk_size || (force && !idat_.empty())) {
+                write_chunk("IDAT", idat_.data(), idat_.size());
+                idat_.clear();
+            }
+        }
+
+    }
+
+}
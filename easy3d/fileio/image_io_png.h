@@ -0,0 +1,114 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_FILEIO_IMAGE_IO_PNG_H
+#define EASY3D_FILEIO_IMAGE_IO_PNG_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        /**
+         * \brief Writes a PNG image strip by strip, so the full image never needs to be in memory.
+         * \class StripedPngWriter easy3d/fileio/image_io_png.h
+         *
+         * \details Rows are given top to bottom in one or more calls to write_rows(). Each call splits its rows
+         *      into strips, which are filtered and compressed in parallel (if OpenMP is available). Each strip is
+         *      compressed on its own into a deflate block, and the blocks are joined into the single zlib stream
+         *      that PNG requires. Matches therefore never cross strip boundaries, which costs a little compression.
+         *      Example usage:
+         *      \code
+         *          io::StripedPngWriter writer;
+         *          writer.open("poster.png", width, height, 4);
+         *          for (each band of rows)
+         *              writer.write_rows(band.data(), band_height);
+         *          writer.close();
+         *      \endcode
+         */
+        class StripedPngWriter {
+        public:
+            StripedPngWriter();
+            /// Destructor. It closes the file if close() has not been called.
+            ~StripedPngWriter();
+
+            /**
+             * \brief Creates the file and writes the PNG header.
+             * \param channels The number of channels: 1 (grey), 2 (grey, alpha), 3 (RGB), or 4 (RGBA).
+             * \param bit_depth The number of bits per channel: 8 or 16. 16-bit samples are given in big-endian
+             *      byte order (as stored in PNG files).
+             */
+            bool open(const std::string& file_name, int width, int height, int channels, int bit_depth = 8);
+
+            /**
+             * \brief Appends rows to the image.
+             * \param data The pixels of \p num_rows rows, stored top to bottom without padding.
+             */
+            bool write_rows(const unsigned char* data, int num_rows);
+
+            /**
+             * \brief Finishes the compressed stream and closes the file.
+             * \return true if all rows have been written successfully.
+             */
+            bool close();
+
+            /// Returns whether a file is open for writing.
+            bool is_open() const { return file_ != nullptr; }
+
+            /// Returns the number of rows written so far.
+            int num_rows_written() const { return rows_written_; }
+
+        private:
+            void write_bits(const std::vector<unsigned char>& bytes, unsigned int tail_bits, int tail_count);
+            void write_chunk(const char* type, const unsigned char* data, std::size_t size);
+            void flush_idat(bool force);
+
+        private:
+            FILE* file_;
+            std::string file_name_;
+            int width_;
+            int height_;
+            int channels_;
+            int bytes_per_pixel_;
+            int rows_written_;
+            bool failed_;
+
+            std::vector<unsigned char> previous_row_;   // the last row written (for filtering the next row)
+            std::vector<unsigned char> idat_;           // compressed data waiting to be written as an IDAT chunk
+            unsigned int bit_buffer_;                   // pending bits of the compressed stream
+            int bit_count_;
+            unsigned int adler_;                        // checksum of the uncompressed (filtered) data
+        };
+
+    }
+
+}
+
+#endif  // EASY3D_FILEIO_IMAGE_IO_PNG_H
@@ -43,11 +43,37 @@ namespace easy3d {
             : Picker(cam)
             , program_(nullptr)
             , hit_resolution_(15)
+            , use_spatial_index_(true)
+            , index_version_(0)
     {
         use_gpu_if_supported_ = true;
     }
 
 
+    void PointCloudPicker::set_spatial_index_enabled(bool b) {
+        use_spatial_index_ = b;
+        if (!b) {
+            index_.clear();
+            index_version_ = 0;
+        }
+    }
+
+
+    const point_projection::BlockIndex *PointCloudPicker::spatial_index(PointCloud *model) {
+        if (!use_spatial_index_)
+            return nullptr;
+
+        // Property versions are unique across all models, so a version also identifies the model. Code modifying the
+        // points in place (through operator[] or vector()) must call notify_modified() to invalidate the index.
+        auto points = model->get_vertex_property<vec3>("v:point");
+        if (index_version_ != points.version() || index_.num_points() != points.vector().size()) {
+            index_.build(points.vector().data(), points.vector().size());
+            index_version_ = points.version();
+        }
+        return &index_;
+    }
+
+
     PointCloud::Vertex PointCloudPicker::pick_vertex(PointCloud* model, int x, int y) {
         auto drawable = model->renderer()->get_points_drawable("vertices");
         if (!drawable)
@@ -89,47 +115,24 @@ namespace easy3d {
 
     PointCloud::Vertex PointCloudPicker::pick_vertex_cpu(PointCloud* model, int px, int py) {
         const std::vector<vec3>& points = model->points();
-        std::size_t num = points.size();
-
-        std::vector<char> status(num, 0);
-        std::vector<float> sqr_dist_to_near(num, FLT_MAX);
 
         const Line3& line = picking_line(px, py);
         const vec3& p_near = line.point();
 
-        const auto sqr_dist_thresh = static_cast<float>(hit_resolution_ * hit_resolution_);
+        // the screen point in normalized screen coordinates, and the scale converting them into pixels
+        const float w = static_cast<float>(camera()->screenWidth() - 1);
+        const float h = static_cast<float>(camera()->screenHeight() - 1);
+        const vec2 center(static_cast<float>(px) / w, 1.0f - static_cast<float>(py) / h);
+
         // Get combined model-view and projection matrix
         const mat4& MVP = camera()->modelViewProjectionMatrix();
         // transformation introduced by manipulation
         const mat4 MANIP = model->manipulator() ? model->manipulator()->matrix() : mat4::identity();
         const mat4& m = MVP * MANIP;
 
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i) {
-            const vec3& p = points[i];
-            float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
-            float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
-            //float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]; // I don't need z
-            float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
-            x /= w;
-            y /= w;
-            x = 0.5f * x + 0.5f;
-            y = 0.5f * y + 0.5f;
-            if (distance2(vec2(x, y), vec2(static_cast<float>(px), static_cast<float>(py))) < sqr_dist_thresh) {
-                status[i] = 1;
-                sqr_dist_to_near[i] = distance2(p, p_near);
-            }
-        }
-
-        int idx = -1;
-        float min_s_dist = FLT_MAX;
-        for (int i = 0; i < num; ++i) {
-            if (status[i] == 1 && sqr_dist_to_near[i] < min_s_dist) {
-                min_s_dist = sqr_dist_to_near[i];
-                idx = i;
-            }
-        }
-
+        const int idx = point_projection::pick_nearest(points.data(), points.size(), m, center, vec2(w, h),
+                                                       static_cast<float>(hit_resolution_), p_near,
+                                                       spatial_index(model));
         return PointCloud::Vertex(idx);
     }
 
@@ -166,6 +169,7 @@ namespace easy3d {
 
         const mat4 MANIP = model->manipulator() ? model->manipulator()->matrix() : mat4::identity();
         program_->bind();
+        drawable->set_attribute_decoding_uniforms(program_, false);
         program_->set_uniform("MVP", camera()->modelViewProjectionMatrix())
                 ->set_uniform("MANIP", MANIP);
         drawable->gl_draw();
@@ -232,6 +236,7 @@ namespace easy3d {
 
         const mat4 MANIP = model->manipulator() ? model->manipulator()->matrix() : mat4::identity();
         program_->bind();
+        drawable->set_attribute_decoding_uniforms(program_, false);
         program_->set_uniform("perspective", camera()->type() == Camera::PERSPECTIVE);
         program_->set_uniform("MV", camera_->modelViewMatrix());
         program_->set_uniform("PROJ", camera_->projectionMatrix());
@@ -287,29 +292,16 @@ namespace easy3d {
         if (ymin > ymax) std::swap(ymin, ymax);
 
         const auto &points = model->get_vertex_property<vec3>("v:point").vector();
-        int num = static_cast<int>(points.size());
         const mat4 MANIP = model->manipulator() ? model->manipulator()->matrix() : mat4::identity();
         const mat4 &m = camera()->modelViewProjectionMatrix() * MANIP;
 
         auto &select = model->vertex_property<bool>("v:select").vector();
 
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i) {
-            const vec3 &p = points[i];
-            float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
-            float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
-            //float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]; // I don't need z
-            float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
-            x /= w;
-            y /= w;
-            x = 0.5f * x + 0.5f;
-            y = 0.5f * y + 0.5f;
-
-            if (x >= xmin && x <= xmax && y >= ymin && y <= ymax)
-                select[i] = !deselect;
-        }
-
-        auto count = std::count(select.begin(), select.end(), true);
+        Box2 region;
+        region.grow(vec2(xmin, ymin));
+        region.grow(vec2(xmax, ymax));
+        const std::size_t count = point_projection::select_in_rect(points.data(), points.size(), m, region, !deselect,
+                                                                   select, spatial_index(model));
         LOG(INFO) << "current selection: " << count << " points";
     }
 
@@ -329,40 +321,14 @@ namespace easy3d {
             region.emplace_back(vec2(x, y));
         }
 
-        const Box2& box = plg.bbox();
-        float xmin = box.min_point().x / static_cast<float>(win_width - 1);
-        float ymin = 1.0f - box.min_point().y / static_cast<float>(win_height - 1);
-        float xmax = box.max_point().x / static_cast<float>(win_width - 1);
-        float ymax = 1.0f - box.max_point().y / static_cast<float>(win_height - 1);
-        if (xmin > xmax) std::swap(xmin, xmax);
-        if (ymin > ymax) std::swap(ymin, ymax);
-
         const auto &points = model->get_vertex_property<vec3>("v:point").vector();
-        int num = static_cast<int>(points.size());
         const mat4 MANIP = model->manipulator() ? model->manipulator()->matrix() : mat4::identity();
         const mat4 &m = camera()->modelViewProjectionMatrix() * MANIP;
 
         auto& select = model->vertex_property<bool>("v:select").vector();
 
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i) {
-            const vec3 &p = points[i];
-            float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
-            float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
-            //float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]; // I don't need z
-            float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
-            x /= w;
-            y /= w;
-            x = 0.5f * x + 0.5f;
-            y = 0.5f * y + 0.5f;
-
-            if (x >= xmin && x <= xmax && y >= ymin && y <= ymax) {
-                if (geom::point_in_polygon(vec2(x, y), region))
-                    select[i] = !deselect;
-            }
-        }
-
-        auto count = std::count(select.begin(), select.end(), true);
+        const std::size_t count = point_projection::select_in_polygon(points.data(), points.size(), m, region,
+                                                                      !deselect, select, spatial_index(model));
         LOG(INFO) << "current selection: " << count << " points";
     }
 
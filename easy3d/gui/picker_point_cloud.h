@@ -30,6 +30,7 @@
 
 #include <easy3d/gui/picker.h>
 #include <easy3d/core/point_cloud.h>
+#include <easy3d/core/point_projection.h>
 
 
 namespace easy3d {
@@ -54,6 +55,15 @@ namespace easy3d {
         ///     the CPU implementation of picking a single point.
         void set_resolution(unsigned int r) { hit_resolution_ = r; }
 
+        /// \brief Returns whether a coarse spatial index is used to accelerate the CPU implementations.
+        bool spatial_index_enabled() const { return use_spatial_index_; }
+        /// \brief Enables/Disables the coarse spatial index (enabled by default).
+        /// \details The index stores the bounding boxes of blocks of consecutive points, which allows rejecting
+        ///     (or accepting) whole blocks of points. It is built on the first use and rebuilt when the version of
+        ///     the "v:point" property has changed, so code modifying the points in place must call notify_modified()
+        ///     on the property. \see point_projection::BlockIndex
+        void set_spatial_index_enabled(bool b);
+
         /**
          * @brief Pick vertex at a given screen location.
          * @param (x, y) The screen point.
@@ -88,9 +98,16 @@ namespace easy3d {
         // pick sphere points implemented in GPU (using shader program)
         PointCloud::Vertex pick_vertex_gpu_sphere(PointCloud *model, int x, int y);
 
+        // returns the spatial index for the points of the model (nullptr if disabled)
+        const point_projection::BlockIndex *spatial_index(PointCloud *model);
+
     private:
         unsigned int hit_resolution_;     // in pixels
         ShaderProgram*	 program_;
+
+        bool use_spatial_index_;
+        point_projection::BlockIndex index_;
+        std::size_t index_version_;   // version of the "v:point" property the index was built for
     };
 
 }
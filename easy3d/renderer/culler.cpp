@@ -0,0 +1,215 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/renderer/culler.h>
+
+#include <algorithm>
+
+#include <easy3d/renderer/camera.h>
+
+
+namespace easy3d {
+
+    namespace internal {
+        // the max number of boxes in a leaf node
+        const int max_leaf_size = 4;
+    }
+
+
+    Culler::Culler()
+            : frustum_culling_(true)
+            , min_screen_size_(0.0f)
+    {
+    }
+
+
+    void Culler::clear() {
+        nodes_.clear();
+        items_.clear();
+        boxes_.clear();
+        always_visible_.clear();
+    }
+
+
+    void Culler::build(const std::vector<Box3> &boxes) {
+        clear();
+        boxes_ = boxes;
+
+        std::vector<vec3> centers(boxes.size());
+        items_.reserve(boxes.size());
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes[i].is_valid()) {
+                items_.push_back(static_cast<int>(i));
+                centers[i] = boxes[i].center();
+            }
+            else
+                always_visible_.push_back(static_cast<int>(i));
+        }
+
+        if (!items_.empty()) {
+            nodes_.reserve(2 * items_.size() / internal::max_leaf_size + 1);
+            build_node(0, static_cast<int>(items_.size()), centers, 0);
+        }
+    }
+
+
+    int Culler::build_node(int first, int count, std::vector<vec3> &centers, int depth) {
+        const int index = static_cast<int>(nodes_.size());
+        nodes_.push_back(Node());
+
+        Box3 box, center_box;
+        for (int i = first; i < first + count; ++i) {
+            box.grow(boxes_[items_[i]]);
+            center_box.grow(centers[items_[i]]);
+        }
+
+        Node node;
+        node.box = box;
+        node.first = first;
+        node.count = count;
+        node.left = -1;
+        node.right = -1;
+
+        if (count > internal::max_leaf_size && depth < 64) {
+            // split at the median of the longest axis of the centers
+            unsigned int axis = 0;
+            for (unsigned int k = 1; k < 3; ++k) {
+                if (center_box.range(k) > center_box.range(axis))
+                    axis = k;
+            }
+            const int half = count / 2;
+            std::nth_element(items_.begin() + first, items_.begin() + first + half, items_.begin() + first + count,
+                             [&](int a, int b) -> bool { return centers[a][axis] < centers[b][axis]; }
+            );
+            node.left = build_node(first, half, centers, depth + 1);
+            node.right = build_node(first + half, count - half, centers, depth + 1);
+        }
+
+        nodes_[index] = node;
+        return index;
+    }
+
+
+    Culler::Visibility Culler::test_frustum(const Box3 &box, const vec4 planes[6], unsigned int &mask) const {
+        const vec3 &bmin = box.min_point();
+        const vec3 &bmax = box.max_point();
+        for (int i = 0; i < 6; ++i) {
+            const unsigned int bit = 1u << i;
+            if (!(mask & bit))
+                continue;   // the parent is completely on the inner side of this plane
+            const vec4 &p = planes[i];
+            // the corners of the box farthest along and against the plane normal
+            const vec3 far_corner(p.x > 0 ? bmax.x : bmin.x, p.y > 0 ? bmax.y : bmin.y, p.z > 0 ? bmax.z : bmin.z);
+            if (p.x * far_corner.x + p.y * far_corner.y + p.z * far_corner.z + p.w < 0)
+                return OUTSIDE;
+            const vec3 near_corner(p.x > 0 ? bmin.x : bmax.x, p.y > 0 ? bmin.y : bmax.y, p.z > 0 ? bmin.z : bmax.z);
+            if (p.x * near_corner.x + p.y * near_corner.y + p.z * near_corner.z + p.w >= 0)
+                mask &= ~bit;
+        }
+        return mask == 0 ? INSIDE : INTERSECTING;
+    }
+
+
+    bool Culler::is_too_small(const Box3 &box, const mat4 &mvp, int width, int height) const {
+        float xmin = max<float>(), ymin = max<float>();
+        float xmax = -max<float>(), ymax = -max<float>();
+        for (int i = 0; i < 8; ++i) {
+            const vec3 corner(
+                    (i & 1) ? box.max_coord(0) : box.min_coord(0),
+                    (i & 2) ? box.max_coord(1) : box.min_coord(1),
+                    (i & 4) ? box.max_coord(2) : box.min_coord(2)
+            );
+            const vec4 q = mvp * vec4(corner, 1.0f);
+            if (q.w <= epsilon<float>())
+                return false;   // the box crosses the plane of the camera, so it must be large
+            const float x = q.x / q.w, y = q.y / q.w;
+            xmin = std::min(xmin, x);
+            xmax = std::max(xmax, x);
+            ymin = std::min(ymin, y);
+            ymax = std::max(ymax, y);
+        }
+        // NDC [-1, 1] covers the full viewport
+        const float size = std::max((xmax - xmin) * 0.5f * width, (ymax - ymin) * 0.5f * height);
+        return size < min_screen_size_;
+    }
+
+
+    void Culler::cull(const mat4 &mvp, int width, int height, std::vector<int> &visible) const {
+        visible = always_visible_;
+        if (nodes_.empty())
+            return;
+
+        // extract the six planes of the frustum (pointing inwards) from the model view projection matrix
+        vec4 planes[6];
+        const vec4 row3 = mvp.row(3);
+        for (int i = 0; i < 3; ++i) {
+            const vec4 row = mvp.row(i);
+            planes[i * 2] = row3 + row;
+            planes[i * 2 + 1] = row3 - row;
+        }
+
+        const bool small_feature_culling = (min_screen_size_ > 0.0f && width > 0 && height > 0);
+
+        std::vector<std::pair<int, unsigned int> > stack;
+        stack.emplace_back(0, frustum_culling_ ? 0x3Fu : 0u);
+        while (!stack.empty()) {
+            const int index = stack.back().first;
+            unsigned int mask = stack.back().second;
+            stack.pop_back();
+
+            const Node &node = nodes_[index];
+            if (mask && test_frustum(node.box, planes, mask) == OUTSIDE)
+                continue;
+            // if the node is too small, all its children are too small
+            if (small_feature_culling && is_too_small(node.box, mvp, width, height))
+                continue;
+
+            if (node.left == -1) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    const int id = items_[i];
+                    unsigned int m = mask;
+                    if (m && test_frustum(boxes_[id], planes, m) == OUTSIDE)
+                        continue;
+                    if (small_feature_culling && is_too_small(boxes_[id], mvp, width, height))
+                        continue;
+                    visible.push_back(id);
+                }
+            }
+            else {
+                stack.emplace_back(node.left, mask);
+                stack.emplace_back(node.right, mask);
+            }
+        }
+
+        std::sort(visible.begin(), visible.end());
+    }
+
+
+    void Culler::cull(const Camera *camera, std::vector<int> &visible) const {
+        cull(camera->modelViewProjectionMatrix(), camera->screenWidth(), camera->screenHeight(), visible);
+    }
+
+}
@@ -0,0 +1,121 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_RENDERER_CULLER_H
+#define EASY3D_RENDERER_CULLER_H
+
+
+#include <vector>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    class Camera;
+
+    /**
+     * \brief View-frustum and small-feature culling of a set of objects represented by their bounding boxes.
+     * \class Culler easy3d/renderer/culler.h
+     * \details The bounding boxes (in world coordinates) are organized in a bounding volume hierarchy, which allows to
+     *      reject a group of objects at once if their common bounding box is outside the view frustum or too small on
+     *      the screen. The culler does not require an OpenGL context and it does not know what the objects are. An
+     *      object is identified by the index of its bounding box given to build().
+     *      Usage example:
+     *      \code
+     *          Culler culler;
+     *          culler.build(boxes);    // rebuild only if the objects have changed
+     *          std::vector<int> visible;
+     *          culler.cull(camera, visible);
+     *          for (auto id : visible)
+     *              objects[id]->draw(camera);
+     *      \endcode
+     */
+    class Culler {
+    public:
+        Culler();
+
+        /// Enables/Disables view-frustum culling (enabled by default).
+        void set_frustum_culling(bool b) { frustum_culling_ = b; }
+        bool frustum_culling() const { return frustum_culling_; }
+
+        /// Sets the minimum screen size (in pixels) of an object to be visible. The size is measured by the larger
+        /// dimension of the projected bounding box. The default value 0 disables small-feature culling.
+        void set_min_screen_size(float pixels) { min_screen_size_ = pixels; }
+        float min_screen_size() const { return min_screen_size_; }
+
+        /// Builds the bounding volume hierarchy for a set of bounding boxes (in world coordinates). Invalid boxes are
+        /// considered to be always visible.
+        void build(const std::vector<Box3> &boxes);
+
+        /// Releases the hierarchy.
+        void clear();
+
+        /// Returns the number of the objects (i.e., boxes) managed by the culler.
+        std::size_t size() const { return boxes_.size(); }
+
+        /**
+         * \brief Collects the objects that are visible in a view.
+         * @param mvp The model view projection matrix defining the view frustum.
+         * @param width The width of the viewport (in pixels), used for small-feature culling.
+         * @param height The height of the viewport (in pixels), used for small-feature culling.
+         * @param visible Returns the indices of the visible objects (in increasing order).
+         */
+        void cull(const mat4 &mvp, int width, int height, std::vector<int> &visible) const;
+
+        /// Collects the objects that are visible from a camera.
+        /// This is an overload of the above cull() method.
+        void cull(const Camera *camera, std::vector<int> &visible) const;
+
+    private:
+        // the result of testing a box against the view.
+        enum Visibility { OUTSIDE, INTERSECTING, INSIDE };
+        Visibility test_frustum(const Box3 &box, const vec4 planes[6], unsigned int &mask) const;
+        bool is_too_small(const Box3 &box, const mat4 &mvp, int width, int height) const;
+
+        int build_node(int first, int count, std::vector<vec3> &centers, int depth);
+
+    private:
+        struct Node {
+            Box3 box;
+            int first;      // the first item (in items_)
+            int count;      // the number of items (including the ones in the children)
+            int left;       // the index of the left child (-1 for leaf nodes)
+            int right;      // the index of the right child (-1 for leaf nodes)
+        };
+        std::vector<Node> nodes_;
+        std::vector<int> items_;        // indices of the boxes, ordered by the nodes
+        std::vector<Box3> boxes_;
+        std::vector<int> always_visible_;
+
+        bool frustum_culling_;
+        float min_screen_size_;
+    };
+
+}
+
+
+#endif // EASY3D_RENDERER_CULLER_H
@@ -27,8 +27,11 @@
 #include <easy3d/renderer/drawable.h>
 
 #include <cassert>
+#include <algorithm>
 
 #include <easy3d/core/model.h>
+#include <easy3d/core/property.h>
+#include <easy3d/core/quantization.h>
 #include <easy3d/renderer/opengl.h>
 #include <easy3d/renderer/vertex_array_object.h>
 #include <easy3d/renderer/shader_program.h>
@@ -46,7 +49,7 @@ namespace easy3d {
     Drawable::Drawable(const std::string &name, Model *model)
             : name_(name), model_(model), vao_(nullptr), num_vertices_(0), num_indices_(0),
               update_needed_(false), update_func_(nullptr), vertex_buffer_(0), color_buffer_(0), normal_buffer_(0),
-              texcoord_buffer_(0), element_buffer_(0), manipulator_(nullptr) {
+              texcoord_buffer_(0), element_buffer_(0), compressed_attributes_(false), manipulator_(nullptr) {
         vao_ = new VertexArrayObject;
         material_ = Material(setting::material_ambient, setting::material_specular, setting::material_shininess);
     }
@@ -68,22 +71,27 @@ namespace easy3d {
 
 
     void Drawable::buffer_stats(std::ostream &output) const {
+        // the size of each element of the compressed buffers (see quantization)
+        const std::size_t vertex_size = compressed_attributes_ ? 4 * sizeof(unsigned short) : sizeof(vec3);
+        const std::size_t normal_size = compressed_attributes_ ? 2 * sizeof(short) : sizeof(vec3);
+        const std::size_t color_size = compressed_attributes_ ? 4 * sizeof(unsigned char) : sizeof(vec3);
+        const std::size_t texcoord_size = compressed_attributes_ ? 2 * sizeof(unsigned short) : sizeof(vec2);
         if (vertex_buffer()) {
-            output << "\t" << name() << std::endl;
+            output << "\t" << name() << (compressed_attributes_ ? " (compressed)" : "") << std::endl;
             output << "\t\tvertex buffer:     " << num_vertices_ << " vertices, "
-                   << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
+                   << num_vertices_ * vertex_size << " bytes" << std::endl;
         }
         if (normal_buffer()) {
             output << "\t\tnormal buffer:     " << num_vertices_ << " normals, "
-                   << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
+                   << num_vertices_ * normal_size << " bytes" << std::endl;
         }
         if (color_buffer()) {
             output << "\t\tcolor buffer:      " << num_vertices_ << " colors, "
-                   << num_vertices_ * sizeof(vec3) << " bytes" << std::endl;
+                   << num_vertices_ * color_size << " bytes" << std::endl;
         }
         if (texcoord_buffer()) {
             output << "\t\ttexcoord buffer:   " << num_vertices_ << " texcoords, "
-                   << num_vertices_ * sizeof(vec2) << " bytes" << std::endl;
+                   << num_vertices_ * texcoord_size << " bytes" << std::endl;
         }
         if (element_buffer()) {
             output << "\t\tindex buffer:      " << num_indices_ << " indices, "
@@ -108,6 +116,7 @@ namespace easy3d {
         num_vertices_ = 0;
         num_indices_ = 0;
         bbox_.clear();
+        tracked_properties_.clear();
     }
 
 
@@ -117,6 +126,73 @@ namespace easy3d {
     }
 
 
+    void Drawable::set_compressed_attributes(bool b) {
+        if (b && type() != DT_POINTS) {
+            LOG(WARNING) << "compressed attributes are supported only by PointsDrawable";
+            return;
+        }
+        if (b == compressed_attributes_)
+            return;
+
+        compressed_attributes_ = b;
+        if (model_ || update_func_)
+            update();
+    }
+
+
+    void Drawable::set_attribute_decoding_uniforms(ShaderProgram *program, bool with_normal) const {
+        const bool quantized = compressed_attributes_ && vertex_buffer_ != 0;
+        program->set_uniform("quantized_position", quantized)
+                ->set_uniform("position_offset", quantized ? quantization_box_.min_point() : vec3(0.0f))
+                ->set_uniform("position_scale", quantized ? quantization_box_.diagonal_vector() : vec3(1.0f));
+        if (with_normal)
+            program->set_uniform("octahedral_normal", compressed_attributes_ && normal_buffer_ != 0);
+    }
+
+
+    bool Drawable::upload_compressed(unsigned int attribute, unsigned int buffer, const void *data, std::size_t begin,
+                                     std::size_t end) {
+        // encodes and uploads the values in chunks of this number of elements
+        const std::size_t chunk_size = 1u << 20;
+        std::vector<unsigned char> encoded;
+        for (std::size_t first = begin; first < end; first += chunk_size) {
+            const std::size_t num = std::min(chunk_size, end - first);
+            std::size_t element_size = 0;
+            switch (attribute) {
+                case ShaderProgram::POSITION:
+                    element_size = 4 * sizeof(unsigned short);
+                    encoded.resize(num * element_size);
+                    quantization::quantize_positions(static_cast<const vec3 *>(data) + first, num, quantization_box_,
+                                                     reinterpret_cast<unsigned short *>(encoded.data()));
+                    break;
+                case ShaderProgram::NORMAL:
+                    element_size = 2 * sizeof(short);
+                    encoded.resize(num * element_size);
+                    quantization::encode_normals(static_cast<const vec3 *>(data) + first, num,
+                                                 reinterpret_cast<short *>(encoded.data()));
+                    break;
+                case ShaderProgram::COLOR:
+                    element_size = 4 * sizeof(unsigned char);
+                    encoded.resize(num * element_size);
+                    quantization::pack_colors(static_cast<const vec3 *>(data) + first, num, encoded.data());
+                    break;
+                case ShaderProgram::TEXCOORD:
+                    element_size = 2 * sizeof(unsigned short);
+                    encoded.resize(num * element_size);
+                    quantization::pack_texcoords(static_cast<const vec2 *>(data) + first, num,
+                                                 reinterpret_cast<unsigned short *>(encoded.data()));
+                    break;
+                default:
+                    return false;
+            }
+            if (!vao_->update_array_buffer(buffer, static_cast<GLintptr>(first * element_size),
+                                           static_cast<GLsizeiptr>(num * element_size), encoded.data()))
+                return false;
+        }
+        return true;
+    }
+
+
     void Drawable::update_buffers_internal() {
         if (!model_ && !update_func_) {
             LOG_N_TIMES(3, ERROR)
@@ -129,6 +205,7 @@ namespace easy3d {
         }
 
         StopWatch w;
+        tracked_properties_.clear();
         if (update_func_)
             update_func_(model_, this);
         else
@@ -139,11 +216,136 @@ namespace easy3d {
     }
 
 
+    template <typename T>
+    void Drawable::track_vertex_property(unsigned int attribute, const std::vector<T> &data) {
+        // forget the previous source of this buffer
+        tracked_properties_.erase(std::remove_if(tracked_properties_.begin(), tracked_properties_.end(),
+                                                 [attribute](const TrackedProperty &p) {
+                                                     return p.attribute == attribute;
+                                                 }), tracked_properties_.end());
+        if (!model_ || data.empty())
+            return;
+
+        std::vector<std::string> candidates;
+        switch (attribute) {
+            case ShaderProgram::POSITION: candidates = {"v:point"}; break;
+            case ShaderProgram::NORMAL: candidates = {"v:normal"}; break;
+            case ShaderProgram::COLOR: candidates = {property_name(), "v:color"}; break;
+            case ShaderProgram::TEXCOORD: candidates = {property_name(), "v:texcoord"}; break;
+            default: return;
+        }
+
+        for (const auto &name : candidates) {
+            const auto array = dynamic_cast<const PropertyArray<T> *>(model_->vertex_property_array(name));
+            if (array && array->vector().data() == data.data() && array->vector().size() == data.size()) {
+                tracked_properties_.push_back({attribute, name, array->version()});
+                return;
+            }
+        }
+    }
+
+
+    void Drawable::update_modified_buffers() {
+        if (!model_)
+            return;
+
+        for (auto &tracked : tracked_properties_) {
+            const BasePropertyArray *array = model_->vertex_property_array(tracked.name);
+            if (array && array->version() == tracked.version)
+                continue;
+
+            const void *data = nullptr;
+            std::size_t count = 0, element_size = 0;
+            if (auto a = dynamic_cast<const PropertyArray<vec3> *>(array)) {
+                data = a->vector().data();
+                count = a->vector().size();
+                element_size = sizeof(vec3);
+            } else if (auto b = dynamic_cast<const PropertyArray<vec2> *>(array)) {
+                data = b->vector().data();
+                count = b->vector().size();
+                element_size = sizeof(vec2);
+            }
+
+            unsigned int buffer = 0;
+            switch (tracked.attribute) {
+                case ShaderProgram::POSITION: buffer = vertex_buffer_; break;
+                case ShaderProgram::NORMAL: buffer = normal_buffer_; break;
+                case ShaderProgram::COLOR: buffer = color_buffer_; break;
+                case ShaderProgram::TEXCOORD: buffer = texcoord_buffer_; break;
+                default: break;
+            }
+
+            // the property has been removed or resized, or the buffer has gone: everything needs to be updated
+            if (!data || count != num_vertices_ || buffer == 0) {
+                update_buffers_internal();
+                return;
+            }
+
+            std::size_t begin = 0, end = count;
+            if (!array->modified_range(tracked.version, begin, end)) {
+                begin = 0;
+                end = count;
+            }
+            end = std::min(end, count);
+
+            if (compressed_attributes_) {
+                // the encoding expects vec2 texture coordinates and vec3 for the others
+                const std::size_t expected_size = (tracked.attribute == ShaderProgram::TEXCOORD) ? sizeof(vec2) : sizeof(vec3);
+                bool needs_full_update = (element_size != expected_size);
+                // modified points outside the quantization box require quantizing all points again
+                if (!needs_full_update && tracked.attribute == ShaderProgram::POSITION) {
+                    const vec3 *points = static_cast<const vec3 *>(data);
+                    const vec3 &bmin = quantization_box_.min_point();
+                    const vec3 &bmax = quantization_box_.max_point();
+                    for (std::size_t i = begin; i < end && !needs_full_update; ++i) {
+                        for (int a = 0; a < 3; ++a) {
+                            if (points[i][a] < bmin[a] || points[i][a] > bmax[a]) {
+                                needs_full_update = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (needs_full_update) {
+                    update_buffers_internal();
+                    return;
+                }
+                if (begin < end) {
+                    const bool success = upload_compressed(tracked.attribute, buffer, data, begin, end);
+                    LOG_IF(!success, ERROR) << "failed updating buffer for property '" << tracked.name << "'";
+                }
+            }
+            else if (begin < end) {
+                const bool success = vao_->update_array_buffer(
+                        buffer, static_cast<GLintptr>(begin * element_size),
+                        static_cast<GLsizeiptr>((end - begin) * element_size),
+                        static_cast<const char *>(data) + begin * element_size);
+                LOG_IF(!success, ERROR) << "failed updating buffer for property '" << tracked.name << "'";
+            }
+            tracked.version = array->version();
+
+            if (tracked.attribute == ShaderProgram::POSITION)
+                bbox_ = model_->bounding_box();
+        }
+    }
+
+
     void Drawable::update_vertex_buffer(const std::vector<vec3> &vertices, bool dynamic) {
         assert(vao_);
 
-        bool success = vao_->create_array_buffer(vertex_buffer_, ShaderProgram::POSITION, vertices.data(),
-                                                 vertices.size() * sizeof(vec3), 3, dynamic);
+        bool success = false;
+        if (compressed_attributes_) {
+            quantization_box_.clear();
+            for (const auto &p : vertices)
+                quantization_box_.grow(p);
+            success = vao_->create_array_buffer(vertex_buffer_, ShaderProgram::POSITION, nullptr,
+                                                vertices.size() * 4 * sizeof(unsigned short), 4, GL_UNSIGNED_SHORT,
+                                                true, dynamic) &&
+                      upload_compressed(ShaderProgram::POSITION, vertex_buffer_, vertices.data(), 0, vertices.size());
+        }
+        else
+            success = vao_->create_array_buffer(vertex_buffer_, ShaderProgram::POSITION, vertices.data(),
+                                                vertices.size() * sizeof(vec3), 3, dynamic);
 
         LOG_IF(!success, ERROR) << "failed creating vertex buffer";
 
@@ -151,6 +353,7 @@ namespace easy3d {
             num_vertices_ = 0;
         else {
             num_vertices_ = vertices.size();
+            track_vertex_property(ShaderProgram::POSITION, vertices);
 
             if (model())
                 bbox_ = model()->bounding_box();
@@ -167,26 +370,52 @@ namespace easy3d {
     void Drawable::update_color_buffer(const std::vector<vec3> &colors, bool dynamic) {
         assert(vao_);
 
-        bool success = vao_->create_array_buffer(color_buffer_, ShaderProgram::COLOR, colors.data(),
-                                                 colors.size() * sizeof(vec3), 3, dynamic);
+        bool success = false;
+        if (compressed_attributes_)
+            success = vao_->create_array_buffer(color_buffer_, ShaderProgram::COLOR, nullptr,
+                                                colors.size() * 4 * sizeof(unsigned char), 4, GL_UNSIGNED_BYTE, true,
+                                                dynamic) &&
+                      upload_compressed(ShaderProgram::COLOR, color_buffer_, colors.data(), 0, colors.size());
+        else
+            success = vao_->create_array_buffer(color_buffer_, ShaderProgram::COLOR, colors.data(),
+                                                colors.size() * sizeof(vec3), 3, dynamic);
         LOG_IF(!success, ERROR) << "failed updating color buffer";
+        if (success)
+            track_vertex_property(ShaderProgram::COLOR, colors);
     }
 
 
     void Drawable::update_normal_buffer(const std::vector<vec3> &normals, bool dynamic) {
         assert(vao_);
-        bool success = vao_->create_array_buffer(normal_buffer_, ShaderProgram::NORMAL, normals.data(),
-                                                 normals.size() * sizeof(vec3), 3, dynamic);
+        bool success = false;
+        if (compressed_attributes_)
+            success = vao_->create_array_buffer(normal_buffer_, ShaderProgram::NORMAL, nullptr,
+                                                normals.size() * 2 * sizeof(short), 2, GL_SHORT, true, dynamic) &&
+                      upload_compressed(ShaderProgram::NORMAL, normal_buffer_, normals.data(), 0, normals.size());
+        else
+            success = vao_->create_array_buffer(normal_buffer_, ShaderProgram::NORMAL, normals.data(),
+                                                normals.size() * sizeof(vec3), 3, dynamic);
         LOG_IF(!success, ERROR) << "failed updating normal buffer";
+        if (success)
+            track_vertex_property(ShaderProgram::NORMAL, normals);
     }
 
 
     void Drawable::update_texcoord_buffer(const std::vector<vec2> &texcoords, bool dynamic) {
         assert(vao_);
 
-        bool success = vao_->create_array_buffer(texcoord_buffer_, ShaderProgram::TEXCOORD, texcoords.data(),
-                                                 texcoords.size() * sizeof(vec2), 2, dynamic);
+        bool success = false;
+        if (compressed_attributes_)
+            success = vao_->create_array_buffer(texcoord_buffer_, ShaderProgram::TEXCOORD, nullptr,
+                                                texcoords.size() * 2 * sizeof(unsigned short), 2, GL_HALF_FLOAT, false,
+                                                dynamic) &&
+                      upload_compressed(ShaderProgram::TEXCOORD, texcoord_buffer_, texcoords.data(), 0, texcoords.size());
+        else
+            success = vao_->create_array_buffer(texcoord_buffer_, ShaderProgram::TEXCOORD, texcoords.data(),
+                                                texcoords.size() * sizeof(vec2), 2, dynamic);
         LOG_IF(!success, ERROR) << "failed updating texcoord buffer";
+        if (success)
+            track_vertex_property(ShaderProgram::TEXCOORD, texcoords);
     }
 
 
@@ -226,6 +455,8 @@ namespace easy3d {
             const_cast<Drawable *>(this)->update_buffers_internal();
             const_cast<Drawable *>(this)->update_needed_ = false;
         }
+        else if (!tracked_properties_.empty())
+            const_cast<Drawable *>(this)->update_modified_buffers();
 
 #ifndef NDEBUG
         LOG_IF_FIRST_N(1, num_indices_ > 0 && num_vertices_ == 0, ERROR)
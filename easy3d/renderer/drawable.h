@@ -40,6 +40,7 @@ namespace easy3d {
     class Camera;
     class Manipulator;
     class VertexArrayObject;
+    class ShaderProgram;
 
     /**
      * @brief The base class for drawable objects. A drawable represent a set of points, line segments, or triangles.
@@ -102,6 +103,9 @@ namespace easy3d {
          *  - Without an element buffer: easier data transfer, but uses more GPU memory. In this case, vertices need to
          *    be in a correct order, like f1_v1, f1_v2, f1_v3, f2_v1, f2_v2, f2_v3... This requires the shared vertices
          *    be duplicated in the vertex buffer.
+         * \note If the data of a buffer is directly the storage of a vertex property of the model (e.g., "v:point",
+         *    "v:normal"), the drawable tracks the modifications of the property and re-uploads only its modified
+         *    range before rendering (see BasePropertyArray::notify_modified()), without requiring update().
          */
         void update_vertex_buffer(const std::vector<vec3> &vertices, bool dynamic = false);
         void update_color_buffer(const std::vector<vec3> &colors, bool dynamic = false);
@@ -121,6 +125,31 @@ namespace easy3d {
         /// \note This method also releases the element buffer.
         void disable_element_buffer();
 
+        /**
+         * \brief Enables/Disables the compact encodings of the vertex attributes.
+         * \details With compression, positions are stored as 16-bit integers relative to the bounding box of the
+         *      vertices (i.e., with a precision of 1/65535 of its extent), normals as two 16-bit integers (octahedral
+         *      encoding), colors as RGBA8, and texture coordinates as half floats. For points with normals and
+         *      colors, this takes 16 instead of 36 bytes per point. The shaders decode the values (see
+         *      set_attribute_decoding_uniforms()).
+         * \note Only PointsDrawable (and the point cloud picker) supports compressed attributes. Effects that render
+         *      drawables with their own shaders (e.g., shadows, SSAO, transparency) do not decode them.
+         *      The buffers of a drawable attached to a model or having an update function are re-created
+         *      automatically. For other drawables, set it before updating the buffers.
+         */
+        void set_compressed_attributes(bool b);
+        /// Returns whether the vertex attributes are compressed.
+        bool compressed_attributes() const { return compressed_attributes_; }
+
+        /**
+         * \brief Sets the uniforms for decoding the compressed attributes in a shader program, i.e.,
+         *      "quantized_position", "position_offset", "position_scale", and "octahedral_normal" (if \p with_normal).
+         * \details It must be called for every program using the shader functions in
+         *      "resources/shaders/common/decode_*.glsl", since a program is shared by drawables with and without
+         *      compressed attributes. The program must be bound.
+         */
+        void set_attribute_decoding_uniforms(ShaderProgram *program, bool with_normal = true) const;
+
         ///@}
 
         std::size_t num_vertices() const { return num_vertices_; }
@@ -139,7 +168,9 @@ namespace easy3d {
         /**
          * @brief Requests an update of the OpenGL buffers.
          * @details This function sets the status to trigger an update of the OpenGL buffers. The actual update does
-         *      not occur immediately but is deferred to the rendering phase.
+         *      not occur immediately but is deferred to the rendering phase. This is required for changes to the
+         *      topology or to the rendering states (e.g., coloring). Buffers that are direct copies of vertex
+         *      properties are updated automatically once their properties are notified of modifications.
          * @note This method works for both standard drawables (no update function required) and non-standard
          *      drawable (update function required). Standard drawables include:
          *            - SurfaceMesh: "faces", "edges", "vertices", "borders", and "locks";
@@ -197,6 +228,19 @@ namespace easy3d {
         // actual update of the rendering buffers are here
         virtual void update_buffers_internal();
 
+        // re-uploads the modified ranges of the buffers whose vertex properties have been modified
+        void update_modified_buffers();
+
+        // if \p data is the storage of a vertex property of the model, records the property as the source of the
+        // buffer bound to \p attribute.
+        template <typename T>
+        void track_vertex_property(unsigned int attribute, const std::vector<T> &data);
+
+        // encodes the values [begin, end) of the data of \p attribute and uploads them to \p buffer (in chunks, so
+        // no encoded copy of the entire data is needed). \p data is a vec3 array (or a vec2 array for TEXCOORD).
+        bool upload_compressed(unsigned int attribute, unsigned int buffer, const void *data, std::size_t begin,
+                               std::size_t end);
+
         void clear();
 
     protected:
@@ -219,6 +263,17 @@ namespace easy3d {
         unsigned int texcoord_buffer_;
         unsigned int element_buffer_;
 
+        bool compressed_attributes_;
+        Box3 quantization_box_;     // the box relative to which the positions are quantized
+
+        // a buffer that is a one-to-one copy of a vertex property of the model
+        struct TrackedProperty {
+            unsigned int attribute;     // ShaderProgram::AttribType
+            std::string name;           // the name of the vertex property
+            std::size_t version;        // the version of the property when it was uploaded
+        };
+        std::vector<TrackedProperty> tracked_properties_;
+
         // drawables not attached to a model can also be manipulated
         Manipulator* manipulator_;   // for manipulation
     };
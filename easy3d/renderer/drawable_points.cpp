@@ -120,6 +120,7 @@ namespace easy3d {
         glPointSize(point_size());
 
         program->bind();
+        set_attribute_decoding_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("MANIP", MANIP)
                 ->set_uniform( "NORMAL", NORMAL)
@@ -165,6 +166,7 @@ namespace easy3d {
         glEnable(GL_VERTEX_PROGRAM_POINT_SIZE); // starting from GL3.2, using GL_PROGRAM_POINT_SIZE
 
         program->bind();
+        set_attribute_decoding_uniforms(program, false);
 
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
@@ -214,6 +216,7 @@ namespace easy3d {
         easy3d_debug_log_gl_error
 
         program->bind();
+        set_attribute_decoding_uniforms(program, false);
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
                 ->set_uniform("PROJ", camera->projectionMatrix())
@@ -273,6 +276,7 @@ namespace easy3d {
         glPointSize(point_size());
 
         program->bind();
+        set_attribute_decoding_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("MANIP", MANIP)
                 ->set_uniform( "NORMAL", NORMAL)
@@ -325,6 +329,7 @@ namespace easy3d {
         easy3d_debug_log_gl_error
 
         program->bind();
+        set_attribute_decoding_uniforms(program, false);
         program->set_uniform("perspective", camera->type() == Camera::PERSPECTIVE)
                 ->set_uniform("MV", camera->modelViewMatrix())
                 ->set_uniform("PROJ", camera->projectionMatrix())
@@ -382,6 +387,7 @@ namespace easy3d {
         const mat3 NORMAL = transform::normal_matrix(MANIP);
 
         program->bind();
+        set_attribute_decoding_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("MANIP", MANIP)
                 ->set_uniform( "NORMAL", NORMAL)
@@ -441,6 +447,7 @@ namespace easy3d {
         const mat3 NORMAL = transform::normal_matrix(MANIP);
 
         program->bind();
+        set_attribute_decoding_uniforms(program);
         program->set_uniform("MVP", MVP)
                 ->set_uniform("MANIP", MANIP)
                 ->set_uniform( "NORMAL", NORMAL);
@@ -0,0 +1,148 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/renderer/frame_capture.h>
+
+#include <cstring>
+#include <algorithm>
+
+#include <easy3d/renderer/framebuffer_object.h>
+#include <easy3d/renderer/opengl_error.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    FrameCapture::FrameCapture(int width, int height, unsigned int num_buffers)
+        : width_(width)
+        , height_(height)
+        , next_(0)
+        , resolved_fbo_(nullptr)
+    {
+        num_buffers = std::max(num_buffers, 2u);
+        buffers_.resize(num_buffers, 0);
+        fences_.resize(num_buffers, nullptr);
+
+        const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+        glGenBuffers(static_cast<GLsizei>(num_buffers), buffers_.data());	easy3d_debug_log_gl_error
+        for (auto id : buffers_) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, id);	easy3d_debug_log_gl_error
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);	easy3d_debug_log_gl_error
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);	easy3d_debug_log_gl_error
+    }
+
+
+    FrameCapture::~FrameCapture() {
+        for (auto fence : fences_) {
+            if (fence)
+                glDeleteSync(fence);
+        }
+        glDeleteBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data());	easy3d_debug_log_gl_error
+        delete resolved_fbo_;
+    }
+
+
+    bool FrameCapture::capture(const FramebufferObject* fbo, std::vector<unsigned char>& frame, unsigned int index) {
+        if (!fbo || fbo->width() != width_ || fbo->height() != height_) {
+            LOG(ERROR) << "framebuffer does not exist or its size does not match the capture size ("
+                       << width_ << ", " << height_ << ")";
+            return false;
+        }
+
+        // make room for the new frame
+        bool retrieved = false;
+        if (pending_.size() == buffers_.size())
+            retrieved = retrieve(frame);
+
+        const FramebufferObject* source = fbo;
+        unsigned int source_index = index;
+        if (fbo->samples() > 0) {
+            if (!resolved_fbo_) {
+                resolved_fbo_ = new FramebufferObject(width_, height_, 0);
+                resolved_fbo_->add_color_buffer();
+            }
+            FramebufferObject::blit_framebuffer(resolved_fbo_, fbo, 0, static_cast<int>(index), GL_COLOR_BUFFER_BIT);
+            source = resolved_fbo_;
+            source_index = 0;
+        }
+
+        GLint prev_read_fbo = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);	easy3d_debug_log_gl_error
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, source->handle());	easy3d_debug_log_gl_error
+        source->activate_read_buffer(source_index);
+
+        // the transfer goes into the PBO, so glReadPixels() returns without waiting
+        GLint prev_alignment = 4;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &prev_alignment);	easy3d_debug_log_gl_error
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);	easy3d_debug_log_gl_error
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[next_]);	easy3d_debug_log_gl_error
+        glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);	easy3d_debug_log_gl_error
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);	easy3d_debug_log_gl_error
+        glPixelStorei(GL_PACK_ALIGNMENT, prev_alignment);	easy3d_debug_log_gl_error
+        fences_[next_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);	easy3d_debug_log_gl_error
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));	easy3d_debug_log_gl_error
+
+        pending_.push_back(next_);
+        next_ = (next_ + 1) % buffers_.size();
+        return retrieved;
+    }
+
+
+    bool FrameCapture::retrieve(std::vector<unsigned char>& frame) {
+        if (pending_.empty())
+            return false;
+
+        const std::size_t id = pending_.front();
+        pending_.pop_front();
+
+        // usually already signaled, because the frame was issued a few frames ago
+        GLsync& fence = fences_[id];
+        if (fence) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);	easy3d_debug_log_gl_error
+            glDeleteSync(fence);	easy3d_debug_log_gl_error
+            fence = nullptr;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(width_) * height_ * 4;
+        frame.resize(size);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[id]);	easy3d_debug_log_gl_error
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);	easy3d_debug_log_gl_error
+        bool success = false;
+        if (data) {
+            std::memcpy(frame.data(), data, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);	easy3d_debug_log_gl_error
+            success = true;
+        }
+        else
+            LOG(ERROR) << "failed mapping the pixel buffer object";
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);	easy3d_debug_log_gl_error
+        return success;
+    }
+
+}
@@ -0,0 +1,107 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_RENDERER_FRAME_CAPTURE_H
+#define EASY3D_RENDERER_FRAME_CAPTURE_H
+
+#include <vector>
+#include <deque>
+
+#include <easy3d/renderer/opengl.h>
+
+
+namespace easy3d {
+
+    class FramebufferObject;
+
+    /**
+     * \brief Asynchronous read back of the rendered frames using a ring of pixel buffer objects (PBOs).
+     *
+     * \class FrameCapture easy3d/renderer/frame_capture.h
+     *
+     * \details FramebufferObject::read_color() calls glFinish() and glReadPixels() into client memory, which stalls
+     * the CPU until the GPU has finished rendering and transferring the frame. FrameCapture instead issues the
+     * glReadPixels() into a PBO, which returns immediately, and maps that PBO only a few frames later when the
+     * transfer is (very likely) complete. With N buffers, the frame captured by the i-th call to capture() is
+     * returned by the (i + N)-th call; the last frames are collected by retrieve() after rendering.
+     * The pixels are in RGBA format and the rows are stored bottom-up (i.e., as read by OpenGL).
+     *
+     * Usage example:
+     *      \code
+     *      FrameCapture capture(fbo->width(), fbo->height());
+     *      std::vector<unsigned char> frame;
+     *      for (...) {
+     *          fbo->bind();
+     *          draw();
+     *          fbo->release();
+     *          if (capture.capture(fbo, frame))
+     *              consume(frame);     // e.g., VideoRecorder::add_frame()
+     *      }
+     *      while (capture.retrieve(frame))
+     *          consume(frame);
+     *      \endcode
+     *
+     * \note All the functions must be called from a thread with the OpenGL context bound.
+     */
+    class FrameCapture {
+    public:
+        /// Creates the buffers for capturing frames of size \p width x \p height. \p num_buffers must be at least 2.
+        FrameCapture(int width, int height, unsigned int num_buffers = 3);
+        ~FrameCapture();
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+        /// Returns the number of frames that have been captured but not yet returned.
+        std::size_t num_pending() const { return pending_.size(); }
+
+        /**
+         * \brief Starts the asynchronous read back of the color attachment \p index of \p fbo.
+         * \details A multisample framebuffer is resolved first. If all the buffers are in use, the oldest pending
+         *      frame is copied into \p frame, which frees a buffer for the new frame.
+         * \return true if \p frame has been filled with the oldest pending frame.
+         */
+        bool capture(const FramebufferObject* fbo, std::vector<unsigned char>& frame, unsigned int index = 0);
+
+        /**
+         * \brief Copies the oldest pending frame into \p frame. It waits for the transfer if needed.
+         * \return false if there is no pending frame.
+         */
+        bool retrieve(std::vector<unsigned char>& frame);
+
+    private:
+        int width_;
+        int height_;
+        std::vector<GLuint> buffers_;
+        std::vector<GLsync> fences_;
+        std::size_t next_;                  // the buffer to be used by the next capture
+        std::deque<std::size_t> pending_;   // the buffers waiting to be retrieved, the oldest first
+        FramebufferObject* resolved_fbo_;   // for resolving multisample framebuffers
+    };
+
+}
+
+#endif  // EASY3D_RENDERER_FRAME_CAPTURE_H
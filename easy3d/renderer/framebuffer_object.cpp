@@ -32,6 +32,7 @@
 #include <easy3d/renderer/opengl_error.h>
 #include <easy3d/renderer/opengl_util.h>
 #include <easy3d/fileio/image_io.h>
+#include <easy3d/fileio/async_image_writer.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/logging.h>
 
@@ -1440,7 +1441,7 @@ namespace easy3d {
     }
 
 
-    bool FramebufferObject::snapshot_color(unsigned int index, const std::string& file_name) const {
+    bool FramebufferObject::snapshot_color(unsigned int index, const std::string& file_name, io::AsyncImageWriter* writer) const {
         if (!is_valid()) {
             LOG(ERROR) << "framebuffer not valid";
             return false;
@@ -1453,7 +1454,12 @@ namespace easy3d {
         std::vector<unsigned char> bits;
 
         const std::string& ext = file_system::extension(file_name, true);
-        if (ext == "png" || ext == "jpg") {
+        if (writer && ext != "ppm") {
+            if (!read_color(index, bits, GL_RGBA, true))
+                return false;
+            return writer->save(file_name, std::move(bits), width_, height_, 4);
+        }
+        else if (ext == "png" || ext == "jpg") {
             if (!read_color(index, bits, GL_RGBA, true))
                 return false;
             return ImageIO::save(file_name, bits, width_, height_, 4);
@@ -1536,23 +1542,16 @@ namespace easy3d {
     }
 
 
-    bool FramebufferObject::snapshot_depth(const std::string& file_name) const {
+    bool FramebufferObject::snapshot_depth(const std::string& file_name, io::AsyncImageWriter* writer) const {
         std::vector<float> depths;
         bool got = read_depth(depths, true);
         if (!got)
             return false;
 
-        // convert the depth values to unsigned char RGB values
-        std::vector<unsigned char> bits(depths.size() * 3);
-        for (std::size_t i = 0; i < depths.size(); ++i) {
-            bits[i * 3] = bits[i * 3 + 1] = bits[i * 3 + 2] = static_cast<unsigned char>(depths[i] * 255);
-        }
-
-        const std::string& ext = file_system::extension(file_name, true);
-        if (ext == "ppm")
-            return io::save_ppm(file_name, bits, width_, height_);
+        if (writer)
+            return writer->save_depth(file_name, std::move(depths), width_, height_);
         else
-            return ImageIO::save(file_name, bits, width_, height_, 3);
+            return ImageIO::save_depth(file_name, depths, width_, height_);
     }
 
 
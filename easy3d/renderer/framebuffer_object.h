@@ -36,6 +36,10 @@
 
 namespace easy3d {
 
+    namespace io {
+        class AsyncImageWriter;
+    }
+
     /**
      * \brief An implementation of framebuffer object (FBO).
      * \class FramebufferObject easy3d/renderer/framebuffer_object.h
@@ -333,12 +337,18 @@ namespace easy3d {
         bool read_depth(float& depth, int x, int y) const;
 
         /// Snapshots the color render buffer attached to color attachment \p index into an image file.
+        /// If \p writer is provided, the file is written asynchronously by \p writer (except for ppm files) and
+        /// the returned value only indicates whether the pixels were read and queued.
         /// \note Only png, jpg, bmp, tga, ppm are supported. File format is determined by the given extension.
-        bool snapshot_color(unsigned int index, const std::string& file_name) const;
-
-        /// Snapshots the color render buffer into an image file.
-        /// \note Only png, jpg, bmp, tga, ppm are supported. File format is determined by the given extension.
-        bool snapshot_depth(const std::string& file_name) const;
+        bool snapshot_color(unsigned int index, const std::string& file_name, io::AsyncImageWriter* writer = nullptr) const;
+
+        /// Snapshots the depth render buffer into an image file. The depth values are saved by
+        /// ImageIO::save_depth(), i.e., exactly for pfm files and as 16-bit grey values for png files.
+        /// If \p writer is provided, the file is written asynchronously by \p writer.
+        /// \attention Previously, png files were written as 8-bit RGB images like the other formats. Use
+        ///     bmp, jpg, tga, or ppm if 8-bit images are needed (e.g., by viewers that can't display 16-bit grey).
+        /// \note Only pfm, png, jpg, bmp, tga, ppm are supported. File format is determined by the given extension.
+        bool snapshot_depth(const std::string& file_name, io::AsyncImageWriter* writer = nullptr) const;
 
         /**
          * \brief Blit the whole sized buffer
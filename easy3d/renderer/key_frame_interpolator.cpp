@@ -36,6 +36,7 @@
 
 #include <easy3d/renderer/key_frame_interpolator.h>
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -60,6 +61,7 @@ namespace easy3d {
             , interpolation_started_(false)
             , last_stopped_index_(0)
             , pathIsValid_(false)
+            , drawables_outdated_(false)
             , path_drawable_(nullptr)
             , cameras_drawable_(nullptr)
     {
@@ -195,75 +197,78 @@ namespace easy3d {
 
 
     void  KeyFrameInterpolator::set_interpolation_method(Method m) {
+        if (m == interpolation_method_)
+            return;
         interpolation_method_ = m;
         pathIsValid_ = false;
     }
 
 
     void KeyFrameInterpolator::set_interpolation_speed(float speed) {
+        if (speed == interpolation_speed_)
+            return;
         interpolation_speed_ = speed;
         pathIsValid_ = false;
     }
 
 
     void KeyFrameInterpolator::set_frame_rate(int fps) {
+        if (fps == fps_)
+            return;
         fps_ = fps;
         pathIsValid_ = false;
     }
 
 
     void KeyFrameInterpolator::start_interpolation() {
-        auto animation = [this]() {
-            // interval in ms (0.9 to approximately compensate the overhead the timer thread and viewer update)
-            const int interval = static_cast<int>(1000.0f / static_cast<float>(frame_rate()) * 0.9f);
-            for (int id = last_stopped_index_; id < interpolated_path_.size(); ++id) {
-                if (timer_.is_stopped()) {
-                    last_stopped_index_ = id;
-                    break;
-                }
-                const auto &f = interpolated_path_[id];
-                frame()->setPositionAndOrientation(f.position(), f.orientation());
-                std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-                if (id == interpolated_path_.size() - 1)  // reaches the end frame
-                    last_stopped_index_ = 0;
-                frame_interpolated.send();
-            }
-            interpolation_stopped.send();
-            interpolation_started_ = false;
-        };
-
         if (keyframes_.empty())
             return;
 
         if (!pathIsValid_)
             interpolate();
 
-        // all done in another thread.
+        if (interpolated_path_.empty() || interpolation_started_)
+            return;
+
+        // each frame is triggered by the (shared) timer thread, so no thread is blocked during the animation
+        auto animation = [this]() {
+            if (last_stopped_index_ < 0 || last_stopped_index_ >= static_cast<int>(interpolated_path_.size()))
+                last_stopped_index_ = 0;
+            const auto &f = interpolated_path_[last_stopped_index_];
+            frame()->setPositionAndOrientation(f.position(), f.orientation());
+            frame_interpolated.send();
+            if (++last_stopped_index_ == static_cast<int>(interpolated_path_.size())) {  // reaches the end frame
+                last_stopped_index_ = 0;
+                stop_interpolation();
+            }
+        };
+
         interpolation_started_ = true;
-        timer_.set_timeout(0, animation);
+        const int interval = static_cast<int>(1000.0f / static_cast<float>(frame_rate()));
+        timer_.set_interval(std::max(interval, 1), animation);
     }
 
 
     void KeyFrameInterpolator::stop_interpolation() {
         timer_.stop();
-        interpolation_started_ = false;
+        if (interpolation_started_) {
+            interpolation_started_ = false;
+            interpolation_stopped.send();
+        }
     }
 
 
     void KeyFrameInterpolator::draw_cameras(const Camera *camera, float camera_width, const vec4 &color) {
         if (keyframes_.empty())
             return;
-        if (!pathIsValid_) {
-            if (path_drawable_) {
-                delete path_drawable_;
-                path_drawable_ = nullptr;
-            }
-            if (cameras_drawable_) {
-                delete cameras_drawable_;
-                cameras_drawable_ = nullptr;
-            }
-            interpolated_path_ = interpolate();
-            pathIsValid_ = true;
+        if (!pathIsValid_)
+            interpolate();
+        if (drawables_outdated_) {  // the path has changed since the drawables were created
+            delete path_drawable_;
+            path_drawable_ = nullptr;
+            delete cameras_drawable_;
+            cameras_drawable_ = nullptr;
+            drawables_outdated_ = false;
         }
         if (interpolated_path_.empty()) // interpolation may have failed.
             return;
@@ -302,17 +307,14 @@ namespace easy3d {
     void KeyFrameInterpolator::draw_path(const Camera *camera, float thickness, const vec4 &color) {
         if (keyframes_.empty())
             return;
-        if (!pathIsValid_) {
-            if (path_drawable_) {
-                delete path_drawable_;
-                path_drawable_ = nullptr;
-            }
-            if (cameras_drawable_) {
-                delete cameras_drawable_;
-                cameras_drawable_ = nullptr;
-            }
-            interpolated_path_ = interpolate();
-            pathIsValid_ = true;
+        if (!pathIsValid_)
+            interpolate();
+        if (drawables_outdated_) {  // the path has changed since the drawables were created
+            delete path_drawable_;
+            path_drawable_ = nullptr;
+            delete cameras_drawable_;
+            cameras_drawable_ = nullptr;
+            drawables_outdated_ = false;
         }
         if (interpolated_path_.empty()) // interpolation may have failed.
             return;
@@ -387,12 +389,18 @@ namespace easy3d {
     const std::vector<Frame>& KeyFrameInterpolator::interpolate() {
         if (pathIsValid_ || keyframes_.empty()) // already fitted or no keyframe
             return interpolated_path_;
-        else if (keyframes_.size() == 1) {   // only one keyframe
+
+        // the path is recomputed only when it has been invalidated (e.g., by editing the keyframes)
+        drawables_outdated_ = true;
+        pathIsValid_ = true;
+        last_stopped_index_ = 0; // not valid anymore
+        interpolated_path_.clear();
+
+        if (keyframes_.size() == 1) {   // only one keyframe
             interpolated_path_.emplace_back(Frame(keyframes_[0].position(), keyframes_[0].orientation()));
             return interpolated_path_;
         }
         else if (keyframes_.size() == 2) {   // only two keyframe: linear interpolation
-            interpolated_path_.clear();
             const float interval = interpolation_speed() * static_cast<float>(interpolation_period()) / 1000.0f;
             const int num_frames = static_cast<int>(duration() / interval + 1);
             for (int i=0; i<num_frames; ++i) {
@@ -401,8 +409,6 @@ namespace easy3d {
                 const auto orient = quat::slerp(keyframes_[0].orientation(), keyframes_[1].orientation(), w);
                 interpolated_path_.emplace_back(Frame(pos, orient.normalized()));
             }
-            pathIsValid_ = true;
-            last_stopped_index_ = 0; // not valid anymore
             return interpolated_path_;
         }
 
@@ -414,10 +420,13 @@ namespace easy3d {
 
         LOG_IF(keyframes_.size() > 2, INFO) << "interpolating " << keyframes_.size() << " keyframes...";
 
-        interpolated_path_.clear();
         const float interval = interpolation_speed() * static_cast<float>(interpolation_period()) / 1000.0f;
         const int num_frames = static_cast<int>(duration() / interval + 1);
 
+        // the positions and orientations of all frames are evaluated at once
+        std::vector<vec3> frame_positions;
+        std::vector<vec4> frame_orientations;
+
         if (interpolation_method_ == INTERPOLATION) {
             // we choose the accumulated path length as parameter, so to have equal intervals.
             std::vector<float> parameters(keyframes_.size());
@@ -445,16 +454,11 @@ namespace easy3d {
             orient_fitter.set_boundary(OrientFitter::second_deriv, 0, OrientFitter::second_deriv, 0);
             orient_fitter.set_points(parameters, orientations);
 
-            for (int i = 0; i < num_frames; ++i) {
-                const float u = static_cast<float>(i) / static_cast<float>(num_frames - 1);
-                const vec3 pos = pos_fitter.eval_f(u);
-                const vec4 q = orient_fitter.eval_f(u);
-                quat orient;
-                for (unsigned char j=0; j<4; ++j)
-                    orient[j] = q[j];
-                orient.normalize();
-                interpolated_path_.emplace_back(Frame(pos, orient));
-            }
+            std::vector<float> frame_parameters(num_frames);
+            for (int i = 0; i < num_frames; ++i)
+                frame_parameters[i] = static_cast<float>(i) / static_cast<float>(num_frames - 1);
+            pos_fitter.eval_f(frame_parameters, frame_positions);
+            orient_fitter.eval_f(frame_parameters, frame_orientations);
         }
         else {
             std::vector<vec3> positions(keyframes_.size());
@@ -477,16 +481,18 @@ namespace easy3d {
             OrientFitter orient_fitter(order, OrientFitter::eOPEN_UNIFORM);
             orient_fitter.set_ctrl_points(orientations);
 
-            for (int i = 0; i < num_frames; ++i) {
-                const float u = parameters[i];
-                const vec3 pos = pos_fitter.eval_f(u);
-                const vec4 q = orient_fitter.eval_f(u);
-                quat orient;
-                for (unsigned char j=0; j<4; ++j)
-                    orient[j] = q[j];
-                orient.normalize();
-                interpolated_path_.emplace_back(Frame(pos, orient));
-            }
+            pos_fitter.eval_f(parameters, frame_positions);
+            orient_fitter.eval_f(parameters, frame_orientations);
+        }
+
+        interpolated_path_.reserve(frame_positions.size());
+        for (std::size_t i = 0; i < frame_positions.size(); ++i) {
+            const vec4 &q = frame_orientations[i];
+            quat orient;
+            for (unsigned char j=0; j<4; ++j)
+                orient[j] = q[j];
+            orient.normalize();
+            interpolated_path_.emplace_back(Frame(frame_positions[i], orient));
         }
 
         LOG_IF(keyframes_.size() > 2, INFO)
@@ -495,8 +501,6 @@ namespace easy3d {
                         << string::time(duration() / interpolation_speed() * 1000)
                         << " (at speed " << interpolation_speed() << "x)";
 
-        pathIsValid_ = true;
-        last_stopped_index_ = 0; // not valid anymore
         return interpolated_path_;
     }
 
@@ -406,6 +406,8 @@ namespace easy3d {
 
         // is path valid? Adding new keyframes or editing a keyframe invalidates the path
         bool pathIsValid_;
+        // the path has been recomputed, so the drawables have to be recreated
+        bool drawables_outdated_;
 
         LinesDrawable* path_drawable_;
         TrianglesDrawable* cameras_drawable_;
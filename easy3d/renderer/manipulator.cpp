@@ -36,8 +36,9 @@
 namespace easy3d {
 
     Manipulator::Manipulator(Model *model)
-            : model_(model), drawable_model_bbox_(nullptr) {
+            : model_(model), drawable_model_bbox_(nullptr), version_(0) {
         frame_ = new ManipulatedFrame;
+        frame_->modified.connect([this]() { ++version_; });
         if (model_) {
             model_->set_manipulator(this);
             frame_->setPositionAndOrientation(model->bounding_box().center(), quat());
@@ -80,6 +80,11 @@ namespace easy3d {
         ///     'frame()->matrix()'. Their relation is: 'matrix() == frame()->matrix() * mat4::translation(-center)'.
         mat4 matrix() const;
 
+        /// Returns the version of the transformation, which changes whenever the manipulated frame is modified. A
+        /// consumer (e.g., the culling of the viewer) can compare it with the one it saw last time to tell if the
+        /// transformation has changed without recomputing it.
+        std::size_t version() const { return version_; }
+
         /// Draws the manipulated frame.
         void draw_frame(const Camera* cam) const;
 
@@ -87,6 +92,7 @@ namespace easy3d {
         Model *model_; // the model to be manipulated
         ManipulatedFrame *frame_;
         LinesDrawable* drawable_model_bbox_;
+        std::size_t version_;
     };
 
 }
@@ -53,6 +53,11 @@ namespace easy3d {
         GLenum status = glewInit();
         _glew_initialized = true;
 
+        // Contexts created without a window system (e.g., EGL and OSMesa for offscreen rendering) have no GLX
+        // display. The OpenGL functions have been loaded anyway, and only the GLX extensions are not available.
+        if (status == GLEW_ERROR_NO_GLX_DISPLAY)
+            status = GLEW_OK;
+
         if (GLEW_OK != status) {
             // Problem: glewInit failed, something is seriously wrong.
             LOG(ERROR) << glewGetErrorString(status);
@@ -512,17 +512,7 @@ namespace easy3d {
             std::vector<float> depths;
             read_depth(depths, true);
 
-            // convert the depth values to unsigned char RGB values
-            std::vector<unsigned char> bits(depths.size() * 3);
-            for (std::size_t i = 0; i < depths.size(); ++i) {
-                bits[i * 3] = bits[i * 3 + 1] = bits[i * 3 + 2] = static_cast<unsigned char>(depths[i] * 255);
-            }
-
-            const std::string& ext = file_system::extension(file_name, true);
-            if (ext == "ppm")
-                io::save_ppm(file_name, bits, w, h);
-            else
-                ImageIO::save(file_name, bits, w, h, 3);
+            ImageIO::save_depth(file_name, depths, w, h);
 		}
 
 
@@ -536,17 +526,7 @@ namespace easy3d {
             std::vector<float> depths;
             read_depth_ms(depths, true);
 
-            // convert the depth values to unsigned char RGB values
-            std::vector<unsigned char> bits(depths.size() * 3);
-            for (std::size_t i = 0; i < depths.size(); ++i) {
-                bits[i * 3] = bits[i * 3 + 1] = bits[i * 3 + 2] = static_cast<unsigned char>(depths[i] * 255);
-            }
-
-            const std::string& ext = file_system::extension(file_name, true);
-            if (ext == "ppm")
-                io::save_ppm(file_name, bits, w, h);
-            else
-                ImageIO::save(file_name, bits, w, h, 3);
+            ImageIO::save_depth(file_name, depths, w, h);
 		}
 
 	}
@@ -68,7 +68,8 @@ namespace easy3d {
         void snapshot_color_ms(int index, const std::string& file_name);	// multisample framebuffer object
 
         // snapshot the depth render buffer into an image file. This is very useful for debugging.
-        // Only png, jpg, bmp, tga, ppm are supported. File format is determined by the given extension.
+        // Only pfm, png, jpg, bmp, tga, ppm are supported. File format is determined by the given extension.
+        // pfm files store the exact depth values and png files store 16-bit values (see ImageIO::save_depth()).
         void snapshot_depth(const std::string& file_name);
         void snapshot_depth_ms(const std::string& file_name);	// multisample framebuffer object
 
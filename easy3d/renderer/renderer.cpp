@@ -25,6 +25,9 @@
  ********************************************************************/
 
 #include <easy3d/renderer/renderer.h>
+
+#include <typeinfo>
+
 #include <easy3d/core/graph.h>
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/core/surface_mesh.h>
@@ -41,6 +44,7 @@ namespace easy3d {
     Renderer::Renderer(Model* model, bool create)
             : visible_(true)
             , selected_(false)
+            , published_(nullptr)
     {
         model_ = model;
         if (model_) {
@@ -56,6 +60,7 @@ namespace easy3d {
         for (auto d : points_drawables_)	delete d;
         for (auto d : lines_drawables_)	    delete d;
         for (auto d : triangles_drawables_)	delete d;
+        delete published_;
     }
 
     
@@ -339,6 +344,56 @@ namespace easy3d {
     }
 
 
+    void Renderer::publish(Model *snapshot) {
+        if (!snapshot)
+            return;
+        if (!model_ || typeid(*snapshot) != typeid(*model_)) {
+            LOG(ERROR) << "the published snapshot must have the same type as the model";
+            delete snapshot;
+            return;
+        }
+
+        Model *discarded = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(published_mutex_);
+            discarded = published_;
+            published_ = snapshot;
+        }
+        delete discarded; // not applied yet, and outdated now
+    }
+
+
+    bool Renderer::has_published() const {
+        std::lock_guard<std::mutex> lock(published_mutex_);
+        return published_ != nullptr;
+    }
+
+
+    bool Renderer::apply_published() {
+        Model *snapshot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(published_mutex_);
+            std::swap(snapshot, published_);
+        }
+        if (!snapshot)
+            return false;
+
+        if (auto cloud = dynamic_cast<PointCloud *>(model_))
+            cloud->swap(*dynamic_cast<PointCloud *>(snapshot));
+        else if (auto mesh = dynamic_cast<SurfaceMesh *>(model_))
+            mesh->swap(*dynamic_cast<SurfaceMesh *>(snapshot));
+        else if (auto graph = dynamic_cast<Graph *>(model_))
+            graph->swap(*dynamic_cast<Graph *>(snapshot));
+        else if (auto poly = dynamic_cast<PolyMesh *>(model_))
+            *poly = *dynamic_cast<PolyMesh *>(snapshot);
+        delete snapshot; // now holds the previous state of the model
+
+        model_->invalidate_bounding_box();
+        update();
+        return true;
+    }
+
+
     PointsDrawable* Renderer::get_points_drawable(const std::string& name, bool warning_not_found) const {
         for (auto d : points_drawables_) {
             if (d->name() == name)
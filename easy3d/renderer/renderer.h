@@ -30,6 +30,7 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 #include <easy3d/core/types.h>
 #include <easy3d/core/point_cloud.h>
@@ -58,6 +59,19 @@ namespace easy3d {
      *      // don't forget to delete the renderer when the model is deleted
      *      delete model->renderer();
      * \endcode
+     *
+     * Concurrent processing and rendering: a model must not be modified by another thread while it is being
+     * rendered. Instead, a worker thread modifies its own copy of the model and publishes snapshots of it, which are
+     * picked up by the rendering thread at the start of a frame (see publish() and apply_published()):
+     * \code
+     *      // in the worker thread (e.g., receiving data from a sensor)
+     *      PointCloud working = ...;   // owned by the worker thread
+     *      while (...) {
+     *          ... // modify working
+     *          model->renderer()->publish(new PointCloud(working));
+     *          viewer->update();
+     *      }
+     * \endcode
      */
     class Renderer {
     public:
@@ -113,6 +127,39 @@ namespace easy3d {
          */
         void update();
 
+        //-------------------- concurrent updates  -----------------------
+
+        /**
+         * @brief Publishes a new state of the model. This function is thread safe.
+         * @details This allows a worker thread to update the model while it is being rendered. The published
+         *      snapshot replaces the content of the model when apply_published() is called by the rendering thread,
+         *      so the rendering never observes a partially modified model. Only the latest snapshot is kept: a
+         *      snapshot that has not been applied yet is discarded when a newer one is published, so the worker
+         *      never waits for the rendering.
+         * @param snapshot The new state of the model. It must have the same type as the model. The renderer takes
+         *      the ownership of the snapshot, and the caller must not access it anymore.
+         * @attention Property handles (e.g., PointCloud::VertexProperty) taken from the model before the snapshot
+         *      is applied become invalid, see apply_published().
+         */
+        void publish(Model *snapshot);
+
+        /**
+         * @brief Applies the latest published snapshot (if any) to the model.
+         * @details This function must be called by the rendering thread, typically at the start of a frame. The
+         *      content of the model is exchanged with the snapshot in constant time (a PolyMesh is copied), and the
+         *      rendering buffers of all drawables are then updated.
+         * @attention The property arrays of the model are replaced by those of the snapshot, and the previous ones
+         *      are deleted together with the snapshot. So any property handle (e.g., the one returned by
+         *      \c cloud->get_vertex_property<vec3>("v:color")) taken from the model before this call points into
+         *      deleted memory afterwards. Fetch the handles again after a frame in which a snapshot may have been
+         *      applied, and don't keep them across frames.
+         * @return \c true if a snapshot has been applied.
+         */
+        bool apply_published();
+
+        /// Returns whether a published snapshot is waiting to be applied. This function is thread safe.
+        bool has_published() const;
+
         //-------------------- drawable management  -----------------------
 
         /**
@@ -285,6 +332,10 @@ namespace easy3d {
         std::vector<PointsDrawable *> points_drawables_;
         std::vector<LinesDrawable *> lines_drawables_;
         std::vector<TrianglesDrawable *> triangles_drawables_;
+
+        // the latest published snapshot of the model (owned by the renderer)
+        Model *published_;
+        mutable std::mutex published_mutex_;
     };
 
 }
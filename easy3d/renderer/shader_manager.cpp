@@ -25,11 +25,20 @@
  ********************************************************************/
 
 #include <easy3d/renderer/shader_manager.h>
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include <easy3d/renderer/opengl.h>
+#include <easy3d/renderer/opengl_util.h>
 #include <easy3d/renderer/opengl_error.h>
 #include <easy3d/util/resource.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/string.h>
 #include <easy3d/util/logging.h>
+#include <easy3d/util/stop_watch.h>
 
 
 namespace easy3d {
@@ -37,8 +46,45 @@ namespace easy3d {
     std::unordered_map<std::string, ShaderProgram*>     ShaderManager::programs_;
     std::unordered_map<std::string, bool>				ShaderManager::attempt_load_program_; // avoid multiple attempt
 
+    std::recursive_mutex    ShaderManager::mutex_;
+
+    bool                    ShaderManager::cache_enabled_ = true;
+    int                     ShaderManager::cache_supported_ = -1;
+    std::string             ShaderManager::cache_directory_;
+    std::string             ShaderManager::driver_string_;
+    bool                    ShaderManager::manifest_loaded_ = false;
+    std::set<std::string>   ShaderManager::manifest_;
+
+    std::size_t             ShaderManager::num_compiled_ = 0;
+    std::size_t             ShaderManager::num_cached_ = 0;
+    double                  ShaderManager::creation_time_ = 0.0;
+
+
+    namespace internal {
+
+        // 64-bit FNV-1a hash. The length of each string is also hashed to separate consecutive strings.
+        inline void hash_string(uint64_t &hash, const std::string &str) {
+            const uint64_t prime = 1099511628211ull;
+            for (unsigned char c : str) {
+                hash ^= c;
+                hash *= prime;
+            }
+            for (std::size_t i = 0; i < sizeof(std::size_t); ++i) {
+                hash ^= static_cast<unsigned char>(str.size() >> (8 * i));
+                hash *= prime;
+            }
+        }
+
+        inline std::string gl_string(GLenum name) {
+            const GLubyte *str = glGetString(name);
+            return str ? std::string(reinterpret_cast<const char *>(str)) : std::string();
+        }
+
+    }
+
 
     ShaderProgram* ShaderManager::get_program(const std::string& shader_name) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         auto pos = programs_.find(shader_name);
         if (pos != programs_.end()) // program already exists
             return pos->second;
@@ -52,6 +98,7 @@ namespace easy3d {
         const std::vector<std::string>& outputs /* = std::vector<std::string>() */,
         bool geom_shader /* = false */ )
     {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         auto it = attempt_load_program_.find(base_name);
         if (it == attempt_load_program_.end())
             attempt_load_program_[base_name] = true;
@@ -78,41 +125,21 @@ namespace easy3d {
             return nullptr;
         }
 
-        auto program = new ShaderProgram(base_name);
-
-        bool success = program->load_shader_from_file(ShaderProgram::VERTEX, vs_file);
-        if (!success) {
+        const std::string vs_code = ShaderProgram::load_shader_source(vs_file);
+        const std::string fs_code = ShaderProgram::load_shader_source(fs_file);
+        const std::string gs_code = geom_shader ? ShaderProgram::load_shader_source(gs_file) : "";
+        if (vs_code.empty() || fs_code.empty() || (geom_shader && gs_code.empty())) {
             attempt_load_program_[base_name] = false;
-            delete program;
             return nullptr;
         }
 
-        success = program->load_shader_from_file(ShaderProgram::FRAGMENT, fs_file);
-        if (!success) {
+        auto program = _create_program(base_name, vs_code, fs_code, gs_code, attributes, outputs);
+        if (!program) {
             attempt_load_program_[base_name] = false;
-            delete program;
-            return nullptr;
-        }
-
-        if (geom_shader) {
-            success = program->load_shader_from_file(ShaderProgram::GEOMETRY, gs_file);
-            if (!success) {
-                attempt_load_program_[base_name] = false;
-                delete program;
-                return nullptr;
-            }
-        }
-
-        program->set_attrib_names(attributes);	easy3d_debug_log_gl_error
-        for (std::size_t i = 0; i < outputs.size(); ++i)
-            program->set_program_output(static_cast<int>(i), outputs[i]);
-
-        success = program->link_program();	easy3d_debug_log_gl_error
-        if (!success) {
-            delete program;
             return nullptr;
         }
 
+        _record_program(base_name, attributes, outputs, geom_shader);
         programs_[base_name] = program;
         return program;
     }
@@ -130,6 +157,7 @@ namespace easy3d {
 		const std::vector<ShaderProgram::Attribute>& attributes /* = std::vector<ShaderProgram::Attribute>() */, 
 		const std::vector<std::string>& outputs /* = std::vector<std::string>() */ )
 	{
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
 		// just give a name
 		const std::string name = vert_file_name + frag_file_name + geom_file_name;
 		auto it = attempt_load_program_.find(name);
@@ -158,49 +186,26 @@ namespace easy3d {
 			return nullptr;
 		}
 
-		auto program = new ShaderProgram(name);
-
 		std::string vert_code;
         file_system::read_file_to_string(vert_file, vert_code);
 		if (!extra_vert_code.empty())
 			string::replace(vert_code, "//INSERT", extra_vert_code);
-        bool success = program->load_shader_from_code(ShaderProgram::VERTEX, vert_code);
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
-		
+
 		std::string frag_code;
         file_system::read_file_to_string(frag_file, frag_code);
 		if (!extra_frag_code.empty())
 			string::replace(frag_code, "//INSERT", extra_frag_code);
-        success = program->load_shader_from_code(ShaderProgram::FRAGMENT, frag_code);
-        if (!success) {
-            delete program;
-            return nullptr;
-        }
 
+        std::string geom_code;
 		if (!geom_file_name.empty()) {
-			std::string geom_code;
             file_system::read_file_to_string(geom_file, geom_code);
 			if (!extra_geom_code.empty())
 				string::replace(geom_code, "//INSERT", extra_geom_code);
-            success = program->load_shader_from_code(ShaderProgram::GEOMETRY, geom_code);
-            if (!success) {
-                delete program;
-                return nullptr;
-            }
 		}
 
-		program->set_attrib_names(attributes);	easy3d_debug_log_gl_error
-		for (std::size_t i = 0; i < outputs.size(); ++i)
-			program->set_program_output(static_cast<int>(i), outputs[i]);
-
-        success = program->link_program();	easy3d_debug_log_gl_error
-        if (!success) {
-            delete program;
+        auto program = _create_program(name, vert_code, frag_code, geom_code, attributes, outputs);
+        if (!program)
             return nullptr;
-        }
 
 		programs_[name] = program;
 		return program;
@@ -225,7 +230,54 @@ namespace easy3d {
             return nullptr;
         }
 
-        auto program = new ShaderProgram;
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return _create_program("unknown", vert_code, frag_code, geom_code, attributes, outputs);
+    }
+
+
+    ShaderProgram* ShaderManager::_create_program(
+            const std::string& name,
+            const std::string& vert_code,
+            const std::string& frag_code,
+            const std::string& geom_code,
+            const std::vector<ShaderProgram::Attribute>& attributes,
+            const std::vector<std::string>& outputs)
+    {
+        StopWatch w;
+
+        std::string cache_file;
+        if (binary_cache_enabled()) {
+            uint64_t key = 14695981039346656037ull;
+            internal::hash_string(key, driver_string_);
+            internal::hash_string(key, vert_code);
+            internal::hash_string(key, frag_code);
+            internal::hash_string(key, geom_code);
+            for (const auto& attr : attributes) {
+                internal::hash_string(key, std::to_string(attr.first));
+                internal::hash_string(key, attr.second);
+            }
+            for (const auto& output : outputs)
+                internal::hash_string(key, output);
+
+            std::ostringstream file;
+            file << binary_cache_directory() << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+            cache_file = file.str();
+
+            if (file_system::is_file(cache_file)) {
+                auto program = new ShaderProgram(name);
+                if (program->load_binary(cache_file)) {
+                    ++num_cached_;
+                    creation_time_ += w.elapsed_seconds(5);
+                    VLOG(1) << "program '" << name << "' loaded from binary cache (" << w.time_string() << ")";
+                    return program;
+                }
+                // the entry is invalid (e.g., a corrupted file), it will be overwritten below
+                LOG(WARNING) << "invalid entry in program binary cache: " << cache_file;
+                delete program;
+            }
+        }
+
+        auto program = new ShaderProgram(name);
 
         bool success = program->load_shader_from_code(ShaderProgram::VERTEX, vert_code);
         if (!success) {
@@ -250,17 +302,200 @@ namespace easy3d {
         for (std::size_t i = 0; i < outputs.size(); ++i)
             program->set_program_output(static_cast<int>(i), outputs[i]);
 
+        if (!cache_file.empty())
+            glProgramParameteri(program->get_program(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
         success = program->link_program();	easy3d_debug_log_gl_error
         if (!success) {
             delete program;
             return nullptr;
         }
 
+        ++num_compiled_;
+        creation_time_ += w.elapsed_seconds(5);
+        VLOG(1) << "program '" << name << "' compiled and linked (" << w.time_string() << ")";
+
+        if (!cache_file.empty()) {
+            if (file_system::is_directory(binary_cache_directory()) || file_system::create_directory(binary_cache_directory())) {
+                if (!program->save_binary(cache_file))
+                    LOG_N_TIMES(3, WARNING) << "failed caching program binary: " << cache_file << ". " << COUNTER;
+            }
+        }
+
         return program;
     }
 
 
+    void ShaderManager::_load_manifest() {
+        if (manifest_loaded_)
+            return;
+        manifest_loaded_ = true;
+
+        std::ifstream input((binary_cache_directory() + "/programs.txt").c_str());
+        std::string line;
+        while (std::getline(input, line)) {
+            if (!line.empty())
+                manifest_.insert(line);
+        }
+    }
+
+
+    // Each program is recorded as a single line:
+    //      base_name geom_shader num_attributes [type name]... num_outputs [name]...
+    void ShaderManager::_record_program(
+            const std::string& base_name,
+            const std::vector<ShaderProgram::Attribute>& attributes,
+            const std::vector<std::string>& outputs,
+            bool geom_shader)
+    {
+        if (!binary_cache_enabled())
+            return;
+
+        std::ostringstream entry;
+        entry << base_name << " " << (geom_shader ? 1 : 0) << " " << attributes.size();
+        for (const auto& attr : attributes)
+            entry << " " << attr.first << " " << attr.second;
+        entry << " " << outputs.size();
+        for (const auto& output : outputs)
+            entry << " " << output;
+
+        _load_manifest();
+        if (!manifest_.insert(entry.str()).second)
+            return;
+
+        if (!file_system::is_directory(binary_cache_directory()) && !file_system::create_directory(binary_cache_directory()))
+            return;
+        std::ofstream output((binary_cache_directory() + "/programs.txt").c_str(), std::ios::app);
+        if (output.is_open())
+            output << entry.str() << std::endl;
+    }
+
+
+    std::size_t ShaderManager::prewarm() {
+        std::vector<std::string> entries;
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            if (!binary_cache_enabled())
+                return 0;
+            _load_manifest();
+            entries.assign(manifest_.begin(), manifest_.end());
+        }
+
+        std::size_t count = 0;
+        for (const auto& entry : entries) {
+            std::istringstream input(entry);
+            std::string base_name;
+            int geom_shader = 0;
+            std::size_t num_attributes = 0, num_outputs = 0;
+            input >> base_name >> geom_shader >> num_attributes;
+            std::vector<ShaderProgram::Attribute> attributes;
+            for (std::size_t i = 0; i < num_attributes && input; ++i) {
+                int type = 0;
+                std::string name;
+                input >> type >> name;
+                attributes.emplace_back(static_cast<ShaderProgram::AttribType>(type), name);
+            }
+            input >> num_outputs;
+            std::vector<std::string> outputs;
+            for (std::size_t i = 0; i < num_outputs && input; ++i) {
+                std::string name;
+                input >> name;
+                outputs.push_back(name);
+            }
+            if (input.fail() || base_name.empty()) {
+                LOG_N_TIMES(3, WARNING) << "invalid entry in program manifest: " << entry << ". " << COUNTER;
+                continue;
+            }
+
+            // the lock is acquired for each program so the rendering thread is blocked at most by a single program
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            if (programs_.find(base_name) != programs_.end())
+                continue;
+            if (create_program_from_files(base_name, attributes, outputs, geom_shader != 0)) {
+                // The program is published to the other contexts (i.e., get_program()) when the lock is released.
+                // It must be complete by then, which requires finishing the commands of this context.
+                glFinish();
+                ++count;
+            }
+        }
+        return count;
+    }
+
+
+    std::size_t ShaderManager::num_recorded_programs() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        _load_manifest();
+        return manifest_.size();
+    }
+
+
+    void ShaderManager::set_binary_cache_enabled(bool b) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        cache_enabled_ = b;
+    }
+
+
+    bool ShaderManager::binary_cache_enabled() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        if (!cache_enabled_)
+            return false;
+
+        // checks the support once (requires a current context)
+        if (cache_supported_ == -1) {
+            cache_supported_ = 0;
+            if (OpenglUtil::is_supported("GL_ARB_get_program_binary")) {
+                // some drivers support the extension but provide no binary formats
+                int num_formats = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+                if (num_formats > 0) {
+                    cache_supported_ = 1;
+                    driver_string_ = internal::gl_string(GL_VENDOR) + "|" + internal::gl_string(GL_RENDERER) + "|" +
+                                     internal::gl_string(GL_VERSION);
+                }
+            }
+            if (!cache_supported_)
+                LOG(INFO) << "program binary cache not supported by the OpenGL driver";
+        }
+        return cache_supported_ == 1;
+    }
+
+
+    void ShaderManager::set_binary_cache_directory(const std::string& dir) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        cache_directory_ = dir;
+        manifest_loaded_ = false;
+        manifest_.clear();
+    }
+
+
+    const std::string& ShaderManager::binary_cache_directory() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        if (cache_directory_.empty())
+            cache_directory_ = file_system::home_directory() + "/.easy3d/shader_cache";
+        return cache_directory_;
+    }
+
+
+    std::size_t ShaderManager::num_compiled_programs() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return num_compiled_;
+    }
+
+
+    std::size_t ShaderManager::num_cached_programs() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return num_cached_;
+    }
+
+
+    double ShaderManager::creation_time() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return creation_time_;
+    }
+
+
     std::vector<ShaderProgram*> ShaderManager::all_programs() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         std::vector<ShaderProgram*> result;
         for (const auto& g : programs_)
             result.push_back(g.second);
@@ -269,6 +504,7 @@ namespace easy3d {
 
 
     void ShaderManager::terminate() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
 		for (const auto& p : programs_)
 			delete p.second;
         programs_.clear();
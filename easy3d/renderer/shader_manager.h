@@ -29,6 +29,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <set>
+#include <mutex>
 
 #include <easy3d/renderer/shader_program.h>
 
@@ -41,6 +43,14 @@ namespace easy3d {
      * \brief Management of shader programs.
      * \class ShaderManager easy3d/renderer/shader_manager.h
      * \note make sure to call terminate() to destroy existing programs before the OpenGL context is deleted.
+     *
+     * Linked programs are transparently stored in an on-disk binary cache (if supported by the driver, i.e.,
+     * GL_ARB_get_program_binary with at least one binary format). A cache entry is keyed by a hash of the complete
+     * shader sources (including the extra code and resolved includes), the attribute bindings, the fragment outputs,
+     * and the driver string (vendor, renderer, and version), so a changed shader or an updated driver simply misses
+     * the cache. The programs created from shader files are also recorded in a manifest in the cache directory, which
+     * allows pre-warming them (see prewarm()) on a shared context in a background thread at startup.
+     * \note All functions are thread safe, so programs can be created from a thread with a shared context current.
      */
     class ShaderManager
     {
@@ -86,11 +96,71 @@ namespace easy3d {
 
 		static void reload();
 
+        /// Enables/Disables the on-disk program binary cache. It is enabled by default.
+        static void set_binary_cache_enabled(bool b);
+        /// Returns whether the program binary cache is enabled and supported by the current OpenGL context.
+        static bool binary_cache_enabled();
+
+        /// Sets the directory of the program binary cache. Default: "<home directory>/.easy3d/shader_cache".
+        static void set_binary_cache_directory(const std::string& dir);
+        static const std::string& binary_cache_directory();
+
+        /**
+         * Creates (i.e., loads from the binary cache, or compiles and links) all the programs recorded in the
+         * manifest of the binary cache that do not exist yet. It is intended to be called from a background thread
+         * with an OpenGL context shared with the rendering context current. Each program is completed (i.e.,
+         * glFinish()) before it becomes visible to the other contexts.
+         * @return The number of created programs.
+         */
+        static std::size_t prewarm();
+        /// Returns the number of programs recorded in the manifest of the binary cache.
+        static std::size_t num_recorded_programs();
+
+        /// Returns the number of programs that have been compiled and linked from their source code.
+        static std::size_t num_compiled_programs();
+        /// Returns the number of programs that have been loaded from the binary cache.
+        static std::size_t num_cached_programs();
+        /// Returns the total time (in seconds) spent on creating programs (from source code or the binary cache).
+        static double creation_time();
+
+    private:
+        // compiles and links the program, or loads it from the binary cache if the same program has been cached.
+        static ShaderProgram* _create_program(
+                const std::string& name,
+                const std::string& vert_code,
+                const std::string& frag_code,
+                const std::string& geom_code,
+                const std::vector<ShaderProgram::Attribute>& attributes,
+                const std::vector<std::string>& outputs
+        );
+
+        // records a program created from files by its base name in the manifest
+        static void _record_program(
+                const std::string& base_name,
+                const std::vector<ShaderProgram::Attribute>& attributes,
+                const std::vector<std::string>& outputs,
+                bool geom_shader
+        );
+        static void _load_manifest();
+
     private:
         // maps of std::string can be super slow when calling find with a string literal or const char*
         // as find forces construction/copy/destruction of a std::sting copy of the const char*.
         static std::unordered_map<std::string, ShaderProgram*>	programs_;
         static std::unordered_map<std::string, bool>			attempt_load_program_; // avoid multiple attempt
+
+        static std::recursive_mutex mutex_;
+
+        static bool         cache_enabled_;
+        static int          cache_supported_;       // -1: unknown, 0: not supported, 1: supported
+        static std::string  cache_directory_;
+        static std::string  driver_string_;
+        static bool         manifest_loaded_;
+        static std::set<std::string> manifest_;     // each entry describes a program created from files
+
+        static std::size_t  num_compiled_;
+        static std::size_t  num_cached_;
+        static double       creation_time_;
     };
 
 }
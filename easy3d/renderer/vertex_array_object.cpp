@@ -98,6 +98,11 @@ namespace easy3d {
 
 
     bool VertexArrayObject::create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim, bool dynamic) {
+        return create_array_buffer(buffer, index, data, size, dim, GL_FLOAT, false, dynamic);
+    }
+
+
+    bool VertexArrayObject::create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim, GLenum type, bool normalized, bool dynamic) {
         release_buffer(buffer);
 		bind();
         glGenBuffers(1, &buffer);                       easy3d_debug_log_gl_error
@@ -105,7 +110,7 @@ namespace easy3d {
         glBindBuffer(GL_ARRAY_BUFFER, buffer);			easy3d_debug_log_gl_error
         glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);		easy3d_debug_log_gl_error
         glEnableVertexAttribArray(index);               easy3d_debug_log_gl_error
-        glVertexAttribPointer(index, int(dim), GL_FLOAT, GL_FALSE, 0, nullptr);		easy3d_debug_log_gl_error
+        glVertexAttribPointer(index, int(dim), type, normalized ? GL_TRUE : GL_FALSE, 0, nullptr);		easy3d_debug_log_gl_error
         if (glGetError() != GL_NO_ERROR) {
             glBindBuffer(GL_ARRAY_BUFFER, 0);           easy3d_debug_log_gl_error
             glDeleteBuffers(1, &buffer);                easy3d_debug_log_gl_error
@@ -118,6 +123,14 @@ namespace easy3d {
     }
 
 
+    bool VertexArrayObject::update_array_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);			easy3d_debug_log_gl_error
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);		easy3d_debug_log_gl_error
+        glBindBuffer(GL_ARRAY_BUFFER, 0);               easy3d_debug_log_gl_error
+        return (glGetError() == GL_NO_ERROR);
+    }
+
+
     bool VertexArrayObject::create_element_buffer(GLuint &buffer, const void *data, std::size_t size, bool dynamic) {
         release_buffer(buffer);
 		bind();
@@ -74,6 +74,23 @@ namespace easy3d {
          * @return OpenGL error code.
          */
         bool create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim, bool dynamic = false);
+        /**
+         * @brief Creates an OpenGL array buffer for attribute values of a given type, e.g., compressed attributes.
+         * @param type   The data type of each component, e.g., GL_FLOAT, GL_UNSIGNED_SHORT, GL_HALF_FLOAT.
+         * @param normalized Whether integer values are mapped to [0, 1] (unsigned) or [-1, 1] (signed) when fetched.
+         * @sa create_array_buffer() for the other parameters.
+         */
+        bool create_array_buffer(GLuint& buffer, GLuint index, const void* data, std::size_t size, std::size_t dim,
+                                 GLenum type, bool normalized, bool dynamic = false);
+        /**
+         * @brief Updates a subset of an existing array buffer.
+         * @param buffer The name of the buffer object.
+         * @param offset The offset (in bytes) into the buffer where the data replacement will begin.
+         * @param size   The size (in bytes) of the data being replaced.
+         * @param data   The pointer to the new data.
+         * @return true on success.
+         */
+        bool update_array_buffer(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
         bool create_element_buffer(GLuint& buffer, const void* data, std::size_t size, bool dynamic = false);
 
         // @param index: the index of the binding point.
@@ -0,0 +1,160 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_UTIL_BLOCKING_QUEUE_H
+#define EASY3D_UTIL_BLOCKING_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A thread-safe FIFO queue for producer-consumer pipelines.
+     * \class BlockingQueue easy3d/util/blocking_queue.h
+     * \details A bounded queue blocks the producers when it is full, and the consumers block when the queue is
+     *      empty. This throttles a fast producer (e.g., the rendering loop) to the speed of its consumers (e.g., the
+     *      video encoder) while keeping the memory bounded. Once the queue is closed, push() fails immediately and
+     *      pop() returns the remaining items before it fails. Example usage:
+     *      \code
+     *          BlockingQueue<Frame> queue(8);
+     *          std::thread consumer([&]() {
+     *              Frame frame;
+     *              while (queue.pop(frame))
+     *                  process(frame);
+     *          });
+     *          for (...)
+     *              queue.push(std::move(frame));
+     *          queue.close();   // let the consumer finish
+     *          consumer.join();
+     *      \endcode
+     */
+    template<typename T>
+    class BlockingQueue {
+    public:
+        /// Constructs a queue holding at most \p capacity items. A capacity of 0 means the queue is unbounded.
+        explicit BlockingQueue(std::size_t capacity = 0) : capacity_(capacity), closed_(false) {}
+
+        /**
+         * \brief Appends an item to the end of the queue, blocking while the queue is full.
+         * \return false if the queue has been closed (the item is discarded).
+         */
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]() { return closed_ || capacity_ == 0 || queue_.size() < capacity_; });
+            if (closed_)
+                return false;
+            queue_.push_back(std::move(item));
+            lock.unlock();
+            not_empty_.notify_one();
+            return true;
+        }
+
+        /**
+         * \brief Appends an item to the end of the queue if it is not full.
+         * \return false if the queue is full or closed (the item is discarded).
+         */
+        bool try_push(T item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (closed_ || (capacity_ > 0 && queue_.size() >= capacity_))
+                return false;
+            queue_.push_back(std::move(item));
+            lock.unlock();
+            not_empty_.notify_one();
+            return true;
+        }
+
+        /**
+         * \brief Removes the first item of the queue, blocking while the queue is empty and not closed.
+         * \return false if the queue has been closed and all its items have been consumed.
+         */
+        bool pop(T &item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+            if (queue_.empty())
+                return false;
+            item = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return true;
+        }
+
+        /**
+         * \brief Removes the first item of the queue if it is not empty.
+         * \return false if the queue is empty.
+         */
+        bool try_pop(T &item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (queue_.empty())
+                return false;
+            item = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return true;
+        }
+
+        /// Closes the queue and wakes up all the waiting producers and consumers.
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+            }
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+        /// Returns whether the queue has been closed.
+        bool is_closed() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return closed_;
+        }
+
+        /// Returns the number of items in the queue.
+        std::size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size();
+        }
+
+        /// Returns the max number of items the queue can hold (0 means unbounded).
+        std::size_t capacity() const { return capacity_; }
+
+    private:
+        std::deque<T> queue_;
+        const std::size_t capacity_;
+        bool closed_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+    };
+
+}
+
+#endif  // EASY3D_UTIL_BLOCKING_QUEUE_H
@@ -27,10 +27,10 @@
 #ifndef EASY3D_UTIL_TIMER_H
 #define EASY3D_UTIL_TIMER_H
 
-#include <thread>
-#include <chrono>
 #include <functional>
 
+#include <easy3d/util/timer_service.h>
+
 namespace easy3d {
 
     /**
@@ -41,6 +41,11 @@ namespace easy3d {
      *      This Timer class provides a single-header implementation.
      *      With Timer, tasks (i.e., calling to functions) can be easily scheduled at either constant intervals
      *      or after a specified period. Timer supports any types of functions with any number of arguments.
+     *      All timers share the single dispatcher thread of the TimerService, so the number of timers does not
+     *      affect the number of threads. The tasks of a timer are cancelled when it is stopped or destroyed.
+     *      By default, the functions are executed on the dispatcher thread. With set_dispatch(), the functions can
+     *      also be executed by the thread calling TimerService::process_main_thread_tasks() (e.g., the rendering
+     *      loop of the viewer).
      *
      * \example Test_Timer  \include{lineno} test_timer.cpp
      */
@@ -48,9 +53,12 @@ namespace easy3d {
     template<class... Args>
     class Timer {
     public:
-        Timer() : stopped_(false), paused_(false) {}
+        Timer() : stopped_(false), paused_(false), dispatch_(TimerService::TIMER_THREAD) {
+            // make sure the service is created first, so it outlives static timers
+            TimerService::instance();
+        }
 
-        ~Timer() { stopped_ = true; }
+        ~Timer() { stop(); }
 
         /**
          * \brief Executes function \p func after \p delay milliseconds.
@@ -153,7 +161,10 @@ namespace easy3d {
          *      temporarily pause a timer, call pause().
          * \sa  is_stopped(), pause().
          */
-        void stop() { stopped_ = true; }
+        void stop() {
+            stopped_ = true;
+            TimerService::instance().cancel(this);
+        }
 
         /**
          * \brief Returns whether the timer has been stopped. If a timer is stopped, it cannot be restarted again.
@@ -181,9 +192,19 @@ namespace easy3d {
          */
         void resume() { if (!stopped_ && paused_) paused_ = false; }
 
+        /**
+         * \brief Sets the thread where the functions scheduled by set_timeout() and set_interval() are executed.
+         *      It does not affect the tasks that have already been scheduled.
+         * \sa TimerService::process_main_thread_tasks().
+         */
+        void set_dispatch(TimerService::Dispatch dispatch) { dispatch_ = dispatch; }
+        /// Returns the thread where the functions scheduled by set_timeout() and set_interval() are executed.
+        TimerService::Dispatch dispatch() const { return dispatch_; }
+
     private:
         bool stopped_;
         bool paused_;
+        TimerService::Dispatch dispatch_;
     };
 
 
@@ -193,46 +214,37 @@ namespace easy3d {
 
     template<class... Args>
     void Timer<Args...>::single_shot(int delay, std::function<void(Args...)> const &func, Args... args) {
-        std::thread t([=]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             func(args...);
         });
-        t.detach();
     }
 
 
     template<class... Args>
     template<class Class>
     void Timer<Args...>::single_shot(int delay, Class *inst, void (Class::*func)(Args...), Args... args) {
-        std::thread t([=]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             (inst->*func)(args...);
         });
-        t.detach();
     }
 
 
     template<class... Args>
     template<class Class>
     void Timer<Args...>::single_shot(int delay, Class const *inst, void (Class::*func)(Args...) const, Args... args) {
-        std::thread t([=]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             (inst->*func)(args...);
         });
-        t.detach();
     }
 
 
     template<class... Args>
     void Timer<Args...>::set_timeout(int delay, std::function<void(Args...)> const &func, Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            if (stopped_) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             if (stopped_) return;
             func(args...);
-        });
-        t.detach();
+        }, this, dispatch_);
     }
 
 
@@ -240,13 +252,10 @@ namespace easy3d {
     template<class Class>
     void Timer<Args...>::set_timeout(int delay, Class *inst, void (Class::*func)(Args...), Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            if (stopped_) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             if (stopped_) return;
             (inst->*func)(args...);
-        });
-        t.detach();
+        }, this, dispatch_);
     }
 
 
@@ -254,29 +263,20 @@ namespace easy3d {
     template<class Class>
     void Timer<Args...>::set_timeout(int delay, Class const *inst, void (Class::*func)(Args...) const, Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            if (stopped_) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        TimerService::instance().schedule(delay, 0, [=]() {
             if (stopped_) return;
             (inst->*func)(args...);
-        });
-        t.detach();
+        }, this, dispatch_);
     }
 
 
     template<class... Args>
     void Timer<Args...>::set_interval(int interval, std::function<void(Args...)> const &func, Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            while (true) {
-                if (stopped_) return;
-                std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-                if (paused_) continue;
-                else if (stopped_) return;
-                func(args...);
-            }
-        });
-        t.detach();
+        TimerService::instance().schedule(interval, interval, [=]() {
+            if (paused_ || stopped_) return;
+            func(args...);
+        }, this, dispatch_);
     }
 
 
@@ -284,32 +284,20 @@ namespace easy3d {
     template<class Class>
     void Timer<Args...>::set_interval(int interval, Class *inst, void (Class::*func)(Args...), Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            while (true) {
-                if (stopped_) return;
-                std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-                if (paused_) continue;
-                else if (stopped_) return;
-                (inst->*func)(args...);
-            }
-        });
-        t.detach();
+        TimerService::instance().schedule(interval, interval, [=]() {
+            if (paused_ || stopped_) return;
+            (inst->*func)(args...);
+        }, this, dispatch_);
     }
 
     template<class... Args>
     template<class Class>
     void Timer<Args...>::set_interval(int interval, Class const *inst, void (Class::*func)(Args...) const, Args... args) const {
         const_cast<Timer<Args...>*>(this)->stopped_ = false;
-        std::thread t([=]() {
-            while (true) {
-                if (stopped_) return;
-                std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-                if (paused_) continue;
-                else if (stopped_) return;
-                (inst->*func)(args...);
-            }
-        });
-        t.detach();
+        TimerService::instance().schedule(interval, interval, [=]() {
+            if (paused_ || stopped_) return;
+            (inst->*func)(args...);
+        }, this, dispatch_);
     }
 
 
@@ -0,0 +1,300 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/util/timer_service.h>
+
+#include <algorithm>
+
+
+namespace easy3d {
+
+    TimerService &TimerService::instance() {
+        static TimerService service;
+        return service;
+    }
+
+
+    TimerService::TimerService() : stopped_(false), next_handle_(1) {
+    }
+
+
+    TimerService::~TimerService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        wakeup_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+
+    TimerService::Handle TimerService::schedule(int delay, int interval, std::function<void()> const &task,
+                                                const void *owner, Dispatch dispatch) {
+        if (!task)
+            return 0;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopped_)
+            return 0;
+        // the dispatcher thread is started on demand
+        if (!thread_.joinable())
+            thread_ = std::thread(&TimerService::run, this);
+
+        const Handle handle = next_handle_++;
+        Task &t = tasks_[handle];
+        t.func = task;
+        t.interval = std::chrono::milliseconds(std::max(interval, 0));
+        t.due = Clock::now() + std::chrono::milliseconds(std::max(delay, 0));
+        t.owner = owner;
+        t.dispatch = dispatch;
+        t.queued = false;
+        queue_.push({t.due, handle});
+        lock.unlock();
+
+        wakeup_.notify_one();
+        return handle;
+    }
+
+
+    TimerService::Handle TimerService::post(std::function<void()> const &task, const void *owner) {
+        if (!task)
+            return 0;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopped_)
+            return 0;
+
+        const Handle handle = next_handle_++;
+        Task &t = tasks_[handle];
+        t.func = task;
+        t.interval = std::chrono::milliseconds(0);
+        t.due = Clock::now();
+        t.owner = owner;
+        t.dispatch = MAIN_THREAD;
+        t.queued = true;
+        main_thread_tasks_.push_back(handle);
+
+        notify(lock);
+        return handle;
+    }
+
+
+    bool TimerService::cancel(Handle handle) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto pos = tasks_.find(handle);
+        if (pos == tasks_.end())
+            return false;
+        // the entries in the heap and the main thread queue are discarded when they are reached
+        tasks_.erase(pos);
+        wait_for_task(handle, lock);
+        return true;
+    }
+
+
+    std::size_t TimerService::cancel(const void *owner) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::vector<Handle> handles;
+        for (auto pos = tasks_.begin(); pos != tasks_.end();) {
+            if (pos->second.owner == owner) {
+                handles.push_back(pos->first);
+                pos = tasks_.erase(pos);
+            } else
+                ++pos;
+        }
+        for (auto handle : handles)
+            wait_for_task(handle, lock);
+        return handles.size();
+    }
+
+
+    void TimerService::wait_for_task(Handle handle, std::unique_lock<std::mutex> &lock) {
+        // a task may cancel itself (or its owner) while it is running, which must not wait
+        const std::thread::id self = std::this_thread::get_id();
+        finished_.wait(lock, [&]() {
+            for (const auto &r : running_) {
+                if (r.first == handle && r.second != self)
+                    return false;
+            }
+            return true;
+        });
+    }
+
+
+    bool TimerService::is_scheduled(Handle handle) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.find(handle) != tasks_.end();
+    }
+
+
+    std::size_t TimerService::num_tasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_.size();
+    }
+
+
+    std::size_t TimerService::num_threads() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return thread_.joinable() ? 1 : 0;
+    }
+
+
+    void TimerService::add_main_thread_notifier(const void *owner, std::function<void()> const &notifier) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &n : notifiers_) {
+            if (n.first == owner) {
+                n.second = notifier;
+                return;
+            }
+        }
+        notifiers_.emplace_back(owner, notifier);
+    }
+
+
+    void TimerService::remove_main_thread_notifier(const void *owner) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notifiers_.erase(std::remove_if(notifiers_.begin(), notifiers_.end(),
+                                        [owner](const std::pair<const void *, std::function<void()> > &n) {
+                                            return n.first == owner;
+                                        }), notifiers_.end());
+    }
+
+
+    void TimerService::notify(std::unique_lock<std::mutex> &lock) {
+        if (notifiers_.empty())
+            return;
+        // a notifier may be removed by another thread while the lock is released, so the notifiers are copied
+        const auto notifiers = notifiers_;
+        lock.unlock();
+        for (const auto &n : notifiers) {
+            if (n.second)
+                n.second();
+        }
+        lock.lock();
+    }
+
+
+    void TimerService::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_) {
+            if (queue_.empty()) {
+                wakeup_.wait(lock);
+                continue;
+            }
+
+            const Entry top = queue_.top();
+            auto pos = tasks_.find(top.handle);
+            if (pos == tasks_.end() || pos->second.due != top.due) { // cancelled
+                queue_.pop();
+                continue;
+            }
+            if (Clock::now() < top.due) {
+                // a new task may be scheduled earlier, so wake up also on notification
+                wakeup_.wait_until(lock, top.due);
+                continue;
+            }
+            queue_.pop();
+
+            Task &task = pos->second;
+            if (task.dispatch == TIMER_THREAD) {
+                execute(top.handle, lock);
+                continue;
+            }
+
+            // a MAIN_THREAD task: queue it for the main thread and schedule its next trigger
+            if (!task.queued) {
+                task.queued = true;
+                main_thread_tasks_.push_back(top.handle);
+            }
+            if (task.interval.count() > 0) {
+                const auto now = Clock::now();
+                task.due += task.interval;
+                if (task.due <= now) // skip the missed triggers
+                    task.due += task.interval * ((now - task.due) / task.interval + 1);
+                queue_.push({task.due, top.handle});
+            }
+            notify(lock);
+        }
+    }
+
+
+    void TimerService::execute(Handle handle, std::unique_lock<std::mutex> &lock) {
+        auto pos = tasks_.find(handle);
+        if (pos == tasks_.end())
+            return;
+
+        const std::function<void()> func = pos->second.func;
+        running_.emplace_back(handle, std::this_thread::get_id());
+        lock.unlock();
+
+        func();
+
+        lock.lock();
+        running_.erase(std::find(running_.begin(), running_.end(),
+                                 std::make_pair(handle, std::this_thread::get_id())));
+        finished_.notify_all();
+
+        // the task may have been cancelled during its execution
+        pos = tasks_.find(handle);
+        if (pos == tasks_.end())
+            return;
+
+        Task &task = pos->second;
+        if (task.interval.count() == 0)
+            tasks_.erase(pos);
+        else if (task.dispatch == TIMER_THREAD) {
+            // fixed-rate scheduling: the next trigger is relative to the previous due time (not the end of the
+            // execution), so the timer does not drift
+            const auto now = Clock::now();
+            task.due += task.interval;
+            if (task.due <= now) // skip the missed triggers
+                task.due += task.interval * ((now - task.due) / task.interval + 1);
+            queue_.push({task.due, handle});
+        }
+    }
+
+
+    std::size_t TimerService::process_main_thread_tasks() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (main_thread_tasks_.empty())
+            return 0;
+
+        std::deque<Handle> handles;
+        handles.swap(main_thread_tasks_);
+
+        std::size_t count = 0;
+        for (auto handle : handles) {
+            auto pos = tasks_.find(handle);
+            if (pos == tasks_.end())
+                continue;
+            pos->second.queued = false;
+            execute(handle, lock);
+            ++count;
+        }
+        return count;
+    }
+
+} // namespace easy3d
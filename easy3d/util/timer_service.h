@@ -0,0 +1,193 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_UTIL_TIMER_SERVICE_H
+#define EASY3D_UTIL_TIMER_SERVICE_H
+
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A shared timer service executing scheduled tasks on a single dispatcher thread.
+     * \class TimerService easy3d/util/timer_service.h
+     * \details All the tasks are kept in a min-heap ordered by their due time and are executed by one dispatcher
+     *      thread, no matter how many tasks are scheduled. The dispatcher thread is started on the first scheduled
+     *      task and is joined when the service is destroyed (at program exit), so no thread outlives the service.
+     *      Each scheduled task is identified by a handle that can be used to cancel it. Tasks can also be tagged with
+     *      an owner (e.g., a Timer) to cancel all the tasks of that owner at once.
+     *
+     *      Tasks scheduled with \c MAIN_THREAD are not executed by the dispatcher thread. When they are due, they are
+     *      queued and then executed by the thread calling process_main_thread_tasks() (usually the rendering loop).
+     *      Notifiers (see add_main_thread_notifier()) can be used to wake up that thread, e.g., glfwPostEmptyEvent().
+     *
+     *      Example usage:
+     *      \code
+     *          auto handle = TimerService::instance().schedule(0, 100, [&]() { refresh(); });
+     *          ...
+     *          TimerService::instance().cancel(handle);
+     *      \endcode
+     *
+     * \note A task blocks the execution of the other tasks while it is running, so long-running work should be
+     *      dispatched to other threads.
+     */
+    class TimerService {
+    public:
+        /// The handle of a scheduled task. 0 is an invalid handle.
+        typedef uint64_t Handle;
+
+        /// The thread where a task is executed.
+        enum Dispatch {
+            TIMER_THREAD,   ///< the dispatcher thread of the timer service
+            MAIN_THREAD     ///< the thread calling process_main_thread_tasks()
+        };
+
+        /// Returns the shared timer service.
+        static TimerService &instance();
+
+        ~TimerService();
+
+        /**
+         * \brief Schedules a task.
+         * \param delay The delay (in milliseconds) before the first execution of the task.
+         * \param interval The interval (in milliseconds) of repeated executions. 0 for a single-shot task.
+         * \param task The task to be executed.
+         * \param owner An optional tag of the task, which allows cancelling all tasks of the same owner at once.
+         * \param dispatch The thread where the task is executed.
+         * \return The handle of the task.
+         */
+        Handle schedule(int delay, int interval, std::function<void()> const &task, const void *owner = nullptr,
+                        Dispatch dispatch = TIMER_THREAD);
+
+        /**
+         * \brief Posts a single-shot task to be executed by the thread calling process_main_thread_tasks().
+         * \details Unlike schedule(), the task is queued immediately without involving the dispatcher thread. The
+         *      notifier (if any) is called on the calling thread.
+         * \param task The task to be executed.
+         * \param owner An optional tag of the task, which allows cancelling all tasks of the same owner at once.
+         * \return The handle of the task.
+         */
+        Handle post(std::function<void()> const &task, const void *owner = nullptr);
+
+        /**
+         * \brief Cancels a task. Once this function returns, the task will not be executed again. If the task is
+         *      running on another thread, this function blocks until its execution is finished.
+         * \return true if the task was cancelled, false if it did not exist or has already finished.
+         */
+        bool cancel(Handle handle);
+
+        /// Cancels all the tasks of \p owner. See cancel().
+        std::size_t cancel(const void *owner);
+
+        /// Returns whether a task is still scheduled.
+        bool is_scheduled(Handle handle) const;
+
+        /// Returns the number of scheduled tasks.
+        std::size_t num_tasks() const;
+
+        /// Returns the number of threads used by the service (i.e., 1 once a task has been scheduled, otherwise 0).
+        std::size_t num_threads() const;
+
+        /**
+         * \brief Executes the due tasks that were scheduled with \c MAIN_THREAD.
+         * \details This function is supposed to be called regularly by the thread that should execute the tasks.
+         * \return The number of executed tasks.
+         */
+        std::size_t process_main_thread_tasks();
+
+        /**
+         * \brief Registers a function to be called when a \c MAIN_THREAD task becomes due.
+         * \details Each \p owner (e.g., a viewer) registers its own notifier, and all registered notifiers are
+         *      called on the dispatcher thread, or on the thread calling post(). Registering a notifier again for
+         *      the same owner replaces the previous one.
+         */
+        void add_main_thread_notifier(const void *owner, std::function<void()> const &notifier);
+        /// Removes the notifier registered by \p owner. The notifiers of the other owners are kept.
+        void remove_main_thread_notifier(const void *owner);
+
+    private:
+        TimerService();
+        TimerService(const TimerService &) = delete;
+        TimerService &operator=(const TimerService &) = delete;
+
+        void run();
+        // executes the task (if it is still scheduled). The lock is held on entry and exit.
+        void execute(Handle handle, std::unique_lock<std::mutex> &lock);
+        // waits (with the lock held) until the task is not running on any other thread.
+        void wait_for_task(Handle handle, std::unique_lock<std::mutex> &lock);
+        // calls all the notifiers. The lock is held on entry and exit, but released while calling them.
+        void notify(std::unique_lock<std::mutex> &lock);
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct Task {
+            std::function<void()> func;
+            std::chrono::milliseconds interval;
+            Clock::time_point due;
+            const void *owner;
+            Dispatch dispatch;
+            bool queued;    // a MAIN_THREAD task already waiting to be processed (repeated triggers are merged)
+        };
+
+        struct Entry {
+            Clock::time_point due;
+            Handle handle;
+            bool operator>(const Entry &other) const {
+                return due > other.due || (due == other.due && handle > other.handle);
+            }
+        };
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable wakeup_;    // wakes up the dispatcher thread
+        std::condition_variable finished_;  // signals the end of the execution of a task
+
+        std::thread thread_;
+        bool stopped_;
+
+        Handle next_handle_;
+        std::unordered_map<Handle, Task> tasks_;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue_;
+        std::deque<Handle> main_thread_tasks_;
+
+        std::vector< std::pair<Handle, std::thread::id> > running_;  // the tasks being executed and their threads
+        std::vector< std::pair<const void *, std::function<void()> > > notifiers_;  // and their owners
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_UTIL_TIMER_SERVICE_H
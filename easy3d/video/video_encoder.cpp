@@ -214,6 +214,24 @@ namespace internal {
             throw std::runtime_error(error_msg);
         }
 
+		/* the frame is already in the codec pixel format (e.g., converted by VideoRecorder): copy the planes */
+		if (pix_fmt == c->pix_fmt) {
+			const int num_bytes = av_image_get_buffer_size(pix_fmt, width, height, 1);
+			if (num_bytes != width * height * 3 / 2) {
+				std::string error_msg = "number of bytes mismatch";
+				LOG(ERROR) << error_msg;
+				throw std::runtime_error(error_msg);
+			}
+
+			uint8_t *src_data[4] = { nullptr };
+			int src_linesize[4] = { 0 };
+			av_image_fill_arrays(src_data, src_linesize, image_data, pix_fmt, width, height, 1);
+			av_image_copy(ost->frame->data, ost->frame->linesize, const_cast<const uint8_t **>(src_data), src_linesize, pix_fmt, width, height);
+
+			ost->frame->pts = ost->next_pts++;
+			return ost->frame;
+		}
+
 		/* as we only generate a YUV420P picture, we must convert it
 		 * to the codec pixel format if needed */
 
@@ -484,6 +502,10 @@ namespace easy3d {
                 channels = 4;
                 pix_fmt = AV_PIX_FMT_BGRA;
                 break;
+            case PIX_FMT_YUV420P:
+                channels = 1;   // not used for planar formats
+                pix_fmt = AV_PIX_FMT_YUV420P;
+                break;
         }
 		return encoder_->write_frame(data, width, height, channels, pix_fmt);
 	}
@@ -67,7 +67,9 @@ namespace easy3d {
             PIX_FMT_RGB_888,    /// packed RGB 8:8:8, 24bpp, RGBRGB...
             PIX_FMT_BGR_888,    /// packed BGR 8:8:8, 24bpp, BGRBGR...
             PIX_FMT_RGBA_8888,  /// packed RGBA 8:8:8:8, 32bpp, RGBARGBA...
-            PIX_FMT_BGRA_8888   /// packed BGRA 8:8:8:8, 32bpp, BGRABGRA...
+            PIX_FMT_BGRA_8888,  /// packed BGRA 8:8:8:8, 32bpp, BGRABGRA...
+            PIX_FMT_YUV420P     /// planar YUV 4:2:0, 12bpp, (1 Cr & Cb sample per 2x2 Y samples). It is passed to
+                                /// the codec without conversion (see VideoRecorder::rgba_to_yuv420p()).
         };
 
 		/**
@@ -85,6 +87,7 @@ namespace easy3d {
          *          BGR 8:8:8, 24bpp     <--->  PIX_FMT_BGR_888    <--->  GL_BGR
          *          RGBA 8:8:8:8, 32bpp  <--->  PIX_FMT_RGBA_8888  <--->  GL_RGBA
          *          BGRA 8:8:8:8, 32bpp  <--->  PIX_FMT_BGRA_8888  <--->  GL_BGRA
+         *          YUV 4:2:0, 12bpp     <--->  PIX_FMT_YUV420P    <--->  (the Y, U, and V planes stored contiguously)
 		 * \return true on successful.
 		 **/
 		bool encode(const unsigned char* data, int width, int height, PixelFormat pixel_format);
@@ -0,0 +1,281 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/video/video_recorder.h>
+
+#include <map>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+#include <easy3d/video/video_encoder.h>
+#include <easy3d/util/blocking_queue.h>
+#include <easy3d/util/logging.h>
+
+
+namespace internal {
+
+    struct RecordedFrame {
+        std::size_t index;
+        bool flip;
+        std::vector<unsigned char> data;
+    };
+
+
+    // The pipeline: add_frame() -> raw_frames_ -> converters_ (RGBA to YUV) -> converted_frames_ -> writer_.
+    // The converters may finish frames out of order, so the writer reorders them before encoding.
+    class VideoRecorderImpl {
+    public:
+        VideoRecorderImpl(unsigned int num_converters, std::size_t queue_capacity)
+                : raw_frames_(queue_capacity), converted_frames_(queue_capacity)
+                , num_converters_(num_converters), width_(0), height_(0), num_added_(0)
+                , num_encoded_(0), failed_(false) {}
+
+        bool start(const std::string& file_name, int framerate, int bitrate) {
+            if (!encoder_.start(file_name, framerate, bitrate))
+                return false;
+            for (unsigned int i = 0; i < num_converters_; ++i)
+                converters_.emplace_back(&VideoRecorderImpl::convert_frames, this);
+            writer_ = std::thread(&VideoRecorderImpl::encode_frames, this);
+            return true;
+        }
+
+        bool add_frame(std::vector<unsigned char>&& rgba, int width, int height, bool flip) {
+            if (failed_)
+                return false;
+            if (num_added_ == 0) {
+                width_ = width;
+                height_ = height;
+            }
+            else if (width != width_ || height != height_) {
+                LOG(ERROR) << "frame size (" << width << ", " << height << ") differs from the size of the previous frames ("
+                           << width_ << ", " << height_ << ")";
+                return false;
+            }
+
+            RecordedFrame frame;
+            frame.index = num_added_;
+            frame.flip = flip;
+            frame.data = std::move(rgba);
+            if (!raw_frames_.push(std::move(frame)))
+                return false;
+            ++num_added_;
+            return true;
+        }
+
+        bool end() {
+            raw_frames_.close();
+            for (auto& t : converters_)
+                t.join();
+            converted_frames_.close();
+            writer_.join();
+
+            if (!encoder_.end())
+                failed_ = true;
+            if (num_encoded_ != num_added_)
+                LOG(ERROR) << num_encoded_ << " out of " << num_added_ << " frames encoded";
+            return !failed_;
+        }
+
+        std::size_t num_encoded_frames() const { return num_encoded_; }
+
+    private:
+        void convert_frames() {
+            RecordedFrame frame;
+            while (raw_frames_.pop(frame)) {
+                if (failed_)    // keep draining so that the producer never blocks
+                    continue;
+                std::vector<unsigned char> yuv(width_ * height_ * 3 / 2);
+                easy3d::VideoRecorder::rgba_to_yuv420p(frame.data.data(), width_, height_, frame.flip, yuv.data());
+                frame.data.swap(yuv);
+                converted_frames_.push(std::move(frame));
+            }
+        }
+
+        void encode_frames() {
+            std::map<std::size_t, RecordedFrame> pending;
+            std::size_t next_index = 0;
+            RecordedFrame frame;
+            while (converted_frames_.pop(frame)) {
+                if (failed_)
+                    continue;
+                const std::size_t index = frame.index;
+                pending[index] = std::move(frame);
+                for (auto pos = pending.find(next_index); pos != pending.end(); pos = pending.find(next_index)) {
+                    bool success = false;
+                    try {
+                        success = encoder_.encode(pos->second.data.data(), width_, height_, easy3d::VideoEncoder::PIX_FMT_YUV420P);
+                    }
+                    catch (const std::exception& e) {
+                        LOG(ERROR) << "failed encoding frame " << next_index << ": " << e.what();
+                    }
+                    if (!success) {
+                        failed_ = true;
+                        raw_frames_.close();  // reject the frames to come
+                        pending.clear();
+                        break;
+                    }
+                    pending.erase(pos);
+                    ++next_index;
+                    ++num_encoded_;
+                }
+            }
+        }
+
+    private:
+        easy3d::VideoEncoder encoder_;
+        easy3d::BlockingQueue<RecordedFrame> raw_frames_;
+        easy3d::BlockingQueue<RecordedFrame> converted_frames_;
+
+        unsigned int num_converters_;
+        std::vector<std::thread> converters_;
+        std::thread writer_;
+
+        int width_;
+        int height_;
+        std::size_t num_added_;
+        std::atomic<std::size_t> num_encoded_;
+        std::atomic<bool> failed_;
+    };
+
+}
+
+
+using namespace internal;
+
+namespace easy3d {
+
+    VideoRecorder::VideoRecorder(unsigned int num_converters, std::size_t queue_capacity)
+            : num_converters_(num_converters), queue_capacity_(std::max<std::size_t>(queue_capacity, 1))
+            , recorder_(nullptr)
+    {
+        if (num_converters_ == 0)
+            num_converters_ = std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+
+
+    VideoRecorder::~VideoRecorder() {
+        if (recorder_) {
+            LOG(WARNING) << "VideoRecorder::end() should be called after adding all frames";
+            end();
+        }
+    }
+
+
+    bool VideoRecorder::start(const std::string& file_name, int framerate, int bitrate) {
+        if (recorder_) {
+            LOG(ERROR) << "the video recorder has already started";
+            return false;
+        }
+
+        recorder_ = new VideoRecorderImpl(num_converters_, queue_capacity_);
+        if (!recorder_->start(file_name, framerate, bitrate)) {
+            delete recorder_;
+            recorder_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+
+    bool VideoRecorder::add_frame(std::vector<unsigned char>&& rgba, int width, int height, bool flip_vertically) {
+        if (!recorder_) {
+            LOG(ERROR) << "the video recorder has not started yet";
+            return false;
+        }
+        if (!VideoEncoder::is_size_acceptable(width, height)) {
+            LOG(ERROR) << "video frame resolution (" << width << ", " << height << ") is not a multiple of 8";
+            return false;
+        }
+        if (rgba.size() != static_cast<std::size_t>(width) * height * 4) {
+            LOG(ERROR) << "frame data size (" << rgba.size() << ") does not match an RGBA image of "
+                       << width << " x " << height;
+            return false;
+        }
+        return recorder_->add_frame(std::move(rgba), width, height, flip_vertically);
+    }
+
+
+    bool VideoRecorder::end() {
+        if (!recorder_) {
+            LOG(ERROR) << "the video recorder has not started yet";
+            return false;
+        }
+
+        const bool success = recorder_->end();
+        delete recorder_;
+        recorder_ = nullptr;
+        return success;
+    }
+
+
+    std::size_t VideoRecorder::num_encoded_frames() const {
+        return recorder_ ? recorder_->num_encoded_frames() : 0;
+    }
+
+
+    void VideoRecorder::rgba_to_yuv420p(const unsigned char* rgba, int width, int height, bool flip_vertically,
+                                        unsigned char* yuv)
+    {
+        // ITU-R BT.601, limited range (the default of the encoders and swscale):
+        //      Y = ( 66 R + 129 G +  25 B) / 256 + 16
+        //      U = (-38 R -  74 G + 112 B) / 256 + 128
+        //      V = (112 R -  94 G -  18 B) / 256 + 128
+        // U and V are computed from the sum of each 2x2 block, so the averaging is folded into the shift.
+        const int half_width = width / 2;
+        unsigned char* y_plane = yuv;
+        unsigned char* u_plane = y_plane + width * height;
+        unsigned char* v_plane = u_plane + half_width * (height / 2);
+
+        const std::size_t row_size = static_cast<std::size_t>(width) * 4;
+        for (int j = 0; j + 1 < height; j += 2) {
+            const unsigned char* row0 = rgba + row_size * (flip_vertically ? height - 1 - j : j);
+            const unsigned char* row1 = rgba + row_size * (flip_vertically ? height - 2 - j : j + 1);
+            unsigned char* y0 = y_plane + width * j;
+            unsigned char* y1 = y0 + width;
+            for (int i = 0; i < width; ++i) {
+                const unsigned char* p0 = row0 + 4 * i;
+                const unsigned char* p1 = row1 + 4 * i;
+                y0[i] = static_cast<unsigned char>(((66 * p0[0] + 129 * p0[1] + 25 * p0[2] + 128) >> 8) + 16);
+                y1[i] = static_cast<unsigned char>(((66 * p1[0] + 129 * p1[1] + 25 * p1[2] + 128) >> 8) + 16);
+            }
+
+            unsigned char* u = u_plane + half_width * (j / 2);
+            unsigned char* v = v_plane + half_width * (j / 2);
+            for (int i = 0; i < half_width; ++i) {
+                const unsigned char* p0 = row0 + 8 * i;
+                const unsigned char* p1 = row1 + 8 * i;
+                const int r = p0[0] + p0[4] + p1[0] + p1[4];
+                const int g = p0[1] + p0[5] + p1[1] + p1[5];
+                const int b = p0[2] + p0[6] + p1[2] + p1[6];
+                u[i] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+                v[i] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+            }
+        }
+    }
+
+}
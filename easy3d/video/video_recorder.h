@@ -0,0 +1,119 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_VIDEO_RECORDER_H
+#define EASY3D_VIDEO_RECORDER_H
+
+#include <string>
+#include <vector>
+
+
+namespace internal {
+    class VideoRecorderImpl;
+}
+
+
+namespace easy3d {
+
+    /**
+     * @brief Records video frames into a video file asynchronously.
+     * @details Unlike VideoEncoder, which converts and encodes each frame on the calling thread, VideoRecorder
+     *    only queues the frames. The RGBA to YUV 4:2:0 conversion runs on a pool of worker threads and the
+     *    encoding runs on a dedicated thread. The queues are bounded, so add_frame() blocks only when the
+     *    consumers fall behind. Frames are encoded in the order they are added. Together with FrameCapture
+     *    (which reads back the framebuffer without stalling the GPU), the rendering loop runs at nearly full
+     *    speed during recording. Below is an example of usage:
+     *      \code
+     *          VideoRecorder recorder;
+     *          recorder.start(output_file, 30, 100 * 1024 * 1024);  // 30 fps, 100 Mbit/s
+     *          for (...) {
+     *              std::vector<unsigned char> rgba = ...;
+     *              recorder.add_frame(std::move(rgba), w, h);
+     *          }
+     *          recorder.end();
+     *      \endcode
+     * @class VideoRecorder easy3d/video/video_recorder.h
+     */
+    class VideoRecorder {
+    public:
+        /**
+         * @brief Constructor.
+         * @param num_converters The number of threads converting the frames. 0 means half of the hardware threads.
+         * @param queue_capacity The max number of frames waiting for conversion (and for encoding, respectively).
+         */
+        explicit VideoRecorder(unsigned int num_converters = 0, std::size_t queue_capacity = 8);
+        /// Destructor. It finishes the recording if end() has not been called.
+        ~VideoRecorder();
+
+        /**
+         * @brief Starts recording and launches the worker threads.
+         * @param file_name The name of the output video file, e.g., "C:/result.mp4". The output format is
+         *      automatically guessed according to the file extension.
+         */
+        bool start(const std::string& file_name, int framerate, int bitrate);
+
+        /**
+         * @brief Queues one frame for encoding.
+         * @param rgba The frame data, 'height' rows of 'width' RGBA pixels (i.e., PIX_FMT_RGBA_8888). It is moved
+         *      into the queue, so no copy is made.
+         * @param flip_vertically true if the rows are stored bottom-up, e.g., the data read from OpenGL.
+         * @return false if the frame was rejected, e.g., the recorder is not started, the size is not acceptable,
+         *      or encoding has failed.
+         */
+        bool add_frame(std::vector<unsigned char>&& rgba, int width, int height, bool flip_vertically = false);
+
+        /**
+         * @brief Waits until all the queued frames have been encoded and closes the video file.
+         * @return true if all frames have been successfully encoded.
+         */
+        bool end();
+
+        /// Returns the number of frames that have been encoded so far.
+        std::size_t num_encoded_frames() const;
+
+        /**
+         * @brief Converts an RGBA image into planar YUV 4:2:0 (BT.601, limited range, as used by most encoders).
+         * @details The conversion uses integer arithmetic and processes two rows at a time, so the inner loops are
+         *      free of branches and can be vectorized by the compiler.
+         * @param rgba The input image, 'height' rows of 'width' RGBA pixels.
+         * @param width The width of the image. It must be even.
+         * @param height The height of the image. It must be even.
+         * @param flip_vertically true if the rows of \p rgba are stored bottom-up.
+         * @param yuv The output, which must hold width * height * 3 / 2 bytes: the Y plane (width x height)
+         *      followed by the U and V planes (width/2 x height/2 each).
+         */
+        static void rgba_to_yuv420p(const unsigned char* rgba, int width, int height, bool flip_vertically,
+                                    unsigned char* yuv);
+
+    private:
+        unsigned int num_converters_;
+        std::size_t queue_capacity_;
+        internal::VideoRecorderImpl* recorder_;
+    };
+
+}
+
+#endif	// EASY3D_VIDEO_RECORDER_H
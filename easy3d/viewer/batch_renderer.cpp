@@ -0,0 +1,184 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/viewer/batch_renderer.h>
+
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/graph.h>
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/poly_mesh.h>
+#include <easy3d/renderer/camera.h>
+#include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/graph_io.h>
+#include <easy3d/fileio/surface_mesh_io.h>
+#include <easy3d/fileio/poly_mesh_io.h>
+#include <easy3d/fileio/ply_reader_writer.h>
+#include <easy3d/util/blocking_queue.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    namespace internal {
+
+        // Loads a model (without touching OpenGL, so it can run on any thread). The model type is determined in the
+        // same way as in Viewer::add_model().
+        Model* load_model(const std::string& file_path) {
+            const std::string file_name = file_system::convert_to_native_style(file_path);
+            const std::string& ext = file_system::extension(file_name, true);
+            bool is_ply_mesh = false;
+            if (ext == "ply")
+                is_ply_mesh = (io::PlyReader::num_instances(file_name, "face") > 0);
+
+            Model* model = nullptr;
+            if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "geojson" || ext == "trilist")
+                model = SurfaceMeshIO::load(file_name);
+            else if (ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0)
+                model = GraphIO::load(file_name);
+            else if (ext == "plm" || ext == "pm" || ext == "mesh")
+                model = PolyMeshIO::load(file_name);
+            else
+                model = PointCloudIO::load(file_name);
+
+            if (model)
+                model->set_name(file_name);
+            return model;
+        }
+
+        struct LoadedModel {
+            std::size_t job;
+            Model* model;
+            double load_time;
+        };
+
+    }
+
+
+    BatchRenderer::BatchRenderer(Viewer::ContextAPI context_api, unsigned int num_loaders)
+            : renderer_(nullptr)
+            , num_loaders_(std::max(num_loaders, 1u))
+    {
+        renderer_ = new OffScreen(800, 600, context_api);
+        default_orientation_ = renderer_->camera()->orientation();
+    }
+
+
+    BatchRenderer::~BatchRenderer() {
+        delete renderer_;
+    }
+
+
+    std::vector<BatchRenderer::Report> BatchRenderer::render(const std::vector<Job>& jobs) {
+        std::vector<Report> reports(jobs.size());
+        if (jobs.empty())
+            return reports;
+
+        StopWatch total;
+
+        // the loaders stay at most 'num_loaders_' models ahead of rendering, which bounds the memory
+        BlockingQueue<internal::LoadedModel> loaded(num_loaders_);
+        std::atomic<std::size_t> next_job(0);
+        std::vector<std::thread> loaders;
+        const unsigned int num_loaders = static_cast<unsigned int>(std::min<std::size_t>(num_loaders_, jobs.size()));
+        for (unsigned int i = 0; i < num_loaders; ++i) {
+            loaders.emplace_back([&]() {
+                for (std::size_t idx = next_job++; idx < jobs.size(); idx = next_job++) {
+                    StopWatch w;
+                    Model* model = internal::load_model(jobs[idx].model_file);
+                    loaded.push({idx, model, w.elapsed_seconds(6)});
+                }
+            });
+        }
+
+        Camera* camera = renderer_->camera();
+        for (std::size_t n = 0; n < jobs.size(); ++n) {
+            internal::LoadedModel item = {0, nullptr, 0.0};
+            if (!loaded.pop(item))
+                break;
+
+            const Job& job = jobs[item.job];
+            Report& report = reports[item.job];
+            report.load_time = item.load_time;
+            if (!item.model) {
+                LOG(ERROR) << "failed loading model: " << job.model_file;
+                continue;
+            }
+
+            StopWatch w;
+            if (renderer_->width() != job.width || renderer_->height() != job.height)
+                renderer_->resize(job.width, job.height);
+            renderer_->add_model(item.model, true);
+            if (job.style)
+                job.style(item.model);
+
+            bool fitted = false;
+            for (const auto& view : job.views) {
+                if (view.fit_screen) {
+                    if (!fitted) {
+                        camera->setOrientation(default_orientation_);
+                        renderer_->fit_screen(item.model);
+                        fitted = true;
+                    }
+                } else {
+                    camera->setPosition(view.position);
+                    camera->setOrientation(view.orientation);
+                    fitted = false;
+                }
+                if (renderer_->render(view.file_name, 1.0f, job.samples, job.background))
+                    ++report.num_images;
+                else
+                    LOG(ERROR) << "failed rendering image: " << view.file_name;
+            }
+
+            renderer_->delete_model(item.model);
+            report.render_time = w.elapsed_seconds(6);
+            report.success = (report.num_images == job.views.size());
+            LOG(INFO) << "job " << item.job << " (" << file_system::simple_name(job.model_file) << "): "
+                      << report.num_images << " images, loading " << report.load_time << " s, rendering "
+                      << report.render_time << " s";
+        }
+
+        loaded.close();
+        for (auto& t : loaders)
+            t.join();
+
+        std::size_t num_failed = 0;
+        for (const auto& r : reports) {
+            if (!r.success)
+                ++num_failed;
+        }
+        LOG(INFO) << jobs.size() - num_failed << " out of " << jobs.size() << " jobs succeeded. "
+                  << total.time_string();
+        return reports;
+    }
+
+}
@@ -0,0 +1,127 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_VIEWER_BATCH_RENDERER_H
+#define EASY3D_VIEWER_BATCH_RENDERER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <easy3d/viewer/offscreen.h>
+
+
+namespace easy3d {
+
+    /**
+     * @brief Renders images of many models in one go, e.g., thumbnails or multi-view image sets.
+     * @class BatchRenderer easy3d/viewer/batch_renderer.h
+     * @details A single OffScreen renderer (and thus one OpenGL context) is used for all jobs, so the shader
+     *      programs (see ShaderManager) and the textures (see TextureManager) are created only once. While a model
+     *      is being rendered, the next models are loaded by worker threads. With Viewer::CONTEXT_EGL or
+     *      Viewer::CONTEXT_OSMESA, the renderer runs on servers without a display. Example usage:
+     *      \code
+     *          BatchRenderer renderer(Viewer::CONTEXT_EGL);
+     *          std::vector<BatchRenderer::Job> jobs;
+     *          for (const auto& file : files) {
+     *              BatchRenderer::Job job(file, 256, 256);
+     *              job.views.emplace_back(file_system::base_name(file) + ".png");   // the default view
+     *              jobs.push_back(job);
+     *          }
+     *          const auto reports = renderer.render(jobs);
+     *      \endcode
+     */
+    class BatchRenderer {
+    public:
+        /// A view of a model to be rendered into an image file.
+        struct View {
+            /// A view that shows the entire model, looking along the default view direction.
+            explicit View(const std::string& file) : file_name(file), fit_screen(true) {}
+            /// A view from a given camera pose.
+            View(const std::string& file, const vec3& pos, const quat& orient)
+                    : file_name(file), position(pos), orientation(orient), fit_screen(false) {}
+
+            std::string file_name;  ///< The output image file (png, jpg, bmp, or tga).
+            vec3 position;          ///< The camera position (ignored if fit_screen is true).
+            quat orientation;       ///< The camera orientation (ignored if fit_screen is true).
+            bool fit_screen;        ///< Use the default view showing the entire model.
+        };
+
+        /// A rendering job: a model and the views to be rendered.
+        struct Job {
+            explicit Job(const std::string& file, int w = 800, int h = 600)
+                    : model_file(file), width(w), height(h), samples(4), background(1) {}
+
+            std::string model_file;         ///< The model to be rendered.
+            std::vector<View> views;        ///< The views to be rendered.
+            int width;                      ///< The width of the images.
+            int height;                     ///< The height of the images.
+            int samples;                    ///< The number of samples for antialiasing.
+            int background;                 ///< The background. 0: current color; 1: white; 2: transparent.
+            /// Customizes the rendering style of the model, e.g., the coloring or visibility of its drawables.
+            std::function<void(Model*)> style;
+        };
+
+        /// The result of a job.
+        struct Report {
+            Report() : success(false), num_images(0), load_time(0.0), render_time(0.0) {}
+
+            bool success;           ///< true if the model has been loaded and all images have been rendered.
+            std::size_t num_images; ///< The number of images written.
+            double load_time;       ///< The time (in seconds) for loading the model (on a worker thread).
+            double render_time;     ///< The time (in seconds) for creating the drawables and rendering all views.
+        };
+
+    public:
+        /**
+         * @brief Constructor.
+         * @param context_api The API for creating the OpenGL context (see Viewer::ContextAPI).
+         * @param num_loaders The number of threads loading the models ahead of rendering.
+         */
+        explicit BatchRenderer(Viewer::ContextAPI context_api = Viewer::CONTEXT_NATIVE, unsigned int num_loaders = 2);
+        ~BatchRenderer();
+
+        /**
+         * @brief Runs all jobs.
+         * @details The models are loaded concurrently and rendered in the order they finish loading. Each model is
+         *      deleted after its views have been rendered.
+         * @return The reports of the jobs, in the same order as \p jobs.
+         */
+        std::vector<Report> render(const std::vector<Job>& jobs);
+
+        /// Returns the offscreen renderer, e.g., to change the background color or to add extra drawables.
+        OffScreen* renderer() { return renderer_; }
+
+    private:
+        OffScreen* renderer_;
+        unsigned int num_loaders_;
+        quat default_orientation_;
+    };
+
+}
+
+
+#endif	// EASY3D_VIEWER_BATCH_RENDERER_H
@@ -26,11 +26,13 @@
 
 #include <easy3d/viewer/offscreen.h>
 
+#include <3rd_party/glfw/include/GLFW/glfw3.h>  // for glfw functions
+
 
 namespace easy3d {
 
-    OffScreen::OffScreen(int width, int height)
-            : Viewer("Easy3D OffScreen Renderer", 4, 3, 2, false, true, 24, 8, width, height)
+    OffScreen::OffScreen(int width, int height, ContextAPI context_api)
+            : Viewer("Easy3D OffScreen Renderer", 4, 3, 2, false, true, 24, 8, width, height, context_api)
     {
         usage_string_ = "";
         init();
@@ -47,6 +49,11 @@ namespace easy3d {
     }
 
 
+    void OffScreen::fit_screen(const easy3d::Model *model) {
+        Viewer::fit_screen(model);
+    }
+
+
     bool OffScreen::render(const std::string &file_name, float scaling, int samples, int back_ground, bool expand) const {
         return snapshot(file_name, scaling, samples, back_ground, expand);
     }
@@ -54,6 +61,10 @@ namespace easy3d {
 
     void OffScreen::resize(int w, int h) {
         Viewer::resize(w, h);
+        // there is no event loop, so apply the new size immediately
+        int width = 0, height = 0;
+        glfwGetWindowSize(window_, &width, &height);
+        callback_event_resize(width, height);
     }
 
 
@@ -53,8 +53,10 @@ namespace easy3d {
          * @brief Constructor
          * @param width The width of the offscreen renderer, which can be changed by calling resize() after construction.
          * @param height The height of the offscreen renderer, which can be changed by calling resize() after construction.
+         * @param context_api The API for creating the OpenGL context. Use Viewer::CONTEXT_EGL or
+         *      Viewer::CONTEXT_OSMESA for rendering on servers without a display (see Viewer::ContextAPI).
          */
-		explicit OffScreen(int width = 800, int height = 600);
+		explicit OffScreen(int width = 800, int height = 600, ContextAPI context_api = CONTEXT_NATIVE);
 
         /// @name Camera manipulation.
         //@{
@@ -62,6 +64,12 @@ namespace easy3d {
         Camera* camera();
         /// @brief Returns the camera used by the offscreen renderer. See \c Camera.
         const Camera* camera() const;
+        /**
+         * @brief Moves the camera so that the entire scene or the given model is centered on the screen at a
+         *      proper scale.
+         * @param model The model to fit. If nullptr, the entire scene (i.e., all models and drawables) is fitted.
+         */
+        void fit_screen(const easy3d::Model* model = nullptr);
         //@}
 
         /**
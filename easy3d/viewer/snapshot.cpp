@@ -29,8 +29,19 @@
 #include <easy3d/renderer/framebuffer_object.h>
 #include <easy3d/renderer/camera.h>
 #include <easy3d/renderer/transform.h>
-#include <easy3d/core/matrix.h>
+#include <easy3d/renderer/frame_capture.h>
 #include <easy3d/fileio/image_io.h>
+#include <easy3d/fileio/image_io_png.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/blocking_queue.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
+
+#include <thread>
+#include <deque>
+#include <numeric>
+#include <algorithm>
+#include <cstring>
 
 #include <easy3d/renderer/opengl.h>				// for gl functions
 
@@ -110,11 +121,24 @@ namespace easy3d {
 				yMin = static_cast<float>(xMin / newAspectRatio);
 		}
 
-		typedef Vec<4, unsigned char> Pixel; // in RGBA order
-		Matrix<Pixel> image(h, w); // Note: rows first
-		if (!image.data()) {
-			LOG(ERROR) << "failed to allocate the image with size " << w << " x " << h;
-			return false;
+		// For PNG files, the image is streamed to the file band by band (a band is a row of tiles), so the full image
+		// never needs to be in memory. Other formats are assembled into a complete image and then saved.
+		const bool streaming = (file_system::extension(file_name, true) == "png");
+
+		io::StripedPngWriter png_writer;
+		std::vector<unsigned char> image;
+		if (streaming) {
+			if (!png_writer.open(file_name, w, h, 4))
+				return false;
+		}
+		else {
+			try {
+				image.resize(static_cast<std::size_t>(w) * h * 4);
+			}
+			catch (const std::bad_alloc&) {
+				LOG(ERROR) << "failed to allocate the image with size " << w << " x " << h;
+				return false;
+			}
 		}
 
 		double scaleX = sub_w / static_cast<double>(w);
@@ -138,8 +162,55 @@ namespace easy3d {
 		fbo->add_color_buffer();
 		fbo->add_depth_buffer();
 
-		for (int i = 0; i < nbX; i++) {
-			for (int j = 0; j < nbY; j++) {
+		// The tiles are read back asynchronously: the read back of a tile overlaps with the rendering of the next one.
+		FrameCapture capture(sub_w, sub_h, 2);
+		std::deque< std::pair<int, int> > pending_tiles;	// (column, row) of the tiles being read back
+		std::vector<unsigned char> tile;
+
+		// The completed bands are compressed and written by a separate thread, while the next band is being rendered.
+		BlockingQueue< std::pair<std::vector<unsigned char>, int> > bands(2);
+		bool write_ok = true;
+		std::thread writer;
+		std::vector<unsigned char> band;
+		if (streaming) {
+			band.resize(static_cast<std::size_t>(w) * sub_h * 4);
+			writer = std::thread([&png_writer, &bands, &write_ok]() {
+				std::pair<std::vector<unsigned char>, int> item;
+				while (bands.pop(item)) {
+					if (write_ok)
+						write_ok = png_writer.write_rows(item.first.data(), item.second);
+				}
+			});
+		}
+
+		// copies a tile (stored bottom-up, as read by OpenGL) to its place in the current band or the full image
+		auto place_tile = [&](int i, int j) {
+			const int cols = std::min(sub_w, w - i * sub_w);
+			const int rows = std::min(sub_h, h - j * sub_h);
+			unsigned char* dest = streaming ? band.data() : image.data() + static_cast<std::size_t>(j) * sub_h * w * 4;
+#pragma omp parallel for
+			for (int r = 0; r < rows; ++r) {
+				const unsigned char* src = tile.data() + static_cast<std::size_t>(sub_h - 1 - r) * sub_w * 4;
+				unsigned char* dst = dest + (static_cast<std::size_t>(r) * w + static_cast<std::size_t>(i) * sub_w) * 4;
+				std::memcpy(dst, src, static_cast<std::size_t>(cols) * 4);
+			}
+			// the last tile of a row completes the band
+			if (streaming && i == nbX - 1) {
+				bands.push(std::make_pair(std::move(band), rows));
+				band.assign(static_cast<std::size_t>(w) * sub_h * 4, 0);
+			}
+		};
+		auto place_oldest_tile = [&]() {
+			place_tile(pending_tiles.front().first, pending_tiles.front().second);
+			pending_tiles.pop_front();
+		};
+
+		std::vector<double> tile_times;	// the render time of each tile, in seconds
+		StopWatch w_tile;
+		// Tiles are rendered row by row (top to bottom), so the bands are completed in the order they are written.
+		for (int j = 0; j < nbY; j++) {
+			for (int i = 0; i < nbX; i++) {
+				w_tile.start();
 				if (camera_->type() == Camera::PERSPECTIVE) {
 					// change the projection matrix of the camera.
 					const mat4& proj = transform::frustum(
@@ -184,23 +255,17 @@ namespace easy3d {
 
 				//---------------------------------------------------------------------------
 
-				Matrix<Pixel> subImage(sub_h, sub_w); // Note: rows first
-				fbo->read_color(0, reinterpret_cast<unsigned char*>(subImage.data()), GL_RGBA);
-
-				// Copy subImage in image
-				for (int ii = 0; ii < sub_w; ii++) {
-					int fi = i * sub_w + ii;
-					if (fi == image.cols())
-						break;
-					for (int jj = 0; jj < sub_h; jj++) {
-						int fj = j * sub_h + jj;
-						if (fj == image.rows())
-							break;
-						image.set(fj, fi, subImage.get(jj, ii));
-					}
-				}
+				// starts reading back this tile, and receives the previous one if its transfer is due
+				pending_tiles.emplace_back(i, j);
+				const bool received = capture.capture(fbo, tile);
+				tile_times.push_back(w_tile.elapsed_seconds(6));
+				VLOG(1) << "tile (" << i << ", " << j << ") rendered. Time: " << w_tile.time_string(3) << " seconds";
+				if (received)
+					place_oldest_tile();
 			}
 		}
+		while (capture.retrieve(tile))
+			place_oldest_tile();
 
 		// clean
 		delete fbo;
@@ -211,12 +276,23 @@ namespace easy3d {
 		camera_->set_projection_matrix(proj_matrix);
 
 		// enable updating the rendering
-		easy3d::connect(&camera_->frame_modified, const_cast<Viewer*>(this), &Viewer::update);
+		easy3d::connect(&camera_->frame_modified, const_cast<Viewer*>(this), &Viewer::update, COALESCED_CONNECTION);
 
-		Pixel* pixels = image.data();
-		std::vector<unsigned char> data(reinterpret_cast<unsigned char*>(pixels), reinterpret_cast<unsigned char*>(pixels) + image.rows()* image.cols() * sizeof(Pixel));
+		if (!tile_times.empty()) {
+			const double total = std::accumulate(tile_times.begin(), tile_times.end(), 0.0);
+			const double slowest = *std::max_element(tile_times.begin(), tile_times.end());
+			LOG(INFO) << "snapshot (" << w << " x " << h << ") rendered in " << tile_times.size() << " tiles. Time per tile: "
+				<< total / static_cast<double>(tile_times.size()) << " (average), " << slowest << " (max) seconds";
+		}
 
-		return ImageIO::save(file_name, data, image.cols(), image.rows(), 4);
+		if (streaming) {
+			bands.close();
+			writer.join();
+			const bool closed = png_writer.close();
+			return write_ok && closed;
+		}
+		else
+			return ImageIO::save(file_name, image, w, h, 4);
 	}
 
 }
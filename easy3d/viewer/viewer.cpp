@@ -46,6 +46,7 @@
 #include <easy3d/renderer/transform.h>
 #include <easy3d/renderer/shape.h>
 #include <easy3d/renderer/camera.h>
+#include <easy3d/renderer/culler.h>
 #include <easy3d/renderer/manipulated_camera_frame.h>
 #include <easy3d/renderer/key_frame_interpolator.h>
 #include <easy3d/renderer/opengl_util.h>
@@ -62,6 +63,7 @@
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/logging.h>
 #include <easy3d/util/timer.h>
+#include <easy3d/util/stop_watch.h>
 #include <easy3d/util/string.h>
 #include <easy3d/util/resource.h>
 #include <easy3d/util/setting.h>
@@ -81,9 +83,30 @@ namespace easy3d {
             int stencil_bits /* = 8 */,
             int width /* = 960 */,
             int height /* = 800 */
+    )
+        : Viewer(title, samples, gl_major, gl_minor, full_screen, resizable, depth_bits, stencil_bits, width, height,
+                 CONTEXT_NATIVE)
+    {
+    }
+
+
+    Viewer::Viewer(
+            const std::string &title,
+            int samples,
+            int gl_major,
+            int gl_minor,
+            bool full_screen,
+            bool resizable,
+            int depth_bits,
+            int stencil_bits,
+            int width,
+            int height,
+            ContextAPI context_api
     )
         : window_(nullptr)
         , should_exit_(false)
+        , prewarm_window_(nullptr)
+        , startup_reported_(false)
         , dpi_scaling_(1.0)
         , title_(title)
         , camera_(nullptr)
@@ -106,6 +129,8 @@ namespace easy3d {
         , drawable_axes_(nullptr)
         , show_camera_path_(false)
         , model_idx_(-1)
+        , culling_(false)
+        , culler_(nullptr)
     {
         // Avoid locale-related number parsing issues.
         setlocale(LC_NUMERIC, "C");
@@ -118,9 +143,15 @@ namespace easy3d {
 
         // create and setup window
         window_ = create_window(title, samples, gl_major, gl_minor, full_screen, resizable,
-                                depth_bits, stencil_bits, width, height);
+                                depth_bits, stencil_bits, width, height, context_api);
         setup_callbacks(window_);
 
+        // compile the shader programs in the background (overlapping with the loading of models)
+        prewarm_shaders();
+
+        // wake up the rendering loop when a timer task has to be executed on this thread
+        TimerService::instance().add_main_thread_notifier(this, []() { glfwPostEmptyEvent(); });
+
         // create and set up the camera
         camera_ = new Camera;
         camera_->setType(Camera::PERSPECTIVE);
@@ -128,11 +159,14 @@ namespace easy3d {
         camera_->setViewDirection(vec3(-1, 0, 0)); // X pointing out
         camera_->showEntireScene();
 
-        easy3d::connect(&camera_->frame_modified, this, &Viewer::update);
+        // the camera may be modified many times per frame (e.g., during interaction), but one repaint is enough
+        easy3d::connect(&camera_->frame_modified, this, &Viewer::update, COALESCED_CONNECTION);
 
         kfi_ = new KeyFrameInterpolator(camera_->frame());
         easy3d::connect(&kfi_->interpolation_stopped, this, &Viewer::update);
 
+        culler_ = new Culler;
+
         sprintf(gpu_time_, "fps: ?? (?? ms/frame)");
 
         /* Poll for events once before starting a potentially lengthy loading process.*/
@@ -199,12 +233,17 @@ namespace easy3d {
             int depth_bits,
             int stencil_bits,
             int width,
-            int height) {
+            int height,
+            ContextAPI context_api) {
         glfwSetErrorCallback(
                 [](int error, const char *desc) {
                     LOG(ERROR) << "GLFW error " << error << ": " << desc;
                 });
 
+        // EGL and OSMesa contexts don't need a window system (only effective before GLFW is initialized)
+        if (context_api != CONTEXT_NATIVE)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
         if (!glfwInit()) {
             LOG(ERROR) << "could not initialize GLFW!";
             throw std::runtime_error("could not initialize GLFW!");
@@ -245,6 +284,11 @@ namespace easy3d {
         glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
         glfwWindowHint(GLFW_RESIZABLE, resizable ? GL_TRUE : GL_FALSE);
 
+        if (context_api == CONTEXT_EGL)
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        else if (context_api == CONTEXT_OSMESA)
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
 #ifndef NDEBUG
         const std::string title_str = title + " - Debug Version";
 #else
@@ -570,8 +614,19 @@ namespace easy3d {
         if (!window_)
             return;
 
+        TimerService::instance().remove_main_thread_notifier(this);
+
+        // the background thread still uses the shared context and the shader manager
+        if (prewarm_thread_.joinable())
+            prewarm_thread_.join();
+        if (prewarm_window_) {
+            glfwDestroyWindow(prewarm_window_);
+            prewarm_window_ = nullptr;
+        }
+
         delete camera_;
         delete kfi_;
+        delete culler_;
         delete drawable_axes_;
         delete texter_;
 
@@ -586,6 +641,29 @@ namespace easy3d {
     }
 
 
+    void Viewer::prewarm_shaders() {
+        if (!ShaderManager::binary_cache_enabled() || ShaderManager::num_recorded_programs() == 0)
+            return;
+
+        // the window hints of the viewer's window still hold, so the new context is compatible with it
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        prewarm_window_ = glfwCreateWindow(1, 1, "prewarm", nullptr, window_);
+        if (!prewarm_window_) {
+            LOG(WARNING) << "failed creating a shared context for pre-warming shader programs";
+            return;
+        }
+
+        GLFWwindow *window = prewarm_window_;
+        prewarm_thread_ = std::thread([window]() {
+            StopWatch w;
+            glfwMakeContextCurrent(window);
+            const std::size_t num = ShaderManager::prewarm(); // each program is complete when published
+            glfwMakeContextCurrent(nullptr);
+            LOG(INFO) << num << " shader programs pre-warmed in the background (" << w.time_string() << " seconds)";
+        });
+    }
+
+
     void Viewer::set_title(const std::string &title) {
         if (title != title_) {
             glfwSetWindowTitle(window_, title.c_str());
@@ -1119,11 +1197,29 @@ namespace easy3d {
                     }
                 }
 
+                // execute the timer tasks dispatched to the rendering thread
+                TimerService::instance().process_main_thread_tasks();
+
+                // pick up the latest snapshots published by other threads
+                for (auto m : models_) {
+                    if (m->renderer())
+                        m->renderer()->apply_published();
+                }
+
                 pre_draw();
                 draw();
                 post_draw();
                 glfwSwapBuffers(window_);
 
+                if (!startup_reported_) {
+                    startup_reported_ = true;
+                    // the timer was reset when the window was created
+                    LOG(INFO) << "startup time: " << string::time(glfwGetTime() * 1000.0)
+                              << " (shader programs: " << ShaderManager::num_compiled_programs() << " compiled, "
+                              << ShaderManager::num_cached_programs() << " loaded from cache, "
+                              << string::time(ShaderManager::creation_time() * 1000.0) << ")";
+                }
+
                 // Don't call 'glfwPollEvents()' at the beginning of the main loop.
                 // Reason: first frame needs time to complete.
                 if (is_animating_ && animation_func_) {
@@ -1745,46 +1841,50 @@ namespace easy3d {
         }
         glScissor(viewport[0], viewport[1], viewport[2], viewport[3]);
 
-#else 
+#else
+
+        if (culling_)
+            draw_with_culling();
+        else {
+            for (const auto m : models_) {
+                if (!m->renderer()->is_visible())
+                    continue;
 
-        for (const auto m : models_) {
-            if (!m->renderer()->is_visible())
-                continue;
+                // Let's check if edges and surfaces are both shown. If true, we
+                // make the depth coordinates of the surface smaller, so that displaying
+                // the mesh and the surface together does not cause Z-fighting.
+                std::size_t count = 0;
+                for (auto d : m->renderer()->lines_drawables()) {
+                    if (d->is_visible()) {
+                        d->draw(camera());
+                        easy3d_debug_log_gl_error
+                        ++count;
+                    }
+                }
 
-            // Let's check if edges and surfaces are both shown. If true, we
-            // make the depth coordinates of the surface smaller, so that displaying
-            // the mesh and the surface together does not cause Z-fighting.
-            std::size_t count = 0;
-            for (auto d : m->renderer()->lines_drawables()) {
-                if (d->is_visible()) {
-                    d->draw(camera());
+                for (auto d : m->renderer()->points_drawables()) {
+                    if (d->is_visible())
+                        d->draw(camera());
                     easy3d_debug_log_gl_error
-                    ++count;
                 }
-            }
 
-            for (auto d : m->renderer()->points_drawables()) {
-                if (d->is_visible())
-                    d->draw(camera());
-                easy3d_debug_log_gl_error
+                if (count > 0) {
+                    glEnable(GL_POLYGON_OFFSET_FILL);
+                    glPolygonOffset(0.5f, -0.0001f);
+                }
+                for (auto d : m->renderer()->triangles_drawables()) {
+                    if (d->is_visible())
+                        d->draw(camera());
+                    easy3d_debug_log_gl_error
+                }
+                if (count > 0)
+                    glDisable(GL_POLYGON_OFFSET_FILL);
             }
 
-            if (count > 0) {
-                glEnable(GL_POLYGON_OFFSET_FILL);
-                glPolygonOffset(0.5f, -0.0001f);
-            }
-            for (auto d : m->renderer()->triangles_drawables()) {
+            for (auto d : drawables_) {
                 if (d->is_visible())
                     d->draw(camera());
-                easy3d_debug_log_gl_error
             }
-            if (count > 0)
-                glDisable(GL_POLYGON_OFFSET_FILL);
-        }
-
-        for (auto d : drawables_) {
-            if (d->is_visible())
-                d->draw(camera());
         }
 
 #if 0 // draw face labels and vertex labels
@@ -1796,4 +1896,118 @@ namespace easy3d {
 #endif
     }
 
+
+    void Viewer::draw_with_culling() const {
+        // The drawables are collected in the same order as in draw(): for each model, its lines, points, and triangles
+        // (with polygon offset if the model also has visible lines), followed by the drawables independent of any
+        // model. Collecting them only reads a few states of each drawable (no allocation after the first frame).
+        std::vector<CullingEntry>& entries = culling_candidates_;
+        entries.clear();
+        auto add = [&](Drawable* d, int group, int pass) {
+            const Manipulator* manip = d->manipulator();
+            entries.push_back({d, group, pass, d->bounding_box(), manip, manip ? manip->version() : 0});
+        };
+
+        for (std::size_t i = 0; i < models_.size(); ++i) {
+            const Model* m = models_[i];
+            if (!m->renderer()->is_visible())
+                continue;
+            const int group = static_cast<int>(i);
+            bool has_lines = false;
+            for (auto d : m->renderer()->lines_drawables()) {
+                if (d->is_visible()) {
+                    add(d, group, 0);
+                    has_lines = true;
+                }
+            }
+            for (auto d : m->renderer()->points_drawables()) {
+                if (d->is_visible())
+                    add(d, group, 1);
+            }
+            for (auto d : m->renderer()->triangles_drawables()) {
+                if (d->is_visible())
+                    add(d, group, has_lines ? 3 : 2);
+            }
+        }
+        for (auto d : drawables_) {
+            if (d->is_visible())
+                add(d, static_cast<int>(models_.size()), 2);
+        }
+
+        // The hierarchy is rebuilt only if the set of drawables, their drawing order, any of their bounding boxes,
+        // or any of their transformations has changed. The transformations are compared by the versions of the
+        // manipulators, so the world bounding boxes are only computed when rebuilding.
+        bool changed = (entries.size() != culled_entries_.size());
+        for (std::size_t i = 0; !changed && i < entries.size(); ++i) {
+            const CullingEntry& a = entries[i];
+            const CullingEntry& b = culled_entries_[i];
+            changed = a.drawable != b.drawable || a.group != b.group || a.pass != b.pass ||
+                      a.manipulator != b.manipulator || a.manipulator_version != b.manipulator_version ||
+                      a.box.min_point() != b.box.min_point() || a.box.max_point() != b.box.max_point();
+        }
+        if (changed) {
+            std::vector<Box3> boxes(entries.size());
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                const Box3& box = entries[i].box;
+                if (!box.is_valid())
+                    continue;
+                const mat4 MANIP = entries[i].drawable->manipulated_matrix();
+                for (int k = 0; k < 8; ++k) {
+                    const vec3 corner(
+                            (k & 1) ? box.max_coord(0) : box.min_coord(0),
+                            (k & 2) ? box.max_coord(1) : box.min_coord(1),
+                            (k & 4) ? box.max_coord(2) : box.min_coord(2)
+                    );
+                    boxes[i].grow(vec3(MANIP * vec4(corner, 1.0f)));
+                }
+            }
+            culler_->build(boxes);
+            culled_entries_.swap(entries);
+        }
+        const std::vector<CullingEntry>& items = culled_entries_;
+
+        std::vector<int>& visible = visible_entries_;
+        culler_->cull(camera(), visible);
+
+        // Sort the drawables of the whole scene by pass, then by the states that determine the shader program, and
+        // then by the texture, to minimize the state changes. Only the triangles drawn with polygon offset (pass 3)
+        // keep the order of their models, as in draw().
+        auto program_key = [](const Drawable* d) -> int {
+            int impostor = 0;
+            if (d->type() == Drawable::DT_POINTS)
+                impostor = static_cast<const PointsDrawable*>(d)->impostor_type();
+            else if (d->type() == Drawable::DT_LINES)
+                impostor = static_cast<const LinesDrawable*>(d)->impostor_type();
+            return (d->type() * 16 + impostor) * 16 + d->coloring_method();
+        };
+        std::stable_sort(visible.begin(), visible.end(), [&](int a, int b) -> bool {
+            if (items[a].pass != items[b].pass)
+                return items[a].pass < items[b].pass;
+            if (items[a].pass == 3 && items[a].group != items[b].group)
+                return items[a].group < items[b].group;
+            const int key_a = program_key(items[a].drawable);
+            const int key_b = program_key(items[b].drawable);
+            if (key_a != key_b)
+                return key_a < key_b;
+            return items[a].drawable->texture() < items[b].drawable->texture();
+        });
+
+        bool polygon_offset = false;
+        for (auto id : visible) {
+            if (items[id].pass == 3 && !polygon_offset) {
+                glEnable(GL_POLYGON_OFFSET_FILL);
+                glPolygonOffset(0.5f, -0.0001f);
+                polygon_offset = true;
+            }
+            else if (items[id].pass != 3 && polygon_offset) {
+                glDisable(GL_POLYGON_OFFSET_FILL);
+                polygon_offset = false;
+            }
+            items[id].drawable->draw(camera());
+            easy3d_debug_log_gl_error
+        }
+        if (polygon_offset)
+            glDisable(GL_POLYGON_OFFSET_FILL);
+    }
+
 }
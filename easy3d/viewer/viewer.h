@@ -30,6 +30,7 @@
 
 #include <string>
 #include <vector>
+#include <thread>
 
 #include <easy3d/core/types.h>
 
@@ -44,6 +45,8 @@ namespace easy3d {
     class TrianglesDrawable;
     class TextRenderer;
     class KeyFrameInterpolator;
+    class Culler;
+    class Manipulator;
 
     /**
      * @brief The built-in Easy3D viewer.
@@ -60,6 +63,19 @@ namespace easy3d {
 	class Viewer
 	{
 	public:
+        /**
+         * @brief The API used for creating the OpenGL context.
+         * @details EGL and OSMesa contexts are created on GLFW's null platform, so they require no display server.
+         *      This allows rendering on headless (and GPU-less, using OSMesa or a software EGL driver) servers.
+         * @note The platform is chosen when GLFW is initialized, i.e., on the creation of the first viewer. All
+         *      viewers in a process should thus request the same kind of context.
+         */
+        enum ContextAPI {
+            CONTEXT_NATIVE, ///< The native context API of the platform (i.e., GLX, WGL, or NSGL).
+            CONTEXT_EGL,    ///< EGL, without a display server.
+            CONTEXT_OSMESA  ///< OSMesa (off-screen software rendering), without a display server.
+        };
+
         /**
          * @brief Constructor
          * @param title The window title of the viewer, which can be changed by calling set_title() after construction.
@@ -337,7 +353,9 @@ namespace easy3d {
          * @brief  Take a snapshot of the screen and save it to an image file. Supported image format: png, jpg, bmp, and tga.
          * @details This function renders the scene into a framebuffer and takes a snapshot of the framebuffer.
          *      It allows the snapshot image to have a dimension different from the viewer, and it has no limit on the
-         *      image size (if memory allows).
+         *      image size (if memory allows). The image is rendered tile by tile and the render time of each tile
+         *      is logged. For PNG files, the rows of tiles are compressed and written to the file while the next
+         *      row is being rendered, so the full image is never held in memory.
          * @param file_name The image file name.
          * @param scaling The scaling factor that determines the size of the image (default to 1.0, using the viewer size), i.e., 
          *      image_width = viewer_width * scaling;
@@ -475,10 +493,30 @@ namespace easy3d {
         bool is_animating() const;
         //@}
 
+        /// @name Culling
+        //@{
+        /**
+         * @brief Enable/Disable the culling stage of the rendering (disabled by default).
+         * @details When enabled, each frame the drawables outside the view frustum (and optionally the ones too
+         *      small on the screen) are skipped, and the remaining ones of the whole scene are drawn in an order that
+         *      groups the same shader programs and textures. So the models are not drawn one after another, which
+         *      matters if your drawables rely on blending. Culling relies on the bounding boxes of the drawables, so
+         *      the bounding box of a model must be kept up to date if its geometry changes.
+         * @sa culler().
+         */
+        void set_culling(bool b) { culling_ = b; }
+        /// @brief Is the culling stage enabled?
+        bool culling() const { return culling_; }
+        /// @brief Returns the culler, e.g., to enable small-feature culling by Culler::set_min_screen_size().
+        Culler* culler() { return culler_; }
+        //@}
+
 	protected:
 
         // rendering. Users can put their additional rendering function here by reimplementing it.
         virtual void draw() const;
+        // the draw procedure with view-frustum/small-feature culling and state sorting. See set_culling().
+        void draw_with_culling() const;
 
 		// OpenGL resources (e.g., shaders, textures, VAOs) must be created when 
 		// there exists a valid rendering context. It is (usually) a bad idea to do 
@@ -535,6 +573,23 @@ namespace easy3d {
 		virtual bool focus_event(bool focused);
 
 	protected:
+        /**
+         * @brief Constructor that allows specifying the API for creating the OpenGL context, e.g., for offscreen
+         *      rendering without a display server. See the public constructor for the other parameters.
+         */
+        Viewer(const std::string& title,
+               int samples,
+               int gl_major,
+               int gl_minor,
+               bool full_screen,
+               bool resizable,
+               int depth_bits,
+               int stencil_bits,
+               int width,
+               int height,
+               ContextAPI context_api
+        );
+
         GLFWwindow *create_window(const std::string &title,
                                   int samples,
                                   int gl_major,   // must >= 3
@@ -544,10 +599,15 @@ namespace easy3d {
                                   int depth_bits,
                                   int stencil_bits,
                                   int width,
-                                  int height);
+                                  int height,
+                                  ContextAPI context_api = CONTEXT_NATIVE);
 
         void setup_callbacks(GLFWwindow*);
 
+        // creates the shader programs recorded in the program binary cache in a background thread using a hidden
+        // window whose context is shared with the viewer's context (see ShaderManager::prewarm()).
+        void prewarm_shaders();
+
 		/* Event handlers. Client code should not touch these */
         virtual bool callback_event_cursor_pos(double x, double y);
         virtual bool callback_event_mouse_button(int button, int action, int modifiers);
@@ -568,6 +628,10 @@ namespace easy3d {
     protected:
 		GLFWwindow*	window_;
 		bool        should_exit_;
+
+        GLFWwindow* prewarm_window_;    // hidden window providing a shared context for pre-warming shaders
+        std::thread prewarm_thread_;
+        bool        startup_reported_;  // the startup time is reported after the first frame of this viewer
         float       dpi_scaling_;
         int         width_;
         int         height_;
@@ -618,6 +682,22 @@ namespace easy3d {
         // drawables independent of any model
         std::vector<Drawable*> drawables_;
 
+        bool    culling_;
+        Culler* culler_;
+        // the state of a drawable that determines its bounding box in world coordinates and its drawing order
+        struct CullingEntry {
+            Drawable* drawable;
+            int group;      // the index of the model (models_.size() for drawables independent of any model)
+            int pass;       // 0 - lines, 1 - points, 2 - triangles, 3 - triangles with polygon offset
+            Box3 box;       // in local coordinates (cached by the model, i.e., updated if the points change)
+            const Manipulator* manipulator;
+            std::size_t manipulator_version;
+        };
+        // the drawables the culler was built for, and the ones collected in the current frame
+        mutable std::vector<CullingEntry> culled_entries_;
+        mutable std::vector<CullingEntry> culling_candidates_;
+        mutable std::vector<int> visible_entries_;
+
         typedef std::pair<Function, Model*> FunctionModel;
         std::map<Key, std::map<Modifier, FunctionModel> >  commands_;
 	};
@@ -0,0 +1,36 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+// Decoding of 16-bit quantized positions (see Drawable::set_compressed_attributes()).
+// The attribute is normalized by OpenGL, i.e., each component is in [0, 1] relative to the quantization box.
+
+uniform bool quantized_position = false;
+uniform vec3 position_offset = vec3(0.0);  // the min corner of the quantization box
+uniform vec3 position_scale = vec3(1.0);   // the extent of the quantization box
+
+vec3 decode_position(vec3 p) {
+    return quantized_position ? position_offset + p * position_scale : p;
+}
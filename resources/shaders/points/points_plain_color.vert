@@ -49,11 +49,15 @@ out Data{
 } DataOut;
 
 
+#include ../common/decode_position.glsl
+#include ../common/decode_normal.glsl
+
+
 void main(void) {
-    vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+    vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
-    DataOut.position = vtx_position;
-    DataOut.normal = NORMAL * vtx_normal;
+    DataOut.position = decode_position(vtx_position);
+    DataOut.normal = NORMAL * decode_normal(vtx_normal);
 
     if (per_vertex_color)
         DataOut.color = vec4(vtx_color, 1.0);
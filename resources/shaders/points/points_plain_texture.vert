@@ -49,12 +49,16 @@ out Data{
 } DataOut;
 
 
+#include ../common/decode_position.glsl
+#include ../common/decode_normal.glsl
+
+
 void main() {
-    vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+    vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
-    DataOut.position = vtx_position;
+    DataOut.position = decode_position(vtx_position);
     DataOut.texcoord = vtx_texcoord;
-    DataOut.normal = NORMAL * vtx_normal;
+    DataOut.normal = NORMAL * decode_normal(vtx_normal);
 
     if (clippingPlaneEnabled) {
         gl_ClipDistance[0] = dot(new_position, clippingPlane0);
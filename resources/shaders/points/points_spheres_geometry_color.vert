@@ -37,9 +37,12 @@ uniform mat4 MANIP = mat4(1.0);
 
 out vec4 sphere_color_in;
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-    vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+    vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
     gl_Position = new_position;
 
@@ -34,9 +34,12 @@ in vec2  vtx_texcoord;
 
 out vec2 texcoord;
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-	vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+	vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
 	texcoord = vtx_texcoord;
 
@@ -49,9 +49,12 @@ out Data {
 } DataOut;
 
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-    vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+    vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
 	if (per_vertex_color)
         DataOut.sphere_color = vec4(vtx_color, 1.0);
@@ -55,9 +55,12 @@ out Data{
 	//float	sphere_radius;
 } DataOut;
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-	vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+	vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
 	DataOut.texcoord = vtx_texcoord;
 
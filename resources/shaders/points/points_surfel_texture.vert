@@ -41,12 +41,16 @@ out VertexData
 } vertexOut;
 
 
+#include ../common/decode_position.glsl
+#include ../common/decode_normal.glsl
+
+
 void main()
 {
-    vec4 new_position = MANIP * vec4(vtx_position, 1.0);
+    vec4 new_position = MANIP * vec4(decode_position(vtx_position), 1.0);
 
     gl_Position = new_position;
 
     vertexOut.texcoord = vtx_texcoord;
-    vertexOut.normal = NORMAL * vtx_normal;
+    vertexOut.normal = NORMAL * decode_normal(vtx_normal);
 }
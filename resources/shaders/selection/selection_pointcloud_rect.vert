@@ -41,9 +41,12 @@ layout(std430, binding = 1) buffer selection_t {
 } selection;
 
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-	vec4 p = MVP * MANIP * vec4(vtx_position, 1.0);
+	vec4 p = MVP * MANIP * vec4(decode_position(vtx_position), 1.0);
 	float x = p.x / p.w * 0.5 + 0.5;
 	float y = p.y / p.w * 0.5 + 0.5;
 	x = x * viewport[2] + viewport[0];
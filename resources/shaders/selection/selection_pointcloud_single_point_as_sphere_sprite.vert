@@ -40,9 +40,12 @@ uniform float	sphere_radius;
 
 out vec4	position; // in eye space
 
+#include ../common/decode_position.glsl
+
+
 void main()
 {
-	position = MV * MANIP * vec4(vtx_position, 1.0);
+	position = MV * MANIP * vec4(decode_position(vtx_position), 1.0);
 
 	// http://stackoverflow.com/questions/8608844/resizing-point-sprites-based-on-distance-from-the-camera
 	vec4 projCorner = PROJ * vec4(sphere_radius, sphere_radius, position.z, position.w);
@@ -26,6 +26,7 @@
 
 #include <easy3d/core/graph.h>
 #include <easy3d/fileio/graph_io.h>
+#include <easy3d/algo/graph_enumerator.h>
 #include <easy3d/util/resource.h>
 #include <easy3d/util/file_system.h>
 
@@ -131,6 +132,22 @@ int test_graph() {
         }
     }
 
+    // enumerate the connected components
+    {
+        // add a separate edge, resulting in two components
+        Graph::Vertex v4 = graph.add_vertex(vec3(2, 0, 0));
+        Graph::Vertex v5 = graph.add_vertex(vec3(2, 1, 0));
+        graph.add_edge(v4, v5);
+
+        auto id = graph.add_vertex_property<int>("v:component_id", -1);
+        const int num = GraphEnumerator::enumerate_connected_components(&graph, id);
+        std::cout << "graph has " << num << " connected components" << std::endl;
+        if (num != 2 || id[Graph::Vertex(3)] != 0 || id[v4] != 1 || id[v5] != 1) {
+            std::cerr << "wrong connected components" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     {
         // Read a graph specified by its file name
         const std::string file_name = resource::directory() + "/data/graph.ply";
@@ -26,6 +26,7 @@
 
 #include <random>
 #include <iostream>
+#include <string>
 
 #include <easy3d/util/logging.h>
 #include <easy3d/util/resource.h>
@@ -33,20 +34,30 @@
 int test_timer();
 int test_signal();
 int test_console_style();
+int test_frame_pipeline();
+int test_image_io();
+int test_quantization();
+int test_model_snapshot();
+int test_point_projection();
 
 int test_linear_solvers();
+int test_matrix();
 int test_spline();
 
 int test_point_cloud();
 int test_surface_mesh();
+int test_surface_mesh_adjacency();
 int test_polyhedral_mesh();
 int test_graph();
 int test_kdtree();
+int test_culler();
 
 int test_point_cloud_algorithms();
+int test_ransac_compatibility();
 int test_surface_mesh_algorithms();
 
 int offscreen();
+int batch_rendering();
 int test_viewer_imgui(int duration);
 int test_composite_view(int duration);
 int test_real_camera();
@@ -76,6 +87,13 @@ int test_model_picker();
 int test_face_picker();
 int test_point_selection();
 
+int benchmark_signal_emission();
+int benchmark_matrix_products();
+int benchmark_point_cloud_ransac();
+int benchmark_surface_mesh_geometry();
+int benchmark_surface_mesh_collision();
+int benchmark_surface_mesh_adjacency();
+
 
 using namespace easy3d;
 
@@ -86,25 +104,47 @@ int main(int argc, char* argv[]) {
     // Initialize random number generator.
     srand(0);
 
+    // The benchmarks are not part of the default test run. Run them with "Tests --benchmark".
+    if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+        int result = 0;
+        result += benchmark_signal_emission();
+        result += benchmark_matrix_products();
+        result += benchmark_point_cloud_ransac();
+        result += benchmark_surface_mesh_geometry();
+        result += benchmark_surface_mesh_collision();
+        result += benchmark_surface_mesh_adjacency();
+        return result;
+    }
+
     int result = 0;
 
     result += test_console_style();
     result += test_timer();
     result += test_signal();
+    result += test_frame_pipeline();
+    result += test_image_io();
+    result += test_quantization();
+    result += test_model_snapshot();
+    result += test_point_projection();
 
     result += test_linear_solvers();
+    result += test_matrix();
     result += test_spline();
 
     result += test_point_cloud();
     result += test_surface_mesh();
+    result += test_surface_mesh_adjacency();
     result += test_polyhedral_mesh();
     result += test_graph();
     result += test_kdtree();
+    result += test_culler();
 
     result += test_point_cloud_algorithms();
+    result += test_ransac_compatibility();
     result += test_surface_mesh_algorithms();
 
     result += offscreen();
+    result += batch_rendering();
 
     const int duration = 1500; // in millisecond
     result += test_viewer_imgui(duration);
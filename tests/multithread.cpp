@@ -37,16 +37,17 @@ using namespace easy3d;
 
 
 
-void edit_model(PointCloud *cloud, Viewer *viewer) {
+// the worker thread modifies its own copy of the point cloud and publishes snapshots of it.
+void edit_model(PointCloud *working, PointCloud *cloud, Viewer *viewer) {
     // in this simple example, we add more points (with per point colors) to the point cloud.
-    auto colors = cloud->vertex_property<vec3>("v:color");
+    auto colors = working->vertex_property<vec3>("v:color");
     for (int i = 0; i < 100; ++i) {
-        auto v = cloud->add_vertex(vec3(random_float(), random_float(), random_float()));
+        auto v = working->add_vertex(vec3(random_float(), random_float(), random_float()));
         colors[v] = vec3(random_float(), random_float(), random_float()); // we use a random color
     }
 
-    // notify the renderer to update the OpenGL buffers
-    cloud->renderer()->update();
+    // hand over a snapshot to the renderer (applied at the start of the next frame)
+    cloud->renderer()->publish(new PointCloud(*working));
     // notify the viewer to update the display
     viewer->update();
 }
@@ -74,13 +75,16 @@ int test_multithread() {
     // set coloring method: we want to visualize the point cloud using the per point color property
     drawable->set_coloring(Drawable::COLOR_PROPERTY, Drawable::VERTEX, "v:color");
 
+    // the copy of the point cloud modified by the worker thread
+    PointCloud working(*cloud);
+
     // run the process in another thread
-    Timer<PointCloud*, Viewer*> timer;
+    Timer<PointCloud*, PointCloud*, Viewer*> timer;
     // call the edit_model() function every 300 milliseconds
-    timer.set_interval(300, edit_model, cloud, &viewer);
+    timer.set_interval(300, edit_model, &working, cloud, &viewer);
 
     // stop the timer before exit
-    Timer<>::single_shot(4000, &timer, &Timer<PointCloud*, Viewer*>::stop); // or Timer<>::single_shot(4000, [&]() -> void { timer.stop(); });
+    Timer<>::single_shot(4000, &timer, &Timer<PointCloud*, PointCloud*, Viewer*>::stop); // or Timer<>::single_shot(4000, [&]() -> void { timer.stop(); });
 
     viewer.set_usage("testing multithreading...");
 
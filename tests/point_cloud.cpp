@@ -68,6 +68,57 @@ int test_point_cloud() {
     }
 
 
+    //  - track the modifications of a property (e.g., for updating the bounding box and the rendering buffers).
+    {
+        auto points = cloud.get_vertex_property<vec3>("v:point");
+        cloud.bounding_box();
+        const std::size_t version = points.version();
+
+        // move a point and announce the modification
+        PointCloud::Vertex v(10);
+        points[v] = vec3(100, 100, 100);
+        points.notify_modified(v.idx(), v.idx() + 1);
+
+        std::size_t begin = 0, end = 0;
+        if (points.version() == version || !points.array().modified_range(version, begin, end) ||
+            begin != v.idx() || end != v.idx() + 1) {
+            std::cerr << "modification of property 'v:point' not tracked" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // the bounding box is updated automatically
+        if (distance(cloud.bounding_box().max_point(), vec3(100, 100, 100)) > epsilon<float>()) {
+            std::cerr << "bounding box not updated after modifying the points" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // the modified range covers only the modifications since the previous version
+        const std::size_t previous_version = points.version();
+        PointCloud::Vertex u(20);
+        points[u] = vec3(50, 50, 50);
+        points.notify_modified(u.idx(), u.idx() + 1);
+        if (!points.array().modified_range(previous_version, begin, end) || begin != u.idx() || end != u.idx() + 1) {
+            std::cerr << "modified range of property 'v:point' not reset for the new version ([" << begin << ", "
+                      << end << ") instead of [" << u.idx() << ", " << u.idx() + 1 << "))" << std::endl;
+            return EXIT_FAILURE;
+        }
+        // the range since an older version is unknown
+        if (points.array().modified_range(version, begin, end)) {
+            std::cerr << "modified range of property 'v:point' reported across several versions" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // structural changes are tracked automatically (and the modified range is unknown)
+        const std::size_t last_version = points.version();
+        cloud.add_vertex(vec3(0, 0, 0));
+        if (points.version() == last_version || points.array().modified_range(last_version, begin, end)) {
+            std::cerr << "adding a point not tracked" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "modifications of property 'v:point' tracked" << std::endl;
+    }
+
+
     //  - load a point cloud from a file;
     //  - save a point cloud to a file.
     {
@@ -29,11 +29,19 @@
 #include <easy3d/algo/point_cloud_normals.h>
 #include <easy3d/algo/point_cloud_ransac.h>
 #include <easy3d/algo/point_cloud_poisson_reconstruction.h>
+#include <easy3d/algo/surface_mesh_geometry.h>
+#include <easy3d/algo/triangle_mesh_kdtree.h>
 #include <easy3d/algo/delaunay_2d.h>
 #include <easy3d/algo/delaunay_3d.h>
 #include <easy3d/algo/point_cloud_simplification.h>
+#include <easy3d/algo/point_cloud_enumerator.h>
 #include <easy3d/fileio/point_cloud_io.h>
 #include <easy3d/util/resource.h>
+#include <easy3d/util/stop_watch.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 using namespace easy3d;
@@ -62,6 +70,44 @@ bool test_algo_point_cloud_normal_estimation() {
 }
 
 
+namespace {
+
+    // detects primitives of the given types using the given number of threads (0 for the default), and returns
+    // the number of primitives and the number of points assigned to them. A fixed seed is used, so the result
+    // doesn't depend on the number of threads.
+    int detect_primitives(PointCloud *cloud, const std::vector<PrimitivesRansac::PrimType> &types, int num_threads,
+                          int &num_inliers, double &seconds) {
+#ifdef _OPENMP
+        const int default_threads = omp_get_max_threads();
+        if (num_threads > 0)
+            omp_set_num_threads(num_threads);
+#else
+        (void) num_threads;
+#endif
+        PrimitivesRansac algo;
+        for (auto t : types)
+            algo.add_primitive_type(t);
+        algo.set_random_seed(2021);
+        // you can try different parameters of RANSAC (usually you don't need to tune them)
+        StopWatch w;
+        const int num = algo.detect(cloud, 200, 0.005f, 0.02f, 0.8f, 0.001f);
+        seconds = w.elapsed_seconds(3);
+#ifdef _OPENMP
+        omp_set_num_threads(default_threads);
+#endif
+
+        num_inliers = 0;
+        auto indices = cloud->get_vertex_property<int>("v:primitive_index");
+        for (auto v : cloud->vertices()) {
+            if (indices[v] >= 0)
+                ++num_inliers;
+        }
+        return num;
+    }
+
+}
+
+
 bool test_algo_point_cloud_plane_extraction() {
     const std::string file = resource::directory() + "/data/polyhedron.bin";
     PointCloud *cloud = PointCloudIO::load(file);
@@ -74,23 +120,42 @@ bool test_algo_point_cloud_plane_extraction() {
     auto normals = cloud->get_vertex_property<vec3>("v:normal");
     if (!normals) {
         std::cerr << "Plane extraction using RANSAC requires normal information but it is not available" << std::endl;
+        delete cloud;
         return false;
     }
 
-    PrimitivesRansac algo;
-    algo.add_primitive_type(PrimitivesRansac::PLANE);
-    std::cout << "detecting planes using RANSAC..." << std::endl;
+    // The candidates are scored in parallel (if OpenMP is available). With the same seed, the result must be
+    // exactly the same as the one obtained using a single thread.
+    std::cout << "detecting planes using RANSAC (single thread)..." << std::endl;
+    int inliers_serial = 0;
+    double seconds_serial = 0.0;
+    const int num_serial = detect_primitives(cloud, {PrimitivesRansac::PLANE}, 1, inliers_serial, seconds_serial);
+    const std::vector<int> labels_serial = cloud->get_vertex_property<int>("v:primitive_index").vector();
+
+    std::cout << "detecting planes using RANSAC (all threads)..." << std::endl;
+    int inliers_parallel = 0;
+    double seconds_parallel = 0.0;
+    const int num_parallel = detect_primitives(cloud, {PrimitivesRansac::PLANE}, 0, inliers_parallel, seconds_parallel);
+    const std::vector<int> labels_parallel = cloud->get_vertex_property<int>("v:primitive_index").vector();
 
-    // you can try different parameters of RANSAC (usually you don't need to tune them)
-    const int num = algo.detect(cloud, 200, 0.005f, 0.02f, 0.8f, 0.001f);
     delete cloud;
 
-    if (num > 0) {
-        std::cout << num << " primitives extracted" << std::endl;
-        return true;
-    }
+    std::cout << "single thread: " << num_serial << " planes, " << inliers_serial << " inliers, " << seconds_serial
+              << " seconds\n"
+              << "all threads:   " << num_parallel << " planes, " << inliers_parallel << " inliers, "
+              << seconds_parallel << " seconds" << std::endl;
 
-    return false;
+    if (num_serial <= 0 || num_parallel <= 0) {
+        std::cerr << "no planes detected" << std::endl;
+        return false;
+    }
+    if (num_parallel != num_serial || labels_parallel != labels_serial) {
+        std::cerr << "the planes detected in parallel (" << num_parallel << " planes, " << inliers_parallel
+                  << " inliers) differ from the ones detected using a single thread (" << num_serial << " planes, "
+                  << inliers_serial << " inliers)" << std::endl;
+        return false;
+    }
+    return true;
 }
 
 
@@ -113,13 +178,80 @@ bool test_algo_point_cloud_poisson_reconstruction() {
     PoissonReconstruction algo;
     algo.set_depth(depth);
     std::cout << "Poisson surface reconstruction (depth = " << depth << ")..." << std::endl;
-    Model *surface = algo.apply(cloud);
+    auto full = dynamic_cast<SurfaceMesh *>(algo.apply(cloud));
+    if (!full) {
+        delete cloud;
+        return false;
+    }
+
+    // the blocked reconstruction must give a watertight surface close to the one of the full reconstruction
+    const int blocks = 2;
+    algo.set_blocks(blocks);
+    std::cout << "blocked Poisson surface reconstruction (depth = " << depth << ", " << blocks << "x" << blocks << "x"
+              << blocks << " blocks)..." << std::endl;
+    auto surface = dynamic_cast<SurfaceMesh *>(algo.apply(cloud));
+    const float cell = cloud->bounding_box().max_range() * 1.1f / static_cast<float>(1 << depth); // the voxel size
     delete cloud;
+    if (!surface) {
+        std::cerr << "blocked Poisson surface reconstruction failed" << std::endl;
+        delete full;
+        return false;
+    }
 
-    if (surface)
-        return true;
+    // Compare each face of the blocked reconstruction with the closest face of the full reconstruction. Its center
+    // must be close to that face and its normal must point to the same side. A folded or self-intersecting cap on a
+    // seam has faces pointing to the other side, and so does an inconsistently oriented part. Only a few slivers (of
+    // a tiny fraction of a voxel each) next to the seams may be inverted where the vertices of adjacent blocks are
+    // merged.
+    float max_distance = 0.0f, inverted_area = 0.0f;
+    std::size_t num_inverted = 0;
+    {
+        TriangleMeshKdTree tree(full);
+        for (auto f : surface->faces()) {
+            vec3 center(0, 0, 0);
+            int n = 0;
+            for (auto v : surface->vertices(f)) {
+                center += surface->position(v);
+                ++n;
+            }
+            const auto nn = tree.nearest(center / static_cast<float>(n));
+            max_distance = std::max(max_distance, nn.dist);
+            if (dot(surface->compute_face_normal(f), full->compute_face_normal(nn.face)) < 0.0f) {
+                inverted_area += geom::triangle_area(surface, f);
+                ++num_inverted;
+            }
+        }
+    }
 
-    return false;
+    std::size_t num_border_edges = 0;
+    for (auto e : surface->edges()) {
+        if (surface->is_border(e))
+            ++num_border_edges;
+    }
+
+    std::cout << "full: " << full->n_faces() << " faces; blocked: " << surface->n_faces() << " faces, "
+              << num_border_edges << " border edges, max distance " << max_distance / cell << " voxels, "
+              << num_inverted << " inverted faces (area " << inverted_area / (cell * cell) << " voxel faces)"
+              << std::endl;
+    delete full;
+    delete surface;
+
+    if (num_border_edges > 0) {
+        std::cerr << "the blocked reconstruction is not watertight (" << num_border_edges << " border edges)"
+                  << std::endl;
+        return false;
+    }
+    if (max_distance > cell) {
+        std::cerr << "the blocked reconstruction deviates from the full reconstruction by " << max_distance / cell
+                  << " voxels" << std::endl;
+        return false;
+    }
+    if (inverted_area > 0.1f * cell * cell) {
+        std::cerr << "the seams of the blocked reconstruction are folded or inverted (" << num_inverted
+                  << " faces of " << inverted_area / (cell * cell) << " voxel faces)" << std::endl;
+        return false;
+    }
+    return true;
 }
 
 
@@ -213,6 +345,40 @@ bool test_algo_point_cloud_downsampling() {
 }
 
 
+bool test_algo_point_cloud_clustering() {
+    const std::string file = resource::directory() + "/data/bunny.bin";
+    PointCloud *cloud = PointCloudIO::load(file);
+    if (!cloud) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct." << std::endl;
+        return false;
+    }
+
+    const float radius = cloud->bounding_box().radius() * 0.05f;
+    std::cout << "Euclidean clustering using radius " << radius << "...";
+    auto id = cloud->vertex_property<int>("v:cluster_id", -1);
+    const int num = PointCloudEnumerator::enumerate_euclidean_clusters(cloud, id, radius);
+    std::cout << " " << num << " clusters" << std::endl;
+
+    // a translated copy far away must result in the same clusters, doubled
+    const vec3 offset(cloud->bounding_box().radius() * 4.0f);
+    const int total_num = static_cast<int>(cloud->n_vertices());
+    for (int i = 0; i < total_num; ++i)
+        cloud->add_vertex(cloud->position(PointCloud::Vertex(i)) + offset);
+    const int num_doubled = PointCloudEnumerator::enumerate_euclidean_clusters(cloud, id, radius);
+    std::cout << "Euclidean clustering of two copies... " << num_doubled << " clusters" << std::endl;
+    for (int i = 0; i < total_num; ++i) {
+        if (num_doubled != num * 2 || id[PointCloud::Vertex(i + total_num)] != id[PointCloud::Vertex(i)] + num) {
+            std::cerr << "Error: inconsistent clusters of the translated copy" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+
+    delete cloud;
+    return true;
+}
+
+
 int test_point_cloud_algorithms() {
     if (!test_algo_point_cloud_normal_estimation())
         return EXIT_FAILURE;
@@ -232,5 +398,37 @@ int test_point_cloud_algorithms() {
     if (!test_algo_point_cloud_downsampling())
         return EXIT_FAILURE;
 
+    if (!test_algo_point_cloud_clustering())
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+
+// reports the throughput of RANSAC (primitives/sec and points/sec) using a single thread and all threads
+int benchmark_point_cloud_ransac() {
+    const std::string file = resource::directory() + "/data/polyhedron.bin";
+    PointCloud *cloud = PointCloudIO::load(file);
+    if (!cloud || !cloud->get_vertex_property<vec3>("v:normal")) {
+        std::cerr << "Error: failed to load a point cloud with normals from " << file << std::endl;
+        delete cloud;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<PrimitivesRansac::PrimType> types = {
+            PrimitivesRansac::PLANE, PrimitivesRansac::CYLINDER, PrimitivesRansac::SPHERE
+    };
+    const auto num_points = cloud->n_vertices();
+    const int threads[] = {1, 0};
+    for (int t : threads) {
+        int inliers = 0;
+        double seconds = 0.0;
+        const int num = detect_primitives(cloud, types, t, inliers, seconds);
+        std::cout << "RANSAC (" << (t == 1 ? "single thread" : "all threads") << "): " << num << " primitives, "
+                  << inliers << " of " << num_points << " points explained, " << seconds << " seconds ("
+                  << (seconds > 0.0 ? num / seconds : 0.0) << " primitives/sec, "
+                  << (seconds > 0.0 ? num_points / seconds : 0.0) << " points/sec)" << std::endl;
+    }
+    delete cloud;
     return EXIT_SUCCESS;
 }
@@ -28,10 +28,142 @@
 #include <easy3d/core/types.h>
 #include <easy3d/core/spline_curve_fitting.h>
 #include <easy3d/core/spline_curve_interpolation.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
 
 
 using namespace easy3d;
 
+
+namespace {
+
+    // the recursive blossom algorithm (i.e., the original implementation of SplineCurveFitting), used as the reference
+    vec3 blossom(float u, std::vector<vec3> p, int k, std::vector<float> node) {
+        if (p.size() == 1)
+            return p[0];
+        std::vector<vec3> p_out(k - 1);
+        for (int i = 0; i < (k - 1); ++i) {
+            const float n0 = node[i + k - 1];
+            const float n1 = node[i];
+            p_out[i] = p[i] * ((n0 - u) / (n0 - n1)) + p[i + 1] * ((u - n1) / (n0 - n1));
+        }
+        return blossom(u, p_out, k - 1, std::vector<float>(node.begin() + 1, node.end() - 1));
+    }
+
+
+    // open uniform spline evaluated by the reference algorithm
+    vec3 reference_eval(float u, const std::vector<vec3> &points, int k) {
+        const int n = static_cast<int>(points.size());
+        std::vector<float> node(k + n);
+        int acc = 1;
+        for (int i = 0; i < (int) node.size(); ++i) {
+            if (i < k)
+                node[i] = 0.0f;
+            else if (i >= n + 1)
+                node[i] = 1.0f;
+            else
+                node[i] = (float) acc++ / (float) (n + 1 - k);
+        }
+        int dec = 0;
+        while (u > node[dec + k])
+            dec++;
+        return blossom(u, std::vector<vec3>(points.begin() + dec, points.begin() + dec + k), k,
+                       std::vector<float>(node.begin() + dec + 1, node.begin() + dec + k + k - 1));
+    }
+
+
+    bool test_batched_evaluation(const std::vector<vec3> &points) {
+        const int resolution = 1000;
+        std::vector<float> parameters(resolution);
+        for (int i = 0; i < resolution; ++i)
+            parameters[i] = float(i) / float(resolution - 1);
+
+        for (int order = 2; order <= 4; ++order) {
+            SplineCurveFitting<vec3> fitter(order, SplineCurveFitting<vec3>::eOPEN_UNIFORM);
+            fitter.set_ctrl_points(points);
+            std::vector<vec3> batch;
+            fitter.eval_f(parameters, batch);
+            for (int i = 0; i < resolution; ++i) {
+                const vec3 p = fitter.eval_f(parameters[i]);
+                if (batch[i] != p || distance(p, reference_eval(parameters[i], points, order)) > 1e-5f) {
+                    LOG(ERROR) << "spline fitting (order " << order << ") evaluated differently at " << parameters[i];
+                    return false;
+                }
+            }
+        }
+
+        SplineCurveInterpolation<vec3> interpolator;
+        interpolator.set_points(points);
+        std::vector<vec3> batch;
+        interpolator.eval_f(parameters, batch);
+        for (int i = 0; i < resolution; ++i) {
+            if (batch[i] != interpolator.eval_f(parameters[i])) {
+                LOG(ERROR) << "spline interpolation evaluated differently at " << parameters[i];
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    bool test_arc_length(const std::vector<vec3> &points) {
+        SplineCurveFitting<vec3> fitter(3, SplineCurveFitting<vec3>::eOPEN_UNIFORM);
+        fitter.set_ctrl_points(points);
+
+        const std::size_t steps = 2000;
+        std::vector<float> parameters, lengths;
+        fitter.get_arc_length_table(steps, parameters, lengths);
+        if (parameters.size() != steps || lengths.size() != steps || parameters.back() != 1.0f) {
+            LOG(ERROR) << "wrong arc-length table";
+            return false;
+        }
+        for (std::size_t i = 1; i < steps; ++i) {
+            if (lengths[i] < lengths[i - 1]) {
+                LOG(ERROR) << "arc lengths must be increasing";
+                return false;
+            }
+        }
+
+        // the points at the equally spaced parameters are equally spaced along the curve
+        const std::vector<float> U = fitter.get_equally_spaced_parameters(steps);
+        std::vector<vec3> curve;
+        fitter.eval_f(U, curve);
+        const float expected = lengths.back() / float(steps - 1);
+        for (std::size_t i = 1; i < steps; ++i) {
+            const float d = distance(curve[i], curve[i - 1]);
+            if (std::abs(d - expected) > 0.05f * expected) {
+                LOG(ERROR) << "points are not equally spaced: " << d << " (expected " << expected << ")";
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    // a long fly-through (e.g., for video export) with many keyframes
+    void benchmark_long_path() {
+        const int num_keyframes = 5000;
+        const int num_frames = 30 * num_keyframes;
+        std::vector<vec3> points(num_keyframes);
+        for (int i = 0; i < num_keyframes; ++i) {
+            const float t = float(i) * 0.05f;
+            points[i] = vec3(std::cos(t) * 10.0f, std::sin(t) * 10.0f, t);
+        }
+
+        SplineCurveFitting<vec3> fitter(3, SplineCurveFitting<vec3>::eOPEN_UNIFORM);
+        fitter.set_ctrl_points(points);
+
+        StopWatch w;
+        const std::vector<float> U = fitter.get_equally_spaced_parameters(num_frames);
+        std::vector<vec3> frames;
+        fitter.eval_f(U, frames);
+        LOG(INFO) << "path of " << num_keyframes << " keyframes: " << num_frames << " equally spaced frames in "
+                  << w.elapsed_seconds(6) << " s";
+    }
+
+}
+
 int test_spline() {
 
     // these are actually a set of camera positions around the bunny.ply model
@@ -97,5 +229,15 @@ int test_spline() {
         }
     }
 
+    std::cout << "batched spline evaluation" << std::endl;
+    if (!test_batched_evaluation(points))
+        return EXIT_FAILURE;
+
+    std::cout << "arc-length table" << std::endl;
+    if (!test_arc_length(points))
+        return EXIT_FAILURE;
+
+    benchmark_long_path();
+
     return EXIT_SUCCESS;
 }
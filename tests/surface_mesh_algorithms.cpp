@@ -27,14 +27,18 @@
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/poly_mesh.h>
+#include <easy3d/algo/collider.h>
 #include <easy3d/algo/surface_mesh_components.h>
 #include <easy3d/algo/surface_mesh_curvature.h>
 #include <easy3d/algo/surface_mesh_enumerator.h>
+#include <easy3d/algo/surface_mesh_factory.h>
 #include <easy3d/algo/surface_mesh_fairing.h>
 #include <easy3d/algo/surface_mesh_geodesic.h>
+#include <easy3d/algo/surface_mesh_geometry.h>
 #include <easy3d/algo/surface_mesh_hole_filling.h>
 #include <easy3d/algo/surface_mesh_parameterization.h>
 #include <easy3d/algo/surface_mesh_polygonization.h>
+#include <easy3d/algo/surface_mesh_region_growing.h>
 #include <easy3d/algo/surface_mesh_remeshing.h>
 #include <easy3d/algo/surface_mesh_sampler.h>
 #include <easy3d/algo/surface_mesh_simplification.h>
@@ -47,14 +51,201 @@
 #include <easy3d/algo/surface_mesh_features.h>
 #include <easy3d/fileio/surface_mesh_io.h>
 #include <easy3d/util/resource.h>
+#include <easy3d/util/stop_watch.h>
+
+#include <algorithm>
+#include <cmath>
 
 #if HAS_CGAL
 #include <easy3d/algo_ext/surfacer.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 using namespace easy3d;
 
+
+namespace {
+
+    // runs the function using the given number of threads (the default number if num_threads <= 0)
+    template <typename FT>
+    void run_with_threads(int num_threads, FT func) {
+#ifdef _OPENMP
+        const int default_threads = omp_get_max_threads();
+        if (num_threads > 0)
+            omp_set_num_threads(num_threads);
+        func();
+        omp_set_num_threads(default_threads);
+#else
+        (void) num_threads;
+        func();
+#endif
+    }
+
+
+    // adds n^3 instances of the mesh to the collider and returns their transformations, which place the instances
+    // on a jittered grid, so each body collides with some of its neighbors (assuming a mesh in the unit sphere)
+    std::vector<mat4> grid_of_bodies(MultiBodyCollider &collider, SurfaceMesh *mesh, int n) {
+        std::vector<mat4> transforms;
+        std::srand(0);
+        for (int i = 0; i < n * n * n; ++i) {
+            collider.add(mesh);
+            const vec3 jitter = vec3(std::rand(), std::rand(), std::rand()) / float(RAND_MAX) * 0.4f;
+            const vec3 pos = vec3(float(i % n), float((i / n) % n), float(i / (n * n))) * 2.1f + jitter;
+            transforms.push_back(mat4::translation(pos));
+        }
+        return transforms;
+    }
+
+
+    // the sorted pairs of bodies whose bounding boxes overlap, checking all pairs. All the bodies have the bounding
+    // box 'box' and the transformations are translations.
+    std::vector<std::pair<int, int> > overlapping_pairs_brute_force(const std::vector<mat4> &transforms,
+                                                                     const Box3 &box) {
+        std::vector<std::pair<int, int> > pairs;
+        const int num = static_cast<int>(transforms.size());
+        for (int i = 0; i < num; ++i) {
+            for (int j = i + 1; j < num; ++j) {
+                const vec3 d = transforms[i].col(3).xyz() - transforms[j].col(3).xyz();
+                if (std::abs(d.x) <= box.range(0) && std::abs(d.y) <= box.range(1) && std::abs(d.z) <= box.range(2))
+                    pairs.emplace_back(i, j);
+            }
+        }
+        return pairs;
+    }
+
+}
+
+bool test_algo_surface_mesh_collision() {
+    // unit spheres
+    SurfaceMesh sphere = SurfaceMeshFactory::icosphere(1);
+    const Box3 box = sphere.bounding_box();
+
+    std::cout << "boolean, distance, and time of impact queries..." << std::endl;
+    {
+        Collider collider(&sphere, &sphere);
+        const mat4 t0 = mat4::identity();
+        const mat4 near = mat4::translation(vec3(1.5f, 0, 0));
+        const mat4 far = mat4::translation(vec3(0, 3.5f, 0));
+        if (!collider.intersects(t0, near) || collider.intersects(t0, far) || collider.distance(t0, near) != 0.0f) {
+            std::cerr << "boolean or distance query of two spheres is wrong (intersecting: "
+                      << collider.intersects(t0, near) << ", separated: " << !collider.intersects(t0, far)
+                      << ", distance of the intersecting ones: " << collider.distance(t0, near) << ")" << std::endl;
+            return false;
+        }
+
+        // the spheres are inscribed in the unit sphere, and the vertices are on it
+        const float dist = collider.distance(t0, far);
+        std::cout << "    distance: " << dist << std::endl;
+        if (dist < 1.5f || dist > 1.5f + 1e-5f + 2.0f * (1.0f - box.max_coord(1))) {
+            std::cerr << "distance of two separated spheres is wrong: " << dist << std::endl;
+            return false;
+        }
+        if (!collider.within_distance(t0, far, dist + 1e-4f) || collider.within_distance(t0, far, dist - 1e-4f)) {
+            std::cerr << "within_distance() is inconsistent with the distance " << dist << std::endl;
+            return false;
+        }
+
+        // moving from y = 3.5 to y = -3.5 (i.e., a distance of 7), the contact is at about y = 2 (i.e., t = 1.5 / 7)
+        bool converged = false;
+        const float toi = collider.time_of_impact(t0, far, t0, mat4::translation(vec3(0, -3.5f, 0)), 1e-4f,
+                                                  &converged);
+        std::cout << "    time of impact: " << toi << std::endl;
+        if (!converged || toi < 1.5f / 7.0f - 1e-3f || toi > (3.5f - 2.0f * box.max_coord(1)) / 7.0f + 1e-3f) {
+            std::cerr << "time of impact is wrong: " << toi << (converged ? "" : " (not converged)") << std::endl;
+            return false;
+        }
+        const float toi_miss = collider.time_of_impact(t0, far, t0, mat4::translation(vec3(5.0f, 3.5f, 0)), 1e-4f,
+                                                       &converged);
+        if (!converged || toi_miss != -1.0f) {
+            std::cerr << "spheres passing each other are reported in contact at " << toi_miss
+                      << (converged ? "" : " (not converged)") << std::endl;
+            return false;
+        }
+    }
+
+    // the broad phase must report exactly the pairs whose bounding boxes overlap
+    std::cout << "broad phase on a grid of bodies..." << std::endl;
+    {
+        const int n = 5;
+        MultiBodyCollider collider;
+        const std::vector<mat4> transforms = grid_of_bodies(collider, &sphere, n);
+        auto pairs = collider.overlapping_pairs(transforms);
+        std::sort(pairs.begin(), pairs.end());
+        const auto expected = overlapping_pairs_brute_force(transforms, box);
+        if (pairs != expected) {
+            std::cerr << "Error: broad phase reported " << pairs.size() << " pairs (expected " << expected.size()
+                      << ")" << std::endl;
+            return false;
+        }
+        const auto contacts = collider.detect(transforms);
+        if (contacts.empty() || contacts.size() > pairs.size()) {
+            std::cerr << "Error: " << contacts.size() << " colliding pairs reported for " << pairs.size()
+                      << " overlapping pairs" << std::endl;
+            return false;
+        }
+    }
+
+    // bodies on a line along x (i.e., the sweep axis) moving in opposite directions, so they pass each other and
+    // swap their order in the sorted list that is kept between the calls
+    std::cout << "broad phase with bodies swapping order along the sweep axis..." << std::endl;
+    {
+        const int num = 20;
+        MultiBodyCollider collider;
+        std::vector<mat4> transforms;
+        for (int i = 0; i < num; ++i) {
+            collider.add(&sphere);
+            const float y = (i % 2) ? 0.5f : -0.5f;
+            transforms.push_back(mat4::translation(vec3(i * 2.1f, y, 0.1f * float(i % 3))));
+        }
+        for (int frame = 0; frame < 30; ++frame) {
+            auto pairs = collider.overlapping_pairs(transforms);
+            std::sort(pairs.begin(), pairs.end());
+            const auto expected = overlapping_pairs_brute_force(transforms, box);
+            if (pairs != expected) {
+                std::cerr << "Error: broad phase reported " << pairs.size() << " pairs in frame " << frame
+                          << " (expected " << expected.size() << ")" << std::endl;
+                return false;
+            }
+            for (int i = 0; i < num; ++i) {
+                const float dx = (i % 2) ? 0.73f : -0.73f;
+                transforms[i] = mat4::translation(vec3(dx, 0, 0)) * transforms[i];
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// scaling with the number of bodies: two frames each, the second one benefits from the temporal coherence
+int benchmark_surface_mesh_collision() {
+    SurfaceMesh sphere = SurfaceMeshFactory::icosphere(1);
+    for (int n : {10, 22, 46}) {
+        const int num = n * n * n;
+        MultiBodyCollider collider;
+        std::vector<mat4> transforms = grid_of_bodies(collider, &sphere, n);
+        for (int frame = 0; frame < 2; ++frame) {
+            if (frame > 0) {
+                for (auto &t : transforms)
+                    t = mat4::translation(vec3(0.01f, -0.01f, 0.02f)) * t;
+            }
+            const auto pairs = collider.overlapping_pairs(transforms);
+            StopWatch w;
+            const auto contacts = collider.detect(transforms);
+            const double time = w.elapsed_seconds(6);
+            std::cout << num << " bodies, frame " << frame << ": " << pairs.size() << " overlapping pairs, "
+                      << contacts.size() << " colliding, " << time * 1000.0 << " ms ("
+                      << static_cast<int>(pairs.size() / std::max(time, 1e-6)) << " pairs/sec)" << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+
 bool test_algo_surface_mesh_components() {
     const std::string file = resource::directory() + "/data/house/house.obj";
     SurfaceMesh *mesh = SurfaceMeshIO::load(file);
@@ -129,6 +320,133 @@ bool test_algo_surface_mesh_topology() {
 }
 
 
+bool test_algo_surface_mesh_geometry() {
+    SurfaceMesh mesh = SurfaceMeshFactory::icosphere(5);
+
+    // serial references, accumulated in double
+    double area_ref = 0.0, volume_ref = 0.0;
+    for (auto f : mesh.faces()) {
+        auto fv = mesh.vertices(f);
+        const vec3 p0 = mesh.position(*fv);
+        const vec3 p1 = mesh.position(*(++fv));
+        const vec3 p2 = mesh.position(*(++fv));
+        area_ref += geom::triangle_area(p0, p1, p2);
+        volume_ref += dot(cross(p0, p1), p2) / 6.0;
+    }
+
+    std::cout << "computing surface area and volume..." << std::endl;
+    const float area = geom::surface_area(&mesh);
+    const float volume = geom::volume(&mesh);
+    if (std::abs(area - area_ref) > 1e-5 * area_ref || std::abs(volume - volume_ref) > 1e-5 * volume_ref) {
+        std::cerr << "surface area/volume mismatch: " << area << " vs " << area_ref << ", " << volume << " vs "
+                  << volume_ref << std::endl;
+        return false;
+    }
+    // the reductions do not depend on the number of threads
+    float area_single = 0.0f, volume_single = 0.0f;
+    run_with_threads(1, [&]() {
+        area_single = geom::surface_area(&mesh);
+        volume_single = geom::volume(&mesh);
+    });
+    if (area != area_single || volume != volume_single) {
+        std::cerr << "surface area/volume using 1 thread (" << area_single << ", " << volume_single
+                  << ") differ from the ones using multiple threads (" << area << ", " << volume << ")" << std::endl;
+        return false;
+    }
+
+    std::cout << "computing Voronoi areas..." << std::endl;
+    std::vector<double> areas, areas_single;
+    geom::voronoi_areas(&mesh, areas);
+    run_with_threads(1, [&]() { geom::voronoi_areas(&mesh, areas_single); });
+    if (areas != areas_single) {
+        std::cerr << "Voronoi areas using 1 thread differ from the ones using multiple threads" << std::endl;
+        return false;
+    }
+    double sum = 0.0;
+    for (auto v : mesh.vertices()) {
+        if (areas[v.idx()] != geom::voronoi_area(&mesh, v)) {
+            std::cerr << "Voronoi area of vertex " << v << " mismatch: " << areas[v.idx()] << " vs "
+                      << geom::voronoi_area(&mesh, v) << std::endl;
+            return false;
+        }
+        sum += areas[v.idx()];
+    }
+    if (std::abs(sum - area_ref) > 1e-3 * area_ref) {
+        std::cerr << "sum of the Voronoi areas (" << sum << ") differs from the surface area (" << area_ref << ")"
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "computing face/vertex normals..." << std::endl;
+    mesh.update_vertex_normals();   // also computes the face normals
+    auto fnormals = mesh.get_face_property<vec3>("f:normal");
+    auto vnormals = mesh.get_vertex_property<vec3>("v:normal");
+    for (auto f : mesh.faces()) {
+        if (fnormals[f] != mesh.compute_face_normal(f)) {
+            std::cerr << "normal of face " << f << " mismatch: " << fnormals[f] << " vs "
+                      << mesh.compute_face_normal(f) << std::endl;
+            return false;
+        }
+    }
+    for (auto v : mesh.vertices()) {
+        if (vnormals[v] != mesh.compute_vertex_normal(v)) {
+            std::cerr << "normal of vertex " << v << " mismatch: " << vnormals[v] << " vs "
+                      << mesh.compute_vertex_normal(v) << std::endl;
+            return false;
+        }
+    }
+
+    // deleted faces are skipped
+    const SurfaceMesh::Face f0(0);
+    const float area0 = geom::triangle_area(&mesh, f0);
+    mesh.delete_face(f0);
+    if (std::abs(geom::surface_area(&mesh) - (area - area0)) > 1e-5 * area) {
+        std::cerr << "surface area after deleting a face mismatch: " << geom::surface_area(&mesh) << " vs "
+                  << area - area0 << std::endl;
+        return false;
+    }
+    mesh.update_face_normals();
+
+    return true;
+}
+
+
+// scaling with the mesh size: the serial loops over the faces/vertices vs. the parallel kernels
+int benchmark_surface_mesh_geometry() {
+    for (std::size_t level : {6, 7, 8}) {
+        SurfaceMesh sphere = SurfaceMeshFactory::icosphere(level);
+        StopWatch w;
+        double checksum = 0.0;
+        for (auto f : sphere.faces()) {
+            checksum += geom::triangle_area(&sphere, f);
+            if (!sphere.is_degenerate(f))
+                checksum += sphere.compute_face_normal(f).x;
+        }
+        const double t_serial_faces = w.elapsed_seconds(6);
+
+        w.restart();
+        checksum -= geom::surface_area(&sphere);
+        sphere.update_face_normals();
+        const double t_parallel_faces = w.elapsed_seconds(6);
+
+        w.restart();
+        for (auto v : sphere.vertices())
+            checksum += sphere.compute_vertex_normal(v).x;
+        const double t_serial_vertices = w.elapsed_seconds(6);
+
+        w.restart();
+        sphere.update_vertex_normals();
+        const double t_parallel_vertices = w.elapsed_seconds(6);
+
+        LOG(INFO) << sphere.n_faces() << " faces, area and face normals: serial " << t_serial_faces
+                  << " s, parallel " << t_parallel_faces << " s; vertex normals: serial " << t_serial_vertices
+                  << " s, parallel " << t_parallel_vertices << " s (checksum " << checksum << ")";
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
 bool test_algo_surface_mesh_curvature() {
     const std::string file = resource::directory() + "/data/mannequin.ply";
     SurfaceMesh *mesh = SurfaceMeshIO::load(file);
@@ -168,11 +486,97 @@ bool test_algo_surface_mesh_enumerator() {
 
     std::cout << "enumerating connected components..." << std::endl;
     auto connected_components = mesh->face_property<int>("f:connected_component", -1);
-    SurfaceMeshEnumerator::enumerate_connected_components(mesh, connected_components);
+    const int num_components = SurfaceMeshEnumerator::enumerate_connected_components(mesh, connected_components);
+
+    // the result must be identical to propagating the components from the seeds in order
+    auto propagated = mesh->face_property<int>("f:propagated", -1);
+    int num_propagated = 0;
+    for (auto f : mesh->faces()) {
+        if (propagated[f] == -1)
+            SurfaceMeshEnumerator::propagate_connected_component(mesh, propagated, f, num_propagated++);
+    }
+    if (num_components != num_propagated || connected_components.vector() != propagated.vector()) {
+        std::cerr << "Error: inconsistent connected components (" << num_components << " vs. " << num_propagated
+                  << ")" << std::endl;
+        delete mesh;
+        return false;
+    }
 
     std::cout << "enumerating planar components..." << std::endl;
     auto planar_segments = mesh->face_property<int>("f:planar_partition", -1);
-    SurfaceMeshEnumerator::enumerate_planar_components(mesh, planar_segments, 1.0f);
+    const int num_segments = SurfaceMeshEnumerator::enumerate_planar_components(mesh, planar_segments, 1.0f);
+
+    // degenerate faces are not seeds (they inherit the labels of their neighbors)
+    std::fill(propagated.vector().begin(), propagated.vector().end(), -1);
+    num_propagated = 0;
+    bool consistent = true;
+    for (auto f : mesh->faces()) {
+        if (propagated[f] == -1 && !mesh->is_degenerate(f))
+            SurfaceMeshEnumerator::propagate_planar_component(mesh, propagated, f, num_propagated++, 1.0f);
+    }
+    for (auto f : mesh->faces()) {
+        if (!mesh->is_degenerate(f) && planar_segments[f] != propagated[f])
+            consistent = false;
+    }
+    if (num_segments != num_propagated || !consistent) {
+        std::cerr << "Error: inconsistent planar components (" << num_segments << " vs. " << num_propagated
+                  << ")" << std::endl;
+        delete mesh;
+        return false;
+    }
+    std::cout << "    " << num_components << " connected components, " << num_segments << " planar components"
+              << std::endl;
+
+    delete mesh;
+    return true;
+}
+
+
+bool test_algo_surface_mesh_region_growing() {
+    const std::string file = resource::directory() + "/data/house/house.obj";
+    SurfaceMesh *mesh = SurfaceMeshIO::load(file);
+    if (!mesh) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "incremental region growing..." << std::endl;
+    SurfaceMeshRegionGrowing segmentation(mesh);
+    segmentation.initialize();
+
+    // the thresholds go up and down, as if the user drags a slider
+    auto incremental = mesh->face_property<int>("f:incremental", -1);
+    auto reference = mesh->face_property<int>("f:reference", -1);
+    for (float threshold : {1.0f, 10.0f, 0.5f, 30.0f, 5.0f, 5.5f, 1.0f, 90.0f, 0.0f}) {
+        const int num = segmentation.set_angle_threshold(threshold);
+        const int num_labeled = segmentation.labels(incremental);
+        const int num_reference = SurfaceMeshEnumerator::enumerate_planar_components(mesh, reference, threshold);
+
+        // the labels may differ, but the partitions (of the non-degenerate faces) must be identical
+        std::vector<int> to_reference(num_labeled, -1), to_incremental(num_reference, -1);
+        bool consistent = (num == num_labeled && num == num_reference);
+        for (auto f : mesh->faces()) {
+            if (!consistent || mesh->is_degenerate(f))
+                continue;
+            const int a = incremental[f], b = reference[f];
+            if (a < 0 || b < 0 || (to_reference[a] != -1 && to_reference[a] != b) ||
+                (to_incremental[b] != -1 && to_incremental[b] != a))
+                consistent = false;
+            else {
+                to_reference[a] = b;
+                to_incremental[b] = a;
+            }
+        }
+        if (!consistent) {
+            std::cerr << "Error: inconsistent planar regions for threshold " << threshold << " (" << num
+                      << " vs. " << num_reference << ")" << std::endl;
+            delete mesh;
+            return false;
+        }
+        std::cout << "    threshold " << threshold << ": " << num << " regions ("
+                  << segmentation.num_updated_candidates() << " candidates updated)" << std::endl;
+    }
 
     delete mesh;
     return true;
@@ -389,13 +793,68 @@ bool test_algo_surface_mesh_sampler() {
     std::cout << "sampling surface mesh..." << std::endl;
     SurfaceMeshSampler sampler;
     PointCloud *cloud = sampler.apply(mesh, 100000);
-    delete mesh;
+    if (!cloud) {
+        delete mesh;
+        return false;
+    }
+    delete cloud;
+
+    std::cout << "sampling surface mesh (random, stratified, and low-discrepancy)..." << std::endl;
+    const SurfaceMeshSampler::Method methods[] = {
+            SurfaceMeshSampler::RANDOM, SurfaceMeshSampler::STRATIFIED, SurfaceMeshSampler::LOW_DISCREPANCY
+    };
+    for (auto method : methods) {
+        // the samples must not depend on the number of threads
+        PointCloud *a = nullptr, *b = nullptr;
+        run_with_threads(1, [&]() { a = SurfaceMeshSampler::apply(mesh, 50000, method, 7, false); });
+        run_with_threads(0, [&]() { b = SurfaceMeshSampler::apply(mesh, 50000, method, 7, false); });
+        const bool ok = a && b && a->n_vertices() == 50000 && a->points() == b->points();
+        delete a;
+        delete b;
+        if (!ok) {
+            std::cerr << "Error: sampling (method " << method << ") gives different results with 1 and "
+                      << "multiple threads for the same seed" << std::endl;
+            delete mesh;
+            return false;
+        }
+    }
 
-    if (cloud) {
+    // With attributes that are affine functions of the positions, the barycentric interpolation must reproduce
+    // the same functions at the samples (and at the vertices, the attributes of the vertices).
+    std::cout << "sampling surface mesh with colors and texture coordinates..." << std::endl;
+    auto color_of = [](const vec3 &p) { return vec3(2.0f * p.x + 0.5f, 0.5f - p.y, 3.0f * p.z + p.x); };
+    auto texcoord_of = [](const vec3 &p) { return vec2(3.0f * p.x, p.y - p.z); };
+    auto vcolors = mesh->add_vertex_property<vec3>("v:color");
+    for (auto v : mesh->vertices())
+        vcolors[v] = color_of(mesh->position(v));
+    auto htexcoords = mesh->add_halfedge_property<vec2>("h:texcoord");
+    for (auto h : mesh->halfedges())
+        htexcoords[h] = texcoord_of(mesh->position(mesh->target(h)));
+
+    for (auto method : methods) {
+        PointCloud *cloud = SurfaceMeshSampler::apply(mesh, 50000, method, 3, true);
+        auto colors = cloud ? cloud->get_vertex_property<vec3>("v:color") : PointCloud::VertexProperty<vec3>();
+        auto texcoords = cloud ? cloud->get_vertex_property<vec2>("v:texcoord") : PointCloud::VertexProperty<vec2>();
+        bool ok = cloud && colors && texcoords;
+        if (ok) {
+            for (auto v : cloud->vertices()) {
+                const vec3 &p = cloud->position(v);
+                if (distance(colors[v], color_of(p)) > 1e-5f || distance(texcoords[v], texcoord_of(p)) > 1e-5f) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
         delete cloud;
-        return true;
+        if (!ok) {
+            std::cerr << "colors/texture coordinates are not correctly interpolated" << std::endl;
+            delete mesh;
+            return false;
+        }
     }
-    return false;
+
+    delete mesh;
+    return true;
 }
 
 
@@ -479,10 +938,325 @@ bool test_algo_surface_mesh_stitching() {
 #endif
 
     delete mesh;
+
+    // split a sphere into two tiles, and also put the tiles into a single mesh with duplicated seam vertices
+    SurfaceMesh sphere = SurfaceMeshFactory::icosphere(3);
+    SurfaceMesh tiles[2], merged;
+    for (auto f : sphere.faces()) {
+        const int t = sphere.position(sphere.target(sphere.halfedge(f))).x < 0 ? 0 : 1;
+        std::vector<SurfaceMesh::Vertex> vts0, vts1;
+        for (auto v : sphere.vertices(f)) {
+            vts0.push_back(tiles[t].add_vertex(sphere.position(v)));
+            vts1.push_back(merged.add_vertex(sphere.position(v)));
+        }
+        tiles[t].add_face(vts0);
+        merged.add_face(vts1);
+    }
+    // each face has its own vertices, so merge the coincident vertices within each tile first
+    for (auto& tile : tiles)
+        SurfaceMeshStitching(&tile).apply();
+
+    std::vector<SurfaceMesh*> meshes = {&tiles[0], &tiles[1]};
+    const auto matches = SurfaceMeshStitching::match_borders(meshes);
+    std::size_t num_seam_edges = 0;
+    for (auto h : tiles[0].halfedges())
+        num_seam_edges += tiles[0].is_border(h);
+    std::cout << "matched " << matches.size() << " border edges of two tiles (seam: " << num_seam_edges << " edges)"
+              << std::endl;
+    if (num_seam_edges == 0 || matches.size() != num_seam_edges) {
+        std::cerr << "Error: " << matches.size() << " border edges of the two tiles matched (expected "
+                  << num_seam_edges << ", i.e., the number of border edges of the first tile)" << std::endl;
+        return false;
+    }
+    for (const auto& m : matches) {
+        if (m.mesh0 == m.mesh1) {
+            std::cerr << "Error: border edges " << m.h0 << " and " << m.h1 << " of tile " << m.mesh0
+                      << " matched with each other (expected a match between the two tiles)" << std::endl;
+            return false;
+        }
+    }
+
+    SurfaceMeshStitching stitch_merged(&merged);
+    const std::size_t num_stitched = stitch_merged.apply();
+    std::cout << "stitched " << num_stitched << " edge pairs: " << merged.n_faces() << " faces, "
+              << merged.n_vertices() << " vertices" << std::endl;
+    if (merged.n_vertices() != sphere.n_vertices()) {
+        std::cerr << "Error: the stitched mesh has " << merged.n_vertices() << " vertices (expected "
+                  << sphere.n_vertices() << ", i.e., those of the sphere)" << std::endl;
+        return false;
+    }
+
     return true;
 }
 
 
+namespace {
+
+    // The Loop and Catmull-Clark subdivisions refining the mesh using insert_vertex()/insert_edge() (i.e., the
+    // implementations before the direct construction), used as the reference.
+    void reference_loop(SurfaceMesh *mesh) {
+        auto points = mesh->vertex_property<vec3>("v:point");
+        auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+        auto efeature = mesh->get_edge_property<bool>("e:feature");
+
+        auto vpoint = mesh->add_vertex_property<vec3>("loop:vpoint");
+        auto epoint = mesh->add_edge_property<vec3>("loop:epoint");
+
+        for (auto v : mesh->vertices()) {
+            if (mesh->is_isolated(v))
+                vpoint[v] = points[v];
+            else if (mesh->is_border(v)) {
+                auto h1 = mesh->out_halfedge(v);
+                auto h0 = mesh->prev(h1);
+                vec3 p = points[v];
+                p *= 6.0;
+                p += points[mesh->target(h1)];
+                p += points[mesh->source(h0)];
+                p *= 0.125;
+                vpoint[v] = p;
+            }
+            else if (vfeature && vfeature[v]) {
+                vec3 p = points[v];
+                p *= 6.0;
+                int count(0);
+                for (auto h : mesh->halfedges(v)) {
+                    if (efeature[mesh->edge(h)]) {
+                        p += points[mesh->target(h)];
+                        ++count;
+                    }
+                }
+                if (count == 2) {   // vertex is on feature edge
+                    p *= 0.125;
+                    vpoint[v] = p;
+                }
+                else                // keep fixed
+                    vpoint[v] = points[v];
+            }
+            else {
+                vec3 p(0, 0, 0);
+                float k(0);
+                for (auto vv : mesh->vertices(v)) {
+                    p += points[vv];
+                    ++k;
+                }
+                p /= k;
+                auto beta = static_cast<float>(0.625 - std::pow(0.375 + 0.25 * std::cos(2.0 * M_PI / k), 2.0));
+                vpoint[v] = points[v] * (float) (1.0 - beta) + beta * p;
+            }
+        }
+
+        for (auto e : mesh->edges()) {
+            if (mesh->is_border(e) || (efeature && efeature[e]))
+                epoint[e] = (points[mesh->vertex(e, 0)] + points[mesh->vertex(e, 1)]) * float(0.5);
+            else {
+                auto h0 = mesh->halfedge(e, 0);
+                auto h1 = mesh->halfedge(e, 1);
+                vec3 p = points[mesh->target(h0)];
+                p += points[mesh->target(h1)];
+                p *= 3.0;
+                p += points[mesh->target(mesh->next(h0))];
+                p += points[mesh->target(mesh->next(h1))];
+                p *= 0.125;
+                epoint[e] = p;
+            }
+        }
+
+        for (auto v : mesh->vertices())
+            points[v] = vpoint[v];
+
+        for (auto e : mesh->edges()) {
+            auto h = mesh->insert_vertex(e, epoint[e]);
+            if (efeature && efeature[e]) {
+                vfeature[mesh->target(h)] = true;
+                efeature[mesh->edge(h)] = true;
+                efeature[mesh->edge(mesh->next(h))] = true;
+            }
+        }
+
+        for (auto f : mesh->faces()) {
+            auto h = mesh->halfedge(f);
+            mesh->insert_edge(h, mesh->next(mesh->next(h)));
+            h = mesh->next(h);
+            mesh->insert_edge(h, mesh->next(mesh->next(h)));
+            h = mesh->next(h);
+            mesh->insert_edge(h, mesh->next(mesh->next(h)));
+        }
+
+        mesh->remove_vertex_property(vpoint);
+        mesh->remove_edge_property(epoint);
+    }
+
+
+    void reference_catmull_clark(SurfaceMesh *mesh) {
+        auto points = mesh->vertex_property<vec3>("v:point");
+        auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+        auto efeature = mesh->get_edge_property<bool>("e:feature");
+
+        auto vpoint = mesh->add_vertex_property<vec3>("catmull:vpoint");
+        auto epoint = mesh->add_edge_property<vec3>("catmull:epoint");
+        auto fpoint = mesh->add_face_property<vec3>("catmull:fpoint");
+
+        for (auto f : mesh->faces())
+            fpoint[f] = geom::centroid(mesh, f);
+
+        for (auto e : mesh->edges()) {
+            if (mesh->is_border(e) || (efeature && efeature[e]))
+                epoint[e] = 0.5f * (points[mesh->vertex(e, 0)] + points[mesh->vertex(e, 1)]);
+            else {
+                vec3 p(0, 0, 0);
+                p += points[mesh->vertex(e, 0)];
+                p += points[mesh->vertex(e, 1)];
+                p += fpoint[mesh->face(e, 0)];
+                p += fpoint[mesh->face(e, 1)];
+                p *= 0.25f;
+                epoint[e] = p;
+            }
+        }
+
+        for (auto v : mesh->vertices()) {
+            if (mesh->is_isolated(v))
+                vpoint[v] = points[v];
+            else if (mesh->is_border(v)) {
+                auto h1 = mesh->out_halfedge(v);
+                auto h0 = mesh->prev(h1);
+                vec3 p = points[v];
+                p *= 6.0;
+                p += points[mesh->target(h1)];
+                p += points[mesh->source(h0)];
+                p *= 0.125;
+                vpoint[v] = p;
+            }
+            else if (vfeature && vfeature[v]) {
+                vec3 p = points[v];
+                p *= 6.0;
+                int count(0);
+                for (auto h : mesh->halfedges(v)) {
+                    if (efeature[mesh->edge(h)]) {
+                        p += points[mesh->target(h)];
+                        ++count;
+                    }
+                }
+                if (count == 2) {   // vertex is on feature edge
+                    p *= 0.125;
+                    vpoint[v] = p;
+                }
+                else                // keep fixed
+                    vpoint[v] = points[v];
+            }
+            else {
+                // weights from SIGGRAPH paper "Subdivision Surfaces in Character Animation"
+                const auto k = static_cast<float>(mesh->valence(v));
+                vec3 p(0, 0, 0);
+                for (auto vv : mesh->vertices(v))
+                    p += points[vv];
+                for (auto f : mesh->faces(v))
+                    p += fpoint[f];
+                p /= (k * k);
+                p += ((k - 2.0f) / k) * points[v];
+                vpoint[v] = p;
+            }
+        }
+
+        for (auto v : mesh->vertices())
+            points[v] = vpoint[v];
+
+        for (auto e : mesh->edges()) {
+            auto h = mesh->insert_vertex(e, epoint[e]);
+            if (efeature && efeature[e]) {
+                vfeature[mesh->target(h)] = true;
+                efeature[mesh->edge(h)] = true;
+                efeature[mesh->edge(mesh->next(h))] = true;
+            }
+        }
+
+        for (auto f : mesh->faces()) {
+            auto h0 = mesh->halfedge(f);
+            mesh->insert_edge(h0, mesh->next(mesh->next(h0)));
+            auto h1 = mesh->next(h0);
+            mesh->insert_vertex(mesh->edge(h1), fpoint[f]);
+            auto h = mesh->next(mesh->next(mesh->next(h1)));
+            while (h != h0) {
+                mesh->insert_edge(h1, h);
+                h = mesh->next(mesh->next(mesh->next(h1)));
+            }
+        }
+
+        mesh->remove_vertex_property(vpoint);
+        mesh->remove_edge_property(epoint);
+        mesh->remove_face_property(fpoint);
+    }
+
+
+    // the faces of a mesh, each as its vertex indices starting from the smallest one
+    std::vector<std::vector<int> > sorted_faces(const SurfaceMesh *mesh) {
+        std::vector<std::vector<int> > faces;
+        for (auto f : mesh->faces()) {
+            std::vector<int> ids;
+            for (auto v : mesh->vertices(f))
+                ids.push_back(v.idx());
+            std::rotate(ids.begin(), std::min_element(ids.begin(), ids.end()), ids.end());
+            faces.push_back(ids);
+        }
+        std::sort(faces.begin(), faces.end());
+        return faces;
+    }
+
+
+    // the feature edges of a mesh, each as the indices of its two vertices
+    std::vector<std::pair<int, int> > sorted_feature_edges(const SurfaceMesh *mesh) {
+        std::vector<std::pair<int, int> > edges;
+        auto efeature = mesh->get_edge_property<bool>("e:feature");
+        for (auto e : mesh->edges()) {
+            if (efeature[e]) {
+                const int a = mesh->vertex(e, 0).idx(), b = mesh->vertex(e, 1).idx();
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        return edges;
+    }
+
+
+    // compares the vertices (positions and feature flags) and the connectivity of two subdivided meshes
+    bool compare_subdivisions(const SurfaceMesh *mesh, const SurfaceMesh *reference, const std::string &method) {
+        if (mesh->n_vertices() != reference->n_vertices() || mesh->n_edges() != reference->n_edges() ||
+            mesh->n_faces() != reference->n_faces()) {
+            std::cerr << method << " subdivision gives " << mesh->n_vertices() << " vertices, " << mesh->n_edges()
+                      << " edges, and " << mesh->n_faces() << " faces, but the reference gives "
+                      << reference->n_vertices() << ", " << reference->n_edges() << ", and "
+                      << reference->n_faces() << std::endl;
+            return false;
+        }
+
+        auto vfeature = mesh->get_vertex_property<bool>("v:feature");
+        auto vfeature_ref = reference->get_vertex_property<bool>("v:feature");
+        for (auto v : reference->vertices()) {
+            if (distance(mesh->position(v), reference->position(v)) > 1e-5f) {
+                std::cerr << method << " subdivision moves vertex " << v << " to " << mesh->position(v)
+                          << ", but the reference moves it to " << reference->position(v) << std::endl;
+                return false;
+            }
+            if (vfeature[v] != vfeature_ref[v]) {
+                std::cerr << method << " subdivision marks vertex " << v << (vfeature[v] ? "" : " not")
+                          << " as feature, unlike the reference" << std::endl;
+                return false;
+            }
+        }
+
+        if (sorted_faces(mesh) != sorted_faces(reference)) {
+            std::cerr << method << " subdivision gives faces different from the reference" << std::endl;
+            return false;
+        }
+        if (sorted_feature_edges(mesh) != sorted_feature_edges(reference)) {
+            std::cerr << method << " subdivision gives feature edges different from the reference" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+}
+
+
 bool test_algo_surface_mesh_subdivision() {
     const std::string file = resource::directory() + "/data/sphere.obj";
     SurfaceMesh *mesh = SurfaceMeshIO::load(file);
@@ -511,6 +1285,116 @@ bool test_algo_surface_mesh_subdivision() {
     }
 
     delete mesh;
+
+    // multiple levels in one call, on a mesh with boundary
+    const std::string open_file = resource::directory() + "/data/hemisphere.ply";
+    for (int method = 0; method < 2; ++method) {
+        SurfaceMesh *multi = SurfaceMeshIO::load(open_file);
+        SurfaceMesh *single = SurfaceMeshIO::load(open_file);
+        if (!multi || !single) {
+            std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                      << std::endl;
+            delete multi;
+            delete single;
+            return false;
+        }
+
+        // the element counts of the refined mesh
+        std::size_t nv = multi->n_vertices(), ne = multi->n_edges(), nf = multi->n_faces(), nc = 3 * nf;
+        for (int i = 0; i < 2; ++i) {
+            if (method == 0) {  // Loop
+                nv += ne;
+                ne = 2 * ne + 3 * nf;
+                nf = 4 * nf;
+            } else {            // Catmull-Clark
+                nv += ne + nf;
+                ne = 2 * ne + nc;
+                nf = nc;
+                nc = 4 * nf;
+            }
+        }
+
+        std::cout << (method == 0 ? "Loop" : "CatmullClark") << " subdivision (2 levels)..." << std::endl;
+        bool success = (method == 0) ? SurfaceMeshSubdivision::loop(multi, 2)
+                                     : SurfaceMeshSubdivision::catmull_clark(multi, 2);
+        for (int i = 0; i < 2; ++i)
+            success = success && ((method == 0) ? SurfaceMeshSubdivision::loop(single)
+                                                : SurfaceMeshSubdivision::catmull_clark(single));
+
+        success = success && multi->n_vertices() == nv && multi->n_edges() == ne && multi->n_faces() == nf;
+        success = success && single->n_vertices() == nv && single->n_edges() == ne && single->n_faces() == nf;
+
+        // the connectivity must be consistent
+        for (auto h : multi->halfedges()) {
+            if (multi->prev(multi->next(h)) != h || multi->face(multi->next(h)) != multi->face(h) ||
+                multi->target(multi->opposite(h)) != multi->source(h)) {
+                success = false;
+                break;
+            }
+        }
+        for (auto v : multi->vertices()) {
+            if (multi->source(multi->out_halfedge(v)) != v) {
+                success = false;
+                break;
+            }
+        }
+
+        // subdividing twice at once is the same as subdividing once twice
+        if (success) {
+            for (auto v : multi->vertices()) {
+                if (distance(multi->position(v), single->position(v)) > 1e-6f) {
+                    success = false;
+                    break;
+                }
+            }
+        }
+
+        delete multi;
+        delete single;
+        if (!success)
+            return false;
+    }
+
+    // Compare with the reference implementations, level by level, on a mesh with boundary and feature edges. Each
+    // level starts from the same mesh, because the two implementations number the split edges (and thus the
+    // vertices of the next level) differently. The second level of Catmull-Clark runs on quads.
+    for (int method = 0; method < 2; ++method) {
+        const std::string name = (method == 0) ? "Loop" : "CatmullClark";
+        SurfaceMesh *reference = SurfaceMeshIO::load(open_file);
+        if (!reference) {
+            std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                      << std::endl;
+            return false;
+        }
+
+        // mark every 7th edge (and its vertices) as feature
+        auto vfeature = reference->add_vertex_property<bool>("v:feature", false);
+        auto efeature = reference->add_edge_property<bool>("e:feature", false);
+        for (auto e : reference->edges()) {
+            if (e.idx() % 7 == 0) {
+                efeature[e] = true;
+                vfeature[reference->vertex(e, 0)] = true;
+                vfeature[reference->vertex(e, 1)] = true;
+            }
+        }
+
+        bool success = true;
+        for (int level = 0; level < 2 && success; ++level) {
+            std::cout << name << " subdivision (level " << level + 1 << ") vs. the reference..." << std::endl;
+            SurfaceMesh mesh(*reference);
+            success = (method == 0) ? SurfaceMeshSubdivision::loop(&mesh) : SurfaceMeshSubdivision::catmull_clark(&mesh);
+            if (method == 0)
+                reference_loop(reference);
+            else
+                reference_catmull_clark(reference);
+            success = success && compare_subdivisions(&mesh, reference, name);
+        }
+
+        delete reference;
+        if (!success)
+            return false;
+    }
+
     return true;
 }
 
@@ -680,18 +1564,27 @@ int test_surface_mesh_slice() {
 
 
 int test_surface_mesh_algorithms() {
+    if (!test_algo_surface_mesh_collision())
+        return EXIT_FAILURE;
+
     if (!test_algo_surface_mesh_components())
         return EXIT_FAILURE;
 
     if (!test_algo_surface_mesh_topology())
         return EXIT_FAILURE;
 
+    if (!test_algo_surface_mesh_geometry())
+        return EXIT_FAILURE;
+
     if (!test_algo_surface_mesh_curvature())
         return EXIT_FAILURE;
 
     if (!test_algo_surface_mesh_enumerator())
         return EXIT_FAILURE;
 
+    if (!test_algo_surface_mesh_region_growing())
+        return EXIT_FAILURE;
+
     if (!test_algo_surface_mesh_fairing())
         return EXIT_FAILURE;
 
@@ -0,0 +1,141 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+
+#include <easy3d/renderer/culler.h>
+#include <easy3d/renderer/transform.h>
+
+#include <iostream>
+
+
+using namespace easy3d;
+
+
+namespace {
+
+    // A grid of 10 x 10 x 10 unit boxes in [0, 20]^3, i.e., separated by gaps of 1 unit.
+    std::vector<Box3> make_grid() {
+        std::vector<Box3> boxes;
+        for (int i = 0; i < 10; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                for (int k = 0; k < 10; ++k) {
+                    const vec3 p(i * 2.0f, j * 2.0f, k * 2.0f);
+                    Box3 box;
+                    box.grow(p);
+                    box.grow(p + vec3(1.0f, 1.0f, 1.0f));
+                    boxes.push_back(box);
+                }
+            }
+        }
+        return boxes;
+    }
+
+
+    // the reference result by testing all the boxes individually against the frustum planes
+    std::vector<int> brute_force(const std::vector<Box3> &boxes, const mat4 &mvp) {
+        std::vector<int> visible;
+        for (std::size_t id = 0; id < boxes.size(); ++id) {
+            bool outside = false;
+            for (int i = 0; i < 3 && !outside; ++i) {
+                for (int s = -1; s <= 1 && !outside; s += 2) {
+                    const vec4 plane = mvp.row(3) + float(s) * mvp.row(i);
+                    bool all_out = true;
+                    for (int c = 0; c < 8; ++c) {
+                        const vec3 corner(
+                                (c & 1) ? boxes[id].max_coord(0) : boxes[id].min_coord(0),
+                                (c & 2) ? boxes[id].max_coord(1) : boxes[id].min_coord(1),
+                                (c & 4) ? boxes[id].max_coord(2) : boxes[id].min_coord(2)
+                        );
+                        if (dot(plane, vec4(corner, 1.0f)) >= 0)
+                            all_out = false;
+                    }
+                    outside = all_out;
+                }
+            }
+            if (!outside)
+                visible.push_back(static_cast<int>(id));
+        }
+        return visible;
+    }
+
+}
+
+
+int test_culler() {
+    std::cout << "culling 1000 boxes..." << std::endl;
+
+    const std::vector<Box3> boxes = make_grid();
+    Culler culler;
+    culler.build(boxes);
+
+    // a camera at the corner of the grid looking at its center
+    const mat4 proj = transform::perspective(static_cast<float>(M_PI / 6.0), 1.0f, 0.1f, 100.0f);
+    const mat4 view = transform::look_at(vec3(-5, -5, -5), vec3(10, 10, 10), vec3(0, 0, 1));
+    const mat4 mvp = proj * view;
+
+    std::vector<int> visible;
+    culler.cull(mvp, 800, 800, visible);
+    const std::vector<int> expected = brute_force(boxes, mvp);
+    if (visible != expected || visible.empty() || visible.size() == boxes.size()) {
+        std::cerr << "frustum culling: " << visible.size() << " visible boxes (expected " << expected.size() << ")"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // a camera looking away from the grid sees nothing
+    const mat4 away = proj * transform::look_at(vec3(-5, -5, -5), vec3(-10, -10, -10), vec3(0, 0, 1));
+    culler.cull(away, 800, 800, visible);
+    if (!visible.empty()) {
+        std::cerr << "frustum culling: " << visible.size() << " visible boxes (expected 0)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // with frustum culling disabled, everything is visible
+    culler.set_frustum_culling(false);
+    culler.cull(away, 800, 800, visible);
+    if (visible.size() != boxes.size()) {
+        std::cerr << "no culling: " << visible.size() << " visible boxes (expected " << boxes.size() << ")"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // seen from far away in a tiny viewport, each box covers less than a pixel
+    culler.set_frustum_culling(true);
+    culler.set_min_screen_size(1.0f);
+    const mat4 far_view = proj * transform::look_at(vec3(10, 10, 80), vec3(10, 10, 10), vec3(0, 1, 0));
+    culler.cull(far_view, 16, 16, visible);
+    if (!visible.empty()) {
+        std::cerr << "small-feature culling: " << visible.size() << " visible boxes (expected 0)" << std::endl;
+        return EXIT_FAILURE;
+    }
+    culler.cull(far_view, 1600, 1600, visible);
+    if (visible != brute_force(boxes, far_view)) {
+        std::cerr << "small-feature culling: " << visible.size() << " visible boxes in a large viewport" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
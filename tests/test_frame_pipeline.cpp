@@ -0,0 +1,166 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/util/blocking_queue.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
+
+#ifdef HAS_FFMPEG
+#include <easy3d/video/video_recorder.h>
+#endif
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+namespace {
+
+    struct Frame {
+        std::size_t index;
+        std::vector<unsigned char> data;
+    };
+
+    // synthetic RGBA frames, each filled with a gray level derived from its index
+    Frame make_frame(std::size_t index, int width, int height) {
+        Frame frame;
+        frame.index = index;
+        frame.data.assign(static_cast<std::size_t>(width) * height * 4, static_cast<unsigned char>(index % 256));
+        return frame;
+    }
+
+}
+
+
+bool test_blocking_queue() {
+    const int width = 64, height = 48;
+    const std::size_t num_frames = 200;
+    const std::size_t capacity = 4;
+
+    BlockingQueue<Frame> queue(capacity);
+    std::size_t max_size = 0, num_consumed = 0;
+    bool in_order = true;
+    std::thread consumer([&]() {
+        Frame frame;
+        while (queue.pop(frame)) {
+            max_size = std::max(max_size, queue.size());
+            in_order = in_order && (frame.index == num_consumed) && (frame.data[0] == num_consumed % 256);
+            ++num_consumed;
+        }
+    });
+
+    for (std::size_t i = 0; i < num_frames; ++i)
+        queue.push(make_frame(i, width, height));
+    queue.close();
+    consumer.join();
+
+    if (num_consumed != num_frames || !in_order) {
+        LOG(ERROR) << "frames lost or out of order (" << num_consumed << " of " << num_frames << " received)";
+        return false;
+    }
+    if (max_size > capacity) {
+        LOG(ERROR) << "queue size (" << max_size << ") exceeded its capacity (" << capacity << ")";
+        return false;
+    }
+    if (queue.push(make_frame(0, width, height)) || queue.try_push(make_frame(0, width, height))) {
+        LOG(ERROR) << "a closed queue should reject new frames";
+        return false;
+    }
+
+    BlockingQueue<int> bounded(2);
+    if (!bounded.try_push(1) || !bounded.try_push(2) || bounded.try_push(3)) {
+        LOG(ERROR) << "try_push() should fail only when the queue is full";
+        return false;
+    }
+    int value = 0;
+    if (!bounded.try_pop(value) || value != 1 || bounded.size() != 1) {
+        LOG(ERROR) << "try_pop() returned a wrong item";
+        return false;
+    }
+
+    return true;
+}
+
+
+#ifdef HAS_FFMPEG
+bool test_video_recorder() {
+    // RGBA to YUV: a frame whose upper half is white and lower half is black
+    const int width = 64, height = 48;
+    std::vector<unsigned char> rgba(width * height * 4, 255);
+    std::fill(rgba.begin() + width * height * 2, rgba.end(), 0);
+    std::vector<unsigned char> yuv(width * height * 3 / 2);
+    VideoRecorder::rgba_to_yuv420p(rgba.data(), width, height, false, yuv.data());
+    const unsigned char* u = yuv.data() + width * height;
+    const unsigned char* v = u + width * height / 4;
+    if (yuv[0] != 235 || yuv[width * height - 1] != 16 || u[0] != 128 || v[0] != 128) {
+        LOG(ERROR) << "wrong RGBA to YUV conversion";
+        return false;
+    }
+    VideoRecorder::rgba_to_yuv420p(rgba.data(), width, height, true, yuv.data());
+    if (yuv[0] != 16 || yuv[width * height - 1] != 235) {
+        LOG(ERROR) << "wrong RGBA to YUV conversion (with vertical flip)";
+        return false;
+    }
+
+    // encoding synthetic frames
+    const std::string file_name = file_system::executable_directory() + "/test_frame_pipeline.mp4";
+    const std::size_t num_frames = 60;
+    VideoRecorder recorder(2, 4);
+    if (!recorder.start(file_name, 30, 8 * 1024 * 1024))
+        return false;
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        auto frame = make_frame(i * 4, width, height);
+        if (!recorder.add_frame(std::move(frame.data), width, height, true)) {
+            recorder.end();
+            return false;
+        }
+    }
+    const bool success = recorder.end();
+    const bool exists = file_system::is_file(file_name);
+    file_system::delete_file(file_name);
+    if (!success || !exists) {
+        LOG(ERROR) << "failed recording the synthetic frames";
+        return false;
+    }
+    return true;
+}
+#endif
+
+
+int test_frame_pipeline() {
+    if (!test_blocking_queue())
+        return EXIT_FAILURE;
+
+#ifdef HAS_FFMPEG
+    if (!test_video_recorder())
+        return EXIT_FAILURE;
+#endif
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/image_io.h>
+#include <easy3d/fileio/image_io_png.h>
+#include <easy3d/fileio/async_image_writer.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+
+bool test_png_round_trip(const std::string& dir) {
+    const int width = 301, height = 157, channels = 4;
+    std::vector<unsigned char> data(width * height * channels);
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            unsigned char* p = data.data() + (j * width + i) * channels;
+            p[0] = static_cast<unsigned char>(i);
+            p[1] = static_cast<unsigned char>(j * 3);
+            p[2] = static_cast<unsigned char>((i * j) % 251);
+            p[3] = static_cast<unsigned char>(255 - i % 7);
+        }
+    }
+
+    const std::string file_name = dir + "/test_image_io.png";
+    std::vector<unsigned char> loaded;
+    int w = 0, h = 0, c = 0;
+    // saved with a vertical flip and loaded with a vertical flip: must give the original data
+    bool success = ImageIO::save(file_name, data, width, height, channels, true) &&
+                   ImageIO::load(file_name, loaded, w, h, c, 0, true);
+    file_system::delete_file(file_name);
+    if (!success || w != width || h != height || c != channels || loaded != data) {
+        LOG(ERROR) << "PNG image not identical after saving and loading";
+        return false;
+    }
+    return true;
+}
+
+
+// an image larger than one strip, written in several bands of rows (as the tiled snapshots do)
+bool test_striped_png_writer(const std::string& dir) {
+    const int width = 1000, height = 700, channels = 4;    // about 65 rows per strip, i.e., 11 strips
+    const std::size_t row_bytes = static_cast<std::size_t>(width) * channels;
+    std::vector<unsigned char> data(row_bytes * height);
+    unsigned int state = 12345;
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            unsigned char* p = data.data() + j * row_bytes + i * channels;
+            state = state * 1664525u + 1013904223u;
+            // smooth gradients with some noise, so all filter types and long and short matches occur
+            p[0] = static_cast<unsigned char>(i / 4 + j);
+            p[1] = static_cast<unsigned char>((state >> 24) & 0x0f);
+            p[2] = static_cast<unsigned char>((i * j) % 253);
+            p[3] = static_cast<unsigned char>((j / 50) % 2 ? 255 : state >> 24);
+        }
+    }
+
+    // bands of uneven heights: within one strip, across strip boundaries, a single row, and the rest
+    const int bands[] = {40, 97, 1, 300, height - 40 - 97 - 1 - 300};
+    const std::string file_name = dir + "/test_image_io_striped.png";
+    io::StripedPngWriter writer;
+    bool success = writer.open(file_name, width, height, channels);
+    int first = 0;
+    for (int num : bands) {
+        success = success && writer.write_rows(data.data() + first * row_bytes, num);
+        first += num;
+    }
+    success = writer.close() && success;
+
+    std::vector<unsigned char> loaded;
+    int w = 0, h = 0, c = 0;
+    success = success && ImageIO::load(file_name, loaded, w, h, c, 0, false);
+    file_system::delete_file(file_name);
+    if (!success || w != width || h != height || c != channels || loaded != data) {
+        LOG(ERROR) << "PNG image written in " << sizeof(bands) / sizeof(bands[0])
+                   << " bands of rows not identical after loading";
+        return false;
+    }
+    return true;
+}
+
+
+bool test_depth_round_trip(const std::string& dir) {
+    const int width = 120, height = 80;
+    std::vector<float> depths(width * height);
+    for (int i = 0; i < width * height; ++i)
+        depths[i] = static_cast<float>(i) / static_cast<float>(width * height);
+
+    // pfm: exact; png: 16-bit
+    const std::string extensions[] = {"pfm", "png"};
+    const float tolerances[] = {0.0f, 0.5f / 65535.0f + 1e-7f};
+    for (int k = 0; k < 2; ++k) {
+        const std::string file_name = dir + "/test_image_io_depth." + extensions[k];
+        std::vector<float> loaded;
+        int w = 0, h = 0;
+        bool success = ImageIO::save_depth(file_name, depths, width, height, true) &&
+                       ImageIO::load_depth(file_name, loaded, w, h, true);
+        file_system::delete_file(file_name);
+        if (!success || w != width || h != height || loaded.size() != depths.size()) {
+            LOG(ERROR) << "failed saving/loading depth map (" << extensions[k] << ")";
+            return false;
+        }
+        for (std::size_t i = 0; i < depths.size(); ++i) {
+            if (std::abs(loaded[i] - depths[i]) > tolerances[k]) {
+                LOG(ERROR) << "depth values changed after saving/loading (" << extensions[k] << "): " << depths[i]
+                           << " vs. " << loaded[i];
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+bool test_async_image_writer(const std::string& dir) {
+    const int width = 64, height = 48, num_frames = 20;
+    std::vector<std::string> files;
+    {
+        io::AsyncImageWriter writer(2, 2);
+        for (int i = 0; i < num_frames; ++i) {
+            const std::string file_name = dir + "/test_image_io_" + std::to_string(i) + (i % 2 ? ".pfm" : ".png");
+            writer.save_depth(file_name, std::vector<float>(width * height, static_cast<float>(i) / num_frames),
+                              width, height);
+            files.push_back(file_name);
+        }
+        writer.wait();
+        if (writer.num_written() != num_frames || writer.num_failed() != 0) {
+            LOG(ERROR) << "asynchronous writer wrote " << writer.num_written() << " of " << num_frames << " files";
+            return false;
+        }
+    }
+
+    bool success = true;
+    for (const auto& file_name : files) {
+        success = success && file_system::is_file(file_name);
+        file_system::delete_file(file_name);
+    }
+    if (!success)
+        LOG(ERROR) << "files missing after asynchronous writing";
+    return success;
+}
+
+
+int test_image_io() {
+    const std::string dir = file_system::executable_directory();
+    if (!test_png_round_trip(dir) || !test_striped_png_writer(dir) || !test_depth_round_trip(dir) ||
+        !test_async_image_writer(dir))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/matrix.h>
+#include <easy3d/core/matrix_algo.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+
+namespace {
+
+    // the straightforward product (i.e., the implementation before the blocked kernels), used as the reference.
+    // C must have the size of the result and must not be A or B.
+    void naive_mult(const MATRIX &A, const MATRIX &B, MATRIX &C) {
+        for (int i = 0; i < A.rows(); ++i) {
+            for (int j = 0; j < B.cols(); ++j) {
+                double sum = 0;
+                for (int k = 0; k < A.cols(); ++k)
+                    sum += A[i][k] * B[k][j];
+                C[i][j] = sum;
+            }
+        }
+    }
+
+    MATRIX naive_mult(const MATRIX &A, const MATRIX &B) {
+        MATRIX C(A.rows(), B.cols());
+        naive_mult(A, B, C);
+        return C;
+    }
+
+
+    double max_difference(const MATRIX &A, const MATRIX &B) {
+        if (A.rows() != B.rows() || A.cols() != B.cols())
+            return 1e30;
+        double diff = 0;
+        for (int i = 0; i < A.rows(); ++i) {
+            for (int j = 0; j < A.cols(); ++j)
+                diff = std::max(diff, std::abs(A[i][j] - B[i][j]));
+        }
+        return diff;
+    }
+
+
+    bool test_products() {
+        // the sizes are chosen to exercise the partial blocks
+        const int sizes[][3] = {{1, 1, 1}, {3, 5, 2}, {7, 9, 13}, {64, 64, 64}, {130, 300, 257}, {5, 520, 3}};
+        for (const auto &s : sizes) {
+            const MATRIX A = random<double>(s[0], s[2]);
+            const MATRIX B = random<double>(s[2], s[1]);
+            const MATRIX ref = naive_mult(A, B);
+            const double eps = 1e-12 * s[2];
+
+            MATRIX C(1, 1);
+            mult(A, B, C);
+            if (max_difference(ref, A * B) > eps || max_difference(ref, mult(A, B)) > eps ||
+                max_difference(ref, C) > eps) {
+                LOG(ERROR) << "matrix-matrix product (" << s[0] << " x " << s[2] << " x " << s[1] << ") is incorrect";
+                return false;
+            }
+
+            if (max_difference(ref, transpose_mult(transpose(A), B)) > eps ||
+                max_difference(ref, mult_transpose(A, transpose(B))) > eps) {
+                LOG(ERROR) << "transpose products (" << s[0] << " x " << s[2] << " x " << s[1] << ") are incorrect";
+                return false;
+            }
+
+            // matrix-vector products
+            const std::vector<double> b = B.get_column(0);
+            const std::vector<double> c = A * b;
+            const std::vector<double> d = transpose_mult(transpose(A), b);
+            for (int i = 0; i < A.rows(); ++i) {
+                if (std::abs(c[i] - ref[i][0]) > eps || std::abs(d[i] - ref[i][0]) > eps) {
+                    LOG(ERROR) << "matrix-vector product (" << s[0] << " x " << s[2] << ") is incorrect";
+                    return false;
+                }
+            }
+        }
+
+        // the result can be one of the operands
+        MATRIX A = random<double>(6, 6);
+        const MATRIX B = random<double>(6, 6);
+        const MATRIX ref = naive_mult(A, B);
+        mult(A, B, A);
+        if (max_difference(ref, A) > 1e-12) {
+            LOG(ERROR) << "in-place matrix-matrix product is incorrect";
+            return false;
+        }
+
+        return true;
+    }
+
+
+    bool test_decompositions() {
+        const int n = 12;
+        MATRIX A = random<double>(n, n);
+        for (int i = 0; i < n; ++i)
+            A[i][i] += n;   // well conditioned
+
+        // inverse
+        const MATRIX invA = inverse(A);
+        if (max_difference(A * invA, identity<double>(n)) > 1e-10) {
+            LOG(ERROR) << "inverse is incorrect";
+            return false;
+        }
+        MATRIX B = A;
+        inverse(B, B);
+        if (max_difference(B, invA) > 1e-12) {
+            LOG(ERROR) << "in-place inverse is incorrect";
+            return false;
+        }
+
+        // SVD of a non-square matrix
+        const MATRIX M = random<double>(9, 5);
+        MATRIX U(9, 9), S(9, 5), V(5, 5);
+        svd_decompose(M, U, S, V);
+        if (max_difference(U * S * transpose(V), M) > 1e-10) {
+            LOG(ERROR) << "SVD is incorrect";
+            return false;
+        }
+
+        // least squares: an exactly consistent over-determined system
+        const MATRIX L = random<double>(20, 4);
+        const std::vector<double> x0 = {1.0, -2.0, 0.5, 3.0};
+        std::vector<double> x;
+        if (!solve_least_squares(L, L * x0, x) || x.size() != x0.size()) {
+            LOG(ERROR) << "failed solving the least squares problem";
+            return false;
+        }
+        for (std::size_t i = 0; i < x0.size(); ++i) {
+            if (std::abs(x[i] - x0[i]) > 1e-8) {
+                LOG(ERROR) << "least squares solution is incorrect";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+}
+
+
+int test_matrix() {
+    std::cout << "test matrix products..." << std::endl;
+    if (!test_products())
+        return EXIT_FAILURE;
+
+    std::cout << "test matrix decompositions..." << std::endl;
+    if (!test_decompositions())
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+
+// compares the blocked product with the straightforward one
+int benchmark_matrix_products() {
+    const int sizes[] = {4, 16, 64, 256};
+    for (int n : sizes) {
+        const MATRIX A = random<double>(n, n);
+        const MATRIX B = random<double>(n, n);
+        const int repeat = std::max(1, (1 << 24) / (n * n * n));
+
+        // both products write into a preallocated matrix, so only the arithmetic is timed
+        MATRIX C(n, n);
+        StopWatch w;
+        double checksum = 0;
+        for (int r = 0; r < repeat; ++r) {
+            naive_mult(A, B, C);
+            checksum += C[0][0];
+        }
+        const double t_naive = w.elapsed_seconds(6);
+
+        w.restart();
+        for (int r = 0; r < repeat; ++r) {
+            mult(A, B, C);
+            checksum -= C[0][0];
+        }
+        const double t_blocked = w.elapsed_seconds(6);
+
+        LOG(INFO) << n << " x " << n << " matrix product (" << repeat << " times): straightforward " << t_naive
+                  << " s, blocked " << t_blocked << " s (checksum " << std::abs(checksum) << ")";
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/graph.h>
+#include <easy3d/renderer/renderer.h>
+#include <easy3d/util/logging.h>
+
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+namespace {
+
+    // a point cloud whose points and colors all encode the same "generation", so a torn state can be detected
+    PointCloud *make_cloud(int generation, int num_points) {
+        auto cloud = new PointCloud;
+        auto colors = cloud->add_vertex_property<vec3>("v:color");
+        for (int i = 0; i < num_points; ++i) {
+            auto v = cloud->add_vertex(vec3(static_cast<float>(generation)));
+            colors[v] = vec3(static_cast<float>(generation));
+        }
+        return cloud;
+    }
+
+    // returns the generation of the point cloud, or -1 if it is inconsistent
+    int generation_of(PointCloud *cloud) {
+        auto colors = cloud->get_vertex_property<vec3>("v:color");
+        if (!colors || cloud->n_vertices() == 0)
+            return -1;
+        const float g = cloud->points()[0].x;
+        if (cloud->n_vertices() != static_cast<unsigned int>(g) + 1)
+            return -1;
+        for (auto v : cloud->vertices()) {
+            if (cloud->position(v) != vec3(g) || colors[v] != vec3(g))
+                return -1;
+        }
+        return static_cast<int>(g);
+    }
+
+}
+
+
+int test_model_snapshot() {
+    // swapping models in constant time
+    {
+        SurfaceMesh a, b;
+        auto v0 = a.add_vertex(vec3(0, 0, 0));
+        auto v1 = a.add_vertex(vec3(1, 0, 0));
+        auto v2 = a.add_vertex(vec3(0, 1, 0));
+        a.add_triangle(v0, v1, v2);
+        a.add_vertex_property<int>("v:label", 7);
+        a.swap(b);
+        if (a.n_vertices() != 0 || b.n_vertices() != 3 || b.n_faces() != 1 || !b.get_vertex_property<int>("v:label")
+            || b.position(v1) != vec3(1, 0, 0)) {
+            LOG(ERROR) << "SurfaceMesh::swap() failed";
+            return EXIT_FAILURE;
+        }
+        // the swapped mesh is still fully functional
+        auto v3 = b.add_vertex(vec3(1, 1, 0));
+        b.add_triangle(v2, v1, v3);
+        if (b.n_faces() != 2 || a.n_faces() != 0) {
+            LOG(ERROR) << "SurfaceMesh::swap() failed";
+            return EXIT_FAILURE;
+        }
+
+        Graph g, h;
+        auto g0 = g.add_vertex(vec3(0, 0, 0));
+        auto g1 = g.add_vertex(vec3(1, 0, 0));
+        g.add_edge(g0, g1);
+        g.swap(h);
+        if (g.n_vertices() != 0 || h.n_vertices() != 2 || h.n_edges() != 1) {
+            LOG(ERROR) << "Graph::swap() failed";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // a worker thread publishes snapshots while the "rendering" thread applies them
+    auto cloud = make_cloud(0, 1);
+    auto renderer = new Renderer(cloud, false);
+
+    const int num_generations = 300;
+    std::atomic<bool> done(false);
+    std::thread worker([&]() {
+        for (int g = 1; g <= num_generations; ++g)
+            cloud->renderer()->publish(make_cloud(g, g + 1));
+        done = true;
+    });
+
+    int num_applied = 0, last = 0;
+    bool consistent = true;
+    while (true) {
+        const bool finished = done;     // read before applying, so the last snapshot is not missed
+        if (renderer->apply_published()) {
+            ++num_applied;
+            const int g = generation_of(cloud);
+            if (g < 0 || g <= last) {   // torn, or an older state
+                consistent = false;
+                break;
+            }
+            last = g;
+        }
+        if (finished && !renderer->has_published())
+            break;
+    }
+    worker.join();
+
+    LOG(INFO) << num_applied << " of " << num_generations << " published snapshots applied";
+
+    const bool success = consistent && last == num_generations && generation_of(cloud) == num_generations;
+    delete renderer;
+    delete cloud;
+
+    if (!success) {
+        LOG(ERROR) << "published snapshots are not correctly applied";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/point_projection.h>
+#include <easy3d/core/random.h>
+#include <easy3d/renderer/transform.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+
+namespace {
+
+    // A scanned-like point cloud: points along the rows of a wavy surface, so consecutive points are spatially
+    // coherent (as the coarse spatial index expects). A few points are placed behind the viewer.
+    std::vector<vec3> generate_points(std::size_t n) {
+        std::vector<vec3> points(n);
+        const std::size_t row = 2000;
+        for (std::size_t i = 0; i < n; ++i) {
+            const float u = static_cast<float>(i % row) / row * 20.0f - 10.0f;
+            const float v = static_cast<float>(i / row) / (n / row + 1) * 20.0f - 10.0f;
+            points[i] = vec3(u, v, std::sin(u) * std::cos(v)) + vec3(random_float(), random_float(), random_float()) * 0.01f;
+        }
+        for (std::size_t i = 0; i < n; i += 997)
+            points[i].z = 40.0f + random_float() * 10.0f;   // behind the camera
+        return points;
+    }
+
+
+    // the normalized screen coordinates of a point (as computed by the scalar kernel)
+    vec2 project(const mat4 &m, const vec3 &p) {
+        float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+        float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+        const float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+        x /= w;
+        y /= w;
+        return vec2(0.5f * x + 0.5f, 0.5f * y + 0.5f);
+    }
+
+
+    // compares two selections. Differences are allowed only for points projected on the border of the rectangle
+    // (where the rounding of a fused multiply-add may decide differently).
+    bool same_selection(const std::vector<bool> &a, const std::vector<bool> &b, const std::vector<vec3> &points,
+                        const mat4 &m, const Box2 &rect, const std::string &what) {
+        std::size_t num_differences = 0;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (a[i] == b[i])
+                continue;
+            const vec2 q = project(m, points[i]);
+            const float d = std::min(std::min(std::abs(q.x - rect.min_point().x), std::abs(q.x - rect.max_point().x)),
+                                     std::min(std::abs(q.y - rect.min_point().y), std::abs(q.y - rect.max_point().y)));
+            if (d > 1e-5f) {
+                LOG(ERROR) << what << ": point " << i << " selected differently (projected to " << q << ")";
+                return false;
+            }
+            ++num_differences;
+        }
+        if (num_differences > 0)
+            LOG(WARNING) << what << ": " << num_differences << " points on the border selected differently";
+        return true;
+    }
+
+}
+
+
+int test_point_projection() {
+    const std::size_t n = 1000003; // not a multiple of the block size nor of 4
+    const std::vector<vec3> points = generate_points(n);
+
+    const mat4 proj = transform::perspective(static_cast<float>(M_PI / 4.0), 4.0f / 3.0f, 0.1f, 100.0f);
+    const mat4 view = transform::look_at(vec3(0.0f, -5.0f, 25.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+    const mat4 m = proj * view;
+
+    point_projection::BlockIndex index;
+    index.build(points.data(), n);
+
+    // ---- rectangle
+
+    Box2 rect;
+    rect.grow(vec2(0.3f, 0.25f));
+    rect.grow(vec2(0.62f, 0.7f));
+
+    StopWatch w;
+    std::vector<bool> reference(n, false);
+    const std::size_t num_reference = point_projection::select_in_rect(points.data(), n, m, rect, true, reference,
+                                                                       nullptr, false);
+    const double t_scalar = w.elapsed_seconds(6);
+    if (num_reference == 0 || num_reference == n) {
+        LOG(ERROR) << "the rectangle should select some of the points (selected " << num_reference << ")";
+        return EXIT_FAILURE;
+    }
+
+    w.restart();
+    std::vector<bool> simd(n, false);
+    point_projection::select_in_rect(points.data(), n, m, rect, true, simd, nullptr, true);
+    const double t_simd = w.elapsed_seconds(6);
+
+    w.restart();
+    std::vector<bool> indexed(n, false);
+    point_projection::select_in_rect(points.data(), n, m, rect, true, indexed, &index, true);
+    const double t_indexed = w.elapsed_seconds(6);
+
+    if (!same_selection(reference, simd, points, m, rect, "rectangle (vectorized)") ||
+        !same_selection(reference, indexed, points, m, rect, "rectangle (vectorized, indexed)"))
+        return EXIT_FAILURE;
+
+    LOG(INFO) << "rectangle selection of " << n << " points (" << num_reference << " selected): scalar " << t_scalar
+              << " s, vectorized " << t_simd << " s, vectorized + index " << t_indexed << " s";
+
+    // deselection keeps the points outside the rectangle untouched
+    std::vector<bool> all(n, true);
+    const std::size_t num_remaining = point_projection::select_in_rect(points.data(), n, m, rect, false, all, &index);
+    if (num_remaining + num_reference != n) {
+        LOG(ERROR) << "deselection: " << num_remaining << " points remain selected, expected " << n - num_reference;
+        return EXIT_FAILURE;
+    }
+
+    // ---- polygon (a concave lasso)
+
+    const std::vector<vec2> lasso = {
+            vec2(0.30f, 0.25f), vec2(0.65f, 0.30f), vec2(0.45f, 0.45f), vec2(0.62f, 0.70f), vec2(0.32f, 0.60f)
+    };
+    std::vector<bool> plg_reference(n, false), plg_simd(n, false), plg_indexed(n, false);
+    const std::size_t num_in_polygon = point_projection::select_in_polygon(points.data(), n, m, lasso, true,
+                                                                           plg_reference, nullptr, false);
+    point_projection::select_in_polygon(points.data(), n, m, lasso, true, plg_simd, nullptr, true);
+    point_projection::select_in_polygon(points.data(), n, m, lasso, true, plg_indexed, &index, true);
+    std::size_t num_differences = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (plg_reference[i] != plg_simd[i] || plg_reference[i] != plg_indexed[i])
+            ++num_differences;
+    }
+    if (num_in_polygon == 0 || num_in_polygon >= num_reference || num_differences > n / 100000) {
+        LOG(ERROR) << "polygon selection: " << num_in_polygon << " selected, " << num_differences << " differences";
+        return EXIT_FAILURE;
+    }
+
+    // ---- picking the point nearest to the viewer around a screen location
+
+    const vec2 scale(799.0f, 599.0f);
+    const vec3 viewer(0.0f, -5.0f, 25.0f);
+    for (int k = 0; k < 20; ++k) {
+        const vec2 center(0.3f + 0.02f * k, 0.3f + 0.015f * k);
+        const int a = point_projection::pick_nearest(points.data(), n, m, center, scale, 5.0f, viewer, nullptr, false);
+        const int b = point_projection::pick_nearest(points.data(), n, m, center, scale, 5.0f, viewer, nullptr, true);
+        const int c = point_projection::pick_nearest(points.data(), n, m, center, scale, 5.0f, viewer, &index, true);
+        if (a < 0 || a != b || a != c) {
+            LOG(ERROR) << "picking at " << center << ": " << a << " (scalar), " << b << " (vectorized), " << c
+                       << " (indexed)";
+            return EXIT_FAILURE;
+        }
+        const vec2 q = project(m, points[a]);
+        if (distance(vec2(q.x * scale.x, q.y * scale.y), vec2(center.x * scale.x, center.y * scale.y)) >= 5.0f) {
+            LOG(ERROR) << "the picked point is too far from the screen location";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/quantization.h>
+#include <easy3d/core/random.h>
+#include <easy3d/util/logging.h>
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+
+bool test_quantized_positions() {
+    const std::size_t n = 1001;    // odd, so both the vectorized and the scalar code are tested
+    std::vector<vec3> points(n);
+    Box3 box;
+    for (auto &p : points) {
+        p = vec3(random_float() * 200.0f - 100.0f, random_float() * 3.0f, random_float() * 0.01f + 5.0f);
+        box.grow(p);
+    }
+
+    std::vector<unsigned short> quantized(n * 4);
+    quantization::quantize_positions(points.data(), n, box, quantized.data());
+
+    const vec3 tolerance = (box.max_point() - box.min_point()) * (0.5f / 65535.0f) + vec3(1e-5f);
+    for (std::size_t i = 0; i < n; ++i) {
+        const vec3 p = quantization::dequantize_position(quantized.data() + 4 * i, box);
+        for (int a = 0; a < 3; ++a) {
+            if (std::abs(p[a] - points[i][a]) > tolerance[a] || quantized[4 * i + 3] != 0) {
+                LOG(ERROR) << "position " << i << " not correctly quantized: " << points[i] << " vs. " << p;
+                return false;
+            }
+        }
+    }
+
+    // the corners of the box map to the extreme values
+    const vec3 corners[2] = {box.min_point(), box.max_point()};
+    unsigned short values[8];
+    quantization::quantize_positions(corners, 2, box, values);
+    if (values[0] != 0 || values[1] != 0 || values[2] != 0 || values[4] != 65535 || values[5] != 65535 || values[6] != 65535) {
+        LOG(ERROR) << "box corners not correctly quantized";
+        return false;
+    }
+    return true;
+}
+
+
+bool test_octahedral_normals() {
+    std::vector<vec3> normals = {vec3(0, 0, 1), vec3(0, 0, -1), vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0),
+                                 vec3(0, -1, 0)};
+    for (int i = 0; i < 1000; ++i)
+        normals.push_back(normalize(vec3(random_float() - 0.5f, random_float() - 0.5f, random_float() - 0.5f)));
+
+    std::vector<short> encoded(normals.size() * 2);
+    quantization::encode_normals(normals.data(), normals.size(), encoded.data());
+    for (std::size_t i = 0; i < normals.size(); ++i) {
+        const vec3 n = quantization::decode_normal(encoded.data() + 2 * i);
+        if (dot(n, normals[i]) < 0.99999f) {
+            LOG(ERROR) << "normal " << i << " not correctly encoded: " << normals[i] << " vs. " << n;
+            return false;
+        }
+    }
+
+    // a single normal is encoded by the scalar code, which must give the same values as the vectorized code
+    normals.push_back(vec3(0, 0, 0));
+    normals.push_back(vec3(0, 0, 0));
+    encoded.resize(normals.size() * 2);
+    quantization::encode_normals(normals.data(), normals.size(), encoded.data());
+    for (std::size_t i = 0; i < normals.size(); ++i) {
+        short single[2];
+        quantization::encode_normals(&normals[i], 1, single);
+        if (single[0] != encoded[2 * i] || single[1] != encoded[2 * i + 1]) {
+            LOG(ERROR) << "normal " << i << " encoded differently as a single normal: (" << single[0] << ", "
+                       << single[1] << ") vs. (" << encoded[2 * i] << ", " << encoded[2 * i + 1] << ")";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool test_packed_colors() {
+    const std::vector<vec3> colors = {vec3(0, 0.5f, 1), vec3(-0.2f, 1.5f, 0.2f), vec3(1.0f / 255, 254.0f / 255, 0.7f)};
+    std::vector<unsigned char> packed(colors.size() * 4);
+    quantization::pack_colors(colors.data(), colors.size(), packed.data());
+    const unsigned char expected[12] = {0, 128, 255, 255, 0, 255, 51, 255, 1, 254, 178, 255};
+    for (int i = 0; i < 12; ++i) {
+        if (packed[i] != expected[i]) {
+            LOG(ERROR) << "color component " << i << " not correctly packed: " << int(packed[i]) << " vs. "
+                       << int(expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool test_half_floats() {
+    // all the finite half values survive a round trip
+    for (unsigned int h = 0; h < 65536; ++h) {
+        if ((h & 0x7c00u) == 0x7c00u && (h & 0x3ffu))
+            continue;   // NaN
+        const float f = quantization::half_to_float(static_cast<unsigned short>(h));
+        if (quantization::float_to_half(f) != h) {
+            LOG(ERROR) << "half value " << h << " changed after conversion to float and back";
+            return false;
+        }
+    }
+
+    struct Case { float value; unsigned short half; };
+    const Case cases[] = {{1.0f, 0x3c00}, {-2.0f, 0xc000}, {0.1f, 0x2e66}, {65504.0f, 0x7bff}, {65520.0f, 0x7c00},
+                          {std::ldexp(1.0f, -24), 0x0001}, {std::ldexp(1.0f, -25), 0x0000}, {1.0f / 3.0f, 0x3555}};
+    for (const auto &c : cases) {
+        if (quantization::float_to_half(c.value) != c.half) {
+            LOG(ERROR) << "wrong conversion of " << c.value << " to half: " << quantization::float_to_half(c.value);
+            return false;
+        }
+    }
+
+    const std::vector<vec2> texcoords = {vec2(0.25f, 0.75f), vec2(1.0f, 0.0f)};
+    unsigned short packed[4];
+    quantization::pack_texcoords(texcoords.data(), texcoords.size(), packed);
+    if (quantization::half_to_float(packed[0]) != 0.25f || quantization::half_to_float(packed[1]) != 0.75f ||
+        packed[2] != 0x3c00 || packed[3] != 0) {
+        LOG(ERROR) << "texture coordinates not correctly converted";
+        return false;
+    }
+    return true;
+}
+
+
+int test_quantization() {
+    if (!test_quantized_positions() || !test_octahedral_normals() || !test_packed_colors() || !test_half_floats())
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+
+// the vectorized kernels used by RANSAC to score the candidates
+#include <FlatNormalThreshPointCompatibilityFunc.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+
+namespace {
+
+    float random_float(float lo, float hi) {
+        return lo + (hi - lo) * static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+    }
+
+    Vec3f random_vector(float lo, float hi) {
+        return Vec3f(random_float(lo, hi), random_float(lo, hi), random_float(lo, hi));
+    }
+
+    Vec3f random_direction() {
+        Vec3f d;
+        do {
+            d = random_vector(-1.0f, 1.0f);
+        } while (d.length() < 0.1f);
+        d.normalize();
+        return d;
+    }
+
+    // a point near the point p on the shape whose normal there is n: the position is perturbed by up to twice the
+    // distance threshold and the normal by a random amount, so both compatible and incompatible points are generated.
+    Point perturbed_point(const Vec3f &p, const Vec3f &n, float dist_thresh) {
+        Vec3f normal = n + random_vector(-0.5f, 0.5f);
+        if (rand() % 2)
+            normal = -normal;
+        normal.normalize();
+        return Point(p + random_direction() * random_float(0.0f, 2.0f * dist_thresh), normal);
+    }
+
+    // Compares the block kernel with the per-point path for a shape. Points whose distance or normal deviation is
+    // within rounding of the thresholds are skipped (the compiler may contract the arithmetic differently).
+    template<class ShapeT>
+    bool compare_kernel(const char *name, const ShapeT &shape, const std::vector<Point> &points,
+                        const FlatNormalThreshPointCompatibilityFunc &func) {
+        const float eps = 1e-5f;
+        for (std::size_t begin = 0; begin < points.size(); begin += SoAPointBlock::Capacity) {
+            SoAPointBlock block;
+            for (std::size_t i = begin; i < points.size() && !block.Full(); ++i)
+                block.Add(points[i], i);
+            func(shape, &block);
+
+            for (std::size_t j = 0; j < block.size; ++j) {
+                const std::size_t i = block.index[j];
+                Vec3f n;
+                const float distance = shape.DistanceAndNormal(points[i].pos, &n);
+                const float deviation = std::fabs(n.dot(points[i].normal));
+                if (std::fabs(distance - func.DistanceThresh()) < eps ||
+                    std::fabs(deviation - func.NormalThresh()) < eps)
+                    continue;
+                const bool expected = func(shape, points, static_cast<unsigned int>(i));
+                if ((block.compatible[j] != 0) != expected) {
+                    std::cerr << name << ": point " << i << " (distance " << distance << ", normal deviation "
+                              << deviation << ") is " << (expected ? "" : "not ") << "compatible, but the "
+                              << "block kernel says the opposite" << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+}
+
+
+int test_ransac_compatibility() {
+    std::cout << "comparing the block kernels of RANSAC with the per-point path" << std::endl;
+
+    const float dist_thresh = 0.01f;
+    const FlatNormalThreshPointCompatibilityFunc func(dist_thresh, 0.9f);
+    const int num_shapes = 20;
+    const int num_points = 1000;   // not a multiple of the block capacity, so the last block is partially filled
+
+    for (int s = 0; s < num_shapes; ++s) {
+        // planes
+        {
+            const Vec3f pos = random_vector(-1.0f, 1.0f), normal = random_direction();
+            const Plane plane(pos, normal);
+            std::vector<Point> points;
+            for (int i = 0; i < num_points; ++i) {
+                // a random point of the plane
+                Vec3f p = pos + random_vector(-1.0f, 1.0f);
+                p -= normal * plane.SignedDistance(p);
+                points.push_back(perturbed_point(p, normal, dist_thresh));
+            }
+            points.emplace_back(pos, Vec3f(0, 0, 0));   // a point without a normal
+            if (!compare_kernel("plane", plane, points, func))
+                return EXIT_FAILURE;
+        }
+
+        // spheres
+        {
+            const Vec3f center = random_vector(-1.0f, 1.0f);
+            const float radius = random_float(0.1f, 1.0f);
+            const Sphere sphere(center, radius);
+            std::vector<Point> points;
+            for (int i = 0; i < num_points; ++i) {
+                const Vec3f n = random_direction();
+                points.push_back(perturbed_point(center + n * radius, n, dist_thresh));
+            }
+            // degenerate: points at the center of the sphere
+            points.emplace_back(center, random_direction());
+            points.emplace_back(center, Vec3f(0, 0, 0));
+            if (!compare_kernel("sphere", sphere, points, func))
+                return EXIT_FAILURE;
+            // degenerate: a sphere of zero radius, so the points at the center are within the distance threshold
+            if (!compare_kernel("sphere (zero radius)", Sphere(center, 0.0f), points, func))
+                return EXIT_FAILURE;
+        }
+
+        // cylinders
+        {
+            const Vec3f axis_dir = random_direction(), axis_pos = random_vector(-1.0f, 1.0f);
+            const float radius = random_float(0.1f, 1.0f);
+            const Cylinder cylinder(axis_dir, axis_pos, radius);
+            std::vector<Point> points;
+            for (int i = 0; i < num_points; ++i) {
+                // a random direction perpendicular to the axis
+                Vec3f n = random_direction();
+                n -= axis_dir * axis_dir.dot(n);
+                if (n.length() < 1e-3f)
+                    continue;
+                n.normalize();
+                const Vec3f p = axis_pos + axis_dir * random_float(-1.0f, 1.0f) + n * radius;
+                points.push_back(perturbed_point(p, n, dist_thresh));
+            }
+            // degenerate: points on the axis of the cylinder
+            points.emplace_back(axis_pos, random_direction());
+            points.emplace_back(axis_pos + axis_dir * 0.5f, Vec3f(0, 0, 0));
+            if (!compare_kernel("cylinder", cylinder, points, func))
+                return EXIT_FAILURE;
+            if (!compare_kernel("cylinder (zero radius)", Cylinder(axis_dir, axis_pos, 0.0f), points, func))
+                return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
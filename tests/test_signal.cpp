@@ -26,8 +26,13 @@
 
 
 #include <easy3d/core/signal.h>
+#include <easy3d/util/timer_service.h>
+#include <easy3d/util/stop_watch.h>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 
 using namespace easy3d;
@@ -247,6 +252,104 @@ void test_signal_for_connect_signal_to_signal() {
 }
 
 
+// queued connections are delivered by the thread calling TimerService::process_main_thread_tasks() (e.g., the
+// rendering loop), and coalesced connections merge all the emissions before the delivery.
+bool test_signal_for_queued_connections() {
+    Signal<int, const std::string &> signal;
+
+    std::vector<int> queued_values;
+    std::vector<int> coalesced_values;
+    std::string last_message;
+    signal.connect([&](int value, const std::string &) { queued_values.push_back(value); }, QUEUED_CONNECTION);
+    signal.connect([&](int value, const std::string &msg) {
+        coalesced_values.push_back(value);
+        last_message = msg;
+    }, COALESCED_CONNECTION);
+
+    for (int i = 0; i < 100; ++i)
+        signal.send(i, "message " + std::to_string(i)); // the arguments must be copied (the string is a temporary)
+    if (!queued_values.empty() || !coalesced_values.empty()) {
+        std::cerr << "queued connections should not be called before the event loop processes them" << std::endl;
+        return false;
+    }
+
+    TimerService::instance().process_main_thread_tasks();   // a "frame"
+    if (queued_values.size() != 100 || queued_values.front() != 0 || queued_values.back() != 99) {
+        std::cerr << "queued connection: expected 100 ordered calls, got " << queued_values.size() << std::endl;
+        return false;
+    }
+    if (coalesced_values.size() != 1 || coalesced_values[0] != 99 || last_message != "message 99") {
+        std::cerr << "coalesced connection: expected a single call with the latest arguments, got "
+                  << coalesced_values.size() << " calls" << std::endl;
+        return false;
+    }
+
+    // emissions from other threads are delivered to the main thread
+    const std::thread::id main_thread = std::this_thread::get_id();
+    std::atomic<int> num_calls(0);
+    std::atomic<bool> wrong_thread(false);
+    Signal<> progress;
+    progress.connect([&]() {
+        ++num_calls;
+        if (std::this_thread::get_id() != main_thread)
+            wrong_thread = true;
+    }, COALESCED_CONNECTION);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i)
+                progress.send();
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    TimerService::instance().process_main_thread_tasks();
+    if (num_calls != 1 || wrong_thread) {
+        std::cerr << "coalesced connection: expected a single call on the main thread, got " << num_calls
+                  << std::endl;
+        return false;
+    }
+
+    // a disconnected function is never called, even if an emission is pending
+    int id = progress.connect([&]() { num_calls += 1000; }, QUEUED_CONNECTION);
+    progress.send();
+    progress.disconnect(id);
+    num_calls = 0;
+    TimerService::instance().process_main_thread_tasks();
+    if (num_calls != 1) {
+        std::cerr << "a disconnected function should not be called" << std::endl;
+        return false;
+    }
+
+    // connecting and disconnecting while other threads are emitting
+    Signal<int> busy;
+    std::atomic<long long> sum(0);
+    std::atomic<bool> stop(false);
+    busy.connect([&](int v) { sum += v; });
+    std::vector<std::thread> emitters;
+    for (int t = 0; t < 4; ++t) {
+        emitters.emplace_back([&]() {
+            while (!stop)
+                busy.send(1);
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        int cid = busy.connect([&](int v) { sum += v; });
+        busy.disconnect(cid);
+    }
+    stop = true;
+    for (auto &e : emitters)
+        e.join();
+    if (busy.num_connections() != 1) {
+        std::cerr << "expected 1 connection, got " << busy.num_connections() << std::endl;
+        return false;
+    }
+
+    std::cout << "queued and coalesced connections: OK" << std::endl;
+    return true;
+}
+
+
 int test_signal() {
     MyCar car(100);
 
@@ -262,5 +365,54 @@ int test_signal() {
     std::cout << "connect a signal to another signal -----------------------------------------------------\n";
     test_signal_for_connect_signal_to_signal();
 
+    std::cout << "queued and coalesced connections -------------------------------------------------------\n";
+    if (!test_signal_for_queued_connections())
+        return EXIT_FAILURE;
+
     return EXIT_SUCCESS;
 }
+
+
+// the cost of emitting a signal for different connection types
+int benchmark_signal_emission() {
+    const int num = 1000000;
+    long long counter = 0;  // the sum of the emitted values overflows an int
+
+    Signal<int> unconnected;
+    StopWatch w;
+    for (int i = 0; i < num; ++i)
+        unconnected.send(i);
+    const double t_none = w.elapsed_seconds(6);
+
+    Signal<int> direct;
+    direct.connect([&](int v) { counter += v; });
+    w.restart();
+    for (int i = 0; i < num; ++i)
+        direct.send(i);
+    const double t_direct = w.elapsed_seconds(6);
+
+    Signal<int> coalesced;
+    coalesced.connect([&](int v) { counter += v; }, COALESCED_CONNECTION);
+    w.restart();
+    for (int i = 0; i < num; ++i)
+        coalesced.send(i);
+    TimerService::instance().process_main_thread_tasks();
+    const double t_coalesced = w.elapsed_seconds(6);
+
+    const int num_queued = num / 10;
+    Signal<int> queued;
+    queued.connect([&](int v) { counter += v; }, QUEUED_CONNECTION);
+    w.restart();
+    for (int i = 0; i < num_queued; ++i)
+        queued.send(i);
+    TimerService::instance().process_main_thread_tasks();
+    const double t_queued = w.elapsed_seconds(6);
+
+    std::cout << "emission cost (ns per emission): unconnected " << t_none * 1e9 / num
+              << ", direct " << t_direct * 1e9 / num
+              << ", coalesced " << t_coalesced * 1e9 / num
+              << ", queued (incl. delivery) " << t_queued * 1e9 / num_queued
+              << " (" << counter << ")" << std::endl;
+    return EXIT_SUCCESS;
+}
+
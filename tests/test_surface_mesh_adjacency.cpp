@@ -0,0 +1,247 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/core/surface_mesh_adjacency.h>
+#include <easy3d/core/small_vector.h>
+#include <easy3d/algo/surface_mesh_factory.h>
+#include <easy3d/util/stop_watch.h>
+#include <easy3d/util/logging.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+
+using namespace easy3d;
+
+
+namespace {
+
+    bool test_small_vector() {
+        SmallVector<int, 4> a;
+        for (int i = 0; i < 3; ++i)
+            a.push_back(i);
+        if (a.size() != 3 || !a.is_inline()) {
+            std::cerr << "Error: small vector has size " << a.size() << " (expected 3) or is not inline" << std::endl;
+            return false;
+        }
+
+        // spill to the heap
+        for (int i = 3; i < 40; ++i)
+            a.push_back(i);
+        if (a.size() != 40 || a.is_inline()) {
+            std::cerr << "Error: small vector has size " << a.size() << " (expected 40) or did not spill to the heap"
+                      << std::endl;
+            return false;
+        }
+        for (int i = 0; i < 40; ++i) {
+            if (a[i] != i) {
+                std::cerr << "Error: small vector has element " << a[i] << " at " << i << " (expected " << i << ")"
+                          << std::endl;
+                return false;
+            }
+        }
+
+        // copies are independent
+        SmallVector<int, 4> b(a);
+        b[0] = 100;
+        if (a[0] != 0 || b[0] != 100 || b.size() != a.size()) {
+            std::cerr << "Error: copy of small vector is not independent of the original" << std::endl;
+            return false;
+        }
+
+        // clearing keeps the capacity
+        const std::size_t capacity = a.capacity();
+        a.clear();
+        a.push_back(7);
+        if (a.size() != 1 || a.back() != 7 || a.capacity() != capacity) {
+            std::cerr << "Error: small vector has capacity " << a.capacity() << " after clearing (expected "
+                      << capacity << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+
+    // checks the gather functions and the adjacency against the circulators
+    bool check_against_circulators(const SurfaceMesh &mesh, const SurfaceMeshAdjacency &adjacency,
+                                   const std::string &name) {
+        if (adjacency.vertices_size() != mesh.vertices_size()) {
+            std::cerr << "Error: adjacency of " << name << " has " << adjacency.vertices_size() << " vertices (expected "
+                      << mesh.vertices_size() << ")" << std::endl;
+            return false;
+        }
+
+        SmallVector<SurfaceMesh::Vertex, 8> ring;
+        SmallVector<vec3, 8> points;
+        for (unsigned int i = 0; i < mesh.vertices_size(); ++i) {
+            const SurfaceMesh::Vertex v(static_cast<int>(i));
+            if (mesh.is_deleted(v)) {
+                if (adjacency.valence(v) != 0) {
+                    std::cerr << "Error: deleted vertex " << v << " of " << name << " has valence "
+                              << adjacency.valence(v) << " in the adjacency" << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            const std::size_t n = gather_one_ring(&mesh, v, ring);
+            gather_one_ring_positions(&mesh, v, points);
+            if (n != mesh.valence(v) || points.size() != n || adjacency.valence(v) != n) {
+                std::cerr << "Error: vertex " << v << " of " << name << " has valence " << mesh.valence(v)
+                          << ", but gathered " << n << " neighbors and " << points.size()
+                          << " positions, and the adjacency has valence " << adjacency.valence(v) << std::endl;
+                return false;
+            }
+
+            std::size_t k = 0;
+            const auto cached_vertices = adjacency.vertices(v);
+            const auto cached_halfedges = adjacency.halfedges(v);
+            for (auto h : mesh.halfedges(v)) {
+                const auto vv = mesh.target(h);
+                if (ring[k] != vv || points[k] != mesh.position(vv) || cached_vertices[k] != vv ||
+                    cached_halfedges[k] != h) {
+                    std::cerr << "Error: neighbor " << k << " of vertex " << v << " of " << name
+                              << " differs from the circulator (expected " << vv << " via " << h << ")" << std::endl;
+                    return false;
+                }
+                ++k;
+            }
+        }
+        return true;
+    }
+
+
+    bool test_adjacency() {
+        SurfaceMesh sphere = SurfaceMeshFactory::icosphere(3);
+        if (!check_against_circulators(sphere, SurfaceMeshAdjacency(&sphere), "icosphere"))
+            return false;
+
+        // a mesh with boundaries
+        SurfaceMesh plane = SurfaceMeshFactory::plane(10);
+        if (!check_against_circulators(plane, SurfaceMeshAdjacency(&plane), "plane"))
+            return false;
+
+        // deleted vertices have an empty one-ring
+        sphere.delete_vertex(SurfaceMesh::Vertex(0));
+        SurfaceMeshAdjacency adjacency(&sphere);
+        if (!check_against_circulators(sphere, adjacency, "icosphere with a deleted vertex"))
+            return false;
+
+        // rebuild after the connectivity changed
+        sphere.collect_garbage();
+        adjacency.build(&sphere);
+        if (!check_against_circulators(sphere, adjacency, "icosphere after garbage collection"))
+            return false;
+
+        adjacency.clear();
+        if (!adjacency.empty() || adjacency.vertices_size() != 0) {
+            std::cerr << "Error: adjacency is not empty after clearing" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+
+    // sums up the neighbor positions (a few smoothing-like passes) using the circulators and the adjacency cache,
+    // and checks that the results are identical. The timings are reported if 'report' is true.
+    bool compare_traversal(const SurfaceMesh &mesh, bool report) {
+        StopWatch w;
+        const SurfaceMeshAdjacency adjacency(&mesh);
+        const double t_build = w.elapsed_seconds(6);
+
+        const int passes = 5;
+        auto points = mesh.get_vertex_property<vec3>("v:point");
+        std::vector<vec3> sum_circulator(mesh.vertices_size());
+        std::vector<vec3> sum_cache(mesh.vertices_size());
+
+        w.restart();
+        for (int p = 0; p < passes; ++p) {
+            for (auto v : mesh.vertices()) {
+                vec3 s(0, 0, 0);
+                for (auto vv : mesh.vertices(v))
+                    s += points[vv];
+                sum_circulator[v.idx()] = s;
+            }
+        }
+        const double t_circulator = w.elapsed_seconds(6);
+
+        w.restart();
+        for (int p = 0; p < passes; ++p) {
+            for (auto v : mesh.vertices()) {
+                vec3 s(0, 0, 0);
+                for (auto vv : adjacency.vertices(v))
+                    s += points[vv];
+                sum_cache[v.idx()] = s;
+            }
+        }
+        const double t_cache = w.elapsed_seconds(6);
+
+        if (report) {
+            LOG(INFO) << "one-ring traversal of " << mesh.n_vertices() << " vertices (" << passes
+                      << " passes): circulators " << t_circulator << " s, adjacency cache " << t_cache
+                      << " s (build " << t_build << " s)";
+        }
+
+        // both traversals visit the neighbors in the same order, so the sums must be identical
+        for (std::size_t i = 0; i < sum_cache.size(); ++i) {
+            if (sum_cache[i] != sum_circulator[i]) {
+                std::cerr << "Error: the one-ring sum of vertex " << i << " using the adjacency cache ("
+                          << sum_cache[i] << ") differs from the one using the circulators (" << sum_circulator[i]
+                          << ")" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+
+int test_surface_mesh_adjacency() {
+    std::cout << "test small vector..." << std::endl;
+    if (!test_small_vector())
+        return EXIT_FAILURE;
+
+    std::cout << "test one-ring gathering and adjacency cache..." << std::endl;
+    if (!test_adjacency())
+        return EXIT_FAILURE;
+
+    std::cout << "test one-ring traversal using the adjacency cache..." << std::endl;
+    const SurfaceMesh plane = SurfaceMeshFactory::plane(100);
+    if (!compare_traversal(plane, false))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+
+// compares the traversal of the one-rings using the circulators and the adjacency cache on a large mesh
+int benchmark_surface_mesh_adjacency() {
+    const SurfaceMesh mesh = SurfaceMeshFactory::plane(3162);   // about 10M vertices
+    return compare_traversal(mesh, true) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -31,6 +31,13 @@
 #include <iostream>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
 
 std::mutex mutex;
 
@@ -261,6 +268,148 @@ void test_timer_for_lambda_functions(Car *car) {
 }
 
 
+// the number of threads of this process (only available on Linux, otherwise returns -1).
+int num_process_threads() {
+#ifdef __linux__
+    int count = 0;
+    DIR *dir = opendir("/proc/self/task");
+    if (!dir)
+        return -1;
+    while (dirent *entry = readdir(dir)) {
+        if (entry->d_name[0] != '.')
+            ++count;
+    }
+    closedir(dir);
+    return count;
+#else
+    return -1;
+#endif
+}
+
+
+// many periodic timers share a single thread; the jitter (i.e., lateness of the triggers) is measured.
+int test_timer_service() {
+    typedef std::chrono::steady_clock Clock;
+    auto &service = TimerService::instance();
+
+    const int threads_before = num_process_threads();
+
+    const int num_timers = 200;
+    const int interval = 20;
+    const int duration = 500;
+    std::mutex jitter_mutex;
+    std::vector<double> lateness;   // in milliseconds
+    std::vector<std::atomic<int> > counts(num_timers);
+
+    const auto start = Clock::now();
+    std::vector<TimerService::Handle> handles;
+    for (int i = 0; i < num_timers; ++i) {
+        counts[i] = 0;
+        handles.push_back(service.schedule(interval, interval, [&, i]() {
+            const int k = ++counts[i];
+            const auto expected = start + std::chrono::milliseconds(interval * k);
+            const double late = std::chrono::duration<double, std::milli>(Clock::now() - expected).count();
+            std::lock_guard<std::mutex> guard(jitter_mutex);
+            lateness.push_back(late);
+        }));
+    }
+
+    // a cancelled task is never executed
+    std::atomic<bool> cancelled_executed(false);
+    auto cancelled = service.schedule(100, 0, [&]() { cancelled_executed = true; });
+    service.cancel(cancelled);
+
+    // the tasks of a destroyed timer are cancelled
+    std::atomic<int> destroyed_count(0);
+    {
+        Timer<> t;
+        t.set_interval(10, [&]() { ++destroyed_count; });
+    }
+
+    // tasks dispatched to the main thread are executed only by process_main_thread_tasks()
+    std::atomic<int> main_count(0);
+    const auto main_thread = std::this_thread::get_id();
+    bool wrong_thread = false;
+    Timer<> main_timer;
+    main_timer.set_dispatch(TimerService::MAIN_THREAD);
+    main_timer.set_interval(50, [&]() {
+        if (std::this_thread::get_id() != main_thread)
+            wrong_thread = true;
+        ++main_count;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration / 2));
+    const int threads_during = num_process_threads();
+    const bool main_not_executed = (main_count == 0);
+    while (Clock::now() - start < std::chrono::milliseconds(duration)) {
+        service.process_main_thread_tasks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    main_timer.stop();
+    for (auto h : handles)
+        service.cancel(h);
+
+    int failures = 0;
+    if (service.num_threads() != 1) {
+        std::cerr << "timer service uses " << service.num_threads() << " threads" << std::endl;
+        ++failures;
+    }
+    // the dispatcher thread may have been started by the previous tests
+    if (threads_before > 0 && threads_during - threads_before > 1) {
+        std::cerr << "threads: " << threads_before << " before, " << threads_during << " with "
+                  << num_timers << " timers" << std::endl;
+        ++failures;
+    }
+    if (cancelled_executed || destroyed_count != 0) {
+        std::cerr << "cancelled tasks have been executed" << std::endl;
+        ++failures;
+    }
+    if (!main_not_executed || main_count == 0 || wrong_thread) {
+        std::cerr << "main thread tasks are not correctly dispatched" << std::endl;
+        ++failures;
+    }
+
+    // each owner (e.g., a viewer) has its own notifier, and removing one keeps the others
+    int owner_a = 0, owner_b = 0;
+    std::atomic<int> notified_a(0), notified_b(0);
+    service.add_main_thread_notifier(&owner_a, [&]() { ++notified_a; });
+    service.add_main_thread_notifier(&owner_b, [&]() { ++notified_b; });
+    service.post([]() {});
+    service.remove_main_thread_notifier(&owner_a);
+    const int notified_a_after_removal = notified_a;
+    const int notified_b_before = notified_b;
+    service.post([]() {});
+    service.remove_main_thread_notifier(&owner_b);
+    service.process_main_thread_tasks();
+    if (notified_a_after_removal == 0 || notified_a != notified_a_after_removal || notified_b <= notified_b_before) {
+        std::cerr << "main thread notifiers: " << notified_a << " calls of the removed one, " << notified_b
+                  << " calls of the remaining one" << std::endl;
+        ++failures;
+    }
+
+    std::lock_guard<std::mutex> guard(jitter_mutex);
+    if (lateness.empty()) {
+        std::cerr << "no timer has been triggered" << std::endl;
+        return 1;
+    }
+    std::sort(lateness.begin(), lateness.end());
+    double mean = 0.0;
+    for (auto l : lateness)
+        mean += l;
+    mean /= static_cast<double>(lateness.size());
+    std::cout << num_timers << " timers (" << interval << " ms) on " << threads_during - threads_before + 1
+              << " thread(s), " << lateness.size() << " triggers. Jitter: mean " << mean << " ms, median "
+              << lateness[lateness.size() / 2] << " ms, max " << lateness.back() << " ms" << std::endl;
+
+    // loose bounds (the test may run on a busy machine)
+    if (lateness[lateness.size() / 2] > interval) {
+        std::cerr << "timer jitter is too large" << std::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+
 int test_timer() {
     Car car(100);
 
@@ -276,5 +425,9 @@ int test_timer() {
     test_timer_for_lambda_functions(&car);
     std::this_thread::sleep_for(std::chrono::seconds(1));
 
+    std::cout << "\ntimer service ------------------------------------------------------------------------\n";
+    if (test_timer_service() != 0)
+        return EXIT_FAILURE;
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,87 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/viewer/batch_renderer.h>
+#include <easy3d/util/resource.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
+
+
+using namespace easy3d;
+
+
+int batch_rendering() {
+    const std::vector<std::string> files = {
+            resource::directory() + "/data/bunny.ply",        // point cloud
+            resource::directory() + "/data/sphere.obj",       // surface mesh
+            resource::directory() + "/data/graph.ply",        // graph
+            resource::directory() + "/data/sphere.plm",       // polyhedral mesh
+            resource::directory() + "/data/not_existing.off"  // expected to fail
+    };
+
+    // the images are written into a temporary directory, which is deleted after checking
+    const std::string dir = file_system::executable_directory() + "/batch_rendering";
+    if (!file_system::is_directory(dir) && !file_system::create_directory(dir)) {
+        LOG(ERROR) << "failed creating directory " << dir;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BatchRenderer::Job> jobs;
+    for (const auto& file : files) {
+        BatchRenderer::Job job(file, 320, 240);
+        const std::string name = dir + "/batch-" + file_system::base_name(file);
+        job.views.emplace_back(name + "-0.png");
+        job.views.emplace_back(name + "-1.png", vec3(0, 0, 5), quat(vec3(0, 0, 1), 0));  // looking down
+        jobs.push_back(job);
+    }
+    jobs[1].width = 256;    // a different resolution
+    jobs[1].height = 256;
+
+    BatchRenderer renderer;
+    const auto reports = renderer.render(jobs);
+
+    bool failed = false;
+    for (std::size_t i = 0; i + 1 < reports.size(); ++i) {
+        if (!reports[i].success || reports[i].num_images != 2) {
+            LOG(ERROR) << "batch rendering failed for " << files[i];
+            failed = true;
+        }
+        for (const auto& view : jobs[i].views) {
+            if (!file_system::is_file(view.file_name)) {
+                LOG(ERROR) << "image " << view.file_name << " has not been written";
+                failed = true;
+            }
+        }
+    }
+    if (reports.back().success) {
+        LOG(ERROR) << "a missing model should be reported as a failure";
+        failed = true;
+    }
+
+    file_system::delete_directory(dir);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -38,26 +38,31 @@ using namespace easy3d;
 // This example shows how to use another thread for
 //      - repeatedly modifying a model, and
 //      - notifying the viewer thread
+// The model being rendered must not be modified by another thread. Instead, the other thread modifies its own copy
+// of the model and publishes snapshots of it, which are picked up by the viewer at the start of the next frame.
+// NOTE: picking up a snapshot replaces the properties of the model being rendered, so the property handles taken from
+//       it (e.g., 'colors' in main()) become invalid after a frame. Fetch them again whenever you need them, e.g.,
+//       auto colors = cloud->get_vertex_property<vec3>("v:color");
 
 
 // a function that modifies the model.
-// in this simple example, we add more points (with per point colors) to a point cloud.
-void edit_model(PointCloud *cloud, Viewer *viewer) {
-    if (cloud->n_vertices() >= 1000000) // stop growing when the model is too big
+// in this simple example, we add more points (with per point colors) to the worker's copy of the point cloud.
+void edit_model(PointCloud *working, PointCloud *cloud, Viewer *viewer) {
+    if (working->n_vertices() >= 1000000) // stop growing when the model is too big
         return;
 
-    auto colors = cloud->vertex_property<vec3>("v:color");
+    auto colors = working->vertex_property<vec3>("v:color");
     for (int i = 0; i < 100; ++i) {
-        auto v = cloud->add_vertex(vec3(random_float(), random_float(), random_float()));
+        auto v = working->add_vertex(vec3(random_float(), random_float(), random_float()));
         colors[v] = vec3(random_float(), random_float(), random_float()); // we use a random color
     }
 
-    // notify the renderer to update the OpenGL buffers
-    cloud->renderer()->update();
+    // hand over a snapshot to the renderer (it updates the OpenGL buffers at the start of the next frame)
+    cloud->renderer()->publish(new PointCloud(*working));
     // notify the viewer to update the display
     viewer->update();
 
-    std::cout << "#points: " << cloud->n_vertices() << std::endl;
+    std::cout << "#points: " << working->n_vertices() << std::endl;
 }
 
 
@@ -77,6 +82,8 @@ int main(int argc, char **argv) {
         // assign a color to each point (here simply a red color)
         colors[v] = vec3(1.0f, 0.0f, 0.0f);
     }
+    // 'colors' must not be used after the viewer has applied a snapshot (i.e., once the viewer is running)
+
     // add the point cloud to the viewer for visualization
     viewer.add_model(cloud);
 
@@ -87,21 +94,22 @@ int main(int argc, char **argv) {
     // set coloring method: we want to visualize the point cloud using the per point color property
     drawable->set_coloring(Drawable::COLOR_PROPERTY, Drawable::VERTEX, "v:color");
 
+    // the copy of the point cloud modified by the other thread
+    PointCloud working(*cloud);
+
     // run the process in another thread.
 #if 1   //  we use a timer to repeatedly edit the point cloud every 300 milliseconds
-    Timer<PointCloud *, Viewer *> timer;
-    timer.set_interval(300, edit_model, cloud, &viewer);
+    Timer<PointCloud *, PointCloud *, Viewer *> timer;
+    timer.set_interval(300, edit_model, &working, cloud, &viewer);
 
     // stop editing the model after 20 seconds
-    Timer<>::single_shot(20000, &timer, &Timer<PointCloud*, Viewer*>::stop); // or Timer<>::single_shot(4900, [&]() -> void { timer.stop(); });
+    Timer<>::single_shot(20000, &timer, &Timer<PointCloud*, PointCloud*, Viewer*>::stop); // or Timer<>::single_shot(4900, [&]() -> void { timer.stop(); });
 #else   // use a simple for loop to repeat the editing a fix number of iterations
     Timer<>::single_shot(0, [&]() {
         // in this example, we modify the point cloud 50 times
         for (int i = 0; i < 50; ++i) {
-            // allow sufficient time for each edit to complete (each edit runs in a separate thread)
             std::this_thread::sleep_for(std::chrono::milliseconds(300));
-            std::thread t(edit_model, cloud, &viewer);
-            t.detach();
+            edit_model(&working, cloud, &viewer);
         }
     });
 #endif